@@ -0,0 +1,364 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+
+/*
+ *!
+ *! The protocols implemented in this file are intended to be demo quality only,
+ *! and not for production devices.
+ *!
+ *
+ * TCPServerBenchmark.c
+ *
+ * Measures how the TCP server (FreeRTOS_TCP_server.c) copes with concurrent
+ * downloads.  Rounds of 1, 2, 4, ... tcpbenchMAX_CLIENTS client tasks each
+ * fetch tcpbenchPATH tcpbenchREQUESTS_PER_CLIENT times over a new connection.
+ * After every round the total throughput and the 50th, 90th and 99th
+ * percentile and maximum request latency are printed, for instance:
+ *
+ *     TCP-bench 4 clients: 80 req 0 fail 5242880 bytes 1310 KB/s latency p50 210 p90 250 p99 410 max 430 ms
+ *
+ * Run it on a second board or simulator against a server built with and
+ * without ipconfigTCP_SERVER_WORKERS to compare the two.  A server that serves
+ * its clients one after the other shows a tail latency that grows with the
+ * number of clients.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+
+#include "TCPServerBenchmark.h"
+
+/* The server under test. */
+#ifndef tcpbenchSERVER_ADDRESS
+    #define tcpbenchSERVER_ADDRESS    "192.168.2.114"
+#endif
+
+#ifndef tcpbenchSERVER_PORT
+    #define tcpbenchSERVER_PORT    ( 80 )
+#endif
+
+/* The file that every client downloads. */
+#ifndef tcpbenchPATH
+    #define tcpbenchPATH    "/index.html"
+#endif
+
+/* The last round runs this many clients at the same time. */
+#ifndef tcpbenchMAX_CLIENTS
+    #define tcpbenchMAX_CLIENTS    ( 16 )
+#endif
+
+#ifndef tcpbenchREQUESTS_PER_CLIENT
+    #define tcpbenchREQUESTS_PER_CLIENT    ( 20 )
+#endif
+
+/* Time allowed for a single download before it is counted as a failure. */
+#define tcpbenchREQUEST_TIMEOUT_MS    ( 10000U )
+
+/* Pause between two rounds, to let the server close its connections. */
+#define tcpbenchROUND_DELAY_MS        ( 2000U )
+
+/*-----------------------------------------------------------*/
+
+typedef struct xBENCH_CLIENT
+{
+    UBaseType_t uxFailures;
+    uint32_t ulBytes;
+    /* Latency of every successful request, in ticks. */
+    UBaseType_t uxLatencyCount;
+    TickType_t xLatencies[ tcpbenchREQUESTS_PER_CLIENT ];
+} BenchClient_t;
+
+/*-----------------------------------------------------------*/
+
+static void prvBenchmarkTask( void * pvParameters );
+static void prvClientTask( void * pvParameters );
+static BaseType_t prvDownload( uint32_t ulServerIP,
+                               char * pcBuffer,
+                               size_t uxBufferLength,
+                               uint32_t * pulBytes );
+static int prvCompareTicks( const void * pvLeft,
+                            const void * pvRight );
+
+/*-----------------------------------------------------------*/
+
+static BenchClient_t xClients[ tcpbenchMAX_CLIENTS ];
+
+/* All latencies of a round, sorted to find the percentiles. */
+static TickType_t xAllLatencies[ tcpbenchMAX_CLIENTS * tcpbenchREQUESTS_PER_CLIENT ];
+
+/* Given by each client task when it has finished its requests. */
+static SemaphoreHandle_t xClientDone = NULL;
+
+static uint16_t usClientStackSize;
+
+/*-----------------------------------------------------------*/
+
+void vStartTCPServerBenchmark( uint16_t usTaskStackSize,
+                               UBaseType_t uxTaskPriority )
+{
+    xClientDone = xSemaphoreCreateCounting( tcpbenchMAX_CLIENTS, 0 );
+
+    if( xClientDone != NULL )
+    {
+        usClientStackSize = usTaskStackSize;
+
+        /* The clients run at the priority of the benchmark task, which
+         * only wakes up at the end of each round. */
+        xTaskCreate( prvBenchmarkTask, "TCPBench", usTaskStackSize, NULL, uxTaskPriority, NULL );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchmarkTask( void * pvParameters )
+{
+    UBaseType_t uxClientCount;
+    UBaseType_t uxIndex;
+    UBaseType_t uxRequests;
+    UBaseType_t uxFailures;
+    uint32_t ulBytes;
+    TickType_t xStartTime;
+    TickType_t xElapsed;
+
+    ( void ) pvParameters;
+
+    for( uxClientCount = 1; uxClientCount <= tcpbenchMAX_CLIENTS; uxClientCount *= 2 )
+    {
+        vTaskDelay( pdMS_TO_TICKS( tcpbenchROUND_DELAY_MS ) );
+
+        memset( xClients, '\0', sizeof( xClients ) );
+        xStartTime = xTaskGetTickCount();
+
+        for( uxIndex = 0; uxIndex < uxClientCount; uxIndex++ )
+        {
+            if( xTaskCreate( prvClientTask, "TCPBenchCl", usClientStackSize, &( xClients[ uxIndex ] ),
+                             uxTaskPriorityGet( NULL ), NULL ) != pdPASS )
+            {
+                /* Count the missing client as a failed client. */
+                xClients[ uxIndex ].uxFailures = tcpbenchREQUESTS_PER_CLIENT;
+                xSemaphoreGive( xClientDone );
+            }
+        }
+
+        for( uxIndex = 0; uxIndex < uxClientCount; uxIndex++ )
+        {
+            xSemaphoreTake( xClientDone, portMAX_DELAY );
+        }
+
+        xElapsed = xTaskGetTickCount() - xStartTime;
+
+        uxRequests = 0;
+        uxFailures = 0;
+        ulBytes = 0;
+
+        for( uxIndex = 0; uxIndex < uxClientCount; uxIndex++ )
+        {
+            memcpy( &( xAllLatencies[ uxRequests ] ), xClients[ uxIndex ].xLatencies,
+                    xClients[ uxIndex ].uxLatencyCount * sizeof( TickType_t ) );
+            uxRequests += xClients[ uxIndex ].uxLatencyCount;
+            uxFailures += xClients[ uxIndex ].uxFailures;
+            ulBytes += xClients[ uxIndex ].ulBytes;
+        }
+
+        if( xElapsed == 0 )
+        {
+            xElapsed = 1;
+        }
+
+        if( uxRequests == 0 )
+        {
+            FreeRTOS_printf( ( "TCP-bench %u clients: all %u requests failed\n",
+                               ( unsigned ) uxClientCount, ( unsigned ) uxFailures ) );
+        }
+        else
+        {
+            qsort( xAllLatencies, uxRequests, sizeof( TickType_t ), prvCompareTicks );
+
+            FreeRTOS_printf( ( "TCP-bench %u clients: %u req %u fail %lu bytes %lu KB/s latency p50 %lu p90 %lu p99 %lu max %lu ms\n",
+                               ( unsigned ) uxClientCount,
+                               ( unsigned ) uxRequests,
+                               ( unsigned ) uxFailures,
+                               ( unsigned long ) ulBytes,
+                               ( unsigned long ) ( ( ( uint64_t ) ulBytes * configTICK_RATE_HZ ) / ( ( uint64_t ) xElapsed * 1024U ) ),
+                               ( unsigned long ) ( xAllLatencies[ ( uxRequests * 50U ) / 100U ] * portTICK_PERIOD_MS ),
+                               ( unsigned long ) ( xAllLatencies[ ( uxRequests * 90U ) / 100U ] * portTICK_PERIOD_MS ),
+                               ( unsigned long ) ( xAllLatencies[ ( uxRequests * 99U ) / 100U ] * portTICK_PERIOD_MS ),
+                               ( unsigned long ) ( xAllLatencies[ uxRequests - 1U ] * portTICK_PERIOD_MS ) ) );
+        }
+    }
+
+    FreeRTOS_printf( ( "TCP-bench ready\n" ) );
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvClientTask( void * pvParameters )
+{
+    BenchClient_t * pxClient = ( BenchClient_t * ) pvParameters;
+    uint32_t ulServerIP = FreeRTOS_inet_addr( tcpbenchSERVER_ADDRESS );
+    char pcBuffer[ 512 ];
+    UBaseType_t uxRequest;
+    TickType_t xStartTime;
+    uint32_t ulBytes;
+
+    for( uxRequest = 0; uxRequest < tcpbenchREQUESTS_PER_CLIENT; uxRequest++ )
+    {
+        xStartTime = xTaskGetTickCount();
+
+        if( prvDownload( ulServerIP, pcBuffer, sizeof( pcBuffer ), &ulBytes ) == pdPASS )
+        {
+            pxClient->xLatencies[ pxClient->uxLatencyCount ] = xTaskGetTickCount() - xStartTime;
+            pxClient->uxLatencyCount++;
+            pxClient->ulBytes += ulBytes;
+        }
+        else
+        {
+            pxClient->uxFailures++;
+        }
+    }
+
+    xSemaphoreGive( xClientDone );
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvDownload( uint32_t ulServerIP,
+                               char * pcBuffer,
+                               size_t uxBufferLength,
+                               uint32_t * pulBytes )
+{
+    Socket_t xSocket;
+    struct freertos_sockaddr xAddress;
+    TickType_t xTimeout = pdMS_TO_TICKS( tcpbenchREQUEST_TIMEOUT_MS );
+    BaseType_t xResult = pdFAIL;
+    BaseType_t xLength;
+    BaseType_t xRc;
+
+    *pulBytes = 0;
+
+    xSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_STREAM, FREERTOS_IPPROTO_TCP );
+
+    if( xSocket == FREERTOS_INVALID_SOCKET )
+    {
+        return pdFAIL;
+    }
+
+    FreeRTOS_setsockopt( xSocket, 0, FREERTOS_SO_RCVTIMEO, &xTimeout, sizeof( xTimeout ) );
+    FreeRTOS_setsockopt( xSocket, 0, FREERTOS_SO_SNDTIMEO, &xTimeout, sizeof( xTimeout ) );
+
+    memset( &xAddress, '\0', sizeof( xAddress ) );
+    xAddress.sin_family = FREERTOS_AF_INET;
+    xAddress.sin_port = FreeRTOS_htons( tcpbenchSERVER_PORT );
+
+    #if defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 )
+    {
+        xAddress.sin_address.ulIP_IPv4 = ulServerIP;
+    }
+    #else
+    {
+        xAddress.sin_addr = ulServerIP;
+    }
+    #endif
+
+    if( FreeRTOS_connect( xSocket, &xAddress, sizeof( xAddress ) ) == 0 )
+    {
+        xLength = snprintf( pcBuffer, uxBufferLength,
+                            "GET %s HTTP/1.1\r\n"
+                            "Host: %s\r\n"
+                            "Connection: close\r\n"
+                            "\r\n",
+                            tcpbenchPATH,
+                            tcpbenchSERVER_ADDRESS );
+
+        if( FreeRTOS_send( xSocket, pcBuffer, xLength, 0 ) == xLength )
+        {
+            /* Read until the server closes the connection.  The headers are
+             * counted as well. */
+            for( ; ; )
+            {
+                xRc = FreeRTOS_recv( xSocket, pcBuffer, uxBufferLength, 0 );
+
+                if( xRc > 0 )
+                {
+                    *pulBytes += ( uint32_t ) xRc;
+                }
+                else if( xRc == 0 )
+                {
+                    /* Timed out. */
+                    break;
+                }
+                else
+                {
+                    /* A closed connection is the normal end of the reply. */
+                    if( *pulBytes > 0U )
+                    {
+                        xResult = pdPASS;
+                    }
+
+                    break;
+                }
+            }
+        }
+    }
+
+    FreeRTOS_shutdown( xSocket, FREERTOS_SHUT_RDWR );
+    FreeRTOS_closesocket( xSocket );
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+static int prvCompareTicks( const void * pvLeft,
+                            const void * pvRight )
+{
+    TickType_t xLeft = *( ( const TickType_t * ) pvLeft );
+    TickType_t xRight = *( ( const TickType_t * ) pvRight );
+    int iResult = 0;
+
+    if( xLeft < xRight )
+    {
+        iResult = -1;
+    }
+    else if( xLeft > xRight )
+    {
+        iResult = 1;
+    }
+
+    return iResult;
+}
+/*-----------------------------------------------------------*/
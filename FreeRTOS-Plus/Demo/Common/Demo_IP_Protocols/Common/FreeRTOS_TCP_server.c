@@ -55,6 +55,13 @@
 /* Remove slashes at the end of a path. */
     static void prvRemoveSlash( char * pcDir );
 
+    #if ( ipconfigTCP_SERVER_WORKERS > 0 )
+        static void prvCreateWorkers( TCPServer_t * pxServer );
+        static TCPServer_t * prvLeastLoadedWorker( TCPServer_t * pxServer );
+        static void prvTakeNewClients( TCPServer_t * pxWorker );
+        static void prvWorkerTask( void * pvParameters );
+    #endif
+
     TCPServer_t * FreeRTOS_CreateTCPServer( const struct xSERVER_CONFIG * pxConfigs,
                                             BaseType_t xCount )
     {
@@ -150,6 +157,15 @@
                 /* Could not allocate the server, delete the socket set */
                 FreeRTOS_DeleteSocketSet( xSocketSet );
             }
+
+            #if ( ipconfigTCP_SERVER_WORKERS > 0 )
+            {
+                if( pxServer != NULL )
+                {
+                    prvCreateWorkers( pxServer );
+                }
+            }
+            #endif
         }
         else
         {
@@ -170,6 +186,7 @@
         FTCPWorkFunction fWorkFunc = NULL;
         FTCPDeleteFunction fDeleteFunc = NULL;
         const char * pcType = "Unknown";
+        TCPServer_t * pxOwner = pxServer;
 
         /*_RB_ Can the work and delete functions be part of the xSERVER_CONFIG structure
          * becomes generic, with no pre-processing required? */
@@ -203,31 +220,74 @@
             pxClient = ( TCPClient_t * ) pvPortMallocLarge( xSize );
         }
 
+        #if ( ipconfigTCP_SERVER_WORKERS > 0 )
+        {
+            pxOwner = prvLeastLoadedWorker( pxServer );
+        }
+        #endif
+
         if( pxClient != NULL )
         {
             memset( pxClient, '\0', xSize );
 
-            /* Put the new client in front of the list. */
             pxClient->eType = pxServer->xServers[ xIndex ].eType;
             pxClient->pcRootDir = pxServer->xServers[ xIndex ].pcRootDir;
-            pxClient->pxParent = pxServer;
+            pxClient->pxParent = pxOwner;
             pxClient->xSocket = xNexSocket;
-            pxClient->pxNextClient = pxServer->pxClients;
             pxClient->fWorkFunction = fWorkFunc;
             pxClient->fDeleteFunction = fDeleteFunc;
-            pxServer->pxClients = pxClient;
 
-            FreeRTOS_FD_SET( xNexSocket, pxServer->xSocketSet, eSELECT_READ | eSELECT_EXCEPT );
+            if( pxOwner == pxServer )
+            {
+                /* Put the new client in front of the list. */
+                pxClient->pxNextClient = pxServer->pxClients;
+                pxServer->pxClients = pxClient;
+
+                FreeRTOS_FD_SET( xNexSocket, pxServer->xSocketSet, eSELECT_READ | eSELECT_EXCEPT );
+            }
+
+            #if ( ipconfigTCP_SERVER_WORKERS > 0 )
+                else
+                {
+                    /* Count the client before the worker can see it, the worker
+                     * decrements the count when the client is deleted. */
+                    taskENTER_CRITICAL();
+                    {
+                        pxOwner->uxClientCount++;
+                    }
+                    taskEXIT_CRITICAL();
+
+                    /* A new connection can be written to straight away, so
+                     * eSELECT_WRITE wakes up the worker's select().  The worker
+                     * clears it when it takes the client, so the bits are set
+                     * before the client is queued. */
+                    FreeRTOS_FD_SET( xNexSocket, pxOwner->xSocketSet, eSELECT_READ | eSELECT_EXCEPT | eSELECT_WRITE );
+
+                    if( xQueueSend( pxOwner->xNewClients, &pxClient, 0 ) != pdPASS )
+                    {
+                        FreeRTOS_FD_CLR( xNexSocket, pxOwner->xSocketSet, eSELECT_ALL );
+
+                        taskENTER_CRITICAL();
+                        {
+                            pxOwner->uxClientCount--;
+                        }
+                        taskEXIT_CRITICAL();
+
+                        vPortFreeLarge( pxClient );
+                        pxClient = NULL;
+                    }
+                }
+            #endif /* ipconfigTCP_SERVER_WORKERS */
         }
-        else
+
+        if( pxClient == NULL )
         {
             pcType = "closed";
-            FreeRTOS_closesocket( xNexSocket );
         }
 
         {
             struct freertos_sockaddr xRemoteAddress;
-            FreeRTOS_GetRemoteAddress( pxClient->xSocket, &xRemoteAddress );
+            FreeRTOS_GetRemoteAddress( xNexSocket, &xRemoteAddress );
             #if defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 )
             {
                 FreeRTOS_printf( ( "TPC-server: new %s client %xip\n", pcType, ( unsigned ) FreeRTOS_ntohl( xRemoteAddress.sin_address.ulIP_IPv4 ) ) );
@@ -239,6 +299,11 @@
             #endif /* defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 ) */
         }
 
+        if( pxClient == NULL )
+        {
+            FreeRTOS_closesocket( xNexSocket );
+        }
+
         /* Remove compiler warnings in case FreeRTOS_printf() is not used. */
         ( void ) pcType;
     }
@@ -277,6 +342,25 @@
             }
         }
 
+        #if ( ipconfigTCP_SERVER_WORKERS > 0 )
+        {
+            if( pxServer->xNewClients != NULL )
+            {
+                prvTakeNewClients( pxServer );
+
+                #if ( ipconfigUSE_HTTP != 0 ) && ( ipconfigHTTP_CACHE_ENTRIES > 0 )
+                {
+                    if( pxServer->xHTTPCacheFlushPending != pdFALSE )
+                    {
+                        vHTTPCacheDrop( pxServer );
+                        pxServer->xHTTPCacheFlushPending = pdFALSE;
+                    }
+                }
+                #endif
+            }
+        }
+        #endif
+
         ppxClient = &pxServer->pxClients;
 
         while( ( *ppxClient ) != NULL )
@@ -293,6 +377,19 @@
                 pxThis->fDeleteFunction( pxThis );
                 /* Free the space */
                 vPortFreeLarge( pxThis );
+
+                #if ( ipconfigTCP_SERVER_WORKERS > 0 )
+                {
+                    if( pxServer->xNewClients != NULL )
+                    {
+                        taskENTER_CRITICAL();
+                        {
+                            pxServer->uxClientCount--;
+                        }
+                        taskEXIT_CRITICAL();
+                    }
+                }
+                #endif
             }
             else
             {
@@ -302,6 +399,119 @@
     }
 /*-----------------------------------------------------------*/
 
+    #if ( ipconfigTCP_SERVER_WORKERS > 0 )
+
+        static void prvCreateWorkers( TCPServer_t * pxServer )
+        {
+            BaseType_t xIndex;
+
+            for( xIndex = 0; xIndex < ipconfigTCP_SERVER_WORKERS; xIndex++ )
+            {
+                TCPServer_t * pxWorker;
+                TaskHandle_t xHandle = NULL;
+
+                /* A worker has no listening sockets, but it needs the
+                 * buffers and the socket set of a server. */
+                pxWorker = ( TCPServer_t * ) pvPortMallocLarge( sizeof( *pxWorker ) );
+
+                if( pxWorker == NULL )
+                {
+                    break;
+                }
+
+                memset( pxWorker, '\0', sizeof( *pxWorker ) );
+                pxWorker->xSocketSet = FreeRTOS_CreateSocketSet();
+                pxWorker->xNewClients = xQueueCreate( ipconfigTCP_SERVER_WORKER_QUEUE_LENGTH, sizeof( TCPClient_t * ) );
+
+                if( ( pxWorker->xSocketSet != NULL ) && ( pxWorker->xNewClients != NULL ) )
+                {
+                    xTaskCreate( prvWorkerTask, "TCPWorker", ipconfigTCP_SERVER_WORKER_STACK_SIZE,
+                                 pxWorker, ipconfigTCP_SERVER_WORKER_PRIORITY, &xHandle );
+                }
+
+                if( xHandle == NULL )
+                {
+                    if( pxWorker->xNewClients != NULL )
+                    {
+                        vQueueDelete( pxWorker->xNewClients );
+                    }
+
+                    if( pxWorker->xSocketSet != NULL )
+                    {
+                        FreeRTOS_DeleteSocketSet( pxWorker->xSocketSet );
+                    }
+
+                    vPortFreeLarge( pxWorker );
+                    break;
+                }
+
+                #if ( ipconfigTCP_SERVER_WORKER_CORE_AFFINITY != 0 ) && ( configUSE_CORE_AFFINITY == 1 ) && ( configNUMBER_OF_CORES > 1 )
+                {
+                    vTaskCoreAffinitySet( xHandle, ( UBaseType_t ) 1U << ( xIndex % configNUMBER_OF_CORES ) );
+                }
+                #endif
+
+                pxServer->pxWorkers[ xIndex ] = pxWorker;
+            }
+
+            /* Clients are served by the server's own task when no worker
+             * could be created. */
+            FreeRTOS_printf( ( "TCP-server: %d worker(s)\n", ( int ) xIndex ) );
+        }
+/*-----------------------------------------------------------*/
+
+        static TCPServer_t * prvLeastLoadedWorker( TCPServer_t * pxServer )
+        {
+            TCPServer_t * pxBest = pxServer;
+            BaseType_t xIndex;
+
+            for( xIndex = 0; xIndex < ipconfigTCP_SERVER_WORKERS; xIndex++ )
+            {
+                TCPServer_t * pxWorker = pxServer->pxWorkers[ xIndex ];
+
+                if( pxWorker == NULL )
+                {
+                    break;
+                }
+
+                if( ( pxBest == pxServer ) || ( pxWorker->uxClientCount < pxBest->uxClientCount ) )
+                {
+                    pxBest = pxWorker;
+                }
+            }
+
+            return pxBest;
+        }
+/*-----------------------------------------------------------*/
+
+        static void prvTakeNewClients( TCPServer_t * pxWorker )
+        {
+            TCPClient_t * pxClient;
+
+            while( xQueueReceive( pxWorker->xNewClients, &pxClient, 0 ) == pdPASS )
+            {
+                /* Put the new client in front of the list. */
+                pxClient->pxNextClient = pxWorker->pxClients;
+                pxWorker->pxClients = pxClient;
+
+                FreeRTOS_FD_CLR( pxClient->xSocket, pxWorker->xSocketSet, eSELECT_WRITE );
+            }
+        }
+/*-----------------------------------------------------------*/
+
+        static void prvWorkerTask( void * pvParameters )
+        {
+            TCPServer_t * pxWorker = ( TCPServer_t * ) pvParameters;
+
+            for( ; ; )
+            {
+                FreeRTOS_TCPServerWork( pxWorker, ipconfigTCP_SERVER_WORKER_BLOCK_TIME );
+            }
+        }
+/*-----------------------------------------------------------*/
+
+    #endif /* ipconfigTCP_SERVER_WORKERS */
+
     static char * strnew( const char * pcString )
     {
         BaseType_t xLength;
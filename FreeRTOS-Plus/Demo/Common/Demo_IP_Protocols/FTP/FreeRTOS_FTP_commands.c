@@ -63,6 +63,7 @@ const FTPCommand_t xFTPCommands[ FTP_CMD_COUNT ] =
     { 3, "PWD",  ECMD_PWD,     pdTRUE,  pdFALSE },
     { 4, "LIST", ECMD_LIST,    pdTRUE,  pdFALSE },
     { 4, "NLST", ECMD_NLST,    pdTRUE,  pdFALSE },
+    { 4, "MLSD", ECMD_MLSD,    pdTRUE,  pdFALSE },
     { 4, "SITE", ECMD_SITE,    pdTRUE,  pdFALSE },
     { 4, "SYST", ECMD_SYST,    pdFALSE, pdFALSE },
     { 4, "FEAT", ECMD_FEAT,    pdFALSE, pdFALSE },
@@ -88,14 +88,30 @@
     #endif
 
 /*
- * ipconfigFTP_ZERO_COPY_ALIGNED_WRITES : experimental optimisation option.
- * If non-zero, receiving data will be done with the zero-copy method and also
- * writes to disk will be done with sector-alignment as much as possible.
+ * ipconfigFTP_ZERO_COPY_ALIGNED_WRITES : if non-zero, receiving data will be
+ * done with the zero-copy method and also writes to disk will be done with
+ * sector-alignment as much as possible, see ipconfigFTP_PREFERRED_WRITE_SIZE.
  */
     #ifndef ipconfigFTP_ZERO_COPY_ALIGNED_WRITES
         #define ipconfigFTP_ZERO_COPY_ALIGNED_WRITES    0
     #endif
 
+/*
+ * ipconfigFTP_TX_ZERO_COPY : if non-zero, files are read from disk straight
+ * into the TX stream of the data socket, using FreeRTOS_get_tx_head().  Reads
+ * are done in multiples of 512 bytes.  Data is only copied through
+ * pcFileBuffer when the free space in the stream wraps around.
+ *
+ * See also ipconfigFTP_TX_DOUBLE_BUFFER in FreeRTOS_server_private.h.
+ */
+    #ifndef ipconfigFTP_TX_ZERO_COPY
+        #define ipconfigFTP_TX_ZERO_COPY    0
+    #endif
+
+    #if ( ipconfigFTP_TX_ZERO_COPY != 0 ) && ( ipconfigFTP_TX_DOUBLE_BUFFER != 0 )
+        #error Please define either ipconfigFTP_TX_ZERO_COPY or ipconfigFTP_TX_DOUBLE_BUFFER, not both
+    #endif
+
 /*
  * This module only has 2 public functions:
  */
@@ -231,8 +247,10 @@
 
 /*
  * LIST: Send a directory listing in Unix style.
+ * MLSD: Send a directory listing in the format of RFC 3659.
  */
-    static BaseType_t prvListSendPrep( FTPClient_t * pxClient );
+    static BaseType_t prvListSendPrep( FTPClient_t * pxClient,
+                                       BaseType_t xMachineList );
     static BaseType_t prvListSendWork( FTPClient_t * pxClient );
 
 /*
@@ -242,6 +260,15 @@
                                            char * pcFileName );
     static BaseType_t prvRetrieveFileWork( FTPClient_t * pxClient );
 
+    #if ( ipconfigFTP_TX_DOUBLE_BUFFER != 0 )
+
+/*
+ * RETR: the double-buffered variant of the transmission loop.
+ */
+        static BaseType_t prvRetrieveFileBuffered( FTPClient_t * pxClient );
+        static BaseType_t prvFillTxBuffers( FTPClient_t * pxClient );
+    #endif
+
 /*
  * STOR: Receive a file from the FTP client and store it.
  */
@@ -252,10 +279,18 @@
 /*
  * Print/format a single directory entry in Unix style.
  */
-    static BaseType_t prvGetFileInfoStat( FF_DirEnt_t * pxEntry,
+    static BaseType_t prvGetFileInfoStat( FTPClient_t * pxClient,
+                                          FF_DirEnt_t * pxEntry,
                                           char * pcLine,
                                           BaseType_t xMaxLength );
 
+/*
+ * Print/format a single directory entry as an MLSD fact line.
+ */
+    static BaseType_t prvGetFileInfoFacts( FF_DirEnt_t * pxEntry,
+                                           char * pcLine,
+                                           BaseType_t xMaxLength );
+
 /*
  * Send a reply to a socket, either the command- or the data-socket.
  */
@@ -814,6 +849,7 @@
                     break;
 
                 case ECMD_LIST:
+                case ECMD_MLSD:
                 case ECMD_RETR:
                 case ECMD_STOR:
 
@@ -843,7 +879,8 @@
                         switch( pxFTPCommand->ucCommandType )
                         {
                             case ECMD_LIST:
-                                prvListSendPrep( pxClient );
+                            case ECMD_MLSD:
+                                prvListSendPrep( pxClient, pxFTPCommand->ucCommandType == ECMD_MLSD );
                                 break;
 
                             case ECMD_RETR:
@@ -887,6 +924,7 @@
                            #if ( ffconfigTIME_SUPPORT != 0 )
                                " MDTM\x0a"
                            #endif
+                           " MLSD\x0a"
                            " REST STREAM\x0a"
                            " SIZE\x0d\x0a"
                            "211 End\x0d\x0a";
@@ -1223,6 +1261,7 @@
         pxClient->bits1.bDirHasEntry = pdFALSE_UNSIGNED;
         pxClient->bits1.bClientConnected = pdFALSE_UNSIGNED;
         pxClient->bits1.bHadError = pdFALSE_UNSIGNED;
+        pxClient->bits1.bMachineList = pdFALSE_UNSIGNED;
     }
 /*-----------------------------------------------------------*/
 
@@ -1245,6 +1284,18 @@
             pxClient->pxReadHandle = NULL;
         }
 
+        #if ( ipconfigFTP_TX_DOUBLE_BUFFER != 0 )
+        {
+            if( pxClient->pucTxBuffers[ 0 ] != NULL )
+            {
+                /* Both buffers are part of a single allocation. */
+                vPortFree( pxClient->pucTxBuffers[ 0 ] );
+                pxClient->pucTxBuffers[ 0 ] = NULL;
+                pxClient->pucTxBuffers[ 1 ] = NULL;
+            }
+        }
+        #endif
+
         /* These two field are only used for logging / file-statistics */
         pxClient->ulRecvBytes = 0ul;
         pxClient->xStartTime = 0ul;
@@ -1642,10 +1693,17 @@
                             xRc = FreeRTOS_recvcount( pxClient->xTransferSocket );
                             xRc = ( xRc / ipconfigFTP_PREFERRED_WRITE_SIZE ) * ipconfigFTP_PREFERRED_WRITE_SIZE;
 
+                            if( xRc > ( BaseType_t ) sizeof( pcFILE_BUFFER ) )
+                            {
+                                xRc = ( sizeof( pcFILE_BUFFER ) / ipconfigFTP_PREFERRED_WRITE_SIZE ) * ipconfigFTP_PREFERRED_WRITE_SIZE;
+                            }
+
                             if( xRc > 0 )
                             {
+                                /* Read no more than the rounded-down amount,
+                                 * so that the write stays sector aligned. */
                                 xRc = FreeRTOS_recv( pxClient->xTransferSocket, ( void * ) pcBuffer,
-                                                     sizeof( pcFILE_BUFFER ), FREERTOS_MSG_DONTWAIT );
+                                                     ( size_t ) xRc, FREERTOS_MSG_DONTWAIT );
                             }
                         }
                     }
@@ -1755,13 +1813,31 @@
                 }
                 else
                 {
-                    pxClient->uxBytesLeft = uxFileSize - pxClient->ulRestartOffset;
+                    pxClient->uxBytesLeft = uxFileSize - uxOffset;
                 }
             }
         }
 
         if( xResult != pdFALSE )
         {
+            #if ( ipconfigFTP_TX_DOUBLE_BUFFER != 0 )
+            {
+                /* Without the buffers, the file is sent through pcFILE_BUFFER. */
+                pxClient->pucTxBuffers[ 0 ] = ( uint8_t * ) pvPortMalloc( 2u * ipconfigFTP_TX_BUFFER_SIZE );
+
+                if( pxClient->pucTxBuffers[ 0 ] != NULL )
+                {
+                    pxClient->pucTxBuffers[ 1 ] = pxClient->pucTxBuffers[ 0 ] + ipconfigFTP_TX_BUFFER_SIZE;
+                    pxClient->uxTxLength[ 0 ] = 0u;
+                    pxClient->uxTxLength[ 1 ] = 0u;
+                    pxClient->uxTxOffset = 0u;
+                    /* Already reduced by a REST offset. */
+                    pxClient->uxReadLeft = pxClient->uxBytesLeft;
+                    pxClient->xTxFront = 0;
+                }
+            }
+            #endif /* ipconfigFTP_TX_DOUBLE_BUFFER */
+
             if( pxClient->bits1.bIsListen != pdFALSE_UNSIGNED )
             {
                 /* True if PASV is used. */
@@ -1807,139 +1883,144 @@
         BaseType_t xRc = 0;
         BaseType_t xSetEvent = pdFALSE;
 
-        do
-        {
-            #if ( ipconfigFTP_TX_ZERO_COPY != 0 )
-                char * pcBuffer;
-                BaseType_t xBufferLength;
-            #endif /* ipconfigFTP_TX_ZERO_COPY */
-
-            /* Take the lesser of the two: tx_space (number of bytes that can be
-             * queued for transmission) and uxBytesLeft (the number of bytes left to
-             * read from the file) */
-            uxSpace = FreeRTOS_tx_space( pxClient->xTransferSocket );
-
-            if( uxSpace == 0 )
+        #if ( ipconfigFTP_TX_DOUBLE_BUFFER != 0 )
+            if( pxClient->pucTxBuffers[ 0 ] != NULL )
             {
-                FreeRTOS_FD_SET( pxClient->xTransferSocket, pxClient->pxParent->xSocketSet, eSELECT_WRITE | eSELECT_EXCEPT );
-                xRc = FreeRTOS_select( pxClient->pxParent->xSocketSet, 200 );
-                uxSpace = FreeRTOS_tx_space( pxClient->xTransferSocket );
+                xRc = prvRetrieveFileBuffered( pxClient );
             }
-
-            uxCount = FreeRTOS_min_uint32( pxClient->uxBytesLeft, uxSpace );
-
-            if( uxCount == 0 )
+            else
+        #endif /* ipconfigFTP_TX_DOUBLE_BUFFER */
+        {
+            do
             {
-                break;
-            }
+                #if ( ipconfigFTP_TX_ZERO_COPY != 0 )
+                    char * pcBuffer;
+                    BaseType_t xBufferLength;
+                #endif /* ipconfigFTP_TX_ZERO_COPY */
 
-            #if ( ipconfigFTP_TX_ZERO_COPY == 0 )
-            {
-                if( uxCount > sizeof( pcFILE_BUFFER ) )
-                {
-                    uxCount = sizeof( pcFILE_BUFFER );
-                }
+                /* Take the lesser of the two: tx_space (number of bytes that can be
+                 * queued for transmission) and uxBytesLeft (the number of bytes left to
+                 * read from the file) */
+                uxSpace = FreeRTOS_tx_space( pxClient->xTransferSocket );
 
-                uxItemsRead = ff_fread( pcFILE_BUFFER, 1, uxCount, pxClient->pxReadHandle );
+                /* When the TX stream is full, return rather than block in select():
+                 * the other clients of this server would have to wait.  The
+                 * eSELECT_WRITE event set below will call this function again. */
+                uxCount = FreeRTOS_min_uint32( pxClient->uxBytesLeft, uxSpace );
 
-                if( uxItemsRead != uxCount )
+                if( uxCount == 0 )
                 {
-                    FreeRTOS_printf( ( "prvRetrieveFileWork: Got %u Expected %u\n", ( unsigned ) uxItemsRead, ( unsigned ) uxCount ) );
-                    xRc = FreeRTOS_shutdown( pxClient->xTransferSocket, FREERTOS_SHUT_RDWR );
-                    pxClient->uxBytesLeft = 0u;
                     break;
                 }
 
-                pxClient->uxBytesLeft -= uxCount;
-
-                if( pxClient->uxBytesLeft == 0u )
+                #if ( ipconfigFTP_TX_ZERO_COPY == 0 )
                 {
-                    BaseType_t xTrueValue = 1;
+                    if( uxCount > sizeof( pcFILE_BUFFER ) )
+                    {
+                        uxCount = sizeof( pcFILE_BUFFER );
+                    }
 
-                    FreeRTOS_setsockopt( pxClient->xTransferSocket, 0, FREERTOS_SO_CLOSE_AFTER_SEND, ( void * ) &xTrueValue, sizeof( xTrueValue ) );
-                }
+                    uxItemsRead = ff_fread( pcFILE_BUFFER, 1, uxCount, pxClient->pxReadHandle );
 
-                xRc = FreeRTOS_send( pxClient->xTransferSocket, pcFILE_BUFFER, uxCount, 0 );
-            }
-            #else /* ipconfigFTP_TX_ZERO_COPY != 0 */
-            {
-                /* Use zero-copy transmission:
-                 * FreeRTOS_get_tx_head() returns a direct pointer to the TX stream and
-                 * set xBufferLength to know how much space there is left. */
-                pcBuffer = ( char * ) FreeRTOS_get_tx_head( pxClient->xTransferSocket, &xBufferLength );
+                    if( uxItemsRead != uxCount )
+                    {
+                        FreeRTOS_printf( ( "prvRetrieveFileWork: Got %u Expected %u\n", ( unsigned ) uxItemsRead, ( unsigned ) uxCount ) );
+                        xRc = FreeRTOS_shutdown( pxClient->xTransferSocket, FREERTOS_SHUT_RDWR );
+                        pxClient->uxBytesLeft = 0u;
+                        break;
+                    }
 
-                if( ( pcBuffer != NULL ) && ( xBufferLength >= 512 ) )
-                {
-                    /* Will read disk data directly to the TX stream of the socket. */
-                    uxCount = FreeRTOS_min_uint32( uxCount, ( uint32_t ) xBufferLength );
+                    pxClient->uxBytesLeft -= uxCount;
 
-                    if( uxCount > ( size_t ) 0x40000u )
+                    if( pxClient->uxBytesLeft == 0u )
                     {
-                        uxCount = ( size_t ) 0x40000u;
+                        BaseType_t xTrueValue = 1;
+
+                        FreeRTOS_setsockopt( pxClient->xTransferSocket, 0, FREERTOS_SO_CLOSE_AFTER_SEND, ( void * ) &xTrueValue, sizeof( xTrueValue ) );
                     }
+
+                    xRc = FreeRTOS_send( pxClient->xTransferSocket, pcFILE_BUFFER, uxCount, 0 );
                 }
-                else
+                #else /* ipconfigFTP_TX_ZERO_COPY != 0 */
                 {
-                    /* Use the normal file i/o buffer. */
-                    pcBuffer = pcFILE_BUFFER;
+                    /* Use zero-copy transmission:
+                     * FreeRTOS_get_tx_head() returns a direct pointer to the TX stream and
+                     * set xBufferLength to know how much space there is left. */
+                    pcBuffer = ( char * ) FreeRTOS_get_tx_head( pxClient->xTransferSocket, &xBufferLength );
 
-                    if( uxCount > sizeof( pcFILE_BUFFER ) )
+                    if( ( pcBuffer != NULL ) && ( xBufferLength >= 512 ) )
                     {
-                        uxCount = sizeof( pcFILE_BUFFER );
+                        /* Will read disk data directly to the TX stream of the socket. */
+                        uxCount = FreeRTOS_min_uint32( uxCount, ( uint32_t ) xBufferLength );
+
+                        if( uxCount > ( size_t ) 0x40000u )
+                        {
+                            uxCount = ( size_t ) 0x40000u;
+                        }
                     }
-                }
+                    else
+                    {
+                        /* Use the normal file i/o buffer. */
+                        pcBuffer = pcFILE_BUFFER;
 
-                if( pxClient->uxBytesLeft >= 1024u )
-                {
-                    uxCount &= ~( ( size_t ) 512u - 1u );
-                }
+                        if( uxCount > sizeof( pcFILE_BUFFER ) )
+                        {
+                            uxCount = sizeof( pcFILE_BUFFER );
+                        }
+                    }
 
-                if( uxCount <= 0u )
-                {
-                    /* Nothing to send after rounding down to a multiple of a sector size. */
-                    break;
-                }
+                    if( pxClient->uxBytesLeft >= 1024u )
+                    {
+                        uxCount &= ~( ( size_t ) 512u - 1u );
+                    }
 
-                uxItemsRead = ff_fread( pcBuffer, 1, uxCount, pxClient->pxReadHandle );
+                    if( uxCount <= 0u )
+                    {
+                        /* Nothing to send after rounding down to a multiple of a sector size. */
+                        break;
+                    }
 
-                if( uxCount != uxItemsRead )
-                {
-                    FreeRTOS_printf( ( "prvRetrieveFileWork: Got %u Expected %u\n", ( unsigned ) uxItemsRead, ( unsigned ) uxCount ) );
-                    xRc = FreeRTOS_shutdown( pxClient->xTransferSocket, FREERTOS_SHUT_RDWR );
-                    pxClient->uxBytesLeft = 0u;
-                    break;
-                }
+                    uxItemsRead = ff_fread( pcBuffer, 1, uxCount, pxClient->pxReadHandle );
+
+                    if( uxCount != uxItemsRead )
+                    {
+                        FreeRTOS_printf( ( "prvRetrieveFileWork: Got %u Expected %u\n", ( unsigned ) uxItemsRead, ( unsigned ) uxCount ) );
+                        xRc = FreeRTOS_shutdown( pxClient->xTransferSocket, FREERTOS_SHUT_RDWR );
+                        pxClient->uxBytesLeft = 0u;
+                        break;
+                    }
 
-                pxClient->uxBytesLeft -= uxCount;
+                    pxClient->uxBytesLeft -= uxCount;
 
-                if( pxClient->uxBytesLeft == 0u )
-                {
-                    BaseType_t xTrueValue = 1;
+                    if( pxClient->uxBytesLeft == 0u )
+                    {
+                        BaseType_t xTrueValue = 1;
 
-                    FreeRTOS_setsockopt( pxClient->xTransferSocket, 0, FREERTOS_SO_CLOSE_AFTER_SEND, ( void * ) &xTrueValue, sizeof( xTrueValue ) );
+                        FreeRTOS_setsockopt( pxClient->xTransferSocket, 0, FREERTOS_SO_CLOSE_AFTER_SEND, ( void * ) &xTrueValue, sizeof( xTrueValue ) );
+                    }
+
+                    if( pcBuffer != pcFILE_BUFFER )
+                    {
+                        pcBuffer = NULL;
+                    }
+
+                    xRc = FreeRTOS_send( pxClient->xTransferSocket, pcBuffer, uxCount, 0 );
                 }
+                #endif /* ipconfigFTP_TX_ZERO_COPY */
 
-                if( pcBuffer != pcFILE_BUFFER )
+                if( xRc < 0 )
                 {
-                    pcBuffer = NULL;
+                    break;
                 }
 
-                xRc = FreeRTOS_send( pxClient->xTransferSocket, pcBuffer, uxCount, 0 );
-            }
-            #endif /* ipconfigFTP_TX_ZERO_COPY */
-
-            if( xRc < 0 )
-            {
-                break;
-            }
-
-            pxClient->ulRecvBytes += xRc;
+                pxClient->ulRecvBytes += xRc;
 
-            if( pxClient->uxBytesLeft == 0u )
-            {
-                break;
-            }
-        } while( uxCount > 0u );
+                if( pxClient->uxBytesLeft == 0u )
+                {
+                    break;
+                }
+            } while( uxCount > 0u );
+        }
 
         if( xRc < 0 )
         {
@@ -1976,6 +2057,107 @@
     }
 /*-----------------------------------------------------------*/
 
+    #if ( ipconfigFTP_TX_DOUBLE_BUFFER != 0 )
+
+        static BaseType_t prvFillTxBuffers( FTPClient_t * pxClient )
+        {
+            BaseType_t xResult = pdPASS;
+            BaseType_t x;
+
+            /* The file is read in the order in which it is sent: the front
+             * buffer is only empty before the first read, after that the back
+             * buffer is refilled each time the front one has been sent. */
+            for( x = 0; x < 2; x++ )
+            {
+                BaseType_t xIndex = ( pxClient->xTxFront + x ) % 2;
+                size_t uxCount, uxItemsRead;
+
+                if( ( pxClient->uxTxLength[ xIndex ] != 0u ) || ( pxClient->uxReadLeft == 0u ) )
+                {
+                    continue;
+                }
+
+                uxCount = FreeRTOS_min_uint32( pxClient->uxReadLeft, ipconfigFTP_TX_BUFFER_SIZE );
+                uxItemsRead = ff_fread( pxClient->pucTxBuffers[ xIndex ], 1, uxCount, pxClient->pxReadHandle );
+
+                if( uxItemsRead != uxCount )
+                {
+                    FreeRTOS_printf( ( "prvFillTxBuffers: Got %u Expected %u\n", ( unsigned ) uxItemsRead, ( unsigned ) uxCount ) );
+                    xResult = pdFAIL;
+                    break;
+                }
+
+                pxClient->uxTxLength[ xIndex ] = uxCount;
+                pxClient->uxReadLeft -= uxCount;
+            }
+
+            return xResult;
+        }
+/*-----------------------------------------------------------*/
+
+        static BaseType_t prvRetrieveFileBuffered( FTPClient_t * pxClient )
+        {
+            BaseType_t xRc = 0;
+            size_t uxSpace;
+            size_t uxCount;
+            const uint8_t * pucData;
+
+            for( ; ; )
+            {
+                /* When the TX stream is full, this function returns with
+                 * both buffers filled, so the next call can queue data
+                 * without waiting for the disk. */
+                if( prvFillTxBuffers( pxClient ) == pdFAIL )
+                {
+                    xRc = FreeRTOS_shutdown( pxClient->xTransferSocket, FREERTOS_SHUT_RDWR );
+                    pxClient->uxBytesLeft = 0u;
+                    break;
+                }
+
+                uxCount = pxClient->uxTxLength[ pxClient->xTxFront ] - pxClient->uxTxOffset;
+                uxSpace = FreeRTOS_tx_space( pxClient->xTransferSocket );
+                uxCount = FreeRTOS_min_uint32( uxCount, uxSpace );
+
+                if( uxCount == 0u )
+                {
+                    /* All has been sent, or the TX stream is full. */
+                    break;
+                }
+
+                if( pxClient->uxBytesLeft == uxCount )
+                {
+                    BaseType_t xTrueValue = 1;
+
+                    FreeRTOS_setsockopt( pxClient->xTransferSocket, 0, FREERTOS_SO_CLOSE_AFTER_SEND, ( void * ) &xTrueValue, sizeof( xTrueValue ) );
+                }
+
+                pucData = pxClient->pucTxBuffers[ pxClient->xTxFront ] + pxClient->uxTxOffset;
+                xRc = FreeRTOS_send( pxClient->xTransferSocket, pucData, uxCount, 0 );
+
+                if( xRc <= 0 )
+                {
+                    break;
+                }
+
+                pxClient->ulRecvBytes += xRc;
+                pxClient->uxBytesLeft -= ( size_t ) xRc;
+                pxClient->uxTxOffset += ( size_t ) xRc;
+
+                if( pxClient->uxTxOffset == pxClient->uxTxLength[ pxClient->xTxFront ] )
+                {
+                    /* The front buffer is empty, continue with the other one. */
+                    pxClient->uxTxLength[ pxClient->xTxFront ] = 0u;
+                    pxClient->uxTxOffset = 0u;
+                    pxClient->xTxFront ^= 1;
+                }
+            }
+
+            return xRc;
+        }
+/*-----------------------------------------------------------*/
+
+    #endif /* ipconfigFTP_TX_DOUBLE_BUFFER */
+
 /*
  ###     #####  ####  #####
  #        #   #    # # # #
@@ -1987,12 +2169,15 @@
  #    #   #   #    #   #
  ####### #####  ####   ####
  */
-/* Prepare sending a directory LIST */
-    static BaseType_t prvListSendPrep( FTPClient_t * pxClient )
+/* Prepare sending a directory LIST or MLSD */
+    static BaseType_t prvListSendPrep( FTPClient_t * pxClient,
+                                       BaseType_t xMachineList )
     {
         BaseType_t xFindResult;
         int iErrorNo;
 
+        pxClient->bits1.bMachineList = ( xMachineList != pdFALSE ) ? pdTRUE_UNSIGNED : pdFALSE_UNSIGNED;
+
         if( pxClient->bits1.bIsListen != pdFALSE_UNSIGNED )
         {
             /* True if PASV is used */
@@ -2005,7 +2190,8 @@
 
             /* Here the FTP server is supposed to connect() */
             xLength = snprintf( pcCOMMAND_BUFFER, sizeof( pcCOMMAND_BUFFER ),
-                                "150 Opening ASCII mode data connection to for /bin/ls \r\n" );
+                                "150 Opening ASCII mode data connection to for %s \r\n",
+                                ( xMachineList != pdFALSE ) ? "MLSD" : "/bin/ls" );
 
             prvSendReply( pxClient->xSocket, pcCOMMAND_BUFFER, xLength );
             /* Clear the current connection acknowledge message */
@@ -2014,6 +2200,8 @@
         }
 
         pxClient->xDirCount = 0;
+        pxClient->ulListDateKey = 0ul;
+        pxClient->pcListDate[ 0 ] = '\0';
         xMakeAbsolute( pxClient, pcNEW_DIR, sizeof( pcNEW_DIR ), pxClient->pcCurrentDir );
 
         xFindResult = ff_findfirst( pcNEW_DIR, &pxClient->xFindData );
@@ -2025,7 +2213,12 @@
         if( ( xFindResult < 0 ) && ( iErrorNo == pdFREERTOS_ERRNO_ENMFILE ) )
         {
             FreeRTOS_printf( ( "prvListSendPrep: Empty directory? (%s)\n", pxClient->pcCurrentDir ) );
-            prvSendReply( pxClient->xTransferSocket, "total 0\r\n", 0 );
+
+            if( xMachineList == pdFALSE )
+            {
+                prvSendReply( pxClient->xTransferSocket, "total 0\r\n", 0 );
+            }
+
             pxClient->xDirCount++;
         }
         else if( xFindResult < 0 )
@@ -2048,23 +2241,42 @@
 
         while( pxClient->bits1.bClientConnected != pdFALSE_UNSIGNED )
         {
-            char * pcWritePtr = pcCOMMAND_BUFFER;
+            char * pcBuffer;
+            char * pcWritePtr;
             BaseType_t xWriteLength;
 
-            xTxSpace = FreeRTOS_tx_space( pxClient->xTransferSocket );
+            /* Format as many entries as possible straight into the TX stream
+             * of the data socket, and send them with a single call.  When the
+             * free space in the stream wraps around, use pcCOMMAND_BUFFER. */
+            pcBuffer = ( char * ) FreeRTOS_get_tx_head( pxClient->xTransferSocket, &xTxSpace );
 
-            if( xTxSpace > ( BaseType_t ) sizeof( pcCOMMAND_BUFFER ) )
+            if( ( pcBuffer == NULL ) || ( xTxSpace < MAX_DIR_LIST_ENTRY_SIZE ) )
             {
-                xTxSpace = sizeof( pcCOMMAND_BUFFER );
+                pcBuffer = pcCOMMAND_BUFFER;
+                xTxSpace = FreeRTOS_tx_space( pxClient->xTransferSocket );
+
+                if( xTxSpace > ( BaseType_t ) sizeof( pcCOMMAND_BUFFER ) )
+                {
+                    xTxSpace = sizeof( pcCOMMAND_BUFFER );
+                }
             }
 
+            pcWritePtr = pcBuffer;
+
             while( ( xTxSpace >= MAX_DIR_LIST_ENTRY_SIZE ) && ( pxClient->bits1.bDirHasEntry != pdFALSE_UNSIGNED ) )
             {
                 BaseType_t xLength, xEndOfDir;
                 int32_t iRc;
                 int iErrorNo;
 
-                xLength = prvGetFileInfoStat( &( pxClient->xFindData.xDirectoryEntry ), pcWritePtr, xTxSpace );
+                if( pxClient->bits1.bMachineList != pdFALSE_UNSIGNED )
+                {
+                    xLength = prvGetFileInfoFacts( &( pxClient->xFindData.xDirectoryEntry ), pcWritePtr, xTxSpace );
+                }
+                else
+                {
+                    xLength = prvGetFileInfoStat( pxClient, &( pxClient->xFindData.xDirectoryEntry ), pcWritePtr, xTxSpace );
+                }
 
                 pxClient->xDirCount++;
                 pcWritePtr += xLength;
@@ -2085,7 +2297,7 @@
                 }
             }
 
-            xWriteLength = ( BaseType_t ) ( pcWritePtr - pcCOMMAND_BUFFER );
+            xWriteLength = ( BaseType_t ) ( pcWritePtr - pcBuffer );
 
             if( xWriteLength == 0 )
             {
@@ -2094,20 +2306,28 @@
 
             if( pxClient->bits1.bDirHasEntry == pdFALSE_UNSIGNED )
             {
-                uint32_t ulTotalCount;
-                uint32_t ulFreeCount;
-                uint32_t ulPercentage;
-
-                ulTotalCount = 1;
-                ulFreeCount = ff_diskfree( pxClient->pcCurrentDir, &ulTotalCount );
-                ulPercentage = ( uint32_t ) ( ( 100ULL * ulFreeCount + ulTotalCount / 2 ) / ulTotalCount );
-
-                /* Prepare the ACK which will be sent when all data has been sent. */
-                snprintf( pxClient->pcClientAck, sizeof( pxClient->pcClientAck ),
-                          "226-Options: -l\r\n"
-                          "226-%ld matches total\r\n"
-                          "226 Total %lu KB (%lu %% free)\r\n",
-                          pxClient->xDirCount, ulTotalCount / 1024, ulPercentage );
+                if( pxClient->bits1.bMachineList != pdFALSE_UNSIGNED )
+                {
+                    snprintf( pxClient->pcClientAck, sizeof( pxClient->pcClientAck ),
+                              "226 %ld matches total\r\n", pxClient->xDirCount );
+                }
+                else
+                {
+                    uint32_t ulTotalCount;
+                    uint32_t ulFreeCount;
+                    uint32_t ulPercentage;
+
+                    ulTotalCount = 1;
+                    ulFreeCount = ff_diskfree( pxClient->pcCurrentDir, &ulTotalCount );
+                    ulPercentage = ( uint32_t ) ( ( 100ULL * ulFreeCount + ulTotalCount / 2 ) / ulTotalCount );
+
+                    /* Prepare the ACK which will be sent when all data has been sent. */
+                    snprintf( pxClient->pcClientAck, sizeof( pxClient->pcClientAck ),
+                              "226-Options: -l\r\n"
+                              "226-%ld matches total\r\n"
+                              "226 Total %lu KB (%lu %% free)\r\n",
+                              pxClient->xDirCount, ulTotalCount / 1024, ulPercentage );
+                }
             }
 
             if( xWriteLength )
@@ -2119,7 +2339,15 @@
                     FreeRTOS_setsockopt( pxClient->xTransferSocket, 0, FREERTOS_SO_CLOSE_AFTER_SEND, ( void * ) &xTrueValue, sizeof( xTrueValue ) );
                 }
 
-                prvSendReply( pxClient->xTransferSocket, pcCOMMAND_BUFFER, xWriteLength );
+                if( pcBuffer == pcCOMMAND_BUFFER )
+                {
+                    prvSendReply( pxClient->xTransferSocket, pcCOMMAND_BUFFER, xWriteLength );
+                }
+                else
+                {
+                    /* The data is in the TX stream already. */
+                    FreeRTOS_send( pxClient->xTransferSocket, NULL, ( size_t ) xWriteLength, 0 );
+                }
             }
 
             if( pxClient->bits1.bDirHasEntry == pdFALSE_UNSIGNED )
@@ -2146,11 +2374,12 @@
     }
 /*-----------------------------------------------------------*/
 
-    static BaseType_t prvGetFileInfoStat( FF_DirEnt_t * pxEntry,
+    static BaseType_t prvGetFileInfoStat( FTPClient_t * pxClient,
+                                          FF_DirEnt_t * pxEntry,
                                           char * pcLine,
                                           BaseType_t xMaxLength )
     {
-        char date[ 16 ];
+        uint32_t ulDateKey;
         char mode[ 11 ] = "----------";
         BaseType_t st_nlink = 1;
         const char user[ 9 ] = "freertos";
@@ -2205,21 +2434,112 @@
         mode[ 8 ] = '-';
         mode[ 9 ] = '-'; /* x for executable. */
 
+        /* Files in a directory often share their time stamp, at least up to
+         * the minute, so the date is only formatted when it differs from the
+         * previous entry.  A key of 0 stands for "no valid date". */
         if( pxCreateTime->Month && pxCreateTime->Day )
         {
-            snprintf( date, sizeof( date ), "%-3.3s %02d %02d:%02d",
-                      pcMonthAbbrev( pxCreateTime->Month ),
-                      pxCreateTime->Day,
-                      pxCreateTime->Hour,
-                      pxCreateTime->Minute );
+            ulDateKey = ( ( ( uint32_t ) pxCreateTime->Month ) << 24 ) |
+                        ( ( ( uint32_t ) pxCreateTime->Day ) << 16 ) |
+                        ( ( ( uint32_t ) pxCreateTime->Hour ) << 8 ) |
+                        ( ( uint32_t ) pxCreateTime->Minute );
         }
         else
         {
-            snprintf( date, sizeof( date ), "Jan 01 1970" );
+            ulDateKey = 0ul;
+        }
+
+        if( ( ulDateKey != pxClient->ulListDateKey ) || ( pxClient->pcListDate[ 0 ] == '\0' ) )
+        {
+            if( ulDateKey != 0ul )
+            {
+                snprintf( pxClient->pcListDate, sizeof( pxClient->pcListDate ), "%-3.3s %02d %02d:%02d",
+                          pcMonthAbbrev( pxCreateTime->Month ),
+                          pxCreateTime->Day,
+                          pxCreateTime->Hour,
+                          pxCreateTime->Minute );
+            }
+            else
+            {
+                snprintf( pxClient->pcListDate, sizeof( pxClient->pcListDate ), "Jan 01 1970" );
+            }
+
+            pxClient->ulListDateKey = ulDateKey;
         }
 
         return snprintf( pcLine, xMaxLength, "%s %3ld %-4s %-4s %8d %12s %s\r\n",
-                         mode, st_nlink, user, group, ( int ) ulSize, date, pcFileName );
+                         mode, st_nlink, user, group, ( int ) ulSize, pxClient->pcListDate, pcFileName );
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvGetFileInfoFacts( FF_DirEnt_t * pxEntry,
+                                           char * pcLine,
+                                           BaseType_t xMaxLength )
+    {
+        BaseType_t xIsDir = ( ( pxEntry->ucAttrib & FF_FAT_ATTR_DIR ) != 0 );
+        BaseType_t xReadOnly = ( ( pxEntry->ucAttrib & FF_FAT_ATTR_READONLY ) != 0 );
+        const char * pcPerm;
+        const char * pcType;
+
+/*
+ *	Creates an MLSD listing as described in RFC 3659, for instance:
+ *
+ * type=file;size=10564588;modify=20150901001700;perm=adfrw; log_0001.txt
+ * type=dir;modify=20150901001700;perm=cdeflmp; logs
+ *
+ * The listed directory itself and its parent are reported as "cdir" and
+ * "pdir".
+ */
+
+        if( xIsDir )
+        {
+            pcPerm = xReadOnly ? "el" : "cdeflmp";
+
+            if( strcmp( pxEntry->pcFileName, "." ) == 0 )
+            {
+                pcType = "cdir";
+            }
+            else if( strcmp( pxEntry->pcFileName, ".." ) == 0 )
+            {
+                pcType = "pdir";
+            }
+            else
+            {
+                pcType = "dir";
+            }
+        }
+        else
+        {
+            pcPerm = xReadOnly ? "r" : "adfrw";
+            pcType = "file";
+        }
+
+        #if ( ffconfigTIME_SUPPORT == 1 )
+        {
+            const FF_SystemTime_t * pxTime = &( pxEntry->xModifiedTime );
+
+            if( pxTime->Year != 0 )
+            {
+                return snprintf( pcLine, xMaxLength, "type=%s;size=%lu;modify=%04u%02u%02u%02u%02u%02u;perm=%s; %s\r\n",
+                                 pcType,
+                                 ( unsigned long ) pxEntry->ulFileSize,
+                                 ( unsigned ) pxTime->Year,
+                                 ( unsigned ) pxTime->Month,
+                                 ( unsigned ) pxTime->Day,
+                                 ( unsigned ) pxTime->Hour,
+                                 ( unsigned ) pxTime->Minute,
+                                 ( unsigned ) pxTime->Second,
+                                 pcPerm,
+                                 pxEntry->pcFileName );
+            }
+        }
+        #endif /* ffconfigTIME_SUPPORT */
+
+        return snprintf( pcLine, xMaxLength, "type=%s;size=%lu;perm=%s; %s\r\n",
+                         pcType,
+                         ( unsigned long ) pxEntry->ulFileSize,
+                         pcPerm,
+                         pxEntry->pcFileName );
     }
 /*-----------------------------------------------------------*/
 
@@ -64,6 +64,12 @@ const char * webCodename( int aCode )
         case WEB_NO_CONTENT: /* 204 */
             return "No content";
 
+        case WEB_PARTIAL_CONTENT: /* 206 */
+            return "Partial Content";
+
+        case WEB_NOT_MODIFIED: /* 304 */
+            return "Not Modified";
+
         case WEB_BAD_REQUEST: /*  = 400, */
             return "Bad request";
 
@@ -79,6 +85,9 @@ const char * webCodename( int aCode )
         case WEB_PRECONDITION_FAILED: /*  = 412, */
             return "Precondition Failed";
 
+        case WEB_RANGE_NOT_SATISFIABLE: /*  = 416, */
+            return "Range Not Satisfiable";
+
         case WEB_INTERNAL_SERVER_ERROR: /*  = 500, */
             return "Internal Server Error";
     }
@@ -75,6 +75,13 @@
         #define ipconfigHTTP_REQUEST_CHARACTER    '?'
     #endif
 
+/* When ipconfigHTTP_TX_ZERO_COPY is non-zero, files are read directly into
+ * the TX stream of the socket, instead of being read into pcFileBuffer and
+ * then copied into the TX stream by FreeRTOS_send(). */
+    #ifndef ipconfigHTTP_TX_ZERO_COPY
+        #define ipconfigHTTP_TX_ZERO_COPY    1
+    #endif
+
 /*_RB_ Need comment block, although fairly self evident. */
     static void prvFileClose( HTTPClient_t * pxClient );
     static BaseType_t prvProcessCmd( HTTPClient_t * pxClient,
@@ -84,6 +91,39 @@
     static BaseType_t prvSendFile( HTTPClient_t * pxClient );
     static BaseType_t prvSendReply( HTTPClient_t * pxClient,
                                     BaseType_t xCode );
+    static void prvReplyDone( HTTPClient_t * pxClient );
+    static const char * pcFindHeader( const char * pcHeaders,
+                                      const char * pcName );
+    static BaseType_t prvParseRange( const char * pcValue,
+                                     size_t uxFileSize,
+                                     size_t * puxFirst,
+                                     size_t * puxLength );
+    static BaseType_t prvReplyPending( const HTTPClient_t * pxClient );
+
+    #if ( ipconfigHTTP_CACHE_ENTRIES > 0 )
+
+/* Space reserved for the pre-rendered headers in front of each cached body. */
+        #define httpCACHE_HEADER_SPACE    ( 256 )
+
+        static uint32_t ulCacheHash( const uint8_t * pucData,
+                                     size_t uxLength );
+        static BaseType_t prvHeaderHasToken( const char * pcValue,
+                                             const char * pcToken );
+        static void prvCacheLoad( HTTPCacheEntry_t * pxEntry,
+                                  FF_FILE * pxFile,
+                                  const char * pcFileName,
+                                  uint32_t ulNameHash,
+                                  const char * pcContentsType,
+                                  BaseType_t xGzip );
+        static HTTPCacheEntry_t * prvCacheGet( TCPServer_t * pxServer,
+                                               const char * pcFileName,
+                                               const char * pcContentsType,
+                                               BaseType_t xGzip );
+        static BaseType_t prvCacheServe( HTTPClient_t * pxClient,
+                                         BaseType_t * pxResult );
+        static BaseType_t prvSendCachedBody( HTTPClient_t * pxClient );
+        static void prvCacheRelease( HTTPClient_t * pxClient );
+    #endif /* ipconfigHTTP_CACHE_ENTRIES */
 
     static const char pcEmptyString[ 1 ] = { '\0' };
 
@@ -123,6 +163,12 @@
         }
 
         prvFileClose( pxClient );
+
+        #if ( ipconfigHTTP_CACHE_ENTRIES > 0 )
+        {
+            prvCacheRelease( pxClient );
+        }
+        #endif
     }
 /*-----------------------------------------------------------*/
 
@@ -152,12 +198,13 @@
                             "Transfer-Encoding: chunked\r\n"
                         #endif
                         "Content-Type: %s\r\n"
-                        "Connection: keep-alive\r\n"
+                        "Connection: %s\r\n"
                         "%s\r\n",
                         ( int ) xCode,
                         webCodename( xCode ),
                         pxParent->pcContentsType[ 0 ] ? pxParent->pcContentsType : "text/html",
-                        pxParent->pcExtraContents );
+                        pxClient->bits.bCloseAfterReply ? "close" : "keep-alive",
+                        pxParent->pcExtraContents[ 0 ] ? pxParent->pcExtraContents : "Content-Length: 0\r\n" );
 
         pxParent->pcContentsType[ 0 ] = '\0';
         pxParent->pcExtraContents[ 0 ] = '\0';
@@ -169,64 +216,119 @@
     }
 /*-----------------------------------------------------------*/
 
+    static void prvReplyDone( HTTPClient_t * pxClient )
+    {
+        /* The whole reply has been queued. Either wait for the next request
+         * on this connection, or close it once the TX stream has drained. */
+        if( pxClient->bits.bCloseAfterReply != pdFALSE_UNSIGNED )
+        {
+            FreeRTOS_shutdown( pxClient->xSocket, FREERTOS_SHUT_RDWR );
+        }
+    }
+/*-----------------------------------------------------------*/
+
     static BaseType_t prvSendFile( HTTPClient_t * pxClient )
     {
         size_t uxSpace;
         size_t uxCount;
+        size_t uxItemsRead;
+        char * pcBuffer;
         BaseType_t xRc = 0;
 
-        if( pxClient->bits.bReplySent == pdFALSE_UNSIGNED )
+        do
         {
-            pxClient->bits.bReplySent = pdTRUE_UNSIGNED;
+            #if ( ipconfigHTTP_TX_ZERO_COPY != 0 )
+                BaseType_t xBufferLength;
+            #endif
 
-            strcpy( pxClient->pxParent->pcContentsType, pcGetContentsType( pxClient->pcCurrentFilename ) );
-            snprintf( pxClient->pxParent->pcExtraContents, sizeof( pxClient->pxParent->pcExtraContents ),
-                      "Content-Length: %d\r\n", ( int ) pxClient->uxBytesLeft );
+            uxSpace = FreeRTOS_tx_space( pxClient->xSocket );
 
-            /* "Requested file action OK". */
-            xRc = prvSendReply( pxClient, WEB_REPLY_OK );
-        }
+            if( pxClient->uxBytesLeft < uxSpace )
+            {
+                uxCount = pxClient->uxBytesLeft;
+            }
+            else
+            {
+                uxCount = uxSpace;
+            }
 
-        if( xRc >= 0 )
-        {
-            do
+            if( uxCount == 0u )
             {
-                uxSpace = FreeRTOS_tx_space( pxClient->xSocket );
+                break;
+            }
+
+            #if ( ipconfigHTTP_TX_ZERO_COPY != 0 )
+            {
+                /* FreeRTOS_get_tx_head() returns a direct pointer to the TX
+                 * stream and sets xBufferLength to the contiguous space left
+                 * before the stream wraps. */
+                pcBuffer = ( char * ) FreeRTOS_get_tx_head( pxClient->xSocket, &xBufferLength );
 
-                if( pxClient->uxBytesLeft < uxSpace )
+                if( ( pcBuffer != NULL ) && ( xBufferLength >= 512 ) )
                 {
-                    uxCount = pxClient->uxBytesLeft;
+                    /* Will read disk data directly to the TX stream of the socket. */
+                    if( uxCount > ( size_t ) xBufferLength )
+                    {
+                        uxCount = ( size_t ) xBufferLength;
+                    }
+
+                    /* Keep reads sector aligned while there is more to come. */
+                    if( pxClient->uxBytesLeft > uxCount )
+                    {
+                        uxCount &= ~( ( size_t ) 512u - 1u );
+                    }
                 }
                 else
                 {
-                    uxCount = uxSpace;
+                    /* Too little space before the wrap, use the file buffer. */
+                    pcBuffer = pcFILE_BUFFER;
                 }
+            }
+            #else /* ipconfigHTTP_TX_ZERO_COPY */
+            {
+                pcBuffer = pcFILE_BUFFER;
+            }
+            #endif /* ipconfigHTTP_TX_ZERO_COPY */
 
-                if( uxCount > 0u )
-                {
-                    if( uxCount > sizeof( pxClient->pxParent->pcFileBuffer ) )
-                    {
-                        uxCount = sizeof( pxClient->pxParent->pcFileBuffer );
-                    }
+            if( ( pcBuffer == pcFILE_BUFFER ) && ( uxCount > sizeof( pcFILE_BUFFER ) ) )
+            {
+                uxCount = sizeof( pcFILE_BUFFER );
+            }
 
-                    ff_fread( pxClient->pxParent->pcFileBuffer, 1, uxCount, pxClient->pxFileHandle );
-                    pxClient->uxBytesLeft -= uxCount;
+            uxItemsRead = ff_fread( pcBuffer, 1, uxCount, pxClient->pxFileHandle );
 
-                    xRc = FreeRTOS_send( pxClient->xSocket, pxClient->pxParent->pcFileBuffer, uxCount, 0 );
+            if( uxItemsRead != uxCount )
+            {
+                /* The Content-Length can not be honoured any more, so the
+                 * connection has to be closed. */
+                FreeRTOS_printf( ( "prvSendFile: Got %u Expected %u\n", ( unsigned ) uxItemsRead, ( unsigned ) uxCount ) );
+                pxClient->uxBytesLeft = 0u;
+                pxClient->bits.bCloseAfterReply = pdTRUE_UNSIGNED;
+                break;
+            }
 
-                    if( xRc < 0 )
-                    {
-                        break;
-                    }
-                }
-            } while( uxCount > 0u );
-        }
+            pxClient->uxBytesLeft -= uxCount;
+
+            /* A NULL buffer tells FreeRTOS_send() that the data is already in
+             * the TX stream, it only needs to advance the head. */
+            xRc = FreeRTOS_send( pxClient->xSocket, ( pcBuffer == pcFILE_BUFFER ) ? pcBuffer : NULL, uxCount, 0 );
+
+            if( xRc < 0 )
+            {
+                break;
+            }
+        } while( pxClient->uxBytesLeft > 0u );
 
-        if( pxClient->uxBytesLeft == 0u )
+        if( ( pxClient->uxBytesLeft == 0u ) || ( xRc < 0 ) )
         {
             /* Writing is ready, no need for further 'eSELECT_WRITE' events. */
             FreeRTOS_FD_CLR( pxClient->xSocket, pxClient->pxParent->xSocketSet, eSELECT_WRITE );
             prvFileClose( pxClient );
+
+            if( xRc >= 0 )
+            {
+                prvReplyDone( pxClient );
+            }
         }
         else
         {
@@ -238,12 +340,577 @@
     }
 /*-----------------------------------------------------------*/
 
+    static const char * pcFindHeader( const char * pcHeaders,
+                                      const char * pcName )
+    {
+        const char * pcLine = pcHeaders;
+        const char * pcResult = NULL;
+        size_t uxNameLength = strlen( pcName );
+
+        /* The first line holds the protocol version, the headers follow,
+         * one per line. */
+        while( ( pcLine = strchr( pcLine, '\n' ) ) != NULL )
+        {
+            pcLine++;
+
+            if( ( strncasecmp( pcLine, pcName, uxNameLength ) == 0 ) && ( pcLine[ uxNameLength ] == ':' ) )
+            {
+                pcResult = pcLine + uxNameLength + 1;
+
+                while( ( *pcResult == ' ' ) || ( *pcResult == '\t' ) )
+                {
+                    pcResult++;
+                }
+
+                break;
+            }
+        }
+
+        return pcResult;
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvParseRange( const char * pcValue,
+                                     size_t uxFileSize,
+                                     size_t * puxFirst,
+                                     size_t * puxLength )
+    {
+        BaseType_t xCode = WEB_REPLY_OK;
+        unsigned long ulFirst;
+        unsigned long ulLast;
+        char * pcEnd;
+
+        /* Only a single "bytes=first-last", "bytes=first-" or "bytes=-suffix"
+         * range is supported. Anything else is ignored, in which case the
+         * whole file is sent as allowed by RFC 7233. */
+        if( strncasecmp( pcValue, "bytes=", 6 ) == 0 )
+        {
+            pcValue += 6;
+
+            if( *pcValue == '-' )
+            {
+                /* The last ulLast bytes of the file. */
+                ulLast = strtoul( pcValue + 1, &pcEnd, 10 );
+
+                if( ( pcEnd != pcValue + 1 ) && ( *pcEnd != ',' ) )
+                {
+                    if( ( ulLast == 0ul ) || ( uxFileSize == 0u ) )
+                    {
+                        xCode = WEB_RANGE_NOT_SATISFIABLE;
+                    }
+                    else
+                    {
+                        *puxLength = ( ulLast < uxFileSize ) ? ( size_t ) ulLast : uxFileSize;
+                        *puxFirst = uxFileSize - *puxLength;
+                        xCode = WEB_PARTIAL_CONTENT;
+                    }
+                }
+            }
+            else
+            {
+                ulFirst = strtoul( pcValue, &pcEnd, 10 );
+
+                if( ( pcEnd != pcValue ) && ( *pcEnd == '-' ) )
+                {
+                    pcValue = pcEnd + 1;
+                    ulLast = strtoul( pcValue, &pcEnd, 10 );
+
+                    if( pcEnd == pcValue )
+                    {
+                        /* "first-": up to the end of the file. */
+                        ulLast = ( unsigned long ) uxFileSize - 1ul;
+                    }
+
+                    if( *pcEnd == ',' )
+                    {
+                        /* A list of ranges, ignore the header. */
+                    }
+                    else if( ( ulFirst >= uxFileSize ) || ( ulLast < ulFirst ) )
+                    {
+                        xCode = WEB_RANGE_NOT_SATISFIABLE;
+                    }
+                    else
+                    {
+                        if( ulLast >= uxFileSize )
+                        {
+                            ulLast = ( unsigned long ) uxFileSize - 1ul;
+                        }
+
+                        *puxFirst = ( size_t ) ulFirst;
+                        *puxLength = ( size_t ) ( ulLast - ulFirst + 1ul );
+                        xCode = WEB_PARTIAL_CONTENT;
+                    }
+                }
+            }
+        }
+
+        return xCode;
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvReplyPending( const HTTPClient_t * pxClient )
+    {
+        BaseType_t xPending = pdFALSE;
+
+        if( pxClient->pxFileHandle != NULL )
+        {
+            xPending = pdTRUE;
+        }
+
+        #if ( ipconfigHTTP_CACHE_ENTRIES > 0 )
+        {
+            if( pxClient->pxCacheEntry != NULL )
+            {
+                xPending = pdTRUE;
+            }
+        }
+        #endif
+
+        return xPending;
+    }
+/*-----------------------------------------------------------*/
+
+    #if ( ipconfigHTTP_CACHE_ENTRIES > 0 )
+
+        static uint32_t ulCacheHash( const uint8_t * pucData,
+                                     size_t uxLength )
+        {
+            /* 32-bit FNV-1a. */
+            uint32_t ulHash = 2166136261ul;
+            size_t uxIndex;
+
+            for( uxIndex = 0u; uxIndex < uxLength; uxIndex++ )
+            {
+                ulHash ^= pucData[ uxIndex ];
+                ulHash *= 16777619ul;
+            }
+
+            return ulHash;
+        }
+/*-----------------------------------------------------------*/
+
+        static BaseType_t prvHeaderHasToken( const char * pcValue,
+                                             const char * pcToken )
+        {
+            size_t uxTokenLength = strlen( pcToken );
+            BaseType_t xFound = pdFALSE;
+
+            /* Look for the token anywhere in the remainder of this header
+             * line. Quality values such as "gzip;q=0" are not taken into
+             * account. */
+            while( ( *pcValue != '\0' ) && ( *pcValue != '\r' ) && ( *pcValue != '\n' ) )
+            {
+                if( strncmp( pcValue, pcToken, uxTokenLength ) == 0 )
+                {
+                    xFound = pdTRUE;
+                    break;
+                }
+
+                pcValue++;
+            }
+
+            return xFound;
+        }
+/*-----------------------------------------------------------*/
+
+        static void prvCacheLoad( HTTPCacheEntry_t * pxEntry,
+                                  FF_FILE * pxFile,
+                                  const char * pcFileName,
+                                  uint32_t ulNameHash,
+                                  const char * pcContentsType,
+                                  BaseType_t xGzip )
+        {
+            size_t uxSize;
+            uint8_t * pucBody;
+            int iLength;
+
+            snprintf( pxEntry->pcFileName, sizeof( pxEntry->pcFileName ), "%s", pcFileName );
+            pxEntry->ulNameHash = ulNameHash;
+            pxEntry->xUsers = 0;
+            pxEntry->uxHeaderLength = 0u;
+            pxEntry->uxBodyLength = 0u;
+            pxEntry->pcETag[ 0 ] = '\0';
+            pxEntry->pucData = NULL;
+
+            /* pxFile is NULL when the file does not exist.  The entry then
+             * records the miss, so the next request for the same name is
+             * answered without looking at the disk, until the cache is flushed.
+             * A file that is too large or can not be read leaves pucData NULL
+             * as well, and is sent from the disk. */
+            pxEntry->xMissing = ( pxFile == NULL ) ? pdTRUE : pdFALSE;
+
+            if( pxFile != NULL )
+            {
+                uxSize = ( size_t ) pxFile->ulFileSize;
+
+                if( uxSize <= ( size_t ) ipconfigHTTP_CACHE_MAX_FILE_SIZE )
+                {
+                    pxEntry->pucData = ( uint8_t * ) pvPortMalloc( httpCACHE_HEADER_SPACE + uxSize );
+                }
+
+                if( pxEntry->pucData != NULL )
+                {
+                    pucBody = pxEntry->pucData + httpCACHE_HEADER_SPACE;
+
+                    if( ff_fread( pucBody, 1, uxSize, pxFile ) != uxSize )
+                    {
+                        vPortFree( pxEntry->pucData );
+                        pxEntry->pucData = NULL;
+                    }
+                }
+
+                if( pxEntry->pucData != NULL )
+                {
+                    snprintf( pxEntry->pcETag, sizeof( pxEntry->pcETag ), "\"%08lx-%lx\"",
+                              ( unsigned long ) ulCacheHash( pucBody, uxSize ),
+                              ( unsigned long ) uxSize );
+
+                    /* The Connection header depends on the request, it is
+                     * added when the reply is sent. */
+                    iLength = snprintf( ( char * ) pxEntry->pucData, httpCACHE_HEADER_SPACE,
+                                        "HTTP/1.1 %d %s\r\n"
+                                        "Content-Type: %s\r\n"
+                                        "Content-Length: %u\r\n"
+                                        "ETag: %s\r\n"
+                                        "Vary: Accept-Encoding\r\n"
+                                        "%s",
+                                        WEB_REPLY_OK,
+                                        webCodename( WEB_REPLY_OK ),
+                                        pcContentsType,
+                                        ( unsigned ) uxSize,
+                                        pxEntry->pcETag,
+                                        /* Ranges are served from the plain file,
+                                         * so they can't be offered for the
+                                         * compressed variant. */
+                                        xGzip ? "Content-Encoding: gzip\r\n" : "Accept-Ranges: bytes\r\n" );
+
+                    if( ( iLength > 0 ) && ( iLength < httpCACHE_HEADER_SPACE ) )
+                    {
+                        pxEntry->uxHeaderLength = ( size_t ) iLength;
+                        pxEntry->uxBodyLength = uxSize;
+                    }
+                    else
+                    {
+                        vPortFree( pxEntry->pucData );
+                        pxEntry->pucData = NULL;
+                    }
+                }
+            }
+
+            FreeRTOS_printf( ( "HTTP cache: '%s' %s\n", pcFileName,
+                               pxEntry->pucData != NULL ? "loaded" : ( pxFile == NULL ? "missing" : "not cacheable" ) ) );
+        }
+/*-----------------------------------------------------------*/
+
+        static HTTPCacheEntry_t * prvCacheGet( TCPServer_t * pxServer,
+                                               const char * pcFileName,
+                                               const char * pcContentsType,
+                                               BaseType_t xGzip )
+        {
+            HTTPCacheEntry_t * pxEntry = NULL;
+            HTTPCacheEntry_t * pxVictim = NULL;
+            HTTPCacheEntry_t * pxEmptyVictim = NULL;
+            FF_FILE * pxFile;
+            uint32_t ulNameHash;
+            BaseType_t x;
+
+            ulNameHash = ulCacheHash( ( const uint8_t * ) pcFileName, strlen( pcFileName ) );
+
+            for( x = 0; x < ipconfigHTTP_CACHE_ENTRIES; x++ )
+            {
+                HTTPCacheEntry_t * pxCurrent = &( pxServer->xHTTPCache[ x ] );
+
+                if( ( pxCurrent->ulNameHash == ulNameHash ) &&
+                    ( pxCurrent->pcFileName[ 0 ] != '\0' ) &&
+                    ( strcmp( pxCurrent->pcFileName, pcFileName ) == 0 ) )
+                {
+                    pxEntry = pxCurrent;
+                    break;
+                }
+
+                /* Remember the least recently used entry that no client is
+                 * sending from, in case the file has to be loaded. */
+                if( ( pxCurrent->xUsers == 0 ) &&
+                    ( ( pxVictim == NULL ) || ( pxCurrent->ulLastUsed < pxVictim->ulLastUsed ) ) )
+                {
+                    pxVictim = pxCurrent;
+                }
+
+                /* And the least recently used entry that holds no data. */
+                if( ( pxCurrent->pucData == NULL ) &&
+                    ( ( pxEmptyVictim == NULL ) || ( pxCurrent->ulLastUsed < pxEmptyVictim->ulLastUsed ) ) )
+                {
+                    pxEmptyVictim = pxCurrent;
+                }
+            }
+
+            if( pxEntry == NULL )
+            {
+                pxFile = ff_fopen( pcFileName, "rb" );
+
+                /* A miss, or a file that is too large to be cached, is only
+                 * recorded in an entry that holds no data.  Requests for such
+                 * files can then not evict the files that are being served
+                 * from the cache. */
+                if( ( pxFile == NULL ) ||
+                    ( ( size_t ) pxFile->ulFileSize > ( size_t ) ipconfigHTTP_CACHE_MAX_FILE_SIZE ) )
+                {
+                    pxVictim = pxEmptyVictim;
+                }
+
+                if( pxVictim != NULL )
+                {
+                    if( pxVictim->pucData != NULL )
+                    {
+                        vPortFree( pxVictim->pucData );
+                        pxVictim->pucData = NULL;
+                    }
+
+                    prvCacheLoad( pxVictim, pxFile, pcFileName, ulNameHash, pcContentsType, xGzip );
+                    pxEntry = pxVictim;
+                }
+
+                if( pxFile != NULL )
+                {
+                    ff_fclose( pxFile );
+                }
+            }
+
+            if( pxEntry != NULL )
+            {
+                pxServer->ulHTTPCacheClock++;
+                pxEntry->ulLastUsed = pxServer->ulHTTPCacheClock;
+            }
+
+            return pxEntry;
+        }
+/*-----------------------------------------------------------*/
+
+        static BaseType_t prvCacheServe( HTTPClient_t * pxClient,
+                                         BaseType_t * pxResult )
+        {
+            TCPServer_t * pxServer = pxClient->pxParent;
+            HTTPCacheEntry_t * pxEntry = NULL;
+            const char * pcValue;
+            const char * pcContentsType;
+            const char * pcConnection;
+            BaseType_t xRc = 0;
+            BaseType_t xHandled = pdFALSE;
+
+            /* Range requests are handled by the file based code. */
+            if( pcFindHeader( pxClient->pcRestData, "Range" ) == NULL )
+            {
+                pcContentsType = pcGetContentsType( pxClient->pcCurrentFilename );
+                pcValue = pcFindHeader( pxClient->pcRestData, "Accept-Encoding" );
+
+                if( ( pcValue != NULL ) && ( prvHeaderHasToken( pcValue, "gzip" ) != pdFALSE ) )
+                {
+                    /* Prefer a pre-compressed "<name>.gz" when it exists. */
+                    snprintf( pcFILE_BUFFER, sizeof( pcFILE_BUFFER ), "%s.gz", pxClient->pcCurrentFilename );
+                    pxEntry = prvCacheGet( pxServer, pcFILE_BUFFER, pcContentsType, pdTRUE );
+                }
+
+                if( ( pxEntry == NULL ) || ( pxEntry->pucData == NULL ) )
+                {
+                    pxEntry = prvCacheGet( pxServer, pxClient->pcCurrentFilename, pcContentsType, pdFALSE );
+                }
+
+                if( ( pxEntry != NULL ) &&
+                    ( ( pxEntry->pucData != NULL ) || ( pxEntry->xMissing != pdFALSE ) ) )
+                {
+                    xHandled = pdTRUE;
+                }
+            }
+
+            if( xHandled != pdFALSE )
+            {
+                pcConnection = pxClient->bits.bCloseAfterReply ? "close" : "keep-alive";
+                pcValue = pcFindHeader( pxClient->pcRestData, "If-None-Match" );
+
+                if( pxEntry->pucData == NULL )
+                {
+                    /* The file was missing at an earlier request: "404 File not found". */
+                    xRc = prvSendReply( pxClient, WEB_NOT_FOUND );
+                    prvReplyDone( pxClient );
+                }
+                else if( ( pcValue != NULL ) &&
+                    ( ( prvHeaderHasToken( pcValue, pxEntry->pcETag ) != pdFALSE ) ||
+                      ( prvHeaderHasToken( pcValue, "*" ) != pdFALSE ) ) )
+                {
+                    /* The client's copy is still valid. */
+                    xRc = snprintf( pcFILE_BUFFER, sizeof( pcFILE_BUFFER ),
+                                    "HTTP/1.1 %d %s\r\n"
+                                    "ETag: %s\r\n"
+                                    "Connection: %s\r\n"
+                                    "\r\n",
+                                    WEB_NOT_MODIFIED,
+                                    webCodename( WEB_NOT_MODIFIED ),
+                                    pxEntry->pcETag,
+                                    pcConnection );
+                    xRc = FreeRTOS_send( pxClient->xSocket, pcFILE_BUFFER, xRc, 0 );
+                    prvReplyDone( pxClient );
+                }
+                else
+                {
+                    /* Send the pre-rendered headers followed by the
+                     * Connection header, which depends on the request. */
+                    xRc = FreeRTOS_send( pxClient->xSocket, pxEntry->pucData, pxEntry->uxHeaderLength, 0 );
+
+                    if( xRc >= 0 )
+                    {
+                        xRc = snprintf( pcFILE_BUFFER, sizeof( pcFILE_BUFFER ), "Connection: %s\r\n\r\n", pcConnection );
+                        xRc = FreeRTOS_send( pxClient->xSocket, pcFILE_BUFFER, xRc, 0 );
+                    }
+
+                    pxClient->bits.bReplySent = pdTRUE_UNSIGNED;
+
+                    if( ( xRc >= 0 ) && ( pxClient->bits.bHeadOnly == pdFALSE_UNSIGNED ) && ( pxEntry->uxBodyLength > 0u ) )
+                    {
+                        pxEntry->xUsers++;
+                        pxClient->pxCacheEntry = pxEntry;
+                        pxClient->uxBytesLeft = pxEntry->uxBodyLength;
+                        xRc = prvSendCachedBody( pxClient );
+                    }
+                    else
+                    {
+                        prvReplyDone( pxClient );
+                    }
+                }
+
+                *pxResult = xRc;
+            }
+
+            return xHandled;
+        }
+/*-----------------------------------------------------------*/
+
+        static BaseType_t prvSendCachedBody( HTTPClient_t * pxClient )
+        {
+            HTTPCacheEntry_t * pxEntry = pxClient->pxCacheEntry;
+            const uint8_t * pucBody;
+            size_t uxCount;
+            BaseType_t xRc = 0;
+
+            uxCount = ( size_t ) FreeRTOS_tx_space( pxClient->xSocket );
+
+            if( uxCount > pxClient->uxBytesLeft )
+            {
+                uxCount = pxClient->uxBytesLeft;
+            }
+
+            if( uxCount > 0u )
+            {
+                pucBody = pxEntry->pucData + httpCACHE_HEADER_SPACE + ( pxEntry->uxBodyLength - pxClient->uxBytesLeft );
+                xRc = FreeRTOS_send( pxClient->xSocket, pucBody, uxCount, 0 );
+
+                if( xRc > 0 )
+                {
+                    pxClient->uxBytesLeft -= ( size_t ) xRc;
+                }
+            }
+
+            if( ( pxClient->uxBytesLeft == 0u ) || ( xRc < 0 ) )
+            {
+                FreeRTOS_FD_CLR( pxClient->xSocket, pxClient->pxParent->xSocketSet, eSELECT_WRITE );
+                prvCacheRelease( pxClient );
+
+                if( xRc >= 0 )
+                {
+                    prvReplyDone( pxClient );
+                }
+            }
+            else
+            {
+                /* Wake up the TCP task as soon as this socket may be written to. */
+                FreeRTOS_FD_SET( pxClient->xSocket, pxClient->pxParent->xSocketSet, eSELECT_WRITE );
+            }
+
+            return xRc;
+        }
+/*-----------------------------------------------------------*/
+
+        static void prvCacheRelease( HTTPClient_t * pxClient )
+        {
+            HTTPCacheEntry_t * pxEntry = pxClient->pxCacheEntry;
+
+            if( pxEntry != NULL )
+            {
+                pxEntry->xUsers--;
+
+                /* An entry that was flushed while in use is freed by its last
+                 * user. */
+                if( ( pxEntry->xUsers == 0 ) && ( pxEntry->pcFileName[ 0 ] == '\0' ) && ( pxEntry->pucData != NULL ) )
+                {
+                    vPortFree( pxEntry->pucData );
+                    pxEntry->pucData = NULL;
+                }
+
+                pxClient->pxCacheEntry = NULL;
+            }
+        }
+/*-----------------------------------------------------------*/
+
+        void vHTTPCacheDrop( TCPServer_t * pxServer )
+        {
+            BaseType_t x;
+
+            for( x = 0; x < ipconfigHTTP_CACHE_ENTRIES; x++ )
+            {
+                HTTPCacheEntry_t * pxEntry = &( pxServer->xHTTPCache[ x ] );
+
+                pxEntry->pcFileName[ 0 ] = '\0';
+                pxEntry->ulNameHash = 0u;
+
+                if( ( pxEntry->xUsers == 0 ) && ( pxEntry->pucData != NULL ) )
+                {
+                    vPortFree( pxEntry->pucData );
+                    pxEntry->pucData = NULL;
+                }
+            }
+        }
+/*-----------------------------------------------------------*/
+
+        void FreeRTOS_HTTPCacheFlush( TCPServer_t * pxServer )
+        {
+            /* The accepting server serves clients itself when no worker
+             * could be created. */
+            vHTTPCacheDrop( pxServer );
+
+            #if ( ipconfigTCP_SERVER_WORKERS > 0 )
+            {
+                BaseType_t xIndex;
+
+                /* A worker's cache is only touched by the worker's task, so
+                 * each worker is asked to drop its cache between two working
+                 * cycles, and this function waits until all have done so. */
+                for( xIndex = 0; ( xIndex < ipconfigTCP_SERVER_WORKERS ) && ( pxServer->pxWorkers[ xIndex ] != NULL ); xIndex++ )
+                {
+                    pxServer->pxWorkers[ xIndex ]->xHTTPCacheFlushPending = pdTRUE;
+                }
+
+                for( xIndex = 0; ( xIndex < ipconfigTCP_SERVER_WORKERS ) && ( pxServer->pxWorkers[ xIndex ] != NULL ); xIndex++ )
+                {
+                    while( pxServer->pxWorkers[ xIndex ]->xHTTPCacheFlushPending != pdFALSE )
+                    {
+                        vTaskDelay( 1 );
+                    }
+                }
+            }
+            #endif /* ipconfigTCP_SERVER_WORKERS */
+        }
+/*-----------------------------------------------------------*/
+
+    #endif /* ipconfigHTTP_CACHE_ENTRIES */
+
     static BaseType_t prvOpenURL( HTTPClient_t * pxClient )
     {
         BaseType_t xRc;
+        BaseType_t xCode;
         char pcSlash[ 2 ];
-
-        pxClient->bits.ulFlags = 0;
+        const char * pcRange;
+        size_t uxFileSize;
+        size_t uxFirst;
+        size_t uxLength;
 
         #if ( ipconfigHTTP_HAS_HANDLE_REQUEST_HOOK != 0 )
         {
@@ -260,11 +927,13 @@
                               "Content-Length: %d\r\n", ( int ) xResult );
                     xRc = prvSendReply( pxClient, WEB_REPLY_OK ); /* "Requested file action OK" */
 
-                    if( xRc > 0 )
+                    if( ( xRc > 0 ) && ( pxClient->bits.bHeadOnly == pdFALSE_UNSIGNED ) )
                     {
                         xRc = FreeRTOS_send( pxClient->xSocket, pxClient->pcCurrentFilename, xResult, 0 );
                     }
 
+                    prvReplyDone( pxClient );
+
                     /* Although against the coding standard of FreeRTOS, a return is
                      * done here  to simplify this conditional code. */
                     return xRc;
@@ -290,6 +959,17 @@
                   pcSlash,
                   pxClient->pcUrlData );
 
+        #if ( ipconfigHTTP_CACHE_ENTRIES > 0 )
+        {
+            if( prvCacheServe( pxClient, &xRc ) != pdFALSE )
+            {
+                /* Although against the coding standard of FreeRTOS, a return is
+                 * done here  to simplify this conditional code. */
+                return xRc;
+            }
+        }
+        #endif /* ipconfigHTTP_CACHE_ENTRIES */
+
         pxClient->pxFileHandle = ff_fopen( pxClient->pcCurrentFilename, "rb" );
 
         FreeRTOS_printf( ( "Open file '%s': %s\n", pxClient->pcCurrentFilename,
@@ -299,11 +979,76 @@
         {
             /* "404 File not found". */
             xRc = prvSendReply( pxClient, WEB_NOT_FOUND );
+            prvReplyDone( pxClient );
         }
         else
         {
-            pxClient->uxBytesLeft = ( size_t ) pxClient->pxFileHandle->ulFileSize;
-            xRc = prvSendFile( pxClient );
+            uxFileSize = ( size_t ) pxClient->pxFileHandle->ulFileSize;
+            uxFirst = 0u;
+            uxLength = uxFileSize;
+            xCode = WEB_REPLY_OK;
+
+            pcRange = pcFindHeader( pxClient->pcRestData, "Range" );
+
+            if( pcRange != NULL )
+            {
+                xCode = prvParseRange( pcRange, uxFileSize, &uxFirst, &uxLength );
+            }
+
+            if( ( xCode == WEB_PARTIAL_CONTENT ) && ( uxFirst > 0u ) &&
+                ( ff_fseek( pxClient->pxFileHandle, ( long ) uxFirst, FF_SEEK_SET ) != 0 ) )
+            {
+                xCode = WEB_INTERNAL_SERVER_ERROR;
+            }
+
+            if( xCode == WEB_PARTIAL_CONTENT )
+            {
+                strcpy( pxClient->pxParent->pcContentsType, pcGetContentsType( pxClient->pcCurrentFilename ) );
+                snprintf( pxClient->pxParent->pcExtraContents, sizeof( pxClient->pxParent->pcExtraContents ),
+                          "Content-Length: %u\r\nContent-Range: bytes %u-%u/%u\r\n",
+                          ( unsigned ) uxLength,
+                          ( unsigned ) uxFirst,
+                          ( unsigned ) ( uxFirst + uxLength - 1u ),
+                          ( unsigned ) uxFileSize );
+            }
+            else if( xCode == WEB_RANGE_NOT_SATISFIABLE )
+            {
+                snprintf( pxClient->pxParent->pcExtraContents, sizeof( pxClient->pxParent->pcExtraContents ),
+                          "Content-Length: 0\r\nContent-Range: bytes */%u\r\n",
+                          ( unsigned ) uxFileSize );
+                uxLength = 0u;
+            }
+            else if( xCode == WEB_REPLY_OK )
+            {
+                strcpy( pxClient->pxParent->pcContentsType, pcGetContentsType( pxClient->pcCurrentFilename ) );
+                snprintf( pxClient->pxParent->pcExtraContents, sizeof( pxClient->pxParent->pcExtraContents ),
+                          "Content-Length: %u\r\nAccept-Ranges: bytes\r\n",
+                          ( unsigned ) uxLength );
+            }
+            else
+            {
+                uxLength = 0u;
+            }
+
+            xRc = prvSendReply( pxClient, xCode );
+
+            if( pxClient->bits.bHeadOnly != pdFALSE_UNSIGNED )
+            {
+                /* HEAD: the same headers as GET, but no body. */
+                uxLength = 0u;
+            }
+
+            pxClient->uxBytesLeft = uxLength;
+
+            if( ( xRc >= 0 ) && ( uxLength > 0u ) )
+            {
+                xRc = prvSendFile( pxClient );
+            }
+            else
+            {
+                prvFileClose( pxClient );
+                prvReplyDone( pxClient );
+            }
         }
 
         return xRc;
@@ -314,6 +1059,25 @@
                                      BaseType_t xIndex )
     {
         BaseType_t xResult = 0;
+        const char * pcConnection;
+
+        pxClient->bits.ulFlags = 0;
+
+        /* HTTP/1.1 connections are persistent unless the client asks for them
+         * to be closed, HTTP/1.0 connections only if it asks for keep-alive. */
+        pcConnection = pcFindHeader( pxClient->pcRestData, "Connection" );
+
+        if( strncmp( pxClient->pcRestData, "HTTP/1.0", 8 ) == 0 )
+        {
+            if( ( pcConnection == NULL ) || ( strncasecmp( pcConnection, "keep-alive", 10 ) != 0 ) )
+            {
+                pxClient->bits.bCloseAfterReply = pdTRUE_UNSIGNED;
+            }
+        }
+        else if( ( pcConnection != NULL ) && ( strncasecmp( pcConnection, "close", 5 ) == 0 ) )
+        {
+            pxClient->bits.bCloseAfterReply = pdTRUE_UNSIGNED;
+        }
 
         /* A new command has been received. Process it. */
         switch( xIndex )
@@ -323,6 +1087,10 @@
                 break;
 
             case ECMD_HEAD:
+                pxClient->bits.bHeadOnly = pdTRUE_UNSIGNED;
+                xResult = prvOpenURL( pxClient );
+                break;
+
             case ECMD_POST:
             case ECMD_PUT:
             case ECMD_DELETE:
@@ -342,82 +1110,113 @@
 
     BaseType_t xHTTPClientWork( TCPClient_t * pxTCPClient )
     {
-        BaseType_t xRc;
+        BaseType_t xRc = 0;
         HTTPClient_t * pxClient = ( HTTPClient_t * ) pxTCPClient;
 
         if( pxClient->pxFileHandle != NULL )
         {
-            prvSendFile( pxClient );
+            xRc = prvSendFile( pxClient );
         }
 
-        xRc = FreeRTOS_recv( pxClient->xSocket, ( void * ) pcCOMMAND_BUFFER, sizeof( pcCOMMAND_BUFFER ), 0 );
+        #if ( ipconfigHTTP_CACHE_ENTRIES > 0 )
+            else if( pxClient->pxCacheEntry != NULL )
+            {
+                xRc = prvSendCachedBody( pxClient );
+            }
+        #endif
 
-        if( xRc > 0 )
+        /* While a reply is still being sent, a pipelined request stays in the
+         * RX stream until the reply is complete. */
+        if( ( xRc >= 0 ) && ( prvReplyPending( pxClient ) == pdFALSE ) )
         {
-            BaseType_t xIndex;
-            const char * pcEndOfCmd;
-            const struct xWEB_COMMAND * curCmd;
-            char * pcBuffer = pcCOMMAND_BUFFER;
+            /* Peek first, so that only the first request is taken from the
+             * RX stream.  A request pipelined behind it stays in the stream
+             * and is handled in a next call. */
+            xRc = FreeRTOS_recv( pxClient->xSocket, ( void * ) pcCOMMAND_BUFFER, sizeof( pcCOMMAND_BUFFER ) - 1, FREERTOS_MSG_PEEK );
 
-            if( xRc < ( BaseType_t ) sizeof( pcCOMMAND_BUFFER ) )
+            if( xRc > 0 )
             {
-                pcBuffer[ xRc ] = '\0';
+                const char * pcEndOfHeaders;
+
+                pcCOMMAND_BUFFER[ xRc ] = '\0';
+
+                /* A request ends with an empty line.  When none is found, all
+                 * bytes peeked are taken as a single request. */
+                pcEndOfHeaders = strstr( pcCOMMAND_BUFFER, "\r\n\r\n" );
+
+                if( pcEndOfHeaders != NULL )
+                {
+                    xRc = ( BaseType_t ) ( pcEndOfHeaders - pcCOMMAND_BUFFER ) + 4;
+                }
+
+                xRc = FreeRTOS_recv( pxClient->xSocket, ( void * ) pcCOMMAND_BUFFER, ( size_t ) xRc, 0 );
             }
 
-            while( xRc && ( pcBuffer[ xRc - 1 ] == 13 || pcBuffer[ xRc - 1 ] == 10 ) )
+            if( xRc > 0 )
             {
-                pcBuffer[ --xRc ] = '\0';
-            }
+                BaseType_t xIndex;
+                const char * pcEndOfCmd;
+                const struct xWEB_COMMAND * curCmd;
+                char * pcBuffer = pcCOMMAND_BUFFER;
 
-            pcEndOfCmd = pcBuffer + xRc;
+                /* The buffer is one byte larger than the largest request. */
+                pcBuffer[ xRc ] = '\0';
 
-            curCmd = xWebCommands;
+                while( xRc && ( pcBuffer[ xRc - 1 ] == 13 || pcBuffer[ xRc - 1 ] == 10 ) )
+                {
+                    pcBuffer[ --xRc ] = '\0';
+                }
 
-            /* Pointing to "/index.html HTTP/1.1". */
-            pxClient->pcUrlData = pcBuffer;
+                pcEndOfCmd = pcBuffer + xRc;
 
-            /* Pointing to "HTTP/1.1". */
-            pxClient->pcRestData = pcEmptyString;
+                curCmd = xWebCommands;
 
-            /* Last entry is "ECMD_UNK". */
-            for( xIndex = 0; xIndex < WEB_CMD_COUNT - 1; xIndex++, curCmd++ )
-            {
-                BaseType_t xLength;
+                /* Pointing to "/index.html HTTP/1.1". */
+                pxClient->pcUrlData = pcBuffer;
 
-                xLength = curCmd->xCommandLength;
+                /* Pointing to "HTTP/1.1". */
+                pxClient->pcRestData = pcEmptyString;
 
-                if( ( xRc >= xLength ) && ( memcmp( curCmd->pcCommandName, pcBuffer, xLength ) == 0 ) )
+                /* Last entry is "ECMD_UNK". */
+                for( xIndex = 0; xIndex < WEB_CMD_COUNT - 1; xIndex++, curCmd++ )
                 {
-                    char * pcLastPtr;
+                    BaseType_t xLength;
 
-                    pxClient->pcUrlData += xLength + 1;
+                    xLength = curCmd->xCommandLength;
 
-                    for( pcLastPtr = ( char * ) pxClient->pcUrlData; pcLastPtr < pcEndOfCmd; pcLastPtr++ )
+                    if( ( xRc >= xLength ) && ( memcmp( curCmd->pcCommandName, pcBuffer, xLength ) == 0 ) )
                     {
-                        char ch = *pcLastPtr;
+                        char * pcLastPtr;
+
+                        pxClient->pcUrlData += xLength + 1;
 
-                        if( ( ch == '\0' ) || ( strchr( "\n\r \t", ch ) != NULL ) )
+                        for( pcLastPtr = ( char * ) pxClient->pcUrlData; pcLastPtr < pcEndOfCmd; pcLastPtr++ )
                         {
-                            *pcLastPtr = '\0';
-                            pxClient->pcRestData = pcLastPtr + 1;
-                            break;
+                            char ch = *pcLastPtr;
+
+                            if( ( ch == '\0' ) || ( strchr( "\n\r \t", ch ) != NULL ) )
+                            {
+                                *pcLastPtr = '\0';
+                                pxClient->pcRestData = pcLastPtr + 1;
+                                break;
+                            }
                         }
+
+                        break;
                     }
+                }
 
-                    break;
+                if( xIndex < ( WEB_CMD_COUNT - 1 ) )
+                {
+                    xRc = prvProcessCmd( pxClient, xIndex );
                 }
             }
-
-            if( xIndex < ( WEB_CMD_COUNT - 1 ) )
+            else if( xRc < 0 )
             {
-                xRc = prvProcessCmd( pxClient, xIndex );
+                /* The connection will be closed and the client will be deleted. */
+                FreeRTOS_printf( ( "xHTTPClientWork: rc = %ld\n", xRc ) );
             }
         }
-        else if( xRc < 0 )
-        {
-            /* The connection will be closed and the client will be deleted. */
-            FreeRTOS_printf( ( "xHTTPClientWork: rc = %ld\n", xRc ) );
-        }
 
         return xRc;
     }
@@ -109,6 +109,7 @@ enum EFTPCommand
     ECMD_PWD,
     ECMD_LIST,
     ECMD_NLST,
+    ECMD_MLSD,
     ECMD_SITE,
     ECMD_SYST,
     ECMD_FEAT,
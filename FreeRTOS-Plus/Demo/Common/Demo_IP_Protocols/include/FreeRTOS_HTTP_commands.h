@@ -30,11 +30,14 @@ enum
 {
     WEB_REPLY_OK = 200,
     WEB_NO_CONTENT = 204,
+    WEB_PARTIAL_CONTENT = 206,
+    WEB_NOT_MODIFIED = 304,
     WEB_BAD_REQUEST = 400,
     WEB_UNAUTHORIZED = 401,
     WEB_NOT_FOUND = 404,
     WEB_GONE = 410,
     WEB_PRECONDITION_FAILED = 412,
+    WEB_RANGE_NOT_SATISFIABLE = 416,
     WEB_INTERNAL_SERVER_ERROR = 500,
 };
 
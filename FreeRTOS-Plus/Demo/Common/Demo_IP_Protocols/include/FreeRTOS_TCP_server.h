@@ -123,6 +123,17 @@
     void FreeRTOS_TCPServerWork( TCPServer_t * pxServer,
                                  TickType_t xBlockingTime );
 
+    #if ( ipconfigUSE_HTTP != 0 ) && ( ipconfigHTTP_CACHE_ENTRIES > 0 )
+
+/* Drop all files from the HTTP server's RAM cache, for instance after the
+ * application has written new versions of them. Must be called from the task
+ * that calls FreeRTOS_TCPServerWork().  When ipconfigTCP_SERVER_WORKERS is
+ * used, every worker has a cache of its own.  Each worker drops it between
+ * two of its working cycles, and the function returns once all of them have
+ * done so, which may take up to ipconfigTCP_SERVER_WORKER_BLOCK_TIME. */
+        void FreeRTOS_HTTPCacheFlush( TCPServer_t * pxServer );
+    #endif
+
     #if ( ipconfigSUPPORT_SIGNALS != 0 )
 
 /* FreeRTOS_TCPServerWork() calls select().
@@ -57,8 +57,96 @@
     #define ipconfigTCP_FILE_BUFFER_SIZE    ( 2048 )
 #endif
 
+/*
+ * ipconfigFTP_TX_DOUBLE_BUFFER: when non-zero, every file that is sent by the
+ * FTP server gets two buffers of ipconfigFTP_TX_BUFFER_SIZE bytes of its own.
+ * While the contents of one buffer are being queued for transmission, the
+ * other one is filled from disk, so data can be queued as soon as the data
+ * socket has space.  The transfer falls back to pcFileBuffer if the buffers
+ * can not be allocated.  Can not be combined with ipconfigFTP_TX_ZERO_COPY.
+ */
+#ifndef ipconfigFTP_TX_DOUBLE_BUFFER
+    #define ipconfigFTP_TX_DOUBLE_BUFFER    ( 0 )
+#endif
+
+#ifndef ipconfigFTP_TX_BUFFER_SIZE
+    #define ipconfigFTP_TX_BUFFER_SIZE    ( 4096 )
+#endif
+
+/*
+ * ipconfigTCP_SERVER_WORKERS sets the number of worker tasks that serve the
+ * connected clients.  Each worker has its own socket set, buffers and list
+ * of clients.  The task that calls FreeRTOS_TCPServerWork() only accepts new
+ * connections and hands each of them to the worker with the fewest clients.
+ * When 0, all clients are served by the task that calls
+ * FreeRTOS_TCPServerWork(), one after the other.
+ *
+ * ipconfigTCP_SERVER_WORKER_CORE_AFFINITY: when 1 on an SMP build, worker
+ * 'n' only runs on core ( n % configNUMBER_OF_CORES ).
+ */
+#ifndef ipconfigTCP_SERVER_WORKERS
+    #define ipconfigTCP_SERVER_WORKERS    ( 0 )
+#endif
+
+#ifndef ipconfigTCP_SERVER_WORKER_STACK_SIZE
+    #define ipconfigTCP_SERVER_WORKER_STACK_SIZE    ( 8 * configMINIMAL_STACK_SIZE )
+#endif
+
+#ifndef ipconfigTCP_SERVER_WORKER_PRIORITY
+    #define ipconfigTCP_SERVER_WORKER_PRIORITY    ( tskIDLE_PRIORITY + 2 )
+#endif
+
+/* The maximum time a worker blocks in FreeRTOS_select(). */
+#ifndef ipconfigTCP_SERVER_WORKER_BLOCK_TIME
+    #define ipconfigTCP_SERVER_WORKER_BLOCK_TIME    pdMS_TO_TICKS( 200U )
+#endif
+
+/* The number of accepted clients that may wait to be taken by a worker. */
+#ifndef ipconfigTCP_SERVER_WORKER_QUEUE_LENGTH
+    #define ipconfigTCP_SERVER_WORKER_QUEUE_LENGTH    ( 8 )
+#endif
+
+#ifndef ipconfigTCP_SERVER_WORKER_CORE_AFFINITY
+    #define ipconfigTCP_SERVER_WORKER_CORE_AFFINITY    ( 0 )
+#endif
+
+#if ( ipconfigTCP_SERVER_WORKERS > 0 )
+    #include "queue.h"
+#endif
+
+/*
+ * ipconfigHTTP_CACHE_ENTRIES sets the number of static files the HTTP server
+ * keeps in RAM, together with their pre-rendered reply headers. 0 disables
+ * the cache.
+ *
+ * ipconfigHTTP_CACHE_MAX_FILE_SIZE sets the size of the largest file that
+ * will be cached. Larger files are always streamed from disk.
+ */
+#ifndef ipconfigHTTP_CACHE_ENTRIES
+    #define ipconfigHTTP_CACHE_ENTRIES    ( 0 )
+#endif
+
+#ifndef ipconfigHTTP_CACHE_MAX_FILE_SIZE
+    #define ipconfigHTTP_CACHE_MAX_FILE_SIZE    ( 16384 )
+#endif
+
 struct xTCP_CLIENT;
 
+#if ( ipconfigUSE_HTTP != 0 ) && ( ipconfigHTTP_CACHE_ENTRIES > 0 )
+    typedef struct xHTTP_CACHE_ENTRY
+    {
+        char pcFileName[ ffconfigMAX_FILENAME ]; /* Full path of the cached file, "" for a free entry. */
+        uint32_t ulNameHash;                     /* Hash of pcFileName, to speed up the look-up. */
+        uint32_t ulLastUsed;                     /* Server's cache clock at the last hit, for LRU replacement. */
+        BaseType_t xUsers;                       /* Number of clients still sending the body. */
+        size_t uxHeaderLength;                   /* Length of the pre-rendered headers at the start of pucData. */
+        size_t uxBodyLength;                     /* Length of the file contents that follow the headers. */
+        char pcETag[ 24 ];                       /* Quoted entity tag, derived from the contents. */
+        uint8_t * pucData;                       /* NULL if the file can not be served from the cache. */
+        BaseType_t xMissing;                     /* pdTRUE if the file did not exist when the entry was loaded. */
+    } HTTPCacheEntry_t;
+#endif
+
 typedef BaseType_t ( * FTCPWorkFunction ) ( struct xTCP_CLIENT * /* pxClient */ );
 typedef void ( * FTCPDeleteFunction ) ( struct xTCP_CLIENT * /* pxClient */ );
 
@@ -89,12 +177,17 @@ struct xHTTP_CLIENT
     char pcCurrentFilename[ ffconfigMAX_FILENAME ];
     size_t uxBytesLeft;
     FF_FILE * pxFileHandle;
+    #if ( ipconfigHTTP_CACHE_ENTRIES > 0 )
+        HTTPCacheEntry_t * pxCacheEntry; /* Not NULL while a cached body is being sent. */
+    #endif
     union
     {
         struct
         {
             uint32_t
-                bReplySent : 1;
+                bReplySent : 1,
+                bHeadOnly : 1,        /* pdTRUE for a HEAD request: send the headers only. */
+                bCloseAfterReply : 1; /* pdTRUE if the connection is not kept alive after the reply. */
         };
         uint32_t ulFlags;
     }
@@ -125,6 +218,15 @@ struct xFTP_CLIENT
     char pcFileName[ ffconfigMAX_FILENAME ];
     char pcConnectionAck[ 128 ];
     char pcClientAck[ 128 ];
+    uint32_t ulListDateKey; /* The time stamp that was formatted last in a LIST, packed. */
+    char pcListDate[ 16 ];  /* The formatted version of that time stamp. */
+    #if ( ipconfigFTP_TX_DOUBLE_BUFFER != 0 )
+        uint8_t * pucTxBuffers[ 2 ]; /* NULL when the file is sent through pcFileBuffer. */
+        size_t uxTxLength[ 2 ];      /* Number of bytes read into each buffer, 0 for an empty buffer. */
+        size_t uxTxOffset;           /* Number of bytes of the front buffer that have been sent. */
+        size_t uxReadLeft;           /* Bytes left to read from disk. */
+        BaseType_t xTxFront;         /* The buffer that is being sent. */
+    #endif
     union
     {
         struct
@@ -148,7 +250,8 @@ struct xFTP_CLIENT
                 bDirHasEntry : 1,     /* pdTRUE if ff_findfirst() was successful. */
                 bClientConnected : 1, /* pdTRUE after connect() or accept() has succeeded. */
                 bEmptyFile : 1,       /* pdTRUE if a connection-without-data was received. */
-                bHadError : 1;        /* pdTRUE if a transfer got aborted because of an error. */
+                bHadError : 1,        /* pdTRUE if a transfer got aborted because of an error. */
+                bMachineList : 1;     /* pdTRUE if the directory is listed for MLSD rather than LIST. */
         };
         uint32_t ulConnFlags;
     }
@@ -163,6 +266,12 @@ BaseType_t xFTPClientWork( TCPClient_t * pxClient );
 void vHTTPClientDelete( TCPClient_t * pxClient );
 void vFTPClientDelete( TCPClient_t * pxClient );
 
+#if ( ipconfigUSE_HTTP != 0 ) && ( ipconfigHTTP_CACHE_ENTRIES > 0 )
+    /* Drop the files in the cache of one server or worker.  Only called by
+     * the task that serves its clients. */
+    void vHTTPCacheDrop( TCPServer_t * pxServer );
+#endif
+
 BaseType_t xMakeAbsolute( struct xFTP_CLIENT * pxClient,
                           char * pcBuffer,
                           BaseType_t xBufferLength,
@@ -185,7 +294,25 @@ struct xTCP_SERVER
     #endif
     #if ( ipconfigUSE_HTTP != 0 )
         char pcContentsType[ 40 ];  /* Space for the msg: "text/javascript" */
-        char pcExtraContents[ 40 ]; /* Space for the msg: "Content-Length: 346500" */
+        char pcExtraContents[ 128 ]; /* Space for the msgs: "Content-Length: 346500" and "Content-Range: bytes 0-1023/346500" */
+        #if ( ipconfigHTTP_CACHE_ENTRIES > 0 )
+            HTTPCacheEntry_t xHTTPCache[ ipconfigHTTP_CACHE_ENTRIES ];
+            uint32_t ulHTTPCacheClock;
+            #if ( ipconfigTCP_SERVER_WORKERS > 0 )
+                /* Only used by a worker: set by FreeRTOS_HTTPCacheFlush(),
+                 * cleared by the worker once it has dropped its cache. */
+                volatile BaseType_t xHTTPCacheFlushPending;
+            #endif
+        #endif
+    #endif
+    #if ( ipconfigTCP_SERVER_WORKERS > 0 )
+        /* The workers, only used by the server that accepts connections.
+         * A worker is a TCPServer_t without listening sockets. */
+        struct xTCP_SERVER * pxWorkers[ ipconfigTCP_SERVER_WORKERS ];
+        /* Only used by a worker: clients handed over by the accepting server. */
+        QueueHandle_t xNewClients;
+        /* Only used by a worker: the number of clients it is serving. */
+        volatile UBaseType_t uxClientCount;
     #endif
     BaseType_t xServerCount;
     TCPClient_t * pxClients;
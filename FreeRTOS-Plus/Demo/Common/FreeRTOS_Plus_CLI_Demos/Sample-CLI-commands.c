@@ -59,21 +59,39 @@
 void vRegisterSampleCLICommands( void );
 
 /*
- * Implements the task-stats command.
+ * Implements the task-stats command.  The table is streamed to the console one
+ * line at a time, so its size is not limited by configCOMMAND_INT_MAX_OUTPUT_SIZE.
  */
-static BaseType_t prvTaskStatsCommand( char * pcWriteBuffer,
-                                       size_t xWriteBufferLen,
+static BaseType_t prvTaskStatsCommand( const CLI_Output_Sink_t * pxSink,
                                        const char * pcCommandString );
 
 /*
- * Implements the run-time-stats command.
+ * Implements the run-time-stats command, which is also streamed.
  */
 #if ( configGENERATE_RUN_TIME_STATS == 1 )
-    static BaseType_t prvRunTimeStatsCommand( char * pcWriteBuffer,
-                                              size_t xWriteBufferLen,
+    static BaseType_t prvRunTimeStatsCommand( const CLI_Output_Sink_t * pxSink,
                                               const char * pcCommandString );
 #endif /* configGENERATE_RUN_TIME_STATS */
 
+/*
+ * Write the heading of the task-stats and run-time-stats tables, the column
+ * titles of which follow the column that holds the task name.
+ */
+static BaseType_t prvWriteTableHeader( const CLI_Output_Sink_t * pxSink,
+                                       const char * pcHeader );
+
+/*
+ * Write a task name padded with spaces to the width of the task name column.
+ */
+static BaseType_t prvWriteTaskName( const CLI_Output_Sink_t * pxSink,
+                                    const char * pcTaskName );
+
+/*
+ * Write xCount spaces.
+ */
+static BaseType_t prvWriteSpaces( const CLI_Output_Sink_t * pxSink,
+                                  size_t xCount );
+
 /*
  * Implements the echo-three-parameters command.
  */
@@ -110,10 +128,11 @@ static BaseType_t prvParameterEchoCommand( char * pcWriteBuffer,
  * a table that gives information on each task in the system. */
 static const CLI_Command_Definition_t xTaskStats =
 {
-    "task-stats",        /* The command string to type. */
+    "task-stats",       /* The command string to type. */
     "\r\ntask-stats:\r\n Displays a table showing the state of each FreeRTOS task\r\n",
-    prvTaskStatsCommand, /* The function to run. */
-    0                    /* No parameters are expected. */
+    NULL,               /* The command is streamed, so has no buffer based function. */
+    0,                  /* No parameters are expected. */
+    prvTaskStatsCommand /* The function to run. */
 };
 
 /* Structure that defines the "echo_3_parameters" command line command.  This
@@ -144,10 +163,11 @@ static const CLI_Command_Definition_t xParameterEcho =
  * generates a table that shows how much run time each task has */
     static const CLI_Command_Definition_t xRunTimeStats =
     {
-        "run-time-stats",       /* The command string to type. */
+        "run-time-stats",      /* The command string to type. */
         "\r\nrun-time-stats:\r\n Displays a table showing how much processing time each FreeRTOS task has used\r\n",
-        prvRunTimeStatsCommand, /* The function to run. */
-        0                       /* No parameters are expected. */
+        NULL,                  /* The command is streamed, so has no buffer based function. */
+        0,                     /* No parameters are expected. */
+        prvRunTimeStatsCommand /* The function to run. */
     };
 #endif /* configGENERATE_RUN_TIME_STATS */
 
@@ -204,44 +224,77 @@ void vRegisterSampleCLICommands( void )
 }
 /*-----------------------------------------------------------*/
 
-static BaseType_t prvTaskStatsCommand( char * pcWriteBuffer,
-                                       size_t xWriteBufferLen,
+static BaseType_t prvTaskStatsCommand( const CLI_Output_Sink_t * pxSink,
                                        const char * pcCommandString )
 {
     const char * const pcHeader = "     State   Priority  Stack    #\r\n************************************************\r\n";
-    BaseType_t xSpacePadding;
+    TaskStatus_t * pxTaskStatusArray;
+    UBaseType_t uxArraySize, x;
+    char cStatus;
+    char cLine[ 48 ];
+    BaseType_t xReturn;
 
-    /* Remove compile time warnings about unused parameters, and check the
-     * write buffer is not NULL.  NOTE - for simplicity, this example assumes the
-     * write buffer length is adequate, so does not check for buffer overflows. */
+    /* Remove compile time warnings about unused parameters. */
     ( void ) pcCommandString;
-    ( void ) xWriteBufferLen;
-    configASSERT( pcWriteBuffer );
 
-    /* Generate a table of task stats. */
-    strcpy( pcWriteBuffer, "Task" );
-    pcWriteBuffer += strlen( pcWriteBuffer );
+    xReturn = prvWriteTableHeader( pxSink, pcHeader );
 
-    /* Minus three for the null terminator and half the number of characters in
-     * "Task" so the column lines up with the centre of the heading. */
-    configASSERT( configMAX_TASK_NAME_LEN > 3 );
+    /* Take a snapshot of the state of the tasks, then write the table one line
+     * at a time, as vTaskList() would have formatted it. */
+    uxArraySize = uxTaskGetNumberOfTasks();
+    pxTaskStatusArray = pvPortMalloc( uxArraySize * sizeof( TaskStatus_t ) );
 
-    for( xSpacePadding = strlen( "Task" ); xSpacePadding < ( configMAX_TASK_NAME_LEN - 3 ); xSpacePadding++ )
+    if( pxTaskStatusArray != NULL )
     {
-        /* Add a space to align columns after the task's name. */
-        *pcWriteBuffer = ' ';
-        pcWriteBuffer++;
+        uxArraySize = uxTaskGetSystemState( pxTaskStatusArray, uxArraySize, NULL );
 
-        /* Ensure always terminated. */
-        *pcWriteBuffer = 0x00;
-    }
+        for( x = 0; ( x < uxArraySize ) && ( xReturn == pdPASS ); x++ )
+        {
+            switch( pxTaskStatusArray[ x ].eCurrentState )
+            {
+                case eRunning:
+                    cStatus = 'X';
+                    break;
+
+                case eReady:
+                    cStatus = 'R';
+                    break;
+
+                case eBlocked:
+                    cStatus = 'B';
+                    break;
+
+                case eSuspended:
+                    cStatus = 'S';
+                    break;
+
+                case eDeleted:
+                    cStatus = 'D';
+                    break;
+
+                case eInvalid:
+                default:
+                    cStatus = 0x00;
+                    break;
+            }
+
+            xReturn = prvWriteTaskName( pxSink, pxTaskStatusArray[ x ].pcTaskName );
+
+            if( xReturn == pdPASS )
+            {
+                snprintf( cLine, sizeof( cLine ), "\t%c\t%u\t%u\t%u\r\n",
+                          cStatus,
+                          ( unsigned int ) pxTaskStatusArray[ x ].uxCurrentPriority,
+                          ( unsigned int ) pxTaskStatusArray[ x ].usStackHighWaterMark,
+                          ( unsigned int ) pxTaskStatusArray[ x ].xTaskNumber );
+                xReturn = FreeRTOS_CLIWriteString( pxSink, cLine );
+            }
+        }
 
-    strcpy( pcWriteBuffer, pcHeader );
-    vTaskList( pcWriteBuffer + strlen( pcHeader ) );
+        vPortFree( pxTaskStatusArray );
+    }
 
-    /* There is no more data to return after this single string, so return
-     * pdFALSE. */
-    return pdFALSE;
+    return xReturn;
 }
 /*-----------------------------------------------------------*/
 
@@ -270,49 +323,133 @@ static BaseType_t prvTaskStatsCommand( char * pcWriteBuffer,
 
 #if ( configGENERATE_RUN_TIME_STATS == 1 )
 
-    static BaseType_t prvRunTimeStatsCommand( char * pcWriteBuffer,
-                                              size_t xWriteBufferLen,
+    static BaseType_t prvRunTimeStatsCommand( const CLI_Output_Sink_t * pxSink,
                                               const char * pcCommandString )
     {
         const char * const pcHeader = "  Abs Time      % Time\r\n****************************************\r\n";
-        BaseType_t xSpacePadding;
+        TaskStatus_t * pxTaskStatusArray;
+        UBaseType_t uxArraySize, x;
+        configRUN_TIME_COUNTER_TYPE ulTotalTime, ulStatsAsPercentage;
+        char cLine[ 48 ];
+        BaseType_t xReturn;
 
-        /* Remove compile time warnings about unused parameters, and check the
-         * write buffer is not NULL.  NOTE - for simplicity, this example assumes the
-         * write buffer length is adequate, so does not check for buffer overflows. */
+        /* Remove compile time warnings about unused parameters. */
         ( void ) pcCommandString;
-        ( void ) xWriteBufferLen;
-        configASSERT( pcWriteBuffer );
 
-        /* Generate a table of task stats. */
-        strcpy( pcWriteBuffer, "Task" );
-        pcWriteBuffer += strlen( pcWriteBuffer );
+        xReturn = prvWriteTableHeader( pxSink, pcHeader );
 
-        /* Pad the string "task" with however many bytes necessary to make it the
-         * length of a task name.  Minus three for the null terminator and half the
-         * number of characters in	"Task" so the column lines up with the centre of
-         * the heading. */
-        for( xSpacePadding = strlen( "Task" ); xSpacePadding < ( configMAX_TASK_NAME_LEN - 3 ); xSpacePadding++ )
-        {
-            /* Add a space to align columns after the task's name. */
-            *pcWriteBuffer = ' ';
-            pcWriteBuffer++;
+        /* Take a snapshot of the run time of the tasks, then write the table
+         * one line at a time, as vTaskGetRunTimeStats() would have formatted
+         * it. */
+        uxArraySize = uxTaskGetNumberOfTasks();
+        pxTaskStatusArray = pvPortMalloc( uxArraySize * sizeof( TaskStatus_t ) );
 
-            /* Ensure always terminated. */
-            *pcWriteBuffer = 0x00;
+        if( pxTaskStatusArray != NULL )
+        {
+            uxArraySize = uxTaskGetSystemState( pxTaskStatusArray, uxArraySize, &ulTotalTime );
+
+            /* For percentage calculations. */
+            ulTotalTime /= 100UL;
+
+            for( x = 0; ( x < uxArraySize ) && ( xReturn == pdPASS ) && ( ulTotalTime > 0UL ); x++ )
+            {
+                ulStatsAsPercentage = pxTaskStatusArray[ x ].ulRunTimeCounter / ulTotalTime;
+
+                xReturn = prvWriteTaskName( pxSink, pxTaskStatusArray[ x ].pcTaskName );
+
+                if( xReturn == pdPASS )
+                {
+                    if( ulStatsAsPercentage > 0UL )
+                    {
+                        snprintf( cLine, sizeof( cLine ), "\t%lu\t\t%lu%%\r\n",
+                                  ( unsigned long ) pxTaskStatusArray[ x ].ulRunTimeCounter,
+                                  ( unsigned long ) ulStatsAsPercentage );
+                    }
+                    else
+                    {
+                        /* If the percentage is zero here then the task has
+                         * consumed less than 1% of the total run time. */
+                        snprintf( cLine, sizeof( cLine ), "\t%lu\t\t<1%%\r\n",
+                                  ( unsigned long ) pxTaskStatusArray[ x ].ulRunTimeCounter );
+                    }
+
+                    xReturn = FreeRTOS_CLIWriteString( pxSink, cLine );
+                }
+            }
+
+            vPortFree( pxTaskStatusArray );
         }
 
-        strcpy( pcWriteBuffer, pcHeader );
-        vTaskGetRunTimeStats( pcWriteBuffer + strlen( pcHeader ) );
-
-        /* There is no more data to return after this single string, so return
-         * pdFALSE. */
-        return pdFALSE;
+        return xReturn;
     }
 
 #endif /* configGENERATE_RUN_TIME_STATS */
 /*-----------------------------------------------------------*/
 
+static BaseType_t prvWriteTableHeader( const CLI_Output_Sink_t * pxSink,
+                                       const char * pcHeader )
+{
+    BaseType_t xReturn;
+
+    /* Pad the string "Task" with however many bytes necessary to make it the
+     * length of a task name.  Minus three for the null terminator and half the
+     * number of characters in "Task" so the column lines up with the centre of
+     * the heading. */
+    configASSERT( configMAX_TASK_NAME_LEN > 3 );
+
+    xReturn = FreeRTOS_CLIWriteString( pxSink, "Task" );
+
+    if( xReturn == pdPASS )
+    {
+        xReturn = prvWriteSpaces( pxSink, ( configMAX_TASK_NAME_LEN - 3 ) - strlen( "Task" ) );
+    }
+
+    if( xReturn == pdPASS )
+    {
+        xReturn = FreeRTOS_CLIWriteString( pxSink, pcHeader );
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvWriteTaskName( const CLI_Output_Sink_t * pxSink,
+                                    const char * pcTaskName )
+{
+    BaseType_t xReturn;
+    size_t xLength = strlen( pcTaskName );
+
+    xReturn = FreeRTOS_CLIWriteString( pxSink, pcTaskName );
+
+    /* Pad to the length of the longest possible task name, so the columns
+     * line up. */
+    if( ( xReturn == pdPASS ) && ( xLength < ( configMAX_TASK_NAME_LEN - 1 ) ) )
+    {
+        xReturn = prvWriteSpaces( pxSink, ( configMAX_TASK_NAME_LEN - 1 ) - xLength );
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvWriteSpaces( const CLI_Output_Sink_t * pxSink,
+                                  size_t xCount )
+{
+    static const char cSpaces[] = "                ";
+    BaseType_t xReturn = pdPASS;
+    size_t xLength;
+
+    while( ( xCount > 0 ) && ( xReturn == pdPASS ) )
+    {
+        xLength = ( xCount < ( sizeof( cSpaces ) - 1 ) ) ? xCount : ( sizeof( cSpaces ) - 1 );
+        xReturn = pxSink->pxWrite( pxSink->pvContext, cSpaces, xLength );
+        xCount -= xLength;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
 static BaseType_t prvThreeParameterEchoCommand( char * pcWriteBuffer,
                                                 size_t xWriteBufferLen,
                                                 const char * pcCommandString )
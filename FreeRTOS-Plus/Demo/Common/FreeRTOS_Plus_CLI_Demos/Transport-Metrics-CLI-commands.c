@@ -0,0 +1,207 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/******************************************************************************
+*
+* Defines the "transport-stats" command, which prints the per-connection
+* statistics gathered by the network transports when transportconfigMETRICS_ENABLED
+* is 1.  The application makes a connection's metrics visible to the command by
+* passing the metrics block returned by the transport's GetMetrics() function to
+* xTransportMetricsCLIAdd() once the connection is established, and removes it
+* with vTransportMetricsCLIRemove() before the connection is closed.
+*
+******************************************************************************/
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS+CLI includes. */
+#include "FreeRTOS_CLI.h"
+
+/* Network transport includes. */
+#include "transport_metrics.h"
+
+/* The number of connections that can be registered with the command at any
+ * one time. */
+#ifndef configTRANSPORT_METRICS_CLI_CONNECTIONS
+    #define configTRANSPORT_METRICS_CLI_CONNECTIONS    4
+#endif
+
+/* The size of the buffer into which the statistics of one connection are
+ * formatted before being written to the output. */
+#ifndef configTRANSPORT_METRICS_CLI_BUFFER_SIZE
+    #define configTRANSPORT_METRICS_CLI_BUFFER_SIZE    1536
+#endif
+
+/* A connection registered with the command. */
+typedef struct xTRANSPORT_METRICS_CLI_ENTRY
+{
+    const char * pcName;
+    const TransportMetrics_t * pxMetrics;
+} TransportMetricsCLIEntry_t;
+
+/*
+ * Implements the transport-stats command, which is streamed.
+ */
+static BaseType_t prvTransportStatsCommand( const CLI_Output_Sink_t * pxSink,
+                                            const char * pcCommandString );
+
+/* Structure that defines the "transport-stats" command line command. */
+static const CLI_Command_Definition_t xTransportStats =
+{
+    "transport-stats",        /* The command string to type. */
+    "\r\ntransport-stats:\r\n Displays the statistics of each registered network transport connection\r\n",
+    NULL,                     /* The command is streamed, so has no buffer based function. */
+    0,                        /* No parameters are expected. */
+    prvTransportStatsCommand  /* The function to run. */
+};
+
+/* The connections registered with the command.  Accessed from a critical
+ * section, as connections are added and removed by the application tasks while
+ * the CLI task reads the table. */
+static TransportMetricsCLIEntry_t xEntries[ configTRANSPORT_METRICS_CLI_CONNECTIONS ];
+
+/*-----------------------------------------------------------*/
+
+void vRegisterTransportMetricsCLICommands( void )
+{
+    FreeRTOS_CLIRegisterCommand( &xTransportStats );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xTransportMetricsCLIAdd( const char * pcName,
+                                    const TransportMetrics_t * pxMetrics )
+{
+    BaseType_t x, xReturn = pdFAIL;
+
+    configASSERT( ( pcName != NULL ) && ( pxMetrics != NULL ) );
+
+    taskENTER_CRITICAL();
+    {
+        for( x = 0; x < configTRANSPORT_METRICS_CLI_CONNECTIONS; x++ )
+        {
+            if( xEntries[ x ].pxMetrics == NULL )
+            {
+                xEntries[ x ].pcName = pcName;
+                xEntries[ x ].pxMetrics = pxMetrics;
+                xReturn = pdPASS;
+                break;
+            }
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vTransportMetricsCLIRemove( const TransportMetrics_t * pxMetrics )
+{
+    BaseType_t x;
+
+    taskENTER_CRITICAL();
+    {
+        for( x = 0; x < configTRANSPORT_METRICS_CLI_CONNECTIONS; x++ )
+        {
+            if( xEntries[ x ].pxMetrics == pxMetrics )
+            {
+                xEntries[ x ].pcName = NULL;
+                xEntries[ x ].pxMetrics = NULL;
+            }
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvTransportStatsCommand( const CLI_Output_Sink_t * pxSink,
+                                            const char * pcCommandString )
+{
+    TransportMetricsCLIEntry_t xEntry;
+    TransportMetrics_t * pxSnapshot;
+    char * pcBuffer;
+    BaseType_t x, xConnections = 0, xReturn = pdPASS;
+
+    /* Remove compile time warnings about unused parameters. */
+    ( void ) pcCommandString;
+
+    /* The metrics are copied before being formatted so the output of each
+     * connection is consistent, and the buffers are allocated rather than
+     * placed on the stack of the CLI task as they are fairly large. */
+    pxSnapshot = pvPortMalloc( sizeof( TransportMetrics_t ) );
+    pcBuffer = pvPortMalloc( configTRANSPORT_METRICS_CLI_BUFFER_SIZE );
+
+    if( ( pxSnapshot == NULL ) || ( pcBuffer == NULL ) )
+    {
+        xReturn = FreeRTOS_CLIWriteString( pxSink, "Insufficient heap to format the statistics\r\n" );
+    }
+    else
+    {
+        for( x = 0; ( x < configTRANSPORT_METRICS_CLI_CONNECTIONS ) && ( xReturn == pdPASS ); x++ )
+        {
+            taskENTER_CRITICAL();
+            {
+                xEntry = xEntries[ x ];
+
+                if( xEntry.pxMetrics != NULL )
+                {
+                    ( void ) memcpy( pxSnapshot, xEntry.pxMetrics, sizeof( TransportMetrics_t ) );
+                }
+            }
+            taskEXIT_CRITICAL();
+
+            if( xEntry.pxMetrics != NULL )
+            {
+                xConnections++;
+                ( void ) snprintf( pcBuffer, configTRANSPORT_METRICS_CLI_BUFFER_SIZE, "\r\n%s:\r\n", xEntry.pcName );
+                xReturn = FreeRTOS_CLIWriteString( pxSink, pcBuffer );
+
+                if( xReturn == pdPASS )
+                {
+                    ( void ) TransportMetrics_Format( pxSnapshot, pcBuffer, configTRANSPORT_METRICS_CLI_BUFFER_SIZE );
+                    xReturn = FreeRTOS_CLIWriteString( pxSink, pcBuffer );
+                }
+            }
+        }
+
+        if( ( xConnections == 0 ) && ( xReturn == pdPASS ) )
+        {
+            xReturn = FreeRTOS_CLIWriteString( pxSink, "No connections are registered\r\n" );
+        }
+    }
+
+    vPortFree( pxSnapshot );
+    vPortFree( pcBuffer );
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
@@ -67,6 +67,14 @@
  * The task that implements the command console processing.
  */
 static void prvUARTCommandConsoleTask( void * pvParameters );
+
+/*
+ * The write function of the sink through which command output is streamed to
+ * the UART.
+ */
+static BaseType_t prvSinkWrite( void * pvContext,
+                                const char * pcData,
+                                size_t xDataLength );
 void vUARTCommandConsoleStart( uint16_t usStackSize,
                                UBaseType_t uxPriority );
 void vOutputString( const char * const pcMessage );
@@ -108,16 +116,22 @@ static void prvUARTCommandConsoleTask( void * pvParameters )
 {
     signed char cRxedChar;
     uint8_t ucInputIndex = 0;
-    char * pcOutputString;
     static char cInputString[ cmdMAX_INPUT_SIZE ], cLastInputString[ cmdMAX_INPUT_SIZE ];
-    BaseType_t xReturned;
+    CLI_Session_t xSession;
+    CLI_Output_Sink_t xSink;
 
     ( void ) pvParameters;
 
-    /* Obtain the address of the output buffer.  Note there is no mutual
-     * exclusion on this buffer as it is assumed only one command console interface
-     * will be used at any one time. */
-    pcOutputString = FreeRTOS_CLIGetOutputBuffer();
+    /* The session uses the output buffer of the command interpreter for the
+     * commands that are not streamed.  Note there is no mutual exclusion on
+     * this buffer as it is assumed only one command console interface will be
+     * used at any one time. */
+    FreeRTOS_CLIInitSession( &xSession, FreeRTOS_CLIGetOutputBuffer(), configCOMMAND_INT_MAX_OUTPUT_SIZE );
+
+    /* All command output is written straight to the UART. */
+    xSink.pxWrite = prvSinkWrite;
+    xSink.pxFlush = NULL;
+    xSink.pvContext = NULL;
 
     /* Initialise the UART. */
     xPort = xSerialPortInitMinimal( configCLI_BAUD_RATE, cmdQUEUE_LENGTH );
@@ -154,18 +168,9 @@ static void prvUARTCommandConsoleTask( void * pvParameters )
                     strcpy( cInputString, cLastInputString );
                 }
 
-                /* Pass the received command to the command interpreter.  The
-                 * command interpreter is called repeatedly until it returns
-                 * pdFALSE	(indicating there is no more output) as it might
-                 * generate more than one string. */
-                do
-                {
-                    /* Get the next output string from the command interpreter. */
-                    xReturned = FreeRTOS_CLIProcessCommand( cInputString, pcOutputString, configCOMMAND_INT_MAX_OUTPUT_SIZE );
-
-                    /* Write the generated string to the UART. */
-                    vSerialPutString( xPort, ( signed char * ) pcOutputString, ( unsigned short ) strlen( pcOutputString ) );
-                } while( xReturned != pdFALSE );
+                /* Pass the received command to the command interpreter, which
+                 * writes all the output the command generates to the UART. */
+                ( void ) FreeRTOS_CLIProcessCommandToSink( &xSession, cInputString, &xSink );
 
                 /* All the strings generated by the input command have been
                  * sent.  Clear the input string ready to receive the next command.
@@ -216,6 +221,19 @@ static void prvUARTCommandConsoleTask( void * pvParameters )
 }
 /*-----------------------------------------------------------*/
 
+static BaseType_t prvSinkWrite( void * pvContext,
+                                const char * pcData,
+                                size_t xDataLength )
+{
+    ( void ) pvContext;
+
+    /* The console task already holds xTxMutex. */
+    vSerialPutString( xPort, ( signed char * ) pcData, ( unsigned short ) xDataLength );
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
 void vOutputString( const char * const pcMessage )
 {
     if( xSemaphoreTake( xTxMutex, cmdMAX_MUTEX_WAIT ) == pdPASS )
@@ -0,0 +1,534 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Asynchronous logging backend - see logging_async.h.
+ *
+ * Each core has its own bounded ring buffer of fixed size slots.  Every slot
+ * carries a sequence number that tells producers and the drain task who owns
+ * it:
+ *
+ *  - sequence == position      The slot is free for the producer that claims
+ *                              position by advancing ulHead.
+ *  - sequence == position + 1  The record is complete and can be output.
+ *
+ * The drain task hands the slot back for the next lap of the ring by setting
+ * its sequence to position + loggingASYNC_RING_LENGTH.  Producers only ever
+ * compare-and-swap ulHead and increment a sequence number, so a task or
+ * interrupt that logs never waits for another logger or for the output.  The
+ * rings are per core only to keep producers on different cores from contending
+ * on the same head index; a task that moves core between reserving and
+ * committing a record is still safe.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "atomic.h"
+
+/* Demo includes. */
+#include "logging_async.h"
+
+/*-----------------------------------------------------------*/
+
+#if ( ( loggingASYNC_RING_LENGTH & ( loggingASYNC_RING_LENGTH - 1 ) ) != 0 )
+    #error loggingASYNC_RING_LENGTH must be a power of 2
+#endif
+
+#if ( loggingASYNC_RECORD_LENGTH < 8 ) || ( loggingASYNC_RECORD_LENGTH > 0xffff )
+    #error loggingASYNC_RECORD_LENGTH is out of range
+#endif
+
+#ifndef configNUMBER_OF_CORES
+    #define configNUMBER_OF_CORES    1
+#endif
+
+#if ( configNUMBER_OF_CORES > 1 )
+    #define dlGET_RING()    ( &( xRings[ portGET_CORE_ID() ] ) )
+#else
+    #define dlGET_RING()    ( &( xRings[ 0 ] ) )
+#endif
+
+/* Space reserved in front of each record for the prefix added by the drain
+ * task. */
+#define dlPREFIX_LENGTH            32
+
+/* Values for the ucFlags member of a slot. */
+#define dlFLAG_FROM_ISR            ( ( uint8_t ) 0x01U )
+#define dlFLAG_TRUNCATED           ( ( uint8_t ) 0x02U )
+
+#define dlRING_INDEX_MASK          ( ( uint32_t ) ( loggingASYNC_RING_LENGTH - 1 ) )
+
+/*-----------------------------------------------------------*/
+
+typedef struct xLOG_SLOT
+{
+    uint32_t volatile ulSequence; /* Ownership of the slot, as described at the top of this file. */
+    TickType_t xTimeStamp;        /* Tick count when the record was begun. */
+    uint16_t usLength;            /* Number of characters in cData. */
+    uint8_t ucFlags;              /* dlFLAG_ values. */
+    char cData[ loggingASYNC_RECORD_LENGTH ];
+} LogSlot_t;
+
+typedef struct xLOG_RING
+{
+    uint32_t volatile ulHead;    /* Next position a producer will claim. */
+    uint32_t ulTail;             /* Next position the drain task will output.  Only accessed by the drain task. */
+    uint32_t volatile ulDropped; /* Records that were dropped because the ring was full. */
+    uint32_t ulDroppedReported;  /* Value of ulDropped when the drain task last reported it. */
+    LogSlot_t xSlots[ loggingASYNC_RING_LENGTH ];
+} LogRing_t;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Claim a slot in the calling core's ring.
+ */
+static BaseType_t prvBegin( LoggingAsyncRecord_t * pxRecord,
+                            TickType_t xTimeStamp,
+                            uint8_t ucFlags );
+
+/*
+ * Format into the slot held by pxRecord, truncating if necessary.
+ */
+static void prvAppend( LoggingAsyncRecord_t * pxRecord,
+                       const char * pcFormat,
+                       va_list xArgs );
+
+/*
+ * Publish the slot held by pxRecord.  Returns pdTRUE if the drain task is
+ * waiting for records and has to be notified.
+ */
+static BaseType_t prvCommit( LoggingAsyncRecord_t * pxRecord );
+
+/*
+ * Output every committed record in pxRing, followed by a note of any records
+ * that were dropped since the last time.  Returns the number of records output.
+ */
+static UBaseType_t prvDrainRing( LogRing_t * pxRing );
+
+/*
+ * Returns pdTRUE if any ring holds a committed record.
+ */
+static BaseType_t prvRecordsWaiting( void );
+
+/*
+ * The task that performs all the output.
+ */
+static void prvDrainTask( void * pvParameters );
+
+/*-----------------------------------------------------------*/
+
+static LogRing_t xRings[ configNUMBER_OF_CORES ];
+
+/* Set once the rings have been initialised and the drain task created. */
+static BaseType_t volatile xInitialised = pdFALSE;
+
+static TaskHandle_t xDrainTask = NULL;
+static LoggingAsyncOutput_t pxOutputFunction = NULL;
+
+/* Set to 1 by the drain task just before it blocks, and cleared by the first
+ * producer to notice, so only one notification is sent per wake up. */
+static uint32_t volatile ulDrainWaiting = 0U;
+
+/* Counters that are not kept per ring. */
+static uint32_t volatile ulTruncatedRecords = 0U;
+static uint32_t ulWrittenRecords = 0U;
+
+/* Numbers each record output, so gaps left by dropped records are visible. */
+static uint32_t ulRecordNumber = 0U;
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xLoggingAsyncInit( LoggingAsyncOutput_t pxOutput,
+                              UBaseType_t uxPriority,
+                              configSTACK_DEPTH_TYPE uxStackDepth )
+{
+    BaseType_t xReturn;
+    UBaseType_t uxRing, uxSlot;
+
+    configASSERT( pxOutput != NULL );
+    configASSERT( xInitialised == pdFALSE );
+
+    for( uxRing = 0; uxRing < ( UBaseType_t ) configNUMBER_OF_CORES; uxRing++ )
+    {
+        memset( &( xRings[ uxRing ] ), 0x00, sizeof( LogRing_t ) );
+
+        for( uxSlot = 0; uxSlot < ( UBaseType_t ) loggingASYNC_RING_LENGTH; uxSlot++ )
+        {
+            xRings[ uxRing ].xSlots[ uxSlot ].ulSequence = ( uint32_t ) uxSlot;
+        }
+    }
+
+    pxOutputFunction = pxOutput;
+
+    xReturn = xTaskCreate( prvDrainTask, "Logging", uxStackDepth, NULL, uxPriority, &xDrainTask );
+
+    if( xReturn == pdPASS )
+    {
+        xInitialised = pdTRUE;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvBegin( LoggingAsyncRecord_t * pxRecord,
+                            TickType_t xTimeStamp,
+                            uint8_t ucFlags )
+{
+    LogRing_t * pxRing;
+    LogSlot_t * pxSlot;
+    uint32_t ulPosition;
+    int32_t lDifference;
+
+    configASSERT( pxRecord != NULL );
+
+    pxRecord->pvSlot = NULL;
+    pxRecord->xLength = 0;
+
+    if( xInitialised != pdFALSE )
+    {
+        pxRing = dlGET_RING();
+
+        for( ; ; )
+        {
+            ulPosition = pxRing->ulHead;
+            pxSlot = &( pxRing->xSlots[ ulPosition & dlRING_INDEX_MASK ] );
+            lDifference = ( int32_t ) ( pxSlot->ulSequence - ulPosition );
+
+            if( lDifference == 0 )
+            {
+                /* The slot is free - try to claim it. */
+                if( Atomic_CompareAndSwap_u32( &( pxRing->ulHead ), ulPosition + 1U, ulPosition ) == ATOMIC_COMPARE_AND_SWAP_SUCCESS )
+                {
+                    pxSlot->xTimeStamp = xTimeStamp;
+                    pxSlot->ucFlags = ucFlags;
+                    pxSlot->cData[ 0 ] = '\0';
+                    pxRecord->pvSlot = pxSlot;
+                    break;
+                }
+            }
+            else if( lDifference < 0 )
+            {
+                /* The drain task has not output the record that was written
+                 * to this slot on the previous lap, so the ring is full. */
+                ( void ) Atomic_Increment_u32( &( pxRing->ulDropped ) );
+                break;
+            }
+            else
+            {
+                /* Another producer claimed the position first.  Try again. */
+            }
+        }
+    }
+
+    return ( pxRecord->pvSlot != NULL ) ? pdPASS : pdFAIL;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xLoggingAsyncBegin( LoggingAsyncRecord_t * pxRecord )
+{
+    return prvBegin( pxRecord, xTaskGetTickCount(), 0U );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xLoggingAsyncBeginFromISR( LoggingAsyncRecord_t * pxRecord )
+{
+    return prvBegin( pxRecord, xTaskGetTickCountFromISR(), dlFLAG_FROM_ISR );
+}
+/*-----------------------------------------------------------*/
+
+static void prvAppend( LoggingAsyncRecord_t * pxRecord,
+                       const char * pcFormat,
+                       va_list xArgs )
+{
+    LogSlot_t * pxSlot = ( LogSlot_t * ) pxRecord->pvSlot;
+    size_t xSpace;
+    int iLength;
+
+    if( pxSlot != NULL )
+    {
+        xSpace = sizeof( pxSlot->cData ) - pxRecord->xLength;
+        iLength = vsnprintf( &( pxSlot->cData[ pxRecord->xLength ] ), xSpace, pcFormat, xArgs );
+
+        if( iLength < 0 )
+        {
+            /* Encoding error.  Leave the record as it was. */
+            pxSlot->cData[ pxRecord->xLength ] = '\0';
+        }
+        else if( ( size_t ) iLength >= xSpace )
+        {
+            pxRecord->xLength = sizeof( pxSlot->cData ) - 1U;
+            pxSlot->ucFlags |= dlFLAG_TRUNCATED;
+        }
+        else
+        {
+            pxRecord->xLength += ( size_t ) iLength;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vLoggingAsyncAppend( LoggingAsyncRecord_t * pxRecord,
+                          const char * pcFormat,
+                          ... )
+{
+    va_list xArgs;
+
+    va_start( xArgs, pcFormat );
+    prvAppend( pxRecord, pcFormat, xArgs );
+    va_end( xArgs );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvCommit( LoggingAsyncRecord_t * pxRecord )
+{
+    LogSlot_t * pxSlot = ( LogSlot_t * ) pxRecord->pvSlot;
+    BaseType_t xWakeDrainTask = pdFALSE;
+
+    if( pxSlot != NULL )
+    {
+        if( ( pxSlot->ucFlags & dlFLAG_TRUNCATED ) != 0U )
+        {
+            /* Keep the output line based even though the end of the record
+             * was lost. */
+            pxSlot->cData[ pxRecord->xLength - 2U ] = '\r';
+            pxSlot->cData[ pxRecord->xLength - 1U ] = '\n';
+            ( void ) Atomic_Increment_u32( &ulTruncatedRecords );
+        }
+
+        pxSlot->usLength = ( uint16_t ) pxRecord->xLength;
+
+        /* Hand the slot to the drain task.  The sequence number moves from
+         * position to position + 1. */
+        ( void ) Atomic_Increment_u32( &( pxSlot->ulSequence ) );
+        pxRecord->pvSlot = NULL;
+
+        if( ( ulDrainWaiting != 0U ) &&
+            ( Atomic_CompareAndSwap_u32( &ulDrainWaiting, 0U, 1U ) == ATOMIC_COMPARE_AND_SWAP_SUCCESS ) )
+        {
+            xWakeDrainTask = pdTRUE;
+        }
+    }
+
+    return xWakeDrainTask;
+}
+/*-----------------------------------------------------------*/
+
+void vLoggingAsyncCommit( LoggingAsyncRecord_t * pxRecord )
+{
+    if( prvCommit( pxRecord ) != pdFALSE )
+    {
+        xTaskNotifyGive( xDrainTask );
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vLoggingAsyncCommitFromISR( LoggingAsyncRecord_t * pxRecord,
+                                 BaseType_t * pxHigherPriorityTaskWoken )
+{
+    if( prvCommit( pxRecord ) != pdFALSE )
+    {
+        vTaskNotifyGiveFromISR( xDrainTask, pxHigherPriorityTaskWoken );
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vLoggingPrintf( const char * pcFormat,
+                     ... )
+{
+    LoggingAsyncRecord_t xRecord;
+    va_list xArgs;
+
+    if( xLoggingAsyncBegin( &xRecord ) == pdPASS )
+    {
+        va_start( xArgs, pcFormat );
+        prvAppend( &xRecord, pcFormat, xArgs );
+        va_end( xArgs );
+
+        vLoggingAsyncCommit( &xRecord );
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vLoggingPrintfFromISR( BaseType_t * pxHigherPriorityTaskWoken,
+                            const char * pcFormat,
+                            ... )
+{
+    LoggingAsyncRecord_t xRecord;
+    va_list xArgs;
+
+    if( xLoggingAsyncBeginFromISR( &xRecord ) == pdPASS )
+    {
+        va_start( xArgs, pcFormat );
+        prvAppend( &xRecord, pcFormat, xArgs );
+        va_end( xArgs );
+
+        vLoggingAsyncCommitFromISR( &xRecord, pxHigherPriorityTaskWoken );
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vLoggingAsyncGetStats( LoggingAsyncStats_t * pxStats )
+{
+    UBaseType_t uxRing;
+
+    configASSERT( pxStats != NULL );
+
+    pxStats->ulWritten = ulWrittenRecords;
+    pxStats->ulTruncated = ulTruncatedRecords;
+    pxStats->ulDropped = 0U;
+
+    for( uxRing = 0; uxRing < ( UBaseType_t ) configNUMBER_OF_CORES; uxRing++ )
+    {
+        pxStats->ulDropped += xRings[ uxRing ].ulDropped;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static UBaseType_t prvDrainRing( LogRing_t * pxRing )
+{
+    char cOutput[ dlPREFIX_LENGTH + loggingASYNC_RECORD_LENGTH ];
+    LogSlot_t * pxSlot;
+    uint32_t ulSequence, ulDropped;
+    UBaseType_t uxOutput = 0;
+    int iLength;
+
+    for( ; ; )
+    {
+        pxSlot = &( pxRing->xSlots[ pxRing->ulTail & dlRING_INDEX_MASK ] );
+
+        /* Read the sequence number with an atomic operation so the reads of
+         * the record that follow cannot be reordered before it. */
+        ulSequence = Atomic_OR_u32( &( pxSlot->ulSequence ), 0U );
+
+        if( ulSequence != ( pxRing->ulTail + 1U ) )
+        {
+            /* Nothing more has been committed. */
+            break;
+        }
+
+        iLength = snprintf( cOutput, dlPREFIX_LENGTH, "%lu %lu %s",
+                            ( unsigned long ) ulRecordNumber++,
+                            ( unsigned long ) pxSlot->xTimeStamp,
+                            ( ( pxSlot->ucFlags & dlFLAG_FROM_ISR ) != 0U ) ? "[ISR] " : "" );
+
+        if( ( iLength < 0 ) || ( iLength >= dlPREFIX_LENGTH ) )
+        {
+            iLength = 0;
+        }
+
+        memcpy( &( cOutput[ iLength ] ), pxSlot->cData, pxSlot->usLength );
+        pxOutputFunction( cOutput, ( size_t ) iLength + pxSlot->usLength );
+
+        /* Return the slot to the producers for the next lap of the ring. */
+        ( void ) Atomic_Add_u32( &( pxSlot->ulSequence ), ( uint32_t ) ( loggingASYNC_RING_LENGTH - 1 ) );
+        pxRing->ulTail++;
+        ulWrittenRecords++;
+        uxOutput++;
+    }
+
+    ulDropped = pxRing->ulDropped;
+
+    if( ulDropped != pxRing->ulDroppedReported )
+    {
+        iLength = snprintf( cOutput, sizeof( cOutput ), "%lu %lu [LOG] %lu records dropped\r\n",
+                            ( unsigned long ) ulRecordNumber++,
+                            ( unsigned long ) xTaskGetTickCount(),
+                            ( unsigned long ) ( ulDropped - pxRing->ulDroppedReported ) );
+
+        if( ( iLength > 0 ) && ( ( size_t ) iLength < sizeof( cOutput ) ) )
+        {
+            pxOutputFunction( cOutput, ( size_t ) iLength );
+        }
+
+        pxRing->ulDroppedReported = ulDropped;
+    }
+
+    return uxOutput;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvRecordsWaiting( void )
+{
+    BaseType_t xReturn = pdFALSE;
+    UBaseType_t uxRing;
+    LogRing_t * pxRing;
+
+    for( uxRing = 0; uxRing < ( UBaseType_t ) configNUMBER_OF_CORES; uxRing++ )
+    {
+        pxRing = &( xRings[ uxRing ] );
+
+        if( Atomic_OR_u32( &( pxRing->xSlots[ pxRing->ulTail & dlRING_INDEX_MASK ].ulSequence ), 0U ) == ( pxRing->ulTail + 1U ) )
+        {
+            xReturn = pdTRUE;
+            break;
+        }
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvDrainTask( void * pvParameters )
+{
+    UBaseType_t uxRing, uxOutput;
+
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        uxOutput = 0;
+
+        for( uxRing = 0; uxRing < ( UBaseType_t ) configNUMBER_OF_CORES; uxRing++ )
+        {
+            uxOutput += prvDrainRing( &( xRings[ uxRing ] ) );
+        }
+
+        if( uxOutput == 0 )
+        {
+            /* Ask the next producer to wake this task, then look again in case
+             * a record was committed before the flag was set.  A notification
+             * sent after the check is not lost, it just makes the take below
+             * return immediately. */
+            ulDrainWaiting = 1U;
+
+            if( prvRecordsWaiting() == pdFALSE )
+            {
+                ( void ) ulTaskNotifyTake( pdTRUE, pdMS_TO_TICKS( loggingASYNC_DRAIN_PERIOD_MS ) );
+            }
+
+            ulDrainWaiting = 0U;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,186 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Asynchronous logging backend.
+ *
+ * Log records are written into a lock free ring buffer (one per core) by the
+ * logging task, then written out by a single low priority drain task.  The
+ * task that logs never blocks and never waits for the output device: if the
+ * ring buffer is full the record is dropped and counted, and the drain task
+ * reports how many records were lost the next time it runs.
+ *
+ * Each record is reserved, filled and committed as a unit, so records from
+ * different tasks (or interrupts) never interleave in the output.  This header
+ * makes the LogError(), LogInfo(), etc. macros of logging_stack.h produce one
+ * record per call instead of three vLoggingPrintf() calls, so must be included
+ * before logging_stack.h in every file that logs.  The simplest way to do that
+ * is to have the compiler include it first in every file, as the Posix TCP echo
+ * demo does with "-include logging_async.h".  Including it after
+ * logging_stack.h is an error.
+ *
+ * The message itself is still formatted by the task that logs it, directly
+ * into the ring buffer.  The drain task adds the record number and time stamp
+ * and performs all the output.
+ */
+
+#ifndef LOGGING_ASYNC_H
+#define LOGGING_ASYNC_H
+
+/* Standard includes. */
+#include <stddef.h>
+#include <stdint.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/*-----------------------------------------------------------*/
+
+/* The number of records each ring buffer can hold.  Must be a power of 2. */
+#ifndef loggingASYNC_RING_LENGTH
+    #define loggingASYNC_RING_LENGTH      64
+#endif
+
+/* The maximum length of one record, including the line terminator.  Longer
+ * records are truncated. */
+#ifndef loggingASYNC_RECORD_LENGTH
+    #define loggingASYNC_RECORD_LENGTH    128
+#endif
+
+/* The longest time, in milliseconds, the drain task sleeps when no task has
+ * woken it. */
+#ifndef loggingASYNC_DRAIN_PERIOD_MS
+    #define loggingASYNC_DRAIN_PERIOD_MS    100
+#endif
+
+/*-----------------------------------------------------------*/
+
+/*
+ * The function the drain task calls to output a complete record.  It is only
+ * ever called from the drain task so does not need to be thread safe.
+ */
+typedef void ( * LoggingAsyncOutput_t )( const char * pcRecord,
+                                         size_t xLength );
+
+/*
+ * A record that is being built.  Obtained from xLoggingAsyncBegin(), filled by
+ * vLoggingAsyncAppend() and published by vLoggingAsyncCommit().
+ */
+typedef struct xLOGGING_ASYNC_RECORD
+{
+    void * pvSlot;  /* The reserved ring buffer slot, NULL if the record was dropped. */
+    size_t xLength; /* The number of characters written to the slot so far. */
+} LoggingAsyncRecord_t;
+
+/*
+ * Counters maintained by the logging backend.
+ */
+typedef struct xLOGGING_ASYNC_STATS
+{
+    uint32_t ulWritten;   /* Records passed to the output function. */
+    uint32_t ulDropped;   /* Records lost because a ring buffer was full. */
+    uint32_t ulTruncated; /* Records cut short at loggingASYNC_RECORD_LENGTH. */
+} LoggingAsyncStats_t;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Create the drain task that passes committed records to pxOutput.  Can be
+ * called before or after the scheduler has started.  Records committed before
+ * the drain task first runs are kept in the ring buffers until it does.
+ */
+BaseType_t xLoggingAsyncInit( LoggingAsyncOutput_t pxOutput,
+                              UBaseType_t uxPriority,
+                              configSTACK_DEPTH_TYPE uxStackDepth );
+
+/*
+ * Reserve a ring buffer slot for a new record.  Returns pdFAIL, and counts a
+ * dropped record, if the ring buffer is full.  Never blocks.  The FromISR
+ * version must be used from interrupts.
+ */
+BaseType_t xLoggingAsyncBegin( LoggingAsyncRecord_t * pxRecord );
+BaseType_t xLoggingAsyncBeginFromISR( LoggingAsyncRecord_t * pxRecord );
+
+/*
+ * Append formatted text to a record obtained from xLoggingAsyncBegin() or
+ * xLoggingAsyncBeginFromISR().
+ */
+void vLoggingAsyncAppend( LoggingAsyncRecord_t * pxRecord,
+                          const char * pcFormat,
+                          ... );
+
+/*
+ * Publish a record to the drain task.  Every successfully begun record must be
+ * committed, otherwise the drain task cannot get past it.  The FromISR version
+ * must be used for records begun with xLoggingAsyncBeginFromISR().
+ */
+void vLoggingAsyncCommit( LoggingAsyncRecord_t * pxRecord );
+void vLoggingAsyncCommitFromISR( LoggingAsyncRecord_t * pxRecord,
+                                 BaseType_t * pxHigherPriorityTaskWoken );
+
+/*
+ * printf() style logging where each call produces one record.  Drop-in
+ * replacements for the vLoggingPrintf() implemented by the other demo logging
+ * backends.
+ */
+void vLoggingPrintf( const char * pcFormat,
+                     ... );
+void vLoggingPrintfFromISR( BaseType_t * pxHigherPriorityTaskWoken,
+                            const char * pcFormat,
+                            ... );
+
+/*
+ * Obtain a snapshot of the backend counters.
+ */
+void vLoggingAsyncGetStats( LoggingAsyncStats_t * pxStats );
+
+/*-----------------------------------------------------------*/
+
+/* Used by SdkLogRecord() to remove the parentheses from around the message
+ * arguments so they can be passed on to vLoggingAsyncAppend(). */
+#define loggingASYNC_STRIP_PARENTHESES( ... )    __VA_ARGS__
+
+/* Make each of the logging_stack.h macros write a single record.  That is only
+ * possible if logging_stack.h has not been included yet. */
+#ifdef LOGGING_STACK_H
+    #error logging_async.h must be included before logging_stack.h
+#endif
+
+#ifndef SdkLogRecord
+    #define SdkLogRecord( level, message )                                                                                       \
+    do {                                                                                                                         \
+        LoggingAsyncRecord_t xLogRecord;                                                                                         \
+        if( xLoggingAsyncBegin( &xLogRecord ) == pdPASS )                                                                        \
+        {                                                                                                                        \
+            vLoggingAsyncAppend( &xLogRecord, level " [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS );          \
+            vLoggingAsyncAppend( &xLogRecord, loggingASYNC_STRIP_PARENTHESES message );                                          \
+            vLoggingAsyncAppend( &xLogRecord, "\r\n" );                                                                          \
+            vLoggingAsyncCommit( &xLogRecord );                                                                                  \
+        }                                                                                                                        \
+    } while( 0 )
+#endif
+
+#endif /* LOGGING_ASYNC_H */
@@ -0,0 +1,501 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Binary, deferred formatting logging backend - see logging_binary.h.
+ *
+ * The format string is only scanned to find out how many arguments there are
+ * and how large each is.  No digits are generated and no metadata is
+ * formatted, that is all left to the host side decoder.
+ */
+
+/* Standard includes. */
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "atomic.h"
+
+/* Demo includes. */
+#include "logging_binary.h"
+
+/*-----------------------------------------------------------*/
+
+/* Size of the fixed part of a record: payload length, site ID and tick
+ * count. */
+#define dlRECORD_HEADER_LENGTH    10U
+
+#if ( loggingBINARY_MAX_STRING_LENGTH > 255 )
+    #error loggingBINARY_MAX_STRING_LENGTH cannot be more than 255
+#endif
+
+#if ( loggingBINARY_RECORD_LENGTH < dlRECORD_HEADER_LENGTH ) || ( loggingBINARY_RECORD_LENGTH > 0xffff )
+    #error loggingBINARY_RECORD_LENGTH is out of range
+#endif
+
+/* Argument sizes used by the stream - see logging_binary.h. */
+#define dlNARROW_ARGUMENT         4U
+#define dlWIDE_ARGUMENT           8U
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Tracks how much of the record buffer has been used.  xLength is set beyond
+ * xSpace once something has failed to fit, after which nothing more is
+ * written.
+ */
+typedef struct xRECORD_WRITER
+{
+    uint8_t * pucBuffer;
+    size_t xSpace;
+    size_t xLength;
+} RecordWriter_t;
+
+/* The length modifiers that change the type of an argument.  hh and h do not,
+ * as those arguments are promoted to int. */
+typedef enum
+{
+    eLengthDefault,
+    eLengthLong,       /* l */
+    eLengthLongLong,   /* ll */
+    eLengthIntMax,     /* j */
+    eLengthSize,       /* z */
+    eLengthPtrDiff,    /* t */
+    eLengthLongDouble  /* L */
+} LengthModifier_t;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Append ullValue to the record as uxBytes little endian bytes.
+ */
+static void prvWriteUnsigned( RecordWriter_t * pxWriter,
+                              uint64_t ullValue,
+                              size_t uxBytes );
+
+/*
+ * Append a length prefixed string to the record, truncated to at most
+ * xMaxLength characters.
+ */
+static void prvWriteString( RecordWriter_t * pxWriter,
+                            const char * pcString,
+                            size_t xMaxLength );
+
+/*
+ * Walk pcFormat and append each argument it consumes from xArgs.
+ */
+static void prvWriteArguments( RecordWriter_t * pxWriter,
+                               const char * pcFormat,
+                               va_list xArgs );
+
+/*-----------------------------------------------------------*/
+
+/* Provided by the linker for the section holding the call site strings. */
+extern const char __start_log_binary_sites[];
+
+static LoggingBinaryOutput_t pxOutputFunction = NULL;
+
+static uint32_t volatile ulWrittenRecords = 0U;
+static uint32_t volatile ulDroppedRecords = 0U;
+
+/*-----------------------------------------------------------*/
+
+void vLoggingBinaryInit( LoggingBinaryOutput_t pxOutput )
+{
+    uint8_t ucHeader[ 9 ];
+    RecordWriter_t xWriter = { ucHeader, sizeof( ucHeader ), 0 };
+
+    configASSERT( pxOutput != NULL );
+
+    memcpy( ucHeader, "FRLB", 4 );
+    xWriter.xLength = 4;
+    prvWriteUnsigned( &xWriter, loggingBINARY_STREAM_VERSION, 1 );
+    prvWriteUnsigned( &xWriter, configTICK_RATE_HZ, dlNARROW_ARGUMENT );
+
+    pxOutput( ucHeader, xWriter.xLength );
+    pxOutputFunction = pxOutput;
+}
+/*-----------------------------------------------------------*/
+
+static void prvWriteUnsigned( RecordWriter_t * pxWriter,
+                              uint64_t ullValue,
+                              size_t uxBytes )
+{
+    size_t uxByte;
+
+    if( ( pxWriter->xLength + uxBytes ) <= pxWriter->xSpace )
+    {
+        for( uxByte = 0; uxByte < uxBytes; uxByte++ )
+        {
+            pxWriter->pucBuffer[ pxWriter->xLength++ ] = ( uint8_t ) ( ullValue >> ( 8U * uxByte ) );
+        }
+    }
+    else
+    {
+        pxWriter->xLength = pxWriter->xSpace + 1U;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvWriteString( RecordWriter_t * pxWriter,
+                            const char * pcString,
+                            size_t xMaxLength )
+{
+    size_t xLength = 0;
+
+    if( pcString == NULL )
+    {
+        pcString = "(null)";
+    }
+
+    if( xMaxLength > loggingBINARY_MAX_STRING_LENGTH )
+    {
+        xMaxLength = loggingBINARY_MAX_STRING_LENGTH;
+    }
+
+    /* The string need not be terminated if a precision limits its length, so
+     * do not read beyond xMaxLength characters. */
+    while( ( xLength < xMaxLength ) && ( pcString[ xLength ] != '\0' ) )
+    {
+        xLength++;
+    }
+
+    /* Truncate the string further rather than drop the whole record if it is
+     * the string that does not fit. */
+    if( ( pxWriter->xLength + 1U + xLength ) > pxWriter->xSpace )
+    {
+        xLength = ( pxWriter->xLength < pxWriter->xSpace ) ? ( pxWriter->xSpace - pxWriter->xLength - 1U ) : 0U;
+    }
+
+    prvWriteUnsigned( pxWriter, xLength, 1 );
+
+    if( pxWriter->xLength <= pxWriter->xSpace )
+    {
+        memcpy( &( pxWriter->pucBuffer[ pxWriter->xLength ] ), pcString, xLength );
+        pxWriter->xLength += xLength;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvWriteArguments( RecordWriter_t * pxWriter,
+                               const char * pcFormat,
+                               va_list xArgs )
+{
+    LengthModifier_t eLength;
+    size_t xPrecision;
+    int32_t lValue;
+    double dValue;
+    uint64_t ullBits;
+
+    while( *pcFormat != '\0' )
+    {
+        if( *pcFormat++ != '%' )
+        {
+            continue;
+        }
+
+        /* Flags. */
+        while( ( *pcFormat == '-' ) || ( *pcFormat == '+' ) || ( *pcFormat == ' ' ) ||
+               ( *pcFormat == '#' ) || ( *pcFormat == '0' ) )
+        {
+            pcFormat++;
+        }
+
+        /* Field width. */
+        if( *pcFormat == '*' )
+        {
+            prvWriteUnsigned( pxWriter, ( uint32_t ) va_arg( xArgs, int ), dlNARROW_ARGUMENT );
+            pcFormat++;
+        }
+        else
+        {
+            while( ( *pcFormat >= '0' ) && ( *pcFormat <= '9' ) )
+            {
+                pcFormat++;
+            }
+        }
+
+        /* Precision, which is only needed here to limit %s arguments. */
+        xPrecision = loggingBINARY_MAX_STRING_LENGTH;
+
+        if( *pcFormat == '.' )
+        {
+            pcFormat++;
+
+            if( *pcFormat == '*' )
+            {
+                lValue = ( int32_t ) va_arg( xArgs, int );
+                prvWriteUnsigned( pxWriter, ( uint32_t ) lValue, dlNARROW_ARGUMENT );
+                pcFormat++;
+
+                /* A negative precision is taken as if it were omitted. */
+                if( ( lValue >= 0 ) && ( ( size_t ) lValue < xPrecision ) )
+                {
+                    xPrecision = ( size_t ) lValue;
+                }
+            }
+            else
+            {
+                xPrecision = 0;
+
+                while( ( *pcFormat >= '0' ) && ( *pcFormat <= '9' ) )
+                {
+                    if( xPrecision < loggingBINARY_MAX_STRING_LENGTH )
+                    {
+                        xPrecision = ( xPrecision * 10U ) + ( size_t ) ( *pcFormat - '0' );
+                    }
+
+                    pcFormat++;
+                }
+            }
+        }
+
+        /* Length modifier. */
+        eLength = eLengthDefault;
+
+        switch( *pcFormat )
+        {
+            case 'h':
+                pcFormat += ( pcFormat[ 1 ] == 'h' ) ? 2 : 1;
+                break;
+
+            case 'l':
+
+                if( pcFormat[ 1 ] == 'l' )
+                {
+                    eLength = eLengthLongLong;
+                    pcFormat++;
+                }
+                else
+                {
+                    eLength = eLengthLong;
+                }
+
+                pcFormat++;
+                break;
+
+            case 'j':
+                eLength = eLengthIntMax;
+                pcFormat++;
+                break;
+
+            case 'z':
+                eLength = eLengthSize;
+                pcFormat++;
+                break;
+
+            case 't':
+                eLength = eLengthPtrDiff;
+                pcFormat++;
+                break;
+
+            case 'L':
+                pcFormat++;
+                eLength = eLengthLongDouble;
+                break;
+
+            default:
+                break;
+        }
+
+        /* Conversion.  Each argument has to be read as the type it was passed
+         * as.  Integers that may be wider than 32 bits are then written as 64
+         * bits, so the decoder does not need to know the size of long, etc. on
+         * the target. */
+        switch( *pcFormat )
+        {
+            case 'd':
+            case 'i':
+
+                switch( eLength )
+                {
+                    case eLengthLong:
+                        prvWriteUnsigned( pxWriter, ( uint64_t ) ( int64_t ) va_arg( xArgs, long ), dlWIDE_ARGUMENT );
+                        break;
+
+                    case eLengthLongLong:
+                        prvWriteUnsigned( pxWriter, ( uint64_t ) ( int64_t ) va_arg( xArgs, long long ), dlWIDE_ARGUMENT );
+                        break;
+
+                    case eLengthIntMax:
+                        prvWriteUnsigned( pxWriter, ( uint64_t ) ( int64_t ) va_arg( xArgs, intmax_t ), dlWIDE_ARGUMENT );
+                        break;
+
+                    case eLengthSize:
+                        prvWriteUnsigned( pxWriter, ( uint64_t ) va_arg( xArgs, size_t ), dlWIDE_ARGUMENT );
+                        break;
+
+                    case eLengthPtrDiff:
+                        prvWriteUnsigned( pxWriter, ( uint64_t ) ( int64_t ) va_arg( xArgs, ptrdiff_t ), dlWIDE_ARGUMENT );
+                        break;
+
+                    default:
+                        prvWriteUnsigned( pxWriter, ( uint32_t ) va_arg( xArgs, int ), dlNARROW_ARGUMENT );
+                        break;
+                }
+
+                break;
+
+            case 'o':
+            case 'u':
+            case 'x':
+            case 'X':
+
+                switch( eLength )
+                {
+                    case eLengthLong:
+                        prvWriteUnsigned( pxWriter, ( uint64_t ) va_arg( xArgs, unsigned long ), dlWIDE_ARGUMENT );
+                        break;
+
+                    case eLengthLongLong:
+                        prvWriteUnsigned( pxWriter, ( uint64_t ) va_arg( xArgs, unsigned long long ), dlWIDE_ARGUMENT );
+                        break;
+
+                    case eLengthIntMax:
+                        prvWriteUnsigned( pxWriter, ( uint64_t ) va_arg( xArgs, uintmax_t ), dlWIDE_ARGUMENT );
+                        break;
+
+                    case eLengthSize:
+                        prvWriteUnsigned( pxWriter, ( uint64_t ) va_arg( xArgs, size_t ), dlWIDE_ARGUMENT );
+                        break;
+
+                    case eLengthPtrDiff:
+                        prvWriteUnsigned( pxWriter, ( uint64_t ) ( int64_t ) va_arg( xArgs, ptrdiff_t ), dlWIDE_ARGUMENT );
+                        break;
+
+                    default:
+                        prvWriteUnsigned( pxWriter, ( uint32_t ) va_arg( xArgs, unsigned int ), dlNARROW_ARGUMENT );
+                        break;
+                }
+
+                break;
+
+            case 'c':
+                prvWriteUnsigned( pxWriter, ( uint32_t ) va_arg( xArgs, int ), dlNARROW_ARGUMENT );
+                break;
+
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+
+                if( eLength == eLengthLongDouble )
+                {
+                    dValue = ( double ) va_arg( xArgs, long double );
+                }
+                else
+                {
+                    dValue = va_arg( xArgs, double );
+                }
+
+                memcpy( &ullBits, &dValue, sizeof( ullBits ) );
+                prvWriteUnsigned( pxWriter, ullBits, dlWIDE_ARGUMENT );
+                break;
+
+            case 's':
+                prvWriteString( pxWriter, va_arg( xArgs, const char * ), xPrecision );
+                break;
+
+            case 'p':
+                prvWriteUnsigned( pxWriter, ( uint64_t ) ( uintptr_t ) va_arg( xArgs, void * ), dlWIDE_ARGUMENT );
+                break;
+
+            case 'n':
+                /* Nothing is printed on the target, so there is no count to
+                 * store.  Just consume the argument. */
+                ( void ) va_arg( xArgs, void * );
+                break;
+
+            case '\0':
+                /* A stray % at the end of the format. */
+                pcFormat--;
+                break;
+
+            default:
+                /* %% or an unknown conversion, neither of which consumes an
+                 * argument. */
+                break;
+        }
+
+        pcFormat++;
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vLoggingBinaryWrite( const char * pcSite,
+                          const char * pcFormat,
+                          ... )
+{
+    uint8_t ucRecord[ loggingBINARY_RECORD_LENGTH ];
+    RecordWriter_t xWriter = { ucRecord, sizeof( ucRecord ), 0 };
+    va_list xArgs;
+    TickType_t xTickCount;
+
+    if( pxOutputFunction != NULL )
+    {
+        xTickCount = ( xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED ) ? 0 : xTaskGetTickCount();
+
+        /* The payload length is filled in once it is known. */
+        xWriter.xLength = 2;
+        prvWriteUnsigned( &xWriter, ( uint32_t ) ( pcSite - __start_log_binary_sites ), dlNARROW_ARGUMENT );
+        prvWriteUnsigned( &xWriter, ( uint32_t ) xTickCount, dlNARROW_ARGUMENT );
+
+        va_start( xArgs, pcFormat );
+        prvWriteArguments( &xWriter, pcFormat, xArgs );
+        va_end( xArgs );
+
+        if( xWriter.xLength <= xWriter.xSpace )
+        {
+            ucRecord[ 0 ] = ( uint8_t ) ( xWriter.xLength - 2U );
+            ucRecord[ 1 ] = ( uint8_t ) ( ( xWriter.xLength - 2U ) >> 8 );
+
+            pxOutputFunction( ucRecord, xWriter.xLength );
+            ( void ) Atomic_Increment_u32( &ulWrittenRecords );
+        }
+        else
+        {
+            ( void ) Atomic_Increment_u32( &ulDroppedRecords );
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vLoggingBinaryGetStats( LoggingBinaryStats_t * pxStats )
+{
+    configASSERT( pxStats != NULL );
+
+    pxStats->ulWritten = ulWrittenRecords;
+    pxStats->ulDropped = ulDroppedRecords;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,218 @@
+#!/usr/bin/env python3
+"""
+Decode a log stream written by Logging_Binary.c back into text.
+
+The call site strings that the stream refers to are read from the
+log_binary_sites section of the ELF file that wrote the stream, so the ELF
+file must be from exactly the same build.  See logging_binary.h for the stream
+layout.
+
+Usage:
+    decode_binary_log.py <elf file> <binary log file>
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+SECTION_NAME = "log_binary_sites"
+STREAM_MAGIC = b"FRLB"
+STREAM_VERSION = 1
+
+# Matches one printf() conversion specification, in the same way the encoder
+# scans it.
+CONVERSION = re.compile(
+    r"%(?P<flags>[-+ #0]*)(?P<width>\*|\d*)(?:\.(?P<precision>\*|\d*))?"
+    r"(?P<length>hh|h|ll|l|j|z|t|L)?(?P<conversion>.?)",
+    re.DOTALL,
+)
+
+
+def read_section(elf_path, section_name):
+    """Return the contents of the named section of an ELF file."""
+    with open(elf_path, "rb") as elf_file:
+        elf = elf_file.read()
+
+    if elf[:4] != b"\x7fELF":
+        raise ValueError(f"{elf_path} is not an ELF file")
+
+    is_64_bit = elf[4] == 2
+    endian = "<" if elf[5] == 1 else ">"
+
+    if is_64_bit:
+        (section_offset,) = struct.unpack_from(endian + "Q", elf, 0x28)
+        entry_size, entry_count, names_index = struct.unpack_from(endian + "HHH", elf, 0x3A)
+        header = endian + "IIQQQQIIQQ"
+    else:
+        (section_offset,) = struct.unpack_from(endian + "I", elf, 0x20)
+        entry_size, entry_count, names_index = struct.unpack_from(endian + "HHH", elf, 0x2E)
+        header = endian + "IIIIIIIIII"
+
+    sections = [
+        struct.unpack_from(header, elf, section_offset + (index * entry_size))
+        for index in range(entry_count)
+    ]
+
+    # Fields used: 0 name offset, 4 file offset, 5 size.
+    names_offset = sections[names_index][4]
+
+    for section in sections:
+        name_start = names_offset + section[0]
+        name = elf[name_start : elf.index(b"\0", name_start)].decode()
+
+        if name == section_name:
+            return elf[section[4] : section[4] + section[5]]
+
+    raise ValueError(f"{elf_path} has no {section_name} section - was it built with logging_binary.h?")
+
+
+class RecordReader:
+    """Reads the little endian argument values out of one record."""
+
+    def __init__(self, payload):
+        self.payload = payload
+        self.offset = 0
+
+    def take(self, length):
+        if self.offset + length > len(self.payload):
+            raise ValueError("record is shorter than its format requires")
+
+        data = self.payload[self.offset : self.offset + length]
+        self.offset += length
+        return data
+
+    def int32(self):
+        return struct.unpack("<i", self.take(4))[0]
+
+    def uint32(self):
+        return struct.unpack("<I", self.take(4))[0]
+
+    def int64(self):
+        return struct.unpack("<q", self.take(8))[0]
+
+    def uint64(self):
+        return struct.unpack("<Q", self.take(8))[0]
+
+    def double(self):
+        return struct.unpack("<d", self.take(8))[0]
+
+    def string(self):
+        length = self.take(1)[0]
+        return self.take(length).decode("utf-8", errors="replace")
+
+
+def format_message(message_format, reader):
+    """Replay message_format with the arguments stored in the record."""
+
+    def convert(match):
+        flags = match.group("flags")
+        width = match.group("width")
+        precision = match.group("precision")
+        length = match.group("length") or ""
+        conversion = match.group("conversion")
+        wide = length in ("l", "ll", "j", "z", "t")
+
+        if conversion in ("%", ""):
+            return "%" if conversion == "%" else ""
+
+        if width == "*":
+            width = str(reader.int32())
+
+        if precision == "*":
+            value = reader.int32()
+            precision = str(value) if value >= 0 else None
+
+        spec = "%" + flags + (width or "") + ("." + precision if precision is not None else "")
+
+        if conversion in "di":
+            return (spec + "d") % (reader.int64() if wide else reader.int32())
+
+        if conversion in "ouxX":
+            value = reader.uint64() if wide else reader.uint32()
+            return (spec + conversion.replace("u", "d")) % value
+
+        if conversion == "c":
+            return (spec + "c") % chr(reader.int32() & 0xFF)
+
+        if conversion in "fFeEgG":
+            return (spec + conversion) % reader.double()
+
+        if conversion in "aA":
+            text = float.hex(reader.double())
+            return (spec + "s") % (text.upper() if conversion == "A" else text)
+
+        if conversion == "s":
+            return (spec + "s") % reader.string()
+
+        if conversion == "p":
+            return (spec + "s") % hex(reader.uint64())
+
+        if conversion == "n":
+            return ""
+
+        # Unknown conversions consume nothing, as in the encoder.
+        return match.group(0)
+
+    return CONVERSION.sub(convert, message_format)
+
+
+def decode(sites, stream, output):
+    """Write the text of every record in stream to output."""
+    if stream[:4] != STREAM_MAGIC:
+        raise ValueError("not a binary log stream")
+
+    version = stream[4]
+
+    if version != STREAM_VERSION:
+        raise ValueError(f"unsupported stream version {version}")
+
+    (tick_rate,) = struct.unpack_from("<I", stream, 5)
+    offset = 9
+    record_number = 0
+
+    while offset + 2 <= len(stream):
+        (payload_length,) = struct.unpack_from("<H", stream, offset)
+        payload = stream[offset + 2 : offset + 2 + payload_length]
+        offset += 2 + payload_length
+
+        if len(payload) < payload_length:
+            output.write(f"{record_number} truncated record at end of stream\n")
+            break
+
+        site_id, ticks = struct.unpack_from("<II", payload, 0)
+
+        if site_id >= len(sites):
+            output.write(f"{record_number} {ticks} unknown site {site_id} - wrong ELF file?\n")
+        else:
+            fields = sites[site_id:].split(b"\0", 4)
+            level, library, file_name, line = (field.decode() for field in fields[:4])
+            message_format = fields[4].split(b"\0", 1)[0].decode()
+
+            try:
+                message = format_message(message_format, RecordReader(payload[8:]))
+            except (ValueError, struct.error) as error:
+                message = f"<{error}: {message_format!r}>"
+
+            milliseconds = (ticks * 1000) // tick_rate if tick_rate else ticks
+            output.write(f"{record_number} {milliseconds} {level} [{library}] [{file_name}:{line}] {message}\n")
+
+        record_number += 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode a FreeRTOS binary log stream.")
+    parser.add_argument("elf", help="ELF file of the build that wrote the log")
+    parser.add_argument("log", help="binary log stream")
+    args = parser.parse_args()
+
+    sites = read_section(args.elf, SECTION_NAME)
+
+    with open(args.log, "rb") as log_file:
+        stream = log_file.read()
+
+    decode(sites, stream, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
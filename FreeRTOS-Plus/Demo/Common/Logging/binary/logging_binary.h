@@ -0,0 +1,169 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Binary, deferred formatting logging backend.
+ *
+ * Include this header before logging_stack.h to make the LogError(),
+ * LogInfo(), etc. macros write compact binary records instead of formatted
+ * text:
+ *
+ *     #include "logging_levels.h"
+ *     #define LIBRARY_LOG_NAME     "MyDemo"
+ *     #define LIBRARY_LOG_LEVEL    LOG_INFO
+ *     #include "logging_binary.h"
+ *     #include "logging_stack.h"
+ *
+ * Each logging call site places a constant string holding the level, library
+ * name, source file, line number and message format in the log_binary_sites
+ * linker section.  At run time only the offset of that string within the
+ * section (the site ID), the tick count and the raw argument values are
+ * written - nothing is formatted on the target.  decode_binary_log.py turns
+ * the binary stream back into text using the same section read from the ELF
+ * file of the logging build, so the stream can only be decoded against the
+ * image that produced it.
+ *
+ * As the metadata is fixed at compile time, records are tagged with the file
+ * and line of the call site rather than LOG_METADATA_FORMAT.  The message
+ * format passed to a LogXxx() macro must be a string literal.  Requires a GCC
+ * compatible compiler and a linker that provides __start_ and __stop_ symbols
+ * for named sections (GNU ld and LLVM lld both do).
+ *
+ * Stream layout, all multi-byte values little endian:
+ *
+ *     Header:  "FRLB", version (1 byte), tick rate in Hz (4 bytes).
+ *     Record:  payload length (2 bytes), site ID (4 bytes), tick count
+ *              (4 bytes), then one entry per argument consumed by the format:
+ *              - int, unsigned and char conversions: 4 bytes.
+ *              - l, ll, j, z and t integer conversions and %p: 8 bytes.
+ *              - Floating point conversions: 8 byte IEEE 754 double.
+ *              - %s: length (1 byte) followed by that many characters.
+ *              - * field widths and precisions: 4 bytes.
+ */
+
+#ifndef LOGGING_BINARY_H
+#define LOGGING_BINARY_H
+
+/* Standard includes. */
+#include <stddef.h>
+#include <stdint.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+#if !defined( __GNUC__ )
+    #error logging_binary.h requires a GCC compatible compiler.
+#endif
+
+/*-----------------------------------------------------------*/
+
+/* The largest record, including its length field, that can be written.
+ * Records that do not fit are dropped and counted. */
+#ifndef loggingBINARY_RECORD_LENGTH
+    #define loggingBINARY_RECORD_LENGTH    128
+#endif
+
+/* The longest string argument that is copied into a record.  Longer strings
+ * are truncated.  Cannot be more than 255. */
+#ifndef loggingBINARY_MAX_STRING_LENGTH
+    #define loggingBINARY_MAX_STRING_LENGTH    48
+#endif
+
+/* The version written to the stream header, checked by the decoder. */
+#define loggingBINARY_STREAM_VERSION    1
+
+/*-----------------------------------------------------------*/
+
+/*
+ * The function called to write the stream header and each complete record.
+ * Called from the task that logs, so must be thread safe if more than one task
+ * logs.
+ */
+typedef void ( * LoggingBinaryOutput_t )( const uint8_t * pucData,
+                                          size_t xLength );
+
+/*
+ * Counters maintained by the binary logging backend.
+ */
+typedef struct xLOGGING_BINARY_STATS
+{
+    uint32_t ulWritten; /* Records passed to the output function. */
+    uint32_t ulDropped; /* Records that did not fit in loggingBINARY_RECORD_LENGTH. */
+} LoggingBinaryStats_t;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Set the output function and write the stream header through it.  Records
+ * logged before this is called are discarded.
+ */
+void vLoggingBinaryInit( LoggingBinaryOutput_t pxOutput );
+
+/*
+ * Encode one record.  pcSite is the call site string placed in the
+ * log_binary_sites section by SdkLogRecord(), and pcFormat the message format
+ * it contains.  Not normally called directly.
+ */
+void vLoggingBinaryWrite( const char * pcSite,
+                          const char * pcFormat,
+                          ... );
+
+/*
+ * Obtain a snapshot of the backend counters.
+ */
+void vLoggingBinaryGetStats( LoggingBinaryStats_t * pxStats );
+
+/*-----------------------------------------------------------*/
+
+#define loggingBINARY_STRINGIFY_( x )                  #x
+#define loggingBINARY_STRINGIFY( x )                   loggingBINARY_STRINGIFY_( x )
+
+/* Remove the parentheses from around the message arguments. */
+#define loggingBINARY_STRIP_PARENTHESES( ... )         __VA_ARGS__
+
+/* Extract the format, which is the first of the message arguments.  The
+ * extra argument keeps the variadic part of the inner macro non-empty. */
+#define loggingBINARY_FORMAT( ... )                    loggingBINARY_FORMAT_( __VA_ARGS__, 0 )
+#define loggingBINARY_FORMAT_( pcFormat, ... )         pcFormat
+
+/* The fields of the call site string, which are separated by NUL characters.
+ * The format comes last so the string terminator ends it.  Must match the
+ * decoder. */
+#define loggingBINARY_SITE( level, message )                   \
+    level "\0" LIBRARY_LOG_NAME "\0" __FILE__ "\0"             \
+    loggingBINARY_STRINGIFY( __LINE__ ) "\0" loggingBINARY_FORMAT message
+
+/* Make each of the logging_stack.h macros write a single binary record. */
+#ifndef SdkLogRecord
+    #define SdkLogRecord( level, message )                                                      \
+    do {                                                                                        \
+        static const char cLogSite[] __attribute__( ( section( "log_binary_sites" ), used ) ) = \
+            loggingBINARY_SITE( level, message );                                               \
+        vLoggingBinaryWrite( cLogSite, loggingBINARY_STRIP_PARENTHESES message );               \
+    } while( 0 )
+#endif
+
+#endif /* LOGGING_BINARY_H */
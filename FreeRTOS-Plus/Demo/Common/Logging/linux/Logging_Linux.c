@@ -0,0 +1,717 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Logging utility that allows FreeRTOS tasks running in the Linux (Posix)
+ * simulator to log to stdout, a disk file and a UDP port without doing any
+ * I/O themselves.
+ *
+ * This is the Linux equivalent of Logging_WinSim.c.  FreeRTOS tasks format
+ * each message and copy it into a circular buffer.  A pthread that is not
+ * under the control of the FreeRTOS scheduler periodically takes everything in
+ * the buffer and writes it out with as few system calls as possible - one
+ * writev() per output file, and UDP datagrams packed with as many complete
+ * lines as fit.  If the buffer is full the message is dropped rather than
+ * making the task wait, and the number of dropped messages is reported in the
+ * log the next time the buffer is flushed.  The only system calls a task makes
+ * while logging are the pthread_sigmask() calls with which the Posix port
+ * implements the critical sections that protect the buffer.
+ *
+ * Unlike Logging_WinSim.c, UDP messages are sent through a Linux socket by the
+ * logging thread, so FreeRTOS+TCP is not needed and UDP logging works before
+ * the simulated network is up.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <string.h>
+#include <ctype.h>
+
+/* Linux includes. */
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo includes. */
+#include "logging.h"
+
+/*-----------------------------------------------------------*/
+
+/* The maximum size to which the log file may grow, before being renamed
+ * to .ful. */
+#define dlLOGGING_FILE_SIZE             ( 40ul * 1024ul * 1024ul )
+
+/* Dimensions the arrays into which print messages are created. */
+#define dlMAX_PRINT_STRING_LENGTH       255
+
+/* The size of the circular buffer used to pass messages from FreeRTOS tasks to
+ * the Linux thread that performs the output.  Must be a power of 2. */
+#define dlLOGGING_BUFFER_SIZE           65536
+
+/* How often the Linux thread empties the circular buffer.  FreeRTOS tasks do
+ * not wake the thread, as that would mean making another system call. */
+#define dlLOGGING_FLUSH_PERIOD_MS       10
+
+/* The largest UDP datagram sent. */
+#define dlMAX_UDP_PAYLOAD               1400
+
+#if ( ( dlLOGGING_BUFFER_SIZE & ( dlLOGGING_BUFFER_SIZE - 1 ) ) != 0 )
+    #error dlLOGGING_BUFFER_SIZE must be a power of 2
+#endif
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Start a new disk log file, or continue the existing one.
+ */
+static void prvFileLoggingInit( void );
+
+/*
+ * Copy pcSource to pcTarget, converting the hex IP addresses that
+ * FreeRTOS+TCP logs as "<n>ip" to dot notation on the way.  Returns the length
+ * of the converted string.
+ */
+static size_t prvExpandIPAddresses( const char * pcSource,
+                                    char * pcTarget );
+
+/*
+ * Add a message to the circular buffer, or count it as dropped if it does not
+ * fit.
+ */
+static void prvBufferMessage( const char * pcMessage,
+                              size_t xLength );
+
+/*
+ * Describe the xLength bytes of the circular buffer starting at xStart with at
+ * most two I/O vectors, to handle wrapping.  Returns the number of vectors
+ * used.
+ */
+static int prvBufferToIOVectors( size_t xStart,
+                                 size_t xLength,
+                                 struct iovec * pxVectors );
+
+/*
+ * Write every I/O vector to the file descriptor, retrying after partial
+ * writes.
+ */
+static void prvWriteAll( int iFile,
+                         struct iovec * pxVectors,
+                         int iVectorCount );
+
+/*
+ * Output xLength bytes starting at xStart in the circular buffer to every
+ * enabled destination.
+ */
+static void prvOutput( size_t xStart,
+                       size_t xLength );
+
+/*
+ * Send xLength bytes of the circular buffer as UDP datagrams, splitting the
+ * data at line endings where possible.
+ */
+static void prvSendUDP( size_t xStart,
+                        size_t xLength );
+
+/*
+ * Output everything that is in the circular buffer, followed by a note of any
+ * messages that were dropped since the last time.
+ */
+static void prvLoggingFlushBuffer( void );
+
+/*
+ * The Linux thread that performs the actual writing of messages, so FreeRTOS
+ * tasks never write to a file or socket.
+ */
+static void * prvLinuxLoggingThread( void * pvParameter );
+
+/*
+ * Flush anything still buffered when the process exits.
+ */
+static void prvLoggingFlushAtExit( void );
+
+/*-----------------------------------------------------------*/
+
+/* Stores the selected logging targets passed in as parameters to the
+ * vLoggingInit() function. */
+static BaseType_t xStdoutLoggingUsed = pdFALSE, xDiskFileLoggingUsed = pdFALSE, xUDPLoggingUsed = pdFALSE;
+
+/* Circular buffer used to pass messages from the FreeRTOS tasks to the Linux
+ * thread.  xBufferHead is only written by FreeRTOS tasks (from within a critical
+ * section) and xBufferTail only by whoever holds xFlushMutex, so the two sides
+ * never wait for each other. */
+static char cLogBuffer[ dlLOGGING_BUFFER_SIZE ];
+static size_t xBufferHead = 0, xBufferTail = 0;
+
+/* Messages that did not fit in the buffer, and how many of those have already
+ * been reported in the log. */
+static uint32_t ulDroppedMessages = 0, ulDroppedReported = 0;
+
+/* Serialises flushes by the logging thread and prvLoggingFlushAtExit().
+ * Never taken by a FreeRTOS task. */
+static pthread_mutex_t xFlushMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* pdTRUE once vLoggingInit() has started the logging thread.  Until then
+ * messages are written directly. */
+static BaseType_t xLoggingThreadStarted = pdFALSE;
+
+/* File names for the in use and complete (full) log files. */
+static const char * pcLogFileName = "RTOSDemo.log";
+static const char * pcFullLogFileName = "RTOSDemo.ful";
+
+/* The log file, and its size, kept to save asking the file system. */
+static int iLogFile = -1;
+static size_t ulSizeOfLoggingFile = 0ul;
+
+/* The Linux socket and address to which UDP messages are sent. */
+static int iPrintSocket = -1;
+static struct sockaddr_in xPrintUDPAddress;
+
+/*-----------------------------------------------------------*/
+
+void vLoggingInit( BaseType_t xLogToStdout,
+                   BaseType_t xLogToFile,
+                   BaseType_t xLogToUDP,
+                   uint32_t ulRemoteIPAddress,
+                   uint16_t usRemotePort )
+{
+    pthread_t xLoggingThread;
+    sigset_t xAllSignals, xOriginalSignals;
+
+    /* Can only be called before the scheduler has started. */
+    configASSERT( xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED );
+
+    /* Record which output methods are to be used. */
+    xStdoutLoggingUsed = xLogToStdout;
+    xDiskFileLoggingUsed = xLogToFile;
+    xUDPLoggingUsed = xLogToUDP;
+
+    /* If a disk file is used then open it now. */
+    if( xDiskFileLoggingUsed != pdFALSE )
+    {
+        prvFileLoggingInit();
+    }
+
+    /* If UDP logging is used then create a Linux socket for the logging
+     * thread to send from.  The address is in network byte order, as it is
+     * throughout FreeRTOS+TCP. */
+    if( xUDPLoggingUsed != pdFALSE )
+    {
+        memset( &xPrintUDPAddress, 0x00, sizeof( xPrintUDPAddress ) );
+        xPrintUDPAddress.sin_family = AF_INET;
+        xPrintUDPAddress.sin_port = htons( usRemotePort );
+        xPrintUDPAddress.sin_addr.s_addr = ulRemoteIPAddress;
+
+        iPrintSocket = socket( AF_INET, SOCK_DGRAM, 0 );
+    }
+
+    /* The Posix port uses signals to drive the scheduler, and those must
+     * only be handled by FreeRTOS threads.  Block every signal while the
+     * logging thread is created so it inherits a mask that blocks them
+     * all. */
+    sigfillset( &xAllSignals );
+    pthread_sigmask( SIG_SETMASK, &xAllSignals, &xOriginalSignals );
+
+    if( pthread_create( &xLoggingThread, NULL, prvLinuxLoggingThread, NULL ) == 0 )
+    {
+        pthread_detach( xLoggingThread );
+        xLoggingThreadStarted = pdTRUE;
+        atexit( prvLoggingFlushAtExit );
+    }
+
+    pthread_sigmask( SIG_SETMASK, &xOriginalSignals, NULL );
+}
+/*-----------------------------------------------------------*/
+
+void vLoggingPrintf( const char * pcFormat,
+                     ... )
+{
+    char cMessage[ dlMAX_PRINT_STRING_LENGTH ];
+    char cPrintString[ dlMAX_PRINT_STRING_LENGTH ];
+    char cOutputString[ dlMAX_PRINT_STRING_LENGTH ];
+    int iLength, iLength2;
+    static BaseType_t xMessageNumber = 0;
+    static BaseType_t xAfterLineBreak = pdTRUE;
+    BaseType_t xNumber = 0, xAddInfo, xEndsLine, xSchedulerRunning;
+    va_list args;
+    const char * pcTaskName;
+    const char * pcNoTask = "None";
+
+    if( xLoggingThreadStarted == pdFALSE )
+    {
+        /* vLoggingInit() has not been called, so just print. */
+        va_start( args, pcFormat );
+        vprintf( pcFormat, args );
+        va_end( args );
+    }
+    else if( ( xStdoutLoggingUsed != pdFALSE ) || ( xDiskFileLoggingUsed != pdFALSE ) || ( xUDPLoggingUsed != pdFALSE ) )
+    {
+        /* Additional info to place at the start of the log. */
+        xSchedulerRunning = ( xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED ) ? pdTRUE : pdFALSE;
+
+        if( xSchedulerRunning != pdFALSE )
+        {
+            pcTaskName = pcTaskGetName( NULL );
+        }
+        else
+        {
+            pcTaskName = pcNoTask;
+        }
+
+        /* There are a variable number of parameters. */
+        va_start( args, pcFormat );
+        iLength2 = vsnprintf( cMessage, dlMAX_PRINT_STRING_LENGTH, pcFormat, args );
+        va_end( args );
+
+        if( iLength2 < 0 )
+        {
+            /* Clean up. */
+            cMessage[ 0 ] = '\0';
+        }
+
+        /* The next message starts a new line, so gets the additional info, if
+         * this one ends the line.  The logging_stack.h macros build a line
+         * from three calls. */
+        iLength2 = ( int ) strlen( cMessage );
+        xEndsLine = ( ( iLength2 > 0 ) && ( cMessage[ iLength2 - 1 ] == '\n' ) ) ? pdTRUE : pdFALSE;
+
+        /* The message number and the line state are shared by all tasks.
+         * Before the scheduler starts there is only the one thread. */
+        if( xSchedulerRunning != pdFALSE )
+        {
+            taskENTER_CRITICAL();
+        }
+
+        {
+            xAddInfo = ( ( xAfterLineBreak == pdTRUE ) && ( strcmp( pcFormat, "\r\n" ) != 0 ) ) ? pdTRUE : pdFALSE;
+
+            if( xAddInfo != pdFALSE )
+            {
+                xNumber = xMessageNumber++;
+            }
+
+            xAfterLineBreak = xEndsLine;
+        }
+
+        if( xSchedulerRunning != pdFALSE )
+        {
+            taskEXIT_CRITICAL();
+        }
+
+        if( xAddInfo != pdFALSE )
+        {
+            iLength = snprintf( cPrintString, dlMAX_PRINT_STRING_LENGTH, "%lu %lu [%s] ",
+                                ( unsigned long ) xNumber,
+                                ( unsigned long ) xTaskGetTickCount(),
+                                pcTaskName );
+        }
+        else
+        {
+            iLength = 0;
+        }
+
+        if( ( iLength < 0 ) || ( iLength >= dlMAX_PRINT_STRING_LENGTH ) )
+        {
+            iLength = 0;
+        }
+
+        snprintf( cPrintString + iLength, dlMAX_PRINT_STRING_LENGTH - iLength, "%s", cMessage );
+
+        /* For ease of viewing, copy the string into another buffer, converting
+         * IP addresses to dot notation on the way. */
+        prvBufferMessage( cOutputString, prvExpandIPAddresses( cPrintString, cOutputString ) );
+    }
+    else
+    {
+        /* No output was selected when vLoggingInit() was called. */
+    }
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvExpandIPAddresses( const char * pcSource,
+                                    char * pcTarget )
+{
+    char * pcStart = pcTarget;
+    char * pcEnd = pcTarget + dlMAX_PRINT_STRING_LENGTH - 1;
+    char * pcBegin;
+    unsigned int ulIPAddress;
+    int iLength;
+
+    while( ( *pcSource != '\0' ) && ( pcTarget < pcEnd ) )
+    {
+        *pcTarget = *pcSource;
+        pcTarget++;
+        pcSource++;
+
+        /* Look forward for an IP address denoted by 'ip'. */
+        if( ( isxdigit( ( unsigned char ) pcSource[ 0 ] ) != 0 ) && ( pcSource[ 1 ] == 'i' ) && ( pcSource[ 2 ] == 'p' ) && ( pcTarget < pcEnd ) )
+        {
+            *pcTarget = *pcSource;
+            pcTarget++;
+            *pcTarget = '\0';
+            pcBegin = ( ( pcTarget - pcStart ) > 8 ) ? ( pcTarget - 8 ) : pcStart;
+
+            while( ( pcTarget > pcBegin ) && ( isxdigit( ( unsigned char ) pcTarget[ -1 ] ) != 0 ) )
+            {
+                pcTarget--;
+            }
+
+            if( sscanf( pcTarget, "%8X", &ulIPAddress ) == 1 )
+            {
+                iLength = snprintf( pcTarget, ( size_t ) ( pcEnd - pcTarget ) + 1U, "%lu.%lu.%lu.%lu",
+                                    ( unsigned long ) ( ulIPAddress >> 24UL ),
+                                    ( unsigned long ) ( ( ulIPAddress >> 16UL ) & 0xffUL ),
+                                    ( unsigned long ) ( ( ulIPAddress >> 8UL ) & 0xffUL ),
+                                    ( unsigned long ) ( ulIPAddress & 0xffUL ) );
+
+                if( iLength > 0 )
+                {
+                    pcTarget += ( iLength < ( pcEnd - pcTarget ) ) ? iLength : ( pcEnd - pcTarget );
+                }
+            }
+            else
+            {
+                pcTarget += strlen( pcTarget );
+            }
+
+            pcSource += 3; /* skip "<n>ip" */
+        }
+    }
+
+    *pcTarget = '\0';
+
+    return ( size_t ) ( pcTarget - pcStart );
+}
+/*-----------------------------------------------------------*/
+
+static void prvBufferMessage( const char * pcMessage,
+                              size_t xLength )
+{
+    size_t xHead, xIndex, xFirstPart;
+    BaseType_t xSchedulerRunning = ( xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED ) ? pdTRUE : pdFALSE;
+
+    /* There are potentially multiple writers, and a task could otherwise be
+     * preempted half way through adding its message.  Before the scheduler
+     * starts there is only the one thread. */
+    if( xSchedulerRunning != pdFALSE )
+    {
+        taskENTER_CRITICAL();
+    }
+
+    {
+        xHead = xBufferHead;
+
+        if( ( dlLOGGING_BUFFER_SIZE - ( xHead - __atomic_load_n( &xBufferTail, __ATOMIC_ACQUIRE ) ) ) >= xLength )
+        {
+            xIndex = xHead & ( dlLOGGING_BUFFER_SIZE - 1 );
+            xFirstPart = dlLOGGING_BUFFER_SIZE - xIndex;
+
+            if( xFirstPart > xLength )
+            {
+                xFirstPart = xLength;
+            }
+
+            memcpy( &( cLogBuffer[ xIndex ] ), pcMessage, xFirstPart );
+            memcpy( cLogBuffer, &( pcMessage[ xFirstPart ] ), xLength - xFirstPart );
+
+            /* Publish the message to the logging thread. */
+            __atomic_store_n( &xBufferHead, xHead + xLength, __ATOMIC_RELEASE );
+        }
+        else
+        {
+            __atomic_fetch_add( &ulDroppedMessages, 1U, __ATOMIC_RELAXED );
+        }
+    }
+
+    if( xSchedulerRunning != pdFALSE )
+    {
+        taskEXIT_CRITICAL();
+    }
+}
+/*-----------------------------------------------------------*/
+
+static int prvBufferToIOVectors( size_t xStart,
+                                 size_t xLength,
+                                 struct iovec * pxVectors )
+{
+    size_t xIndex = xStart & ( dlLOGGING_BUFFER_SIZE - 1 );
+    size_t xFirstPart = dlLOGGING_BUFFER_SIZE - xIndex;
+    int iVectorCount = 1;
+
+    pxVectors[ 0 ].iov_base = &( cLogBuffer[ xIndex ] );
+
+    if( xFirstPart >= xLength )
+    {
+        pxVectors[ 0 ].iov_len = xLength;
+    }
+    else
+    {
+        pxVectors[ 0 ].iov_len = xFirstPart;
+        pxVectors[ 1 ].iov_base = cLogBuffer;
+        pxVectors[ 1 ].iov_len = xLength - xFirstPart;
+        iVectorCount = 2;
+    }
+
+    return iVectorCount;
+}
+/*-----------------------------------------------------------*/
+
+static void prvWriteAll( int iFile,
+                         struct iovec * pxVectors,
+                         int iVectorCount )
+{
+    ssize_t xWritten;
+
+    while( iVectorCount > 0 )
+    {
+        xWritten = writev( iFile, pxVectors, iVectorCount );
+
+        if( xWritten < 0 )
+        {
+            if( errno != EINTR )
+            {
+                /* Nothing sensible can be done about a failing log output. */
+                break;
+            }
+        }
+        else
+        {
+            /* Skip over whatever was written, in case it was only part. */
+            while( ( iVectorCount > 0 ) && ( ( size_t ) xWritten >= pxVectors->iov_len ) )
+            {
+                xWritten -= ( ssize_t ) pxVectors->iov_len;
+                pxVectors++;
+                iVectorCount--;
+            }
+
+            if( iVectorCount > 0 )
+            {
+                pxVectors->iov_base = ( char * ) pxVectors->iov_base + xWritten;
+                pxVectors->iov_len -= ( size_t ) xWritten;
+            }
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvSendUDP( size_t xStart,
+                        size_t xLength )
+{
+    struct iovec xVectors[ 2 ];
+    struct msghdr xMessage;
+    size_t xDatagram, xScan;
+
+    memset( &xMessage, 0x00, sizeof( xMessage ) );
+    xMessage.msg_name = &xPrintUDPAddress;
+    xMessage.msg_namelen = sizeof( xPrintUDPAddress );
+    xMessage.msg_iov = xVectors;
+
+    while( xLength > 0 )
+    {
+        xDatagram = xLength;
+
+        if( xDatagram > dlMAX_UDP_PAYLOAD )
+        {
+            /* Send as many complete lines as fit, or a full datagram if even a
+             * single line does not. */
+            xDatagram = dlMAX_UDP_PAYLOAD;
+
+            for( xScan = dlMAX_UDP_PAYLOAD; xScan > 0; xScan-- )
+            {
+                if( cLogBuffer[ ( xStart + xScan - 1 ) & ( dlLOGGING_BUFFER_SIZE - 1 ) ] == '\n' )
+                {
+                    xDatagram = xScan;
+                    break;
+                }
+            }
+        }
+
+        xMessage.msg_iovlen = ( size_t ) prvBufferToIOVectors( xStart, xDatagram, xVectors );
+        ( void ) sendmsg( iPrintSocket, &xMessage, 0 );
+
+        xStart += xDatagram;
+        xLength -= xDatagram;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvOutput( size_t xStart,
+                       size_t xLength )
+{
+    struct iovec xVectors[ 2 ];
+    int iVectorCount;
+
+    if( xStdoutLoggingUsed != pdFALSE )
+    {
+        iVectorCount = prvBufferToIOVectors( xStart, xLength, xVectors );
+        prvWriteAll( STDOUT_FILENO, xVectors, iVectorCount );
+    }
+
+    if( iLogFile >= 0 )
+    {
+        iVectorCount = prvBufferToIOVectors( xStart, xLength, xVectors );
+        prvWriteAll( iLogFile, xVectors, iVectorCount );
+        ulSizeOfLoggingFile += xLength;
+
+        /* If the file has grown to its maximum permissible size then close and
+         * rename it - then start with a new file. */
+        if( ulSizeOfLoggingFile > ( size_t ) dlLOGGING_FILE_SIZE )
+        {
+            close( iLogFile );
+            rename( pcLogFileName, pcFullLogFileName );
+            prvFileLoggingInit();
+        }
+    }
+
+    if( iPrintSocket >= 0 )
+    {
+        prvSendUDP( xStart, xLength );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvLoggingFlushBuffer( void )
+{
+    size_t xHead, xTail;
+    uint32_t ulDropped;
+    char cDroppedString[ 64 ];
+    struct iovec xVector;
+    int iLength;
+
+    pthread_mutex_lock( &xFlushMutex );
+    {
+        xTail = xBufferTail;
+        xHead = __atomic_load_n( &xBufferHead, __ATOMIC_ACQUIRE );
+
+        if( xHead != xTail )
+        {
+            prvOutput( xTail, xHead - xTail );
+
+            /* Give the space back to the FreeRTOS tasks. */
+            __atomic_store_n( &xBufferTail, xHead, __ATOMIC_RELEASE );
+        }
+
+        ulDropped = __atomic_load_n( &ulDroppedMessages, __ATOMIC_RELAXED );
+
+        if( ulDropped != ulDroppedReported )
+        {
+            iLength = snprintf( cDroppedString, sizeof( cDroppedString ), "[LOG] %lu messages dropped\n",
+                                ( unsigned long ) ( ulDropped - ulDroppedReported ) );
+            ulDroppedReported = ulDropped;
+
+            if( ( iLength > 0 ) && ( ( size_t ) iLength < sizeof( cDroppedString ) ) )
+            {
+                if( xStdoutLoggingUsed != pdFALSE )
+                {
+                    xVector.iov_base = cDroppedString;
+                    xVector.iov_len = ( size_t ) iLength;
+                    prvWriteAll( STDOUT_FILENO, &xVector, 1 );
+                }
+
+                if( iLogFile >= 0 )
+                {
+                    xVector.iov_base = cDroppedString;
+                    xVector.iov_len = ( size_t ) iLength;
+                    prvWriteAll( iLogFile, &xVector, 1 );
+                    ulSizeOfLoggingFile += ( size_t ) iLength;
+                }
+
+                if( iPrintSocket >= 0 )
+                {
+                    ( void ) sendto( iPrintSocket, cDroppedString, ( size_t ) iLength, 0,
+                                     ( struct sockaddr * ) &xPrintUDPAddress, sizeof( xPrintUDPAddress ) );
+                }
+            }
+        }
+    }
+    pthread_mutex_unlock( &xFlushMutex );
+}
+/*-----------------------------------------------------------*/
+
+static void * prvLinuxLoggingThread( void * pvParameter )
+{
+    const struct timespec xFlushPeriod =
+    {
+        .tv_sec  = 0,
+        .tv_nsec = dlLOGGING_FLUSH_PERIOD_MS * 1000000L
+    };
+
+    ( void ) pvParameter;
+
+    for( ; ; )
+    {
+        nanosleep( &xFlushPeriod, NULL );
+
+        /* Write out all waiting messages. */
+        prvLoggingFlushBuffer();
+    }
+
+    return NULL;
+}
+/*-----------------------------------------------------------*/
+
+static void prvLoggingFlushAtExit( void )
+{
+    prvLoggingFlushBuffer();
+}
+/*-----------------------------------------------------------*/
+
+static void prvFileLoggingInit( void )
+{
+    struct stat xFileStatus;
+
+    iLogFile = open( pcLogFileName, O_WRONLY | O_CREAT | O_APPEND, 0644 );
+
+    if( ( iLogFile >= 0 ) && ( fstat( iLogFile, &xFileStatus ) == 0 ) )
+    {
+        ulSizeOfLoggingFile = ( size_t ) xFileStatus.st_size;
+    }
+    else
+    {
+        ulSizeOfLoggingFile = 0ul;
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vPlatformInitLogging( void )
+{
+    vLoggingInit( pdTRUE, pdFALSE, pdFALSE, 0U, 0U );
+}
+/*-----------------------------------------------------------*/
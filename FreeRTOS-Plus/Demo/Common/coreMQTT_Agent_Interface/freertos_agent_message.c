@@ -35,14 +35,95 @@
 
 /* Kernel includes. */
 #include "FreeRTOS.h"
+#include "task.h"
 #include "semphr.h"
 
 /* Header include. */
 #include "freertos_agent_message.h"
+#include "freertos_command_pool.h"
 #include "core_mqtt_agent_message_interface.h"
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Add one command to a mailbox, applying its policy if it is full.
+ *
+ * @param[in] pMailbox The mailbox.
+ * @param[in] pCommand The command to add.
+ * @param[in] blockTimeMs Block time to wait for space.
+ * @param[in,out] pWakeReceiver Set to pdTRUE if the receiver has to be woken.
+ * The receiver is woken before waiting for space, and the flag cleared.
+ *
+ * @return `true` if the command was added, else `false`.
+ */
+static bool prvMailboxSend( AgentMailbox_t * pMailbox,
+                            MQTTAgentCommand_t * pCommand,
+                            uint32_t blockTimeMs,
+                            BaseType_t * pWakeReceiver );
+
+/**
+ * @brief Return the next command from a mailbox, refilling the receiver's
+ * batch from the ring when it is empty.
+ */
+static bool prvMailboxReceive( AgentMailbox_t * pMailbox,
+                               MQTTAgentCommand_t ** pReceivedCommand,
+                               uint32_t blockTimeMs );
+
+/**
+ * @brief Complete and release a command dropped by AgentMailboxDropOldest.
+ */
+static void prvDropCommand( AgentMailbox_t * pMailbox,
+                            MQTTAgentCommand_t * pCommand );
+
+/*-----------------------------------------------------------*/
+
+bool Agent_InitializeMailbox( MQTTAgentMessageContext_t * pMsgCtx,
+                              AgentMailbox_t * pMailbox,
+                              MQTTAgentCommand_t ** pRing,
+                              size_t length,
+                              AgentMailboxPolicy_t policy,
+                              AgentMailboxDropCallback_t dropCallback )
+{
+    bool mailboxCreated = false;
+
+    configASSERT( pMsgCtx != NULL );
+    configASSERT( pMailbox != NULL );
+    configASSERT( pRing != NULL );
+    configASSERT( length > 0U );
+
+    memset( pMailbox, 0x00, sizeof( AgentMailbox_t ) );
+    pMailbox->pRing = pRing;
+    pMailbox->length = length;
+    pMailbox->policy = policy;
+    pMailbox->dropCallback = dropCallback;
+
+    pMailbox->itemsAvailable = xSemaphoreCreateBinary();
+    pMailbox->spaceAvailable = xSemaphoreCreateCounting( length, 0U );
+
+    if( ( pMailbox->itemsAvailable != NULL ) && ( pMailbox->spaceAvailable != NULL ) )
+    {
+        pMsgCtx->queue = NULL;
+        pMsgCtx->pMailbox = pMailbox;
+        mailboxCreated = true;
+    }
+    else
+    {
+        if( pMailbox->itemsAvailable != NULL )
+        {
+            vSemaphoreDelete( pMailbox->itemsAvailable );
+        }
+
+        if( pMailbox->spaceAvailable != NULL )
+        {
+            vSemaphoreDelete( pMailbox->spaceAvailable );
+        }
+    }
+
+    return mailboxCreated;
+}
+
+/*-----------------------------------------------------------*/
+
 bool Agent_MessageSend( const MQTTAgentMessageContext_t * pMsgCtx,
                         MQTTAgentCommand_t * const * pCommandToSend,
                         uint32_t blockTimeMs )
@@ -51,7 +132,14 @@ bool Agent_MessageSend( const MQTTAgentMessageContext_t * pMsgCtx,
 
     if( ( pMsgCtx != NULL ) && ( pCommandToSend != NULL ) )
     {
-        queueStatus = xQueueSendToBack( pMsgCtx->queue, pCommandToSend, pdMS_TO_TICKS( blockTimeMs ) );
+        if( pMsgCtx->pMailbox != NULL )
+        {
+            queueStatus = ( Agent_MessageSendBatch( pMsgCtx, pCommandToSend, 1U, blockTimeMs ) == 1U ) ? pdPASS : pdFAIL;
+        }
+        else
+        {
+            queueStatus = xQueueSendToBack( pMsgCtx->queue, pCommandToSend, pdMS_TO_TICKS( blockTimeMs ) );
+        }
     }
 
     return ( queueStatus == pdPASS ) ? true : false;
@@ -67,8 +155,297 @@ bool Agent_MessageReceive( const MQTTAgentMessageContext_t * pMsgCtx,
 
     if( ( pMsgCtx != NULL ) && ( pReceivedCommand != NULL ) )
     {
-        queueStatus = xQueueReceive( pMsgCtx->queue, pReceivedCommand, pdMS_TO_TICKS( blockTimeMs ) );
+        if( pMsgCtx->pMailbox != NULL )
+        {
+            queueStatus = prvMailboxReceive( pMsgCtx->pMailbox, pReceivedCommand, blockTimeMs ) ? pdPASS : pdFAIL;
+        }
+        else
+        {
+            queueStatus = xQueueReceive( pMsgCtx->queue, pReceivedCommand, pdMS_TO_TICKS( blockTimeMs ) );
+        }
     }
 
     return ( queueStatus == pdPASS ) ? true : false;
 }
+
+/*-----------------------------------------------------------*/
+
+size_t Agent_MessageSendBatch( const MQTTAgentMessageContext_t * pMsgCtx,
+                               MQTTAgentCommand_t * const * pCommandsToSend,
+                               size_t commandCount,
+                               uint32_t blockTimeMs )
+{
+    size_t commandsSent = 0U;
+    BaseType_t wakeReceiver = pdFALSE;
+
+    if( ( pMsgCtx != NULL ) && ( pCommandsToSend != NULL ) )
+    {
+        if( pMsgCtx->pMailbox != NULL )
+        {
+            while( ( commandsSent < commandCount ) &&
+                   prvMailboxSend( pMsgCtx->pMailbox, pCommandsToSend[ commandsSent ], blockTimeMs, &wakeReceiver ) )
+            {
+                commandsSent++;
+            }
+
+            /* One wake up for the whole batch. */
+            if( wakeReceiver != pdFALSE )
+            {
+                ( void ) xSemaphoreGive( pMsgCtx->pMailbox->itemsAvailable );
+            }
+        }
+        else
+        {
+            while( ( commandsSent < commandCount ) &&
+                   ( xQueueSendToBack( pMsgCtx->queue, &( pCommandsToSend[ commandsSent ] ), pdMS_TO_TICKS( blockTimeMs ) ) == pdPASS ) )
+            {
+                commandsSent++;
+            }
+        }
+    }
+
+    return commandsSent;
+}
+
+/*-----------------------------------------------------------*/
+
+size_t Agent_GetPendingCommandCount( const MQTTAgentMessageContext_t * pMsgCtx )
+{
+    size_t pendingCount;
+
+    configASSERT( pMsgCtx != NULL );
+
+    if( pMsgCtx->pMailbox != NULL )
+    {
+        /* Commands still in the ring, and those the receiver has taken but
+         * not returned yet.  batchIndex is reset just after a new batch is
+         * taken, so it can briefly be beyond batchCount. */
+        taskENTER_CRITICAL();
+        {
+            pendingCount = pMsgCtx->pMailbox->count;
+
+            if( pMsgCtx->pMailbox->batchIndex < pMsgCtx->pMailbox->batchCount )
+            {
+                pendingCount += pMsgCtx->pMailbox->batchCount - pMsgCtx->pMailbox->batchIndex;
+            }
+        }
+        taskEXIT_CRITICAL();
+    }
+    else
+    {
+        pendingCount = ( size_t ) uxQueueMessagesWaiting( pMsgCtx->queue );
+    }
+
+    return pendingCount;
+}
+
+/*-----------------------------------------------------------*/
+
+uint32_t Agent_GetMailboxDropCount( const MQTTAgentMessageContext_t * pMsgCtx )
+{
+    configASSERT( ( pMsgCtx != NULL ) && ( pMsgCtx->pMailbox != NULL ) );
+
+    return pMsgCtx->pMailbox->droppedCommands;
+}
+
+/*-----------------------------------------------------------*/
+
+static bool prvMailboxSend( AgentMailbox_t * pMailbox,
+                            MQTTAgentCommand_t * pCommand,
+                            uint32_t blockTimeMs,
+                            BaseType_t * pWakeReceiver )
+{
+    MQTTAgentCommand_t * pDroppedCommand;
+    TickType_t startTime, elapsedTime;
+    const TickType_t blockTime = pdMS_TO_TICKS( blockTimeMs );
+    bool commandAdded = false;
+    bool waiting = false;
+
+    startTime = xTaskGetTickCount();
+
+    for( ; ; )
+    {
+        pDroppedCommand = NULL;
+
+        taskENTER_CRITICAL();
+        {
+            if( ( pMailbox->count == pMailbox->length ) && ( pMailbox->policy == AgentMailboxDropOldest ) )
+            {
+                /* Make room by dropping the command at the tail. */
+                pDroppedCommand = pMailbox->pRing[ ( pMailbox->head + pMailbox->length - pMailbox->count ) % pMailbox->length ];
+                pMailbox->count--;
+                pMailbox->droppedCommands++;
+            }
+
+            if( pMailbox->count < pMailbox->length )
+            {
+                pMailbox->pRing[ pMailbox->head ] = pCommand;
+                pMailbox->head = ( pMailbox->head + 1U ) % pMailbox->length;
+                pMailbox->count++;
+                commandAdded = true;
+
+                if( pMailbox->receiverWaiting != pdFALSE )
+                {
+                    pMailbox->receiverWaiting = pdFALSE;
+                    *pWakeReceiver = pdTRUE;
+                }
+            }
+            else if( !waiting )
+            {
+                /* Announce the wait while the mailbox is known to be full,
+                 * so the receiver gives spaceAvailable once it takes some
+                 * commands. */
+                pMailbox->sendersWaiting++;
+                waiting = true;
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        if( pDroppedCommand != NULL )
+        {
+            prvDropCommand( pMailbox, pDroppedCommand );
+        }
+
+        if( commandAdded || ( pMailbox->policy == AgentMailboxFail ) )
+        {
+            break;
+        }
+
+        /* The receiver must be woken before waiting for it to make space. */
+        if( *pWakeReceiver != pdFALSE )
+        {
+            *pWakeReceiver = pdFALSE;
+            ( void ) xSemaphoreGive( pMailbox->itemsAvailable );
+        }
+
+        elapsedTime = xTaskGetTickCount() - startTime;
+
+        if( elapsedTime >= blockTime )
+        {
+            break;
+        }
+
+        ( void ) xSemaphoreTake( pMailbox->spaceAvailable, blockTime - elapsedTime );
+    }
+
+    if( waiting )
+    {
+        taskENTER_CRITICAL();
+        {
+            pMailbox->sendersWaiting--;
+        }
+        taskEXIT_CRITICAL();
+    }
+
+    return commandAdded;
+}
+
+/*-----------------------------------------------------------*/
+
+static bool prvMailboxReceive( AgentMailbox_t * pMailbox,
+                               MQTTAgentCommand_t ** pReceivedCommand,
+                               uint32_t blockTimeMs )
+{
+    TickType_t startTime, elapsedTime;
+    const TickType_t blockTime = pdMS_TO_TICKS( blockTimeMs );
+    size_t tail, i;
+    UBaseType_t sendersToWake = 0U;
+    bool commandReceived = false;
+
+    if( pMailbox->batchIndex < pMailbox->batchCount )
+    {
+        /* A command taken by an earlier call, no need to look at the ring. */
+        *pReceivedCommand = pMailbox->batch[ pMailbox->batchIndex ];
+        pMailbox->batchIndex++;
+        commandReceived = true;
+    }
+    else
+    {
+        startTime = xTaskGetTickCount();
+
+        for( ; ; )
+        {
+            taskENTER_CRITICAL();
+            {
+                /* Take every pending command that fits in the batch. */
+                pMailbox->batchCount = ( pMailbox->count < MQTT_AGENT_MAILBOX_BATCH_LENGTH ) ? pMailbox->count : MQTT_AGENT_MAILBOX_BATCH_LENGTH;
+                tail = ( pMailbox->head + pMailbox->length - pMailbox->count ) % pMailbox->length;
+
+                for( i = 0U; i < pMailbox->batchCount; i++ )
+                {
+                    pMailbox->batch[ i ] = pMailbox->pRing[ tail ];
+                    tail = ( tail + 1U ) % pMailbox->length;
+                }
+
+                pMailbox->count -= pMailbox->batchCount;
+
+                if( pMailbox->batchCount == 0U )
+                {
+                    pMailbox->receiverWaiting = pdTRUE;
+                }
+                else
+                {
+                    pMailbox->receiverWaiting = pdFALSE;
+                    sendersToWake = ( pMailbox->sendersWaiting < pMailbox->batchCount ) ? pMailbox->sendersWaiting : ( UBaseType_t ) pMailbox->batchCount;
+                }
+            }
+            taskEXIT_CRITICAL();
+
+            if( pMailbox->batchCount > 0U )
+            {
+                while( sendersToWake > 0U )
+                {
+                    ( void ) xSemaphoreGive( pMailbox->spaceAvailable );
+                    sendersToWake--;
+                }
+
+                *pReceivedCommand = pMailbox->batch[ 0 ];
+                pMailbox->batchIndex = 1U;
+                commandReceived = true;
+                break;
+            }
+
+            elapsedTime = xTaskGetTickCount() - startTime;
+
+            if( elapsedTime >= blockTime )
+            {
+                taskENTER_CRITICAL();
+                {
+                    pMailbox->receiverWaiting = pdFALSE;
+                }
+                taskEXIT_CRITICAL();
+                break;
+            }
+
+            /* The semaphore may still be given from a send that raced with an
+             * earlier timeout, so go round again after it is taken. */
+            ( void ) xSemaphoreTake( pMailbox->itemsAvailable, blockTime - elapsedTime );
+        }
+    }
+
+    return commandReceived;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvDropCommand( AgentMailbox_t * pMailbox,
+                            MQTTAgentCommand_t * pCommand )
+{
+    MQTTAgentReturnInfo_t returnInfo;
+
+    if( pMailbox->dropCallback != NULL )
+    {
+        pMailbox->dropCallback( pCommand );
+    }
+    else
+    {
+        if( pCommand->pCommandCompleteCallback != NULL )
+        {
+            memset( &returnInfo, 0x00, sizeof( returnInfo ) );
+            returnInfo.returnCode = MQTTNoMemory;
+            pCommand->pCommandCompleteCallback( pCommand->pCmdContext, &returnInfo );
+        }
+
+        ( void ) Agent_ReleaseCommand( pCommand );
+    }
+}
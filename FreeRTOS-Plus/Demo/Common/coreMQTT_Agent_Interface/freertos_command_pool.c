@@ -27,6 +27,14 @@
 /**
  * @file freertos_command_pool.c
  * @brief Implements functions to obtain and release commands.
+ *
+ * Free commands are kept on a singly linked list of pool indices.  The head of
+ * the list is a single 32-bit word holding the index of the first free command
+ * in its low 16 bits and a modification count in its high 16 bits, so a
+ * command is obtained or released with one compare-and-swap, and the count
+ * stops a head that was popped and pushed back in between from being mistaken
+ * for an unchanged one.  Tasks only use the kernel when they have to wait for
+ * a command to become free.
  */
 
 /* Standard includes. */
@@ -35,16 +43,43 @@
 
 /* Kernel includes. */
 #include "FreeRTOS.h"
+#include "task.h"
 #include "semphr.h"
+#include "atomic.h"
 
 /* Header include. */
 #include "freertos_command_pool.h"
-#include "freertos_agent_message.h"
 
 /*-----------------------------------------------------------*/
 
-#define QUEUE_NOT_INITIALIZED    ( 0U )
-#define QUEUE_INITIALIZED        ( 1U )
+#define POOL_NOT_INITIALIZED    ( 0U )
+#define POOL_INITIALIZED        ( 1U )
+
+/**
+ * @brief Marks the end of the free list.
+ */
+#define POOL_INDEX_NONE          ( 0xFFFFU )
+
+/**
+ * @brief The bits of the free list head that hold the index of the first free
+ * command.  The remaining bits hold the modification count.
+ */
+#define POOL_HEAD_INDEX_MASK     ( 0x0000FFFFUL )
+
+/**
+ * @brief Added to the free list head every time it is changed.
+ */
+#define POOL_HEAD_COUNT_STEP     ( 0x00010000UL )
+
+#if ( MQTT_COMMAND_CONTEXTS_POOL_SIZE >= POOL_INDEX_NONE )
+    #error MQTT_COMMAND_CONTEXTS_POOL_SIZE must be less than 65535
+#endif
+
+#if ( MQTT_COMMAND_POOL_CACHE_SIZE > 0U )
+    #if ( MQTT_COMMAND_POOL_CACHE_TLS_INDEX >= configNUM_THREAD_LOCAL_STORAGE_POINTERS )
+        #error MQTT_COMMAND_POOL_CACHE_TLS_INDEX must be less than configNUM_THREAD_LOCAL_STORAGE_POINTERS
+    #endif
+#endif
 
 /**
  * @brief The pool of command structures used to hold information on commands (such
@@ -54,46 +89,86 @@
 static MQTTAgentCommand_t commandStructurePool[ MQTT_COMMAND_CONTEXTS_POOL_SIZE ];
 
 /**
- * @brief The message context used to guard the pool of MQTTAgentCommand_t structures.
- * For FreeRTOS, this is implemented with a queue. Structures may be
- * obtained by receiving a pointer from the queue, and returned by
- * sending the pointer back into it.
+ * @brief For each free command, the index of the next free command.
+ */
+static volatile uint16_t nextFreeCommand[ MQTT_COMMAND_CONTEXTS_POOL_SIZE ];
+
+/**
+ * @brief The head of the free list, see the description at the top of the file.
+ */
+static volatile uint32_t freeListHead;
+
+/**
+ * @brief The number of tasks waiting in Agent_GetCommand() for a command.
+ */
+static volatile uint32_t waitingTasks;
+
+/**
+ * @brief Given when a command is released while tasks are waiting for one.
+ */
+static SemaphoreHandle_t commandReleased;
+
+/**
+ * @brief Pool statistics, updated atomically.
+ */
+static volatile uint32_t commandsInUse;
+static volatile uint32_t commandsHighWaterMark;
+static volatile uint32_t poolExhaustions;
+static volatile uint32_t poolTimeouts;
+
+/**
+ * @brief Initialization status of the pool.
+ */
+static volatile uint8_t initStatus = POOL_NOT_INITIALIZED;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Remove the first command from the free list.
+ *
+ * @return The pool index of the command, or POOL_INDEX_NONE if the list is empty.
+ */
+static uint16_t prvPopFreeCommand( void );
+
+/**
+ * @brief Add a command to the front of the free list.
+ *
+ * @param[in] index The pool index of the command.
  */
-static MQTTAgentMessageContext_t commandStructMessageCtx;
+static void prvPushFreeCommand( uint16_t index );
 
 /**
- * @brief Initialization status of the queue.
+ * @brief Wait for a command to be released, the slow path of Agent_GetCommand().
+ *
+ * @param[in] blockTimeMs The maximum time to wait.
+ *
+ * @return The pool index of the command, or POOL_INDEX_NONE on timeout.
  */
-static volatile uint8_t initStatus = QUEUE_NOT_INITIALIZED;
+static uint16_t prvWaitForFreeCommand( uint32_t blockTimeMs );
 
 /*-----------------------------------------------------------*/
 
 void Agent_InitializePool( void )
 {
-    size_t i;
-    MQTTAgentCommand_t * pCommand;
-    static uint8_t staticQueueStorageArea[ MQTT_COMMAND_CONTEXTS_POOL_SIZE * sizeof( MQTTAgentCommand_t * ) ];
-    static StaticQueue_t staticQueueStructure;
-    bool commandAdded = false;
+    uint16_t i;
 
-    if( initStatus == QUEUE_NOT_INITIALIZED )
+    if( initStatus == POOL_NOT_INITIALIZED )
     {
         memset( ( void * ) commandStructurePool, 0x00, sizeof( commandStructurePool ) );
-        commandStructMessageCtx.queue = xQueueCreate( MQTT_COMMAND_CONTEXTS_POOL_SIZE,
-                                                      sizeof( MQTTAgentCommand_t * ) );
-        configASSERT( commandStructMessageCtx.queue );
 
-        /* Populate the queue. */
+        /* Chain every command onto the free list. */
         for( i = 0; i < MQTT_COMMAND_CONTEXTS_POOL_SIZE; i++ )
         {
-            /* Store the address as a variable. */
-            pCommand = &commandStructurePool[ i ];
-            /* Send the pointer to the queue. */
-            commandAdded = Agent_MessageSend( &commandStructMessageCtx, &pCommand, 0U );
-            configASSERT( commandAdded );
+            nextFreeCommand[ i ] = ( uint16_t ) ( i + 1U );
         }
 
-        initStatus = QUEUE_INITIALIZED;
+        nextFreeCommand[ MQTT_COMMAND_CONTEXTS_POOL_SIZE - 1U ] = POOL_INDEX_NONE;
+        freeListHead = 0U;
+
+        commandReleased = xSemaphoreCreateCounting( MQTT_COMMAND_CONTEXTS_POOL_SIZE, 0U );
+        configASSERT( commandReleased );
+
+        initStatus = POOL_INITIALIZED;
     }
 }
 
@@ -102,18 +177,59 @@ void Agent_InitializePool( void )
 MQTTAgentCommand_t * Agent_GetCommand( uint32_t blockTimeMs )
 {
     MQTTAgentCommand_t * structToUse = NULL;
-    bool structRetrieved = false;
+    uint16_t index = POOL_INDEX_NONE;
+    uint32_t inUse, highWaterMark;
 
-    /* Check queue has been created. */
-    configASSERT( initStatus == QUEUE_INITIALIZED );
+    /* Check the pool has been initialized. */
+    configASSERT( initStatus == POOL_INITIALIZED );
 
-    /* Retrieve a struct from the queue. */
-    structRetrieved = Agent_MessageReceive( &commandStructMessageCtx, &( structToUse ), blockTimeMs );
+    #if ( MQTT_COMMAND_POOL_CACHE_SIZE > 0U )
+    {
+        AgentCommandCache_t * pCache;
+
+        pCache = ( AgentCommandCache_t * ) pvTaskGetThreadLocalStoragePointer( NULL, MQTT_COMMAND_POOL_CACHE_TLS_INDEX );
+
+        if( ( pCache != NULL ) && ( pCache->count > 0U ) )
+        {
+            pCache->count--;
+            index = pCache->indices[ pCache->count ];
+        }
+    }
+    #endif /* MQTT_COMMAND_POOL_CACHE_SIZE */
+
+    if( index == POOL_INDEX_NONE )
+    {
+        index = prvPopFreeCommand();
+    }
 
-    if( !structRetrieved )
+    if( index == POOL_INDEX_NONE )
     {
+        ( void ) Atomic_Increment_u32( &poolExhaustions );
+
+        if( blockTimeMs > 0U )
+        {
+            index = prvWaitForFreeCommand( blockTimeMs );
+        }
+    }
+
+    if( index == POOL_INDEX_NONE )
+    {
+        ( void ) Atomic_Increment_u32( &poolTimeouts );
         LogError( ( "No command structure available." ) );
     }
+    else
+    {
+        structToUse = &commandStructurePool[ index ];
+
+        /* Atomic_Increment_u32() returns the value before the increment. */
+        inUse = Atomic_Increment_u32( &commandsInUse ) + 1U;
+
+        do
+        {
+            highWaterMark = commandsHighWaterMark;
+        } while( ( inUse > highWaterMark ) &&
+                 ( Atomic_CompareAndSwap_u32( &commandsHighWaterMark, inUse, highWaterMark ) != ATOMIC_COMPARE_AND_SWAP_SUCCESS ) );
+    }
 
     return structToUse;
 }
@@ -123,21 +239,178 @@ MQTTAgentCommand_t * Agent_GetCommand( uint32_t blockTimeMs )
 bool Agent_ReleaseCommand( MQTTAgentCommand_t * pCommandToRelease )
 {
     bool structReturned = false;
+    uint16_t index;
 
-    configASSERT( initStatus == QUEUE_INITIALIZED );
+    configASSERT( initStatus == POOL_INITIALIZED );
 
     /* See if the structure being returned is actually from the pool. */
     if( ( pCommandToRelease >= commandStructurePool ) &&
         ( pCommandToRelease < ( commandStructurePool + MQTT_COMMAND_CONTEXTS_POOL_SIZE ) ) )
     {
-        structReturned = Agent_MessageSend( &commandStructMessageCtx, &pCommandToRelease, 0U );
+        index = ( uint16_t ) ( pCommandToRelease - commandStructurePool );
+        ( void ) Atomic_Decrement_u32( &commandsInUse );
+
+        #if ( MQTT_COMMAND_POOL_CACHE_SIZE > 0U )
+        {
+            AgentCommandCache_t * pCache;
+
+            pCache = ( AgentCommandCache_t * ) pvTaskGetThreadLocalStoragePointer( NULL, MQTT_COMMAND_POOL_CACHE_TLS_INDEX );
+
+            /* Keep the command for this task, unless another task is waiting
+             * for one. */
+            if( ( pCache != NULL ) && ( pCache->count < MQTT_COMMAND_POOL_CACHE_SIZE ) && ( waitingTasks == 0U ) )
+            {
+                pCache->indices[ pCache->count ] = index;
+                pCache->count++;
+                structReturned = true;
+            }
+        }
+        #endif /* MQTT_COMMAND_POOL_CACHE_SIZE */
 
-        /* The send should not fail as the queue was created to hold every command
-         * in the pool. */
-        configASSERT( structReturned );
-        LogDebug( ( "Returned Command Context %d to pool",
-                    ( int ) ( pCommandToRelease - commandStructurePool ) ) );
+        if( !structReturned )
+        {
+            prvPushFreeCommand( index );
+            structReturned = true;
+
+            /* A waiting task increments waitingTasks before it looks at the
+             * free list for the last time, so either it sees this command or
+             * it is woken here. */
+            if( waitingTasks > 0U )
+            {
+                ( void ) xSemaphoreGive( commandReleased );
+            }
+        }
     }
 
     return structReturned;
 }
+
+/*-----------------------------------------------------------*/
+
+void Agent_GetCommandPoolStats( AgentCommandPoolStats_t * pStats )
+{
+    configASSERT( pStats != NULL );
+
+    pStats->poolSize = MQTT_COMMAND_CONTEXTS_POOL_SIZE;
+    pStats->inUse = commandsInUse;
+    pStats->highWaterMark = commandsHighWaterMark;
+    pStats->exhaustions = poolExhaustions;
+    pStats->timeouts = poolTimeouts;
+}
+
+/*-----------------------------------------------------------*/
+
+#if ( MQTT_COMMAND_POOL_CACHE_SIZE > 0U )
+
+    void Agent_RegisterCommandCache( AgentCommandCache_t * pCache )
+    {
+        configASSERT( pCache != NULL );
+
+        pCache->count = 0U;
+        vTaskSetThreadLocalStoragePointer( NULL, MQTT_COMMAND_POOL_CACHE_TLS_INDEX, pCache );
+    }
+
+/*-----------------------------------------------------------*/
+
+    void Agent_UnregisterCommandCache( void )
+    {
+        AgentCommandCache_t * pCache;
+
+        pCache = ( AgentCommandCache_t * ) pvTaskGetThreadLocalStoragePointer( NULL, MQTT_COMMAND_POOL_CACHE_TLS_INDEX );
+        vTaskSetThreadLocalStoragePointer( NULL, MQTT_COMMAND_POOL_CACHE_TLS_INDEX, NULL );
+
+        if( pCache != NULL )
+        {
+            while( pCache->count > 0U )
+            {
+                pCache->count--;
+                prvPushFreeCommand( pCache->indices[ pCache->count ] );
+
+                if( waitingTasks > 0U )
+                {
+                    ( void ) xSemaphoreGive( commandReleased );
+                }
+            }
+        }
+    }
+
+#endif /* MQTT_COMMAND_POOL_CACHE_SIZE */
+/*-----------------------------------------------------------*/
+
+static uint16_t prvPopFreeCommand( void )
+{
+    uint32_t head, newHead;
+    uint16_t index;
+
+    do
+    {
+        head = freeListHead;
+        index = ( uint16_t ) ( head & POOL_HEAD_INDEX_MASK );
+
+        if( index == POOL_INDEX_NONE )
+        {
+            break;
+        }
+
+        /* nextFreeCommand[ index ] may already be stale if another task has
+         * taken the command in the meantime, in which case the head has
+         * changed and the compare-and-swap fails. */
+        newHead = ( ( head + POOL_HEAD_COUNT_STEP ) & ~POOL_HEAD_INDEX_MASK ) | nextFreeCommand[ index ];
+    } while( Atomic_CompareAndSwap_u32( &freeListHead, newHead, head ) != ATOMIC_COMPARE_AND_SWAP_SUCCESS );
+
+    return index;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvPushFreeCommand( uint16_t index )
+{
+    uint32_t head, newHead;
+
+    do
+    {
+        head = freeListHead;
+        nextFreeCommand[ index ] = ( uint16_t ) ( head & POOL_HEAD_INDEX_MASK );
+        newHead = ( ( head + POOL_HEAD_COUNT_STEP ) & ~POOL_HEAD_INDEX_MASK ) | index;
+    } while( Atomic_CompareAndSwap_u32( &freeListHead, newHead, head ) != ATOMIC_COMPARE_AND_SWAP_SUCCESS );
+}
+
+/*-----------------------------------------------------------*/
+
+static uint16_t prvWaitForFreeCommand( uint32_t blockTimeMs )
+{
+    TickType_t startTime, elapsedTime;
+    const TickType_t blockTime = pdMS_TO_TICKS( blockTimeMs );
+    uint16_t index;
+
+    startTime = xTaskGetTickCount();
+
+    /* Announce the wait before looking at the free list again, see
+     * Agent_ReleaseCommand(). */
+    ( void ) Atomic_Increment_u32( &waitingTasks );
+
+    for( ; ; )
+    {
+        index = prvPopFreeCommand();
+
+        if( index != POOL_INDEX_NONE )
+        {
+            break;
+        }
+
+        elapsedTime = xTaskGetTickCount() - startTime;
+
+        if( elapsedTime >= blockTime )
+        {
+            break;
+        }
+
+        /* The semaphore may have been given for a command that another task
+         * took first, so go round again after it is taken. */
+        ( void ) xSemaphoreTake( commandReleased, blockTime - elapsedTime );
+    }
+
+    ( void ) Atomic_Decrement_u32( &waitingTasks );
+
+    return index;
+}
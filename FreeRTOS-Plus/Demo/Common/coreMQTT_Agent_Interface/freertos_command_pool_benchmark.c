@@ -0,0 +1,260 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file freertos_command_pool_benchmark.c
+ * @brief Benchmark of the command pool and of PUBLISH command throughput from
+ * several producer tasks.
+ */
+
+/* Standard includes. */
+#include <string.h>
+#include <stdio.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Header include. */
+#include "freertos_command_pool.h"
+#include "freertos_command_pool_benchmark.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief What the producers do in a round.
+ */
+typedef enum BenchmarkMode
+{
+    BENCHMARK_MODE_POOL,   /**< @brief Obtain and release commands. */
+    BENCHMARK_MODE_PUBLISH /**< @brief Send QoS 0 PUBLISH commands to the agent. */
+} BenchmarkMode_t;
+
+/**
+ * @brief The state of one producer task.
+ */
+typedef struct BenchmarkProducer
+{
+    TaskHandle_t task;
+    uint32_t operations; /**< @brief Successful operations in the current round. */
+    uint32_t failures;   /**< @brief Operations that timed out in the current round. */
+} BenchmarkProducer_t;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The task that runs the rounds and reports the results.
+ */
+static void prvControllerTask( void * pvParameters );
+
+/**
+ * @brief A task that generates commands while a round is running.
+ */
+static void prvProducerTask( void * pvParameters );
+
+/**
+ * @brief Run one round with the first activeProducers producers.
+ */
+static void prvRunRound( BenchmarkMode_t mode,
+                         UBaseType_t activeProducers );
+
+/*-----------------------------------------------------------*/
+
+static BenchmarkProducer_t producers[ MQTT_COMMAND_POOL_BENCHMARK_PRODUCERS ];
+static TaskHandle_t controllerTask;
+static MQTTAgentContext_t * pBenchmarkAgentContext;
+static const char * pBenchmarkTopic;
+static volatile BenchmarkMode_t roundMode;
+static volatile BaseType_t roundRunning;
+
+/*-----------------------------------------------------------*/
+
+void Agent_StartCommandPoolBenchmark( MQTTAgentContext_t * pAgentContext,
+                                      const char * pTopic,
+                                      configSTACK_DEPTH_TYPE stackSize,
+                                      UBaseType_t priority )
+{
+    UBaseType_t i;
+    BaseType_t taskCreated;
+
+    configASSERT( pAgentContext != NULL );
+    configASSERT( pTopic != NULL );
+
+    pBenchmarkAgentContext = pAgentContext;
+    pBenchmarkTopic = pTopic;
+
+    for( i = 0; i < MQTT_COMMAND_POOL_BENCHMARK_PRODUCERS; i++ )
+    {
+        taskCreated = xTaskCreate( prvProducerTask,
+                                   "PoolBench",
+                                   stackSize,
+                                   &( producers[ i ] ),
+                                   priority,
+                                   &( producers[ i ].task ) );
+        configASSERT( taskCreated == pdPASS );
+    }
+
+    /* The controller runs above the producers so it can stop them. */
+    taskCreated = xTaskCreate( prvControllerTask,
+                               "PoolBenchCtl",
+                               stackSize,
+                               NULL,
+                               priority + 1U,
+                               &controllerTask );
+    configASSERT( taskCreated == pdPASS );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvControllerTask( void * pvParameters )
+{
+    UBaseType_t activeProducers;
+
+    ( void ) pvParameters;
+
+    for( activeProducers = 1U; activeProducers <= MQTT_COMMAND_POOL_BENCHMARK_PRODUCERS; activeProducers *= 2U )
+    {
+        prvRunRound( BENCHMARK_MODE_POOL, activeProducers );
+    }
+
+    for( activeProducers = 1U; activeProducers <= MQTT_COMMAND_POOL_BENCHMARK_PRODUCERS; activeProducers *= 2U )
+    {
+        prvRunRound( BENCHMARK_MODE_PUBLISH, activeProducers );
+    }
+
+    LogInfo( ( "Command pool benchmark done." ) );
+
+    vTaskDelete( NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvRunRound( BenchmarkMode_t mode,
+                         UBaseType_t activeProducers )
+{
+    UBaseType_t i;
+    uint32_t operations = 0U, failures = 0U;
+    AgentCommandPoolStats_t stats;
+
+    roundMode = mode;
+    roundRunning = pdTRUE;
+
+    for( i = 0; i < activeProducers; i++ )
+    {
+        producers[ i ].operations = 0U;
+        producers[ i ].failures = 0U;
+        xTaskNotifyGive( producers[ i ].task );
+    }
+
+    vTaskDelay( pdMS_TO_TICKS( MQTT_COMMAND_POOL_BENCHMARK_ROUND_MS ) );
+    roundRunning = pdFALSE;
+
+    /* Wait for every producer to finish its last operation. */
+    for( i = 0; i < activeProducers; i++ )
+    {
+        ( void ) ulTaskNotifyTake( pdFALSE, portMAX_DELAY );
+    }
+
+    for( i = 0; i < activeProducers; i++ )
+    {
+        operations += producers[ i ].operations;
+        failures += producers[ i ].failures;
+    }
+
+    Agent_GetCommandPoolStats( &stats );
+
+    LogInfo( ( "%s, %u producer(s): %u commands/s, %u timeouts, pool %u in use, high water %u/%u, %u exhaustions",
+               ( mode == BENCHMARK_MODE_POOL ) ? "Pool only" : "QoS 0 PUBLISH",
+               ( unsigned ) activeProducers,
+               ( unsigned ) ( ( ( uint64_t ) operations * 1000U ) / MQTT_COMMAND_POOL_BENCHMARK_ROUND_MS ),
+               ( unsigned ) failures,
+               ( unsigned ) stats.inUse,
+               ( unsigned ) stats.highWaterMark,
+               ( unsigned ) stats.poolSize,
+               ( unsigned ) stats.exhaustions ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvProducerTask( void * pvParameters )
+{
+    BenchmarkProducer_t * pProducer = ( BenchmarkProducer_t * ) pvParameters;
+    MQTTAgentCommand_t * pCommand;
+    MQTTPublishInfo_t publishInfo;
+    MQTTAgentCommandInfo_t commandInfo;
+    static const char payload[] = "command pool benchmark";
+
+    memset( &publishInfo, 0x00, sizeof( publishInfo ) );
+    publishInfo.qos = MQTTQoS0;
+    publishInfo.pTopicName = pBenchmarkTopic;
+    publishInfo.topicNameLength = ( uint16_t ) strlen( pBenchmarkTopic );
+    publishInfo.pPayload = payload;
+    publishInfo.payloadLength = sizeof( payload ) - 1U;
+
+    /* Without a callback, the agent releases a QoS 0 PUBLISH command as soon as
+     * it has been sent. */
+    memset( &commandInfo, 0x00, sizeof( commandInfo ) );
+    commandInfo.blockTimeMs = MQTT_COMMAND_POOL_BENCHMARK_BLOCK_MS;
+
+    for( ; ; )
+    {
+        /* Wait for the start of a round. */
+        ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+        while( roundRunning != pdFALSE )
+        {
+            if( roundMode == BENCHMARK_MODE_POOL )
+            {
+                pCommand = Agent_GetCommand( MQTT_COMMAND_POOL_BENCHMARK_BLOCK_MS );
+
+                if( pCommand != NULL )
+                {
+                    ( void ) Agent_ReleaseCommand( pCommand );
+                    pProducer->operations++;
+                }
+                else
+                {
+                    pProducer->failures++;
+                }
+            }
+            else
+            {
+                if( MQTTAgent_Publish( pBenchmarkAgentContext, &publishInfo, &commandInfo ) == MQTTSuccess )
+                {
+                    pProducer->operations++;
+                }
+                else
+                {
+                    pProducer->failures++;
+                }
+            }
+        }
+
+        xTaskNotifyGive( controllerTask );
+    }
+}
+
+/*-----------------------------------------------------------*/
@@ -27,6 +27,14 @@
 /**
  * @file freertos_agent_message.h
  * @brief Functions to interact with queues.
+ *
+ * A message context either wraps a FreeRTOS queue, set by the application, or
+ * a batched mailbox initialized with Agent_InitializeMailbox().  A mailbox is a
+ * ring of command pointers.  Senders only wake the agent task when it is
+ * waiting for a command, and the agent takes every pending command, up to
+ * MQTT_AGENT_MAILBOX_BATCH_LENGTH, each time it looks at the ring, then
+ * returns them from subsequent Agent_MessageReceive() calls without touching
+ * the ring or the kernel.  A mailbox must only be received from by one task.
  */
 #ifndef FREERTOS_AGENT_MESSAGE_H
 #define FREERTOS_AGENT_MESSAGE_H
@@ -39,9 +47,59 @@
 #include "FreeRTOS.h"
 #include "queue.h"
 
+#include "semphr.h"
+
 /* Include MQTT agent messaging interface. */
 #include "core_mqtt_agent_message_interface.h"
 
+/**
+ * @brief The most commands the agent takes out of a mailbox at a time.
+ */
+#ifndef MQTT_AGENT_MAILBOX_BATCH_LENGTH
+    #define MQTT_AGENT_MAILBOX_BATCH_LENGTH    ( 16U )
+#endif
+
+/**
+ * @brief What Agent_MessageSend() does when a mailbox is full.
+ */
+typedef enum AgentMailboxPolicy
+{
+    AgentMailboxBlock,     /**< @brief Wait up to the block time for space, as a queue does. */
+    AgentMailboxFail,      /**< @brief Fail at once, ignoring the block time. */
+    AgentMailboxDropOldest /**< @brief Drop the oldest command that the agent has not taken yet. */
+} AgentMailboxPolicy_t;
+
+/**
+ * @brief Called, in the context of the sending task, with each command
+ * dropped by the AgentMailboxDropOldest policy.  It must complete the
+ * command and return it to the pool.  If NULL, the command's completion
+ * callback is called with MQTTNoMemory and the command is given to
+ * Agent_ReleaseCommand().
+ */
+typedef void (* AgentMailboxDropCallback_t)( MQTTAgentCommand_t * pDroppedCommand );
+
+/**
+ * @brief The state of a batched mailbox.  The members are private to
+ * freertos_agent_message.c.
+ */
+typedef struct AgentMailbox
+{
+    MQTTAgentCommand_t ** pRing;      /**< @brief Storage for the pending commands. */
+    size_t length;                    /**< @brief The number of entries in pRing. */
+    size_t head;                      /**< @brief Where the next command is written. */
+    size_t count;                     /**< @brief The number of pending commands. */
+    AgentMailboxPolicy_t policy;
+    AgentMailboxDropCallback_t dropCallback;
+    SemaphoreHandle_t itemsAvailable; /**< @brief Given when the receiver is waiting and a command is sent. */
+    SemaphoreHandle_t spaceAvailable; /**< @brief Given when senders are waiting and commands are taken. */
+    volatile BaseType_t receiverWaiting;
+    volatile UBaseType_t sendersWaiting;
+    MQTTAgentCommand_t * batch[ MQTT_AGENT_MAILBOX_BATCH_LENGTH ]; /**< @brief Commands taken by the receiver. */
+    size_t batchCount;                /**< @brief The number of commands in batch. */
+    size_t batchIndex;                /**< @brief The next command in batch to return. */
+    volatile uint32_t droppedCommands;
+} AgentMailbox_t;
+
 /**
  * @ingroup mqtt_agent_struct_types
  * @brief Context with which tasks may deliver messages to the agent.
@@ -49,6 +107,7 @@
 struct MQTTAgentMessageContext
 {
     QueueHandle_t queue;
+    AgentMailbox_t * pMailbox; /**< @brief Used instead of queue if not NULL. */
 };
 
 /*-----------------------------------------------------------*/
@@ -81,4 +140,57 @@ bool Agent_MessageReceive( const MQTTAgentMessageContext_t * pMsgCtx,
                            MQTTAgentCommand_t ** pReceivedCommand,
                            uint32_t blockTimeMs );
 
+/**
+ * @brief Make pMsgCtx a batched mailbox.  Not thread safe.
+ *
+ * @param[in] pMsgCtx The message context to initialize.
+ * @param[in] pMailbox Storage for the state of the mailbox.
+ * @param[in] pRing Storage for length command pointers.
+ * @param[in] length The most commands the mailbox can hold.
+ * @param[in] policy What to do when a command is sent to a full mailbox.
+ * @param[in] dropCallback See #AgentMailboxDropCallback_t, may be NULL.
+ *
+ * @return `true` if the mailbox was initialized, `false` if its semaphores
+ * could not be created.
+ */
+bool Agent_InitializeMailbox( MQTTAgentMessageContext_t * pMsgCtx,
+                              AgentMailbox_t * pMailbox,
+                              MQTTAgentCommand_t ** pRing,
+                              size_t length,
+                              AgentMailboxPolicy_t policy,
+                              AgentMailboxDropCallback_t dropCallback );
+
+/**
+ * @brief Send several commands at once.  With a mailbox, the agent task is
+ * woken at most once for the whole batch.
+ *
+ * @param[in] pMsgCtx An #MQTTAgentMessageContext_t.
+ * @param[in] pCommandsToSend The commands to send.
+ * @param[in] commandCount The number of commands in pCommandsToSend.
+ * @param[in] blockTimeMs Block time to wait for space for each command.
+ *
+ * @return The number of commands sent, from the start of pCommandsToSend.
+ */
+size_t Agent_MessageSendBatch( const MQTTAgentMessageContext_t * pMsgCtx,
+                               MQTTAgentCommand_t * const * pCommandsToSend,
+                               size_t commandCount,
+                               uint32_t blockTimeMs );
+
+/**
+ * @brief Return the number of commands that were sent and have not been
+ * received yet.  Works for both a queue and a mailbox.  The count may be out
+ * of date by the time it is used if other tasks are sending or receiving.
+ *
+ * @param[in] pMsgCtx An #MQTTAgentMessageContext_t.
+ */
+size_t Agent_GetPendingCommandCount( const MQTTAgentMessageContext_t * pMsgCtx );
+
+/**
+ * @brief Return the number of commands a mailbox has dropped.
+ *
+ * @param[in] pMsgCtx An #MQTTAgentMessageContext_t initialized with
+ * Agent_InitializeMailbox().
+ */
+uint32_t Agent_GetMailboxDropCount( const MQTTAgentMessageContext_t * pMsgCtx );
+
 #endif /* FREERTOS_AGENT_MESSAGE_H */
@@ -34,6 +34,53 @@
 /* MQTT agent includes. */
 #include "core_mqtt_agent.h"
 
+/**
+ * @brief The number of commands each task can keep in its own cache, 0 to
+ * disable the caches.
+ *
+ * A task that registers a cache with Agent_RegisterCommandCache() keeps up to
+ * this many of the commands it releases for its own next calls to
+ * Agent_GetCommand(), so does not touch the shared free list at all while it
+ * has cached commands.  That only helps tasks that both obtain and release
+ * commands - commands sent to the MQTT agent are normally released by the
+ * agent task.
+ */
+#ifndef MQTT_COMMAND_POOL_CACHE_SIZE
+    #define MQTT_COMMAND_POOL_CACHE_SIZE    ( 0U )
+#endif
+
+/**
+ * @brief The thread local storage pointer in which a task's command cache is
+ * stored.  Only used if MQTT_COMMAND_POOL_CACHE_SIZE is not 0.
+ */
+#ifndef MQTT_COMMAND_POOL_CACHE_TLS_INDEX
+    #define MQTT_COMMAND_POOL_CACHE_TLS_INDEX    ( 0 )
+#endif
+
+/**
+ * @brief Statistics of the command pool, see Agent_GetCommandPoolStats().
+ */
+typedef struct AgentCommandPoolStats
+{
+    uint32_t poolSize;      /**< @brief MQTT_COMMAND_CONTEXTS_POOL_SIZE. */
+    uint32_t inUse;         /**< @brief Commands obtained and not yet released.  Commands kept in a task's cache are not counted. */
+    uint32_t highWaterMark; /**< @brief The most commands that have been in use at the same time. */
+    uint32_t exhaustions;   /**< @brief Calls to Agent_GetCommand() that found the pool empty. */
+    uint32_t timeouts;      /**< @brief Calls to Agent_GetCommand() that returned NULL. */
+} AgentCommandPoolStats_t;
+
+#if ( MQTT_COMMAND_POOL_CACHE_SIZE > 0U )
+
+/**
+ * @brief A task's own cache of free commands.
+ */
+    typedef struct AgentCommandCache
+    {
+        uint16_t count;                                   /**< @brief The number of commands in the cache. */
+        uint16_t indices[ MQTT_COMMAND_POOL_CACHE_SIZE ]; /**< @brief The pool indices of the cached commands. */
+    } AgentCommandCache_t;
+#endif
+
 /**
  * @brief Initialize the common task pool. Not thread safe.
  */
@@ -80,4 +127,29 @@ MQTTAgentCommand_t * Agent_GetCommand( uint32_t blockTimeMs );
  */
 bool Agent_ReleaseCommand( MQTTAgentCommand_t * pCommandToRelease );
 
+/**
+ * @brief Get a snapshot of the statistics of the command pool.
+ *
+ * @param[out] pStats Set to the current statistics.
+ */
+void Agent_GetCommandPoolStats( AgentCommandPoolStats_t * pStats );
+
+#if ( MQTT_COMMAND_POOL_CACHE_SIZE > 0U )
+
+/**
+ * @brief Give the calling task a cache of free commands.
+ *
+ * @param[in] pCache The cache, which must remain valid until the task calls
+ * Agent_UnregisterCommandCache().  Only the calling task accesses it.
+ */
+    void Agent_RegisterCommandCache( AgentCommandCache_t * pCache );
+
+/**
+ * @brief Return the commands in the calling task's cache to the pool, and stop
+ * using the cache.  Must be called before a task that registered a cache is
+ * deleted.
+ */
+    void Agent_UnregisterCommandCache( void );
+#endif
+
 #endif /* FREERTOS_COMMAND_POOL_H */
@@ -0,0 +1,85 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file freertos_command_pool_benchmark.h
+ * @brief Measures how many commands per second tasks can obtain from the
+ * command pool, and how many PUBLISH commands they can send to the MQTT agent.
+ */
+#ifndef FREERTOS_COMMAND_POOL_BENCHMARK_H
+#define FREERTOS_COMMAND_POOL_BENCHMARK_H
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/* MQTT agent includes. */
+#include "core_mqtt_agent.h"
+
+/**
+ * @brief The most producer tasks used by the benchmark.  Rounds are run with
+ * 1, 2, 4, ... producers up to this number.
+ */
+#ifndef MQTT_COMMAND_POOL_BENCHMARK_PRODUCERS
+    #define MQTT_COMMAND_POOL_BENCHMARK_PRODUCERS    ( 4U )
+#endif
+
+/**
+ * @brief The length of each round of the benchmark.
+ */
+#ifndef MQTT_COMMAND_POOL_BENCHMARK_ROUND_MS
+    #define MQTT_COMMAND_POOL_BENCHMARK_ROUND_MS    ( 5000U )
+#endif
+
+/**
+ * @brief The time a producer waits for a command, or for space in the agent's
+ * command queue, before counting a failure.
+ */
+#ifndef MQTT_COMMAND_POOL_BENCHMARK_BLOCK_MS
+    #define MQTT_COMMAND_POOL_BENCHMARK_BLOCK_MS    ( 100U )
+#endif
+
+/**
+ * @brief Start the benchmark.
+ *
+ * The benchmark first runs rounds in which the producers only obtain and
+ * release commands, which measures the pool on its own, then rounds in which
+ * the producers send QoS 0 PUBLISH commands to pTopic through the agent, as
+ * fast as the agent accepts them.  The results, and the pool statistics, are
+ * logged at the end of each round.  The agent must be running and connected
+ * before the PUBLISH rounds start.
+ *
+ * @param[in] pAgentContext The MQTT agent to send the PUBLISH commands to.
+ * @param[in] pTopic The topic to publish to.  Must remain valid.
+ * @param[in] stackSize The stack size of each task created by the benchmark.
+ * @param[in] priority The priority of the producers.  Should be below the
+ * priority of the agent task.
+ */
+void Agent_StartCommandPoolBenchmark( MQTTAgentContext_t * pAgentContext,
+                                      const char * pTopic,
+                                      configSTACK_DEPTH_TYPE stackSize,
+                                      UBaseType_t priority );
+
+#endif /* FREERTOS_COMMAND_POOL_BENCHMARK_H */
@@ -62,6 +62,38 @@
 /* Local includes. */
 #include "console.h"
 
+/* Set mainUSE_ASYNC_LOGGING to 1 (the Makefile does this when ASYNC_LOGGING=1)
+ * to send vLoggingPrintf() output through the lock free ring buffer in
+ * Demo/Common/Logging/async instead of calling vprintf() from the task that
+ * logs. */
+#ifndef mainUSE_ASYNC_LOGGING
+    #define mainUSE_ASYNC_LOGGING    0
+#endif
+
+/* Set mainUSE_BUFFERED_LOGGING to 1 (the Makefile does this when
+ * BUFFERED_LOGGING=1) to use Demo/Common/Logging/linux, which buffers
+ * vLoggingPrintf() output for a Linux thread to write out. */
+#ifndef mainUSE_BUFFERED_LOGGING
+    #define mainUSE_BUFFERED_LOGGING    0
+#endif
+
+#if ( mainUSE_ASYNC_LOGGING == 1 ) && ( mainUSE_BUFFERED_LOGGING == 1 )
+    #error Only one of mainUSE_ASYNC_LOGGING and mainUSE_BUFFERED_LOGGING can be set
+#endif
+
+#if ( mainUSE_ASYNC_LOGGING == 1 )
+
+/* The Makefile also includes logging_async.h ahead of everything else, so the
+ * LogInfo() etc. macros write one record per call in every file. */
+    #include "logging_levels.h"
+    #define LIBRARY_LOG_NAME     "PosixDemo"
+    #define LIBRARY_LOG_LEVEL    LOG_INFO
+    #include "logging_async.h"
+    #include "logging_stack.h"
+#elif ( mainUSE_BUFFERED_LOGGING == 1 )
+    #include "logging.h"
+#endif
+
 #include <trcRecorder.h>
 
 #define    ECHO_CLIENT_DEMO         0
@@ -90,6 +122,15 @@ void vApplicationTickHook( void );
  */
 static void prvSaveTraceFile( void );
 
+#if ( mainUSE_ASYNC_LOGGING == 1 )
+
+/*
+ * Called by the asynchronous logging drain task to output each record.
+ */
+    static void prvWriteLogRecord( const char * pcRecord,
+                                   size_t xLength );
+#endif
+
 /*-----------------------------------------------------------*/
 
 /* When configSUPPORT_STATIC_ALLOCATION is set to 1 the application writer can
@@ -126,6 +167,22 @@ int main( void )
     #endif
 
     console_init();
+
+    #if ( mainUSE_ASYNC_LOGGING == 1 )
+    {
+        /* The drain task only runs when it has something to write, so can run
+         * just above the idle task, which sleeps on every iteration. */
+        xLoggingAsyncInit( prvWriteLogRecord, tskIDLE_PRIORITY + 1, configMINIMAL_STACK_SIZE * 2 );
+        LogInfo( ( "Asynchronous logging started, %u records per ring buffer.",
+                   ( unsigned ) loggingASYNC_RING_LENGTH ) );
+    }
+    #elif ( mainUSE_BUFFERED_LOGGING == 1 )
+    {
+        /* Log to stdout only. */
+        vLoggingInit( pdTRUE, pdFALSE, pdFALSE, 0U, 0U );
+    }
+    #endif
+
     #if ( mainSELECTED_APPLICATION == ECHO_CLIENT_DEMO )
     {
         console_print( "Starting echo client demo\n" );
@@ -231,15 +288,28 @@ void traceOnEnter()
     }
 }
 
-void vLoggingPrintf( const char * pcFormat,
-                     ... )
-{
-    va_list arg;
+#if ( mainUSE_ASYNC_LOGGING == 1 )
 
-    va_start( arg, pcFormat );
-    vprintf( pcFormat, arg );
-    va_end( arg );
-}
+    static void prvWriteLogRecord( const char * pcRecord,
+                                   size_t xLength )
+    {
+        ( void ) fwrite( pcRecord, 1, xLength, stdout );
+        ( void ) fflush( stdout );
+    }
+
+#elif ( mainUSE_BUFFERED_LOGGING == 0 )
+
+    void vLoggingPrintf( const char * pcFormat,
+                         ... )
+    {
+        va_list arg;
+
+        va_start( arg, pcFormat );
+        vprintf( pcFormat, arg );
+        va_end( arg );
+    }
+
+#endif /* if ( mainUSE_ASYNC_LOGGING == 1 ) */
 /*-----------------------------------------------------------*/
 
 void vApplicationDaemonTaskStartupHook( void )
@@ -0,0 +1,87 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file benchmark_client.h
+ * @brief Client ends of the transport benchmarks. Each transport is wrapped in
+ * its own file because transport_wolfSSL.h defines struct NetworkContext, while
+ * the plaintext and mbedTLS transports expect their user to define it.
+ */
+
+#ifndef BENCHMARK_CLIENT_H
+#define BENCHMARK_CLIENT_H
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/* Transport interface include. */
+#include "transport_interface.h"
+
+/**
+ * @brief Send and receive timeout of both ends of the benchmark connections.
+ * A call that times out returns 0 and is retried; a peer that disconnects is
+ * reported as an error, which ends the connection.
+ */
+#define benchmarkSOCKET_TIMEOUT_MS    ( 1000U )
+
+/**
+ * @brief Connect the plaintext transport to the loopback benchmark server.
+ *
+ * @param[in] usPort The port the server is listening on.
+ * @param[out] pxTransport Filled with the send and receive functions and the
+ * network context of the connection.
+ *
+ * @return pdPASS on success, otherwise pdFAIL.
+ */
+BaseType_t xBenchmarkPlaintextConnect( uint16_t usPort,
+                                       TransportInterface_t * pxTransport );
+
+/**
+ * @brief Disconnect a connection made with xBenchmarkPlaintextConnect().
+ */
+void vBenchmarkPlaintextDisconnect( TransportInterface_t * pxTransport );
+
+/**
+ * @brief Connect the TLS transport to the loopback benchmark server.
+ *
+ * The cipher suite is chosen by the server, which only offers the one under
+ * test.
+ *
+ * @param[in] usPort The port the server is listening on.
+ * @param[out] pxTransport Filled with the send and receive functions and the
+ * network context of the connection.
+ *
+ * @return pdPASS on success, otherwise pdFAIL.
+ */
+BaseType_t xBenchmarkTlsConnect( uint16_t usPort,
+                                 TransportInterface_t * pxTransport );
+
+/**
+ * @brief Disconnect a connection made with xBenchmarkTlsConnect().
+ */
+void vBenchmarkTlsDisconnect( TransportInterface_t * pxTransport );
+
+#endif /* ifndef BENCHMARK_CLIENT_H */
@@ -0,0 +1,90 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file benchmark_client_plaintext.c
+ * @brief Plaintext client end of the transport benchmarks.
+ */
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/* Transport includes. */
+#include "transport_plaintext.h"
+
+/* Benchmark includes. */
+#include "benchmark_client.h"
+#include "benchmark_credentials.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Each compilation unit that consumes the NetworkContext must define it.
+ */
+struct NetworkContext
+{
+    PlaintextTransportParams_t * pParams;
+};
+
+/*-----------------------------------------------------------*/
+
+/* The benchmark only has one connection open at a time. */
+static PlaintextTransportParams_t xPlaintextParams;
+static NetworkContext_t xNetworkContext = { &xPlaintextParams };
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xBenchmarkPlaintextConnect( uint16_t usPort,
+                                       TransportInterface_t * pxTransport )
+{
+    BaseType_t xResult = pdFAIL;
+
+    configASSERT( pxTransport != NULL );
+
+    if( Plaintext_FreeRTOS_Connect( &xNetworkContext,
+                                    benchmarkSERVER_HOST_NAME,
+                                    usPort,
+                                    benchmarkSOCKET_TIMEOUT_MS,
+                                    benchmarkSOCKET_TIMEOUT_MS ) == PLAINTEXT_TRANSPORT_SUCCESS )
+    {
+        pxTransport->pNetworkContext = &xNetworkContext;
+        pxTransport->send = Plaintext_FreeRTOS_send;
+        pxTransport->recv = Plaintext_FreeRTOS_recv;
+        pxTransport->writev = NULL;
+        xResult = pdPASS;
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+void vBenchmarkPlaintextDisconnect( TransportInterface_t * pxTransport )
+{
+    configASSERT( pxTransport != NULL );
+
+    ( void ) Plaintext_FreeRTOS_Disconnect( pxTransport->pNetworkContext );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,93 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file benchmark_client_wolfssl.c
+ * @brief wolfSSL client end of the transport benchmarks.
+ */
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/* Transport includes. */
+#include "transport_wolfSSL.h"
+
+/* Benchmark includes. */
+#include "benchmark_client.h"
+#include "benchmark_credentials.h"
+
+/*-----------------------------------------------------------*/
+
+/* The benchmark only has one connection open at a time. transport_wolfSSL.h
+ * defines struct NetworkContext itself. */
+static NetworkContext_t xNetworkContext;
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xBenchmarkTlsConnect( uint16_t usPort,
+                                 TransportInterface_t * pxTransport )
+{
+    NetworkCredentials_t xCredentials = { 0 };
+    BaseType_t xResult = pdFAIL;
+
+    configASSERT( pxTransport != NULL );
+
+    /* The server certificate is self-signed, so it is also the root CA. The
+     * transport always loads a client certificate; the server does not ask
+     * for it, so the server's own pair is reused. */
+    xCredentials.disableSni = pdTRUE;
+    xCredentials.pRootCa = ( const unsigned char * ) benchmarkCERTIFICATE_PEM;
+    xCredentials.rootCaSize = sizeof( benchmarkCERTIFICATE_PEM ) - 1U;
+    xCredentials.pClientCert = ( const unsigned char * ) benchmarkCERTIFICATE_PEM;
+    xCredentials.clientCertSize = sizeof( benchmarkCERTIFICATE_PEM ) - 1U;
+    xCredentials.pPrivateKey = ( const unsigned char * ) benchmarkPRIVATE_KEY_PEM;
+    xCredentials.privateKeySize = sizeof( benchmarkPRIVATE_KEY_PEM ) - 1U;
+
+    if( TLS_FreeRTOS_Connect( &xNetworkContext,
+                              benchmarkSERVER_HOST_NAME,
+                              usPort,
+                              &xCredentials,
+                              benchmarkSOCKET_TIMEOUT_MS,
+                              benchmarkSOCKET_TIMEOUT_MS ) == TLS_TRANSPORT_SUCCESS )
+    {
+        pxTransport->pNetworkContext = &xNetworkContext;
+        pxTransport->send = TLS_FreeRTOS_send;
+        pxTransport->recv = TLS_FreeRTOS_recv;
+        pxTransport->writev = NULL;
+        xResult = pdPASS;
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+void vBenchmarkTlsDisconnect( TransportInterface_t * pxTransport )
+{
+    configASSERT( pxTransport != NULL );
+
+    TLS_FreeRTOS_Disconnect( pxTransport->pNetworkContext );
+}
+/*-----------------------------------------------------------*/
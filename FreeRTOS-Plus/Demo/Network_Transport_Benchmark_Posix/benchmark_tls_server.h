@@ -0,0 +1,101 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file benchmark_tls_server.h
+ * @brief Server end of the TLS benchmarks. The implementation used is chosen
+ * at build time to match the TLS library of the transport under test.
+ */
+
+#ifndef BENCHMARK_TLS_SERVER_H
+#define BENCHMARK_TLS_SERVER_H
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/* TCP Sockets Wrapper include.*/
+#include "tcp_sockets_wrapper.h"
+
+/**
+ * @brief Name of the TLS library the server is built against.
+ */
+extern const char * const pcBenchmarkTlsLibrary;
+
+/**
+ * @brief Cipher suites the benchmark iterates over, in the TLS library's own
+ * naming convention.
+ */
+extern const char * const pcBenchmarkCipherSuites[];
+
+/**
+ * @brief Number of entries in #pcBenchmarkCipherSuites.
+ */
+extern const UBaseType_t uxBenchmarkCipherSuiteCount;
+
+/**
+ * @brief Perform the server side of a TLS handshake on an accepted socket,
+ * only offering a single cipher suite.
+ *
+ * @param[in] xSocket The accepted loopback socket.
+ * @param[in] uxCipherSuite Index into #pcBenchmarkCipherSuites.
+ * @param[out] ppvSession Set to the new TLS session on success.
+ *
+ * @return pdPASS if the handshake completed, otherwise pdFAIL.
+ */
+BaseType_t xBenchmarkTlsServerAccept( Socket_t xSocket,
+                                      UBaseType_t uxCipherSuite,
+                                      void ** ppvSession );
+
+/**
+ * @brief Read decrypted application data from a server session.
+ *
+ * @return Bytes read, 0 if the read should be retried, negative on error or
+ * when the client closed the connection.
+ */
+int32_t lBenchmarkTlsServerRecv( void * pvSession,
+                                 void * pvBuffer,
+                                 size_t xBufferLength );
+
+/**
+ * @brief Encrypt and send application data on a server session.
+ *
+ * @return Bytes sent, 0 if the write should be retried, negative on error.
+ */
+int32_t lBenchmarkTlsServerSend( void * pvSession,
+                                 const void * pvBuffer,
+                                 size_t xDataLength );
+
+/**
+ * @brief Free a server session. The socket is not closed.
+ */
+void vBenchmarkTlsServerClose( void * pvSession );
+
+/**
+ * @brief Name of the cipher suite negotiated on a session, for reporting.
+ */
+const char * pcBenchmarkTlsServerCipherSuite( void * pvSession );
+
+#endif /* ifndef BENCHMARK_TLS_SERVER_H */
@@ -0,0 +1,296 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file benchmark_tls_server_mbedtls.c
+ * @brief mbedTLS server end of the TLS benchmarks.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/* MbedTLS includes. */
+#if !defined( MBEDTLS_CONFIG_FILE )
+    #include "mbedtls/mbedtls_config.h"
+#else
+    #include MBEDTLS_CONFIG_FILE
+#endif
+
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/ssl.h"
+#include "mbedtls/x509_crt.h"
+
+#ifdef MBEDTLS_PSA_CRYPTO_C
+    #include "psa/crypto.h"
+#endif
+
+/* MBedTLS Bio TCP sockets wrapper include. */
+#include "mbedtls_bio_tcp_sockets_wrapper.h"
+
+/* Benchmark includes. */
+#include "benchmark_credentials.h"
+#include "benchmark_tls_server.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief State of one server side TLS session.
+ */
+typedef struct BenchmarkServerSession
+{
+    mbedtls_ssl_config xConfig;
+    mbedtls_ssl_context xContext;
+    mbedtls_x509_crt xCertificate;
+    mbedtls_pk_context xPrivateKey;
+    mbedtls_entropy_context xEntropy;
+    mbedtls_ctr_drbg_context xCtrDrbg;
+    int xCipherSuites[ 2 ]; /* The single offered suite and a 0 terminator. */
+} BenchmarkServerSession_t;
+
+/*-----------------------------------------------------------*/
+
+const char * const pcBenchmarkTlsLibrary = "mbedTLS";
+
+const char * const pcBenchmarkCipherSuites[] =
+{
+    "TLS-ECDHE-ECDSA-WITH-AES-128-GCM-SHA256",
+    "TLS-ECDHE-ECDSA-WITH-AES-256-GCM-SHA384",
+    "TLS-ECDHE-ECDSA-WITH-CHACHA20-POLY1305-SHA256",
+    "TLS-ECDHE-ECDSA-WITH-AES-128-CBC-SHA256"
+};
+
+const UBaseType_t uxBenchmarkCipherSuiteCount = sizeof( pcBenchmarkCipherSuites ) / sizeof( pcBenchmarkCipherSuites[ 0 ] );
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xBenchmarkTlsServerAccept( Socket_t xSocket,
+                                      UBaseType_t uxCipherSuite,
+                                      void ** ppvSession )
+{
+    BenchmarkServerSession_t * pxSession = NULL;
+    int lResult = 0;
+
+    configASSERT( ppvSession != NULL );
+    configASSERT( uxCipherSuite < uxBenchmarkCipherSuiteCount );
+
+    pxSession = pvPortMalloc( sizeof( BenchmarkServerSession_t ) );
+
+    if( pxSession == NULL )
+    {
+        lResult = -1;
+    }
+    else
+    {
+        mbedtls_ssl_config_init( &( pxSession->xConfig ) );
+        mbedtls_ssl_init( &( pxSession->xContext ) );
+        mbedtls_x509_crt_init( &( pxSession->xCertificate ) );
+        mbedtls_pk_init( &( pxSession->xPrivateKey ) );
+        mbedtls_entropy_init( &( pxSession->xEntropy ) );
+        mbedtls_ctr_drbg_init( &( pxSession->xCtrDrbg ) );
+
+        #ifdef MBEDTLS_PSA_CRYPTO_C
+            /* Calling this more than once is harmless. */
+            lResult = ( int ) psa_crypto_init();
+        #endif
+    }
+
+    if( lResult == 0 )
+    {
+        lResult = mbedtls_ctr_drbg_seed( &( pxSession->xCtrDrbg ),
+                                         mbedtls_entropy_func,
+                                         &( pxSession->xEntropy ),
+                                         NULL,
+                                         0 );
+    }
+
+    if( lResult == 0 )
+    {
+        /* The PEM parsers require the terminating NULL in the length. */
+        lResult = mbedtls_x509_crt_parse( &( pxSession->xCertificate ),
+                                          ( const unsigned char * ) benchmarkCERTIFICATE_PEM,
+                                          sizeof( benchmarkCERTIFICATE_PEM ) );
+    }
+
+    if( lResult == 0 )
+    {
+        #if MBEDTLS_VERSION_NUMBER < 0x03000000
+            lResult = mbedtls_pk_parse_key( &( pxSession->xPrivateKey ),
+                                            ( const unsigned char * ) benchmarkPRIVATE_KEY_PEM,
+                                            sizeof( benchmarkPRIVATE_KEY_PEM ),
+                                            NULL, 0 );
+        #else
+            lResult = mbedtls_pk_parse_key( &( pxSession->xPrivateKey ),
+                                            ( const unsigned char * ) benchmarkPRIVATE_KEY_PEM,
+                                            sizeof( benchmarkPRIVATE_KEY_PEM ),
+                                            NULL, 0,
+                                            mbedtls_ctr_drbg_random,
+                                            &( pxSession->xCtrDrbg ) );
+        #endif
+    }
+
+    if( lResult == 0 )
+    {
+        lResult = mbedtls_ssl_config_defaults( &( pxSession->xConfig ),
+                                               MBEDTLS_SSL_IS_SERVER,
+                                               MBEDTLS_SSL_TRANSPORT_STREAM,
+                                               MBEDTLS_SSL_PRESET_DEFAULT );
+    }
+
+    if( lResult == 0 )
+    {
+        /* Only offer the suite under test so the client has to negotiate it. */
+        pxSession->xCipherSuites[ 0 ] = mbedtls_ssl_get_ciphersuite_id( pcBenchmarkCipherSuites[ uxCipherSuite ] );
+        pxSession->xCipherSuites[ 1 ] = 0;
+
+        mbedtls_ssl_conf_ciphersuites( &( pxSession->xConfig ), pxSession->xCipherSuites );
+        mbedtls_ssl_conf_rng( &( pxSession->xConfig ), mbedtls_ctr_drbg_random, &( pxSession->xCtrDrbg ) );
+        mbedtls_ssl_conf_authmode( &( pxSession->xConfig ), MBEDTLS_SSL_VERIFY_NONE );
+
+        #if MBEDTLS_VERSION_NUMBER >= 0x03000000
+            /* The suites under test are TLS 1.2 suites; stop the client and
+             * server agreeing on TLS 1.3 instead. */
+            mbedtls_ssl_conf_max_tls_version( &( pxSession->xConfig ), MBEDTLS_SSL_VERSION_TLS1_2 );
+        #endif
+
+        lResult = mbedtls_ssl_conf_own_cert( &( pxSession->xConfig ),
+                                             &( pxSession->xCertificate ),
+                                             &( pxSession->xPrivateKey ) );
+    }
+
+    if( lResult == 0 )
+    {
+        lResult = mbedtls_ssl_setup( &( pxSession->xContext ), &( pxSession->xConfig ) );
+    }
+
+    if( lResult == 0 )
+    {
+        mbedtls_ssl_set_bio( &( pxSession->xContext ),
+                             ( void * ) xSocket,
+                             xMbedTLSBioTCPSocketsWrapperSend,
+                             xMbedTLSBioTCPSocketsWrapperRecv,
+                             NULL );
+
+        do
+        {
+            lResult = mbedtls_ssl_handshake( &( pxSession->xContext ) );
+        } while( ( lResult == MBEDTLS_ERR_SSL_WANT_READ ) ||
+                 ( lResult == MBEDTLS_ERR_SSL_WANT_WRITE ) );
+    }
+
+    if( lResult == 0 )
+    {
+        *ppvSession = pxSession;
+    }
+    else if( pxSession != NULL )
+    {
+        vBenchmarkTlsServerClose( pxSession );
+    }
+    else
+    {
+        /* Nothing was allocated. */
+    }
+
+    return ( lResult == 0 ) ? pdPASS : pdFAIL;
+}
+/*-----------------------------------------------------------*/
+
+int32_t lBenchmarkTlsServerRecv( void * pvSession,
+                                 void * pvBuffer,
+                                 size_t xBufferLength )
+{
+    BenchmarkServerSession_t * pxSession = ( BenchmarkServerSession_t * ) pvSession;
+    int lResult;
+
+    lResult = mbedtls_ssl_read( &( pxSession->xContext ), pvBuffer, xBufferLength );
+
+    if( ( lResult == MBEDTLS_ERR_SSL_WANT_READ ) ||
+        ( lResult == MBEDTLS_ERR_SSL_WANT_WRITE ) ||
+        ( lResult == MBEDTLS_ERR_SSL_TIMEOUT ) )
+    {
+        lResult = 0;
+    }
+    else if( lResult == 0 )
+    {
+        /* The underlying connection was closed. */
+        lResult = -1;
+    }
+    else
+    {
+        /* Bytes read, or an error such as the peer's close-notify. */
+    }
+
+    return ( int32_t ) lResult;
+}
+/*-----------------------------------------------------------*/
+
+int32_t lBenchmarkTlsServerSend( void * pvSession,
+                                 const void * pvBuffer,
+                                 size_t xDataLength )
+{
+    BenchmarkServerSession_t * pxSession = ( BenchmarkServerSession_t * ) pvSession;
+    int lResult;
+
+    lResult = mbedtls_ssl_write( &( pxSession->xContext ), pvBuffer, xDataLength );
+
+    if( ( lResult == MBEDTLS_ERR_SSL_WANT_READ ) ||
+        ( lResult == MBEDTLS_ERR_SSL_WANT_WRITE ) ||
+        ( lResult == MBEDTLS_ERR_SSL_TIMEOUT ) )
+    {
+        lResult = 0;
+    }
+
+    return ( int32_t ) lResult;
+}
+/*-----------------------------------------------------------*/
+
+void vBenchmarkTlsServerClose( void * pvSession )
+{
+    BenchmarkServerSession_t * pxSession = ( BenchmarkServerSession_t * ) pvSession;
+
+    if( pxSession != NULL )
+    {
+        mbedtls_ssl_free( &( pxSession->xContext ) );
+        mbedtls_ssl_config_free( &( pxSession->xConfig ) );
+        mbedtls_x509_crt_free( &( pxSession->xCertificate ) );
+        mbedtls_pk_free( &( pxSession->xPrivateKey ) );
+        mbedtls_ctr_drbg_free( &( pxSession->xCtrDrbg ) );
+        mbedtls_entropy_free( &( pxSession->xEntropy ) );
+        vPortFree( pxSession );
+    }
+}
+/*-----------------------------------------------------------*/
+
+const char * pcBenchmarkTlsServerCipherSuite( void * pvSession )
+{
+    BenchmarkServerSession_t * pxSession = ( BenchmarkServerSession_t * ) pvSession;
+
+    return mbedtls_ssl_get_ciphersuite( &( pxSession->xContext ) );
+}
+/*-----------------------------------------------------------*/
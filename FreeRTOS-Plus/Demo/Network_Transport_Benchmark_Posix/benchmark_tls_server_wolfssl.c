@@ -0,0 +1,316 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file benchmark_tls_server_wolfssl.c
+ * @brief wolfSSL server end of the TLS benchmarks.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/* wolfSSL includes. */
+#include "user_settings.h"
+#include "wolfssl/ssl.h"
+
+/* Benchmark includes. */
+#include "benchmark_credentials.h"
+#include "benchmark_tls_server.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief State of one server side TLS session.
+ */
+typedef struct BenchmarkServerSession
+{
+    WOLFSSL_CTX * pxContext;
+    WOLFSSL * pxSsl;
+} BenchmarkServerSession_t;
+
+/*-----------------------------------------------------------*/
+
+const char * const pcBenchmarkTlsLibrary = "wolfSSL";
+
+const char * const pcBenchmarkCipherSuites[] =
+{
+    "ECDHE-ECDSA-AES128-GCM-SHA256",
+    "ECDHE-ECDSA-AES256-GCM-SHA384",
+    "ECDHE-ECDSA-CHACHA20-POLY1305",
+    "ECDHE-ECDSA-AES128-SHA256"
+};
+
+const UBaseType_t uxBenchmarkCipherSuiteCount = sizeof( pcBenchmarkCipherSuites ) / sizeof( pcBenchmarkCipherSuites[ 0 ] );
+
+/*-----------------------------------------------------------*/
+
+/*
+ * wolfSSL I/O callbacks on top of the TCP sockets wrapper. They mirror the
+ * glue in transport_wolfSSL.c, which is private to that file.
+ */
+static int prvIORecv( WOLFSSL * pxSsl,
+                      char * pcBuffer,
+                      int lSize,
+                      void * pvContext );
+static int prvIOSend( WOLFSSL * pxSsl,
+                      char * pcBuffer,
+                      int lSize,
+                      void * pvContext );
+
+/*-----------------------------------------------------------*/
+
+static int prvIORecv( WOLFSSL * pxSsl,
+                      char * pcBuffer,
+                      int lSize,
+                      void * pvContext )
+{
+    int32_t lRead = TCP_Sockets_Recv( ( Socket_t ) pvContext, pcBuffer, ( size_t ) lSize );
+
+    ( void ) pxSsl;
+
+    if( ( lRead == 0 ) || ( lRead == TCP_SOCKETS_ERRNO_EWOULDBLOCK ) )
+    {
+        lRead = WOLFSSL_CBIO_ERR_WANT_READ;
+    }
+    else if( lRead == TCP_SOCKETS_ERRNO_ENOTCONN )
+    {
+        lRead = WOLFSSL_CBIO_ERR_CONN_CLOSE;
+    }
+    else if( lRead < 0 )
+    {
+        lRead = WOLFSSL_CBIO_ERR_GENERAL;
+    }
+    else
+    {
+        /* Bytes were read. */
+    }
+
+    return ( int ) lRead;
+}
+/*-----------------------------------------------------------*/
+
+static int prvIOSend( WOLFSSL * pxSsl,
+                      char * pcBuffer,
+                      int lSize,
+                      void * pvContext )
+{
+    int32_t lSent = TCP_Sockets_Send( ( Socket_t ) pvContext, pcBuffer, ( size_t ) lSize );
+
+    ( void ) pxSsl;
+
+    if( ( lSent == 0 ) ||
+        ( lSent == TCP_SOCKETS_ERRNO_EWOULDBLOCK ) ||
+        ( lSent == TCP_SOCKETS_ERRNO_ENOSPC ) )
+    {
+        lSent = WOLFSSL_CBIO_ERR_WANT_WRITE;
+    }
+    else if( lSent == TCP_SOCKETS_ERRNO_ENOTCONN )
+    {
+        lSent = WOLFSSL_CBIO_ERR_CONN_CLOSE;
+    }
+    else if( lSent < 0 )
+    {
+        lSent = WOLFSSL_CBIO_ERR_GENERAL;
+    }
+    else
+    {
+        /* Bytes were sent. */
+    }
+
+    return ( int ) lSent;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xBenchmarkTlsServerAccept( Socket_t xSocket,
+                                      UBaseType_t uxCipherSuite,
+                                      void ** ppvSession )
+{
+    BenchmarkServerSession_t * pxSession = NULL;
+    BaseType_t xResult = pdPASS;
+    int lStatus;
+
+    configASSERT( ppvSession != NULL );
+    configASSERT( uxCipherSuite < uxBenchmarkCipherSuiteCount );
+
+    /* wolfSSL reference counts initialisation, so this is safe per session. */
+    ( void ) wolfSSL_Init();
+
+    pxSession = pvPortMalloc( sizeof( BenchmarkServerSession_t ) );
+
+    if( pxSession == NULL )
+    {
+        xResult = pdFAIL;
+    }
+    else
+    {
+        pxSession->pxSsl = NULL;
+        pxSession->pxContext = wolfSSL_CTX_new( wolfTLSv1_2_server_method() );
+
+        if( pxSession->pxContext == NULL )
+        {
+            xResult = pdFAIL;
+        }
+    }
+
+    if( xResult == pdPASS )
+    {
+        /* Only offer the suite under test so the client has to negotiate it. */
+        if( ( wolfSSL_CTX_use_certificate_buffer( pxSession->pxContext,
+                                                  ( const unsigned char * ) benchmarkCERTIFICATE_PEM,
+                                                  ( long ) sizeof( benchmarkCERTIFICATE_PEM ) - 1,
+                                                  SSL_FILETYPE_PEM ) != SSL_SUCCESS ) ||
+            ( wolfSSL_CTX_use_PrivateKey_buffer( pxSession->pxContext,
+                                                 ( const unsigned char * ) benchmarkPRIVATE_KEY_PEM,
+                                                 ( long ) sizeof( benchmarkPRIVATE_KEY_PEM ) - 1,
+                                                 SSL_FILETYPE_PEM ) != SSL_SUCCESS ) ||
+            ( wolfSSL_CTX_set_cipher_list( pxSession->pxContext,
+                                           pcBenchmarkCipherSuites[ uxCipherSuite ] ) != SSL_SUCCESS ) )
+        {
+            xResult = pdFAIL;
+        }
+    }
+
+    if( xResult == pdPASS )
+    {
+        wolfSSL_SetIORecv( pxSession->pxContext, prvIORecv );
+        wolfSSL_SetIOSend( pxSession->pxContext, prvIOSend );
+
+        pxSession->pxSsl = wolfSSL_new( pxSession->pxContext );
+
+        if( pxSession->pxSsl == NULL )
+        {
+            xResult = pdFAIL;
+        }
+    }
+
+    if( xResult == pdPASS )
+    {
+        wolfSSL_SetIOReadCtx( pxSession->pxSsl, ( void * ) xSocket );
+        wolfSSL_SetIOWriteCtx( pxSession->pxSsl, ( void * ) xSocket );
+
+        do
+        {
+            lStatus = wolfSSL_accept( pxSession->pxSsl );
+
+            if( lStatus == SSL_SUCCESS )
+            {
+                break;
+            }
+
+            lStatus = wolfSSL_get_error( pxSession->pxSsl, lStatus );
+        } while( ( lStatus == SSL_ERROR_WANT_READ ) ||
+                 ( lStatus == SSL_ERROR_WANT_WRITE ) );
+
+        if( lStatus != SSL_SUCCESS )
+        {
+            xResult = pdFAIL;
+        }
+    }
+
+    if( xResult == pdPASS )
+    {
+        *ppvSession = pxSession;
+    }
+    else
+    {
+        vBenchmarkTlsServerClose( pxSession );
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+int32_t lBenchmarkTlsServerRecv( void * pvSession,
+                                 void * pvBuffer,
+                                 size_t xBufferLength )
+{
+    BenchmarkServerSession_t * pxSession = ( BenchmarkServerSession_t * ) pvSession;
+    int lResult;
+
+    lResult = wolfSSL_read( pxSession->pxSsl, pvBuffer, ( int ) xBufferLength );
+
+    if( lResult <= 0 )
+    {
+        lResult = wolfSSL_get_error( pxSession->pxSsl, lResult );
+        lResult = ( lResult == SSL_ERROR_WANT_READ ) ? 0 : -1;
+    }
+
+    return ( int32_t ) lResult;
+}
+/*-----------------------------------------------------------*/
+
+int32_t lBenchmarkTlsServerSend( void * pvSession,
+                                 const void * pvBuffer,
+                                 size_t xDataLength )
+{
+    BenchmarkServerSession_t * pxSession = ( BenchmarkServerSession_t * ) pvSession;
+    int lResult;
+
+    lResult = wolfSSL_write( pxSession->pxSsl, pvBuffer, ( int ) xDataLength );
+
+    if( lResult <= 0 )
+    {
+        lResult = wolfSSL_get_error( pxSession->pxSsl, lResult );
+        lResult = ( lResult == SSL_ERROR_WANT_WRITE ) ? 0 : -1;
+    }
+
+    return ( int32_t ) lResult;
+}
+/*-----------------------------------------------------------*/
+
+void vBenchmarkTlsServerClose( void * pvSession )
+{
+    BenchmarkServerSession_t * pxSession = ( BenchmarkServerSession_t * ) pvSession;
+
+    if( pxSession != NULL )
+    {
+        if( pxSession->pxSsl != NULL )
+        {
+            wolfSSL_free( pxSession->pxSsl );
+        }
+
+        if( pxSession->pxContext != NULL )
+        {
+            wolfSSL_CTX_free( pxSession->pxContext );
+        }
+
+        vPortFree( pxSession );
+    }
+
+    ( void ) wolfSSL_Cleanup();
+}
+/*-----------------------------------------------------------*/
+
+const char * pcBenchmarkTlsServerCipherSuite( void * pvSession )
+{
+    BenchmarkServerSession_t * pxSession = ( BenchmarkServerSession_t * ) pvSession;
+
+    return wolfSSL_get_cipher_name( pxSession->pxSsl );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,520 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Throughput and latency benchmark for the network transports.
+ *
+ * A server task and a client task are connected through the loopback TCP
+ * sockets wrapper, so the numbers reflect the cost of the transport and TLS
+ * library rather than of a network stack. For the plaintext transport and
+ * then for each cipher suite in pcBenchmarkCipherSuites[] the client opens a
+ * connection, and for each payload size sends the payload and waits for the
+ * server to echo it back.
+ *
+ * For each payload size the following is reported:
+ *  - The minimum, average, 99th percentile and maximum round trip time.
+ *  - The echoed payload throughput.
+ *  - Process CPU cycles per echoed payload byte. This covers the client and
+ *    the server and both directions of the round trip, and is derived from the
+ *    process CPU time and benchmarkCPU_FREQUENCY_MHZ, so it is only as accurate
+ *    as that frequency on a host that scales its clock.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+/* Loopback sockets include. */
+#include "loopback_sockets.h"
+
+/* Benchmark includes. */
+#include "benchmark_client.h"
+#include "benchmark_tls_server.h"
+#include "transport_benchmark.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Loopback port the benchmark server listens on.
+ */
+#define benchmarkPORT                    ( 4433U )
+
+/**
+ * @brief Number of payload bytes echoed for each payload size, which sets the
+ * number of round trips measured, within the limits below.
+ */
+#ifndef benchmarkBYTES_PER_PAYLOAD_SIZE
+    #define benchmarkBYTES_PER_PAYLOAD_SIZE    ( 4U * 1024U * 1024U )
+#endif
+
+/**
+ * @brief Minimum and maximum number of round trips measured per payload size.
+ */
+#define benchmarkMIN_ROUND_TRIPS         ( 200U )
+#define benchmarkMAX_ROUND_TRIPS         ( 10000U )
+
+/**
+ * @brief Round trips made before measuring starts, so the first records and
+ * cold caches are not counted.
+ */
+#define benchmarkWARMUP_ROUND_TRIPS      ( 16U )
+
+/**
+ * @brief Largest payload; one full TLS record.
+ */
+#define benchmarkMAX_PAYLOAD_SIZE        ( 16384U )
+
+/**
+ * @brief Clock frequency used to convert CPU time to cycles. The Makefile sets
+ * this from /proc/cpuinfo; if it is left at 0 the cycles per byte column reads
+ * 0.
+ */
+#ifndef benchmarkCPU_FREQUENCY_MHZ
+    #define benchmarkCPU_FREQUENCY_MHZ    ( 0U )
+#endif
+
+/**
+ * @brief How long the server waits for the client to connect after being told
+ * to expect a connection.
+ */
+#define benchmarkACCEPT_TIMEOUT_MS       ( 5000U )
+
+#define benchmarkSERVER_PRIORITY         ( tskIDLE_PRIORITY + 2 )
+#define benchmarkCLIENT_PRIORITY         ( tskIDLE_PRIORITY + 1 )
+#define benchmarkSTACK_SIZE              ( configMINIMAL_STACK_SIZE * 4 )
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tells the server how to treat the next connection it accepts.
+ */
+typedef struct BenchmarkRun
+{
+    BaseType_t xUseTls;
+    UBaseType_t uxCipherSuite;
+} BenchmarkRun_t;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Accepts one connection per entry posted to xRunQueue and echoes everything
+ * it receives until the client disconnects.
+ */
+static void prvServerTask( void * pvParameters );
+
+/*
+ * Runs the plaintext and TLS benchmarks in turn, then exits the process.
+ */
+static void prvClientTask( void * pvParameters );
+
+/*
+ * Benchmark one connection across all payload sizes.
+ */
+static void prvBenchmarkConnection( const char * pcName,
+                                    BaseType_t xUseTls,
+                                    UBaseType_t uxCipherSuite );
+
+/*
+ * Measure round trips of one payload size on an open connection and print a
+ * result line.
+ */
+static BaseType_t prvBenchmarkPayloadSize( const TransportInterface_t * pxTransport,
+                                           const char * pcName,
+                                           size_t xPayloadSize );
+
+/*
+ * Loop on the transport until all the bytes have been sent or received.
+ */
+static BaseType_t prvSendAll( const TransportInterface_t * pxTransport,
+                              const uint8_t * pucData,
+                              size_t xLength );
+static BaseType_t prvRecvAll( const TransportInterface_t * pxTransport,
+                              uint8_t * pucData,
+                              size_t xLength );
+
+/*
+ * Read a host clock in nanoseconds.
+ */
+static uint64_t prvNanoseconds( clockid_t xClock );
+
+/*
+ * qsort() comparison function for the latency samples.
+ */
+static int prvCompareLatencies( const void * pvLeft,
+                                const void * pvRight );
+
+/*-----------------------------------------------------------*/
+
+static const size_t xPayloadSizes[] = { 64U, 256U, 1024U, 4096U, benchmarkMAX_PAYLOAD_SIZE };
+
+static QueueHandle_t xRunQueue = NULL;
+
+static uint8_t ucServerBuffer[ benchmarkMAX_PAYLOAD_SIZE ];
+static uint8_t ucClientTxBuffer[ benchmarkMAX_PAYLOAD_SIZE ];
+static uint8_t ucClientRxBuffer[ benchmarkMAX_PAYLOAD_SIZE ];
+static uint64_t ullLatenciesNs[ benchmarkMAX_ROUND_TRIPS ];
+
+/*-----------------------------------------------------------*/
+
+void vStartTransportBenchmark( void )
+{
+    BaseType_t xStatus;
+    size_t x;
+
+    xRunQueue = xQueueCreate( 1, sizeof( BenchmarkRun_t ) );
+    configASSERT( xRunQueue != NULL );
+
+    xStatus = Loopback_Sockets_Listen( benchmarkPORT );
+    configASSERT( xStatus == TCP_SOCKETS_ERRNO_NONE );
+
+    for( x = 0; x < sizeof( ucClientTxBuffer ); x++ )
+    {
+        ucClientTxBuffer[ x ] = ( uint8_t ) ( x * 31U );
+    }
+
+    xTaskCreate( prvServerTask, "BenchSrv", benchmarkSTACK_SIZE, NULL, benchmarkSERVER_PRIORITY, NULL );
+    xTaskCreate( prvClientTask, "BenchCli", benchmarkSTACK_SIZE, NULL, benchmarkCLIENT_PRIORITY, NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvServerTask( void * pvParameters )
+{
+    BenchmarkRun_t xRun;
+    Socket_t xSocket;
+    void * pvSession = NULL;
+    int32_t lReceived;
+    int32_t lSent;
+    int32_t lOffset;
+
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        ( void ) xQueueReceive( xRunQueue, &xRun, portMAX_DELAY );
+
+        if( Loopback_Sockets_Accept( benchmarkPORT,
+                                     &xSocket,
+                                     benchmarkSOCKET_TIMEOUT_MS,
+                                     benchmarkSOCKET_TIMEOUT_MS,
+                                     pdMS_TO_TICKS( benchmarkACCEPT_TIMEOUT_MS ) ) != TCP_SOCKETS_ERRNO_NONE )
+        {
+            printf( "Server accept failed.\r\n" );
+            continue;
+        }
+
+        if( ( xRun.xUseTls == pdTRUE ) &&
+            ( xBenchmarkTlsServerAccept( xSocket, xRun.uxCipherSuite, &pvSession ) != pdPASS ) )
+        {
+            printf( "Server handshake failed for %s.\r\n", pcBenchmarkCipherSuites[ xRun.uxCipherSuite ] );
+            TCP_Sockets_Disconnect( xSocket );
+            continue;
+        }
+
+        /* Echo until the client disconnects. */
+        for( lReceived = 0; lReceived >= 0; )
+        {
+            if( xRun.xUseTls == pdTRUE )
+            {
+                lReceived = lBenchmarkTlsServerRecv( pvSession, ucServerBuffer, sizeof( ucServerBuffer ) );
+            }
+            else
+            {
+                lReceived = TCP_Sockets_Recv( xSocket, ucServerBuffer, sizeof( ucServerBuffer ) );
+            }
+
+            for( lOffset = 0; ( lReceived > 0 ) && ( lOffset < lReceived ); )
+            {
+                if( xRun.xUseTls == pdTRUE )
+                {
+                    lSent = lBenchmarkTlsServerSend( pvSession, &( ucServerBuffer[ lOffset ] ), ( size_t ) ( lReceived - lOffset ) );
+                }
+                else
+                {
+                    lSent = TCP_Sockets_Send( xSocket, &( ucServerBuffer[ lOffset ] ), ( size_t ) ( lReceived - lOffset ) );
+                }
+
+                if( lSent < 0 )
+                {
+                    lReceived = lSent;
+                }
+                else
+                {
+                    lOffset += lSent;
+                }
+            }
+        }
+
+        if( xRun.xUseTls == pdTRUE )
+        {
+            vBenchmarkTlsServerClose( pvSession );
+            pvSession = NULL;
+        }
+
+        TCP_Sockets_Disconnect( xSocket );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvClientTask( void * pvParameters )
+{
+    UBaseType_t uxCipherSuite;
+
+    ( void ) pvParameters;
+
+    printf( "\r\nTransport benchmark, TLS library %s, CPU clock %u MHz.\r\n",
+            pcBenchmarkTlsLibrary,
+            ( unsigned ) benchmarkCPU_FREQUENCY_MHZ );
+    printf( "Round trip latencies are in microseconds; throughput is echoed payload.\r\n\r\n" );
+    printf( "%-46s %7s %9s %9s %9s %9s %9s %10s\r\n",
+            "Transport", "Payload", "Min", "Avg", "P99", "Max", "MB/s", "Cycles/B" );
+
+    prvBenchmarkConnection( "plaintext", pdFALSE, 0U );
+
+    for( uxCipherSuite = 0U; uxCipherSuite < uxBenchmarkCipherSuiteCount; uxCipherSuite++ )
+    {
+        prvBenchmarkConnection( pcBenchmarkCipherSuites[ uxCipherSuite ], pdTRUE, uxCipherSuite );
+    }
+
+    printf( "\r\nBenchmark complete.\r\n" );
+
+    /* The benchmark is a host program, so simply end the process. */
+    exit( EXIT_SUCCESS );
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchmarkConnection( const char * pcName,
+                                    BaseType_t xUseTls,
+                                    UBaseType_t uxCipherSuite )
+{
+    BenchmarkRun_t xRun;
+    TransportInterface_t xTransport;
+    BaseType_t xStatus;
+    uint64_t ullStartNs;
+    size_t x;
+
+    xRun.xUseTls = xUseTls;
+    xRun.uxCipherSuite = uxCipherSuite;
+    ( void ) xQueueSend( xRunQueue, &xRun, portMAX_DELAY );
+
+    ullStartNs = prvNanoseconds( CLOCK_MONOTONIC );
+
+    if( xUseTls == pdTRUE )
+    {
+        xStatus = xBenchmarkTlsConnect( benchmarkPORT, &xTransport );
+    }
+    else
+    {
+        xStatus = xBenchmarkPlaintextConnect( benchmarkPORT, &xTransport );
+    }
+
+    if( xStatus != pdPASS )
+    {
+        printf( "%-46s connect failed\r\n", pcName );
+    }
+    else
+    {
+        printf( "%-46s connect + handshake %.1f us\r\n",
+                pcName,
+                ( double ) ( prvNanoseconds( CLOCK_MONOTONIC ) - ullStartNs ) / 1000.0 );
+
+        for( x = 0; ( x < ( sizeof( xPayloadSizes ) / sizeof( xPayloadSizes[ 0 ] ) ) ) && ( xStatus == pdPASS ); x++ )
+        {
+            xStatus = prvBenchmarkPayloadSize( &xTransport, pcName, xPayloadSizes[ x ] );
+        }
+
+        if( xUseTls == pdTRUE )
+        {
+            vBenchmarkTlsDisconnect( &xTransport );
+        }
+        else
+        {
+            vBenchmarkPlaintextDisconnect( &xTransport );
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvBenchmarkPayloadSize( const TransportInterface_t * pxTransport,
+                                           const char * pcName,
+                                           size_t xPayloadSize )
+{
+    BaseType_t xStatus = pdPASS;
+    uint32_t ulRoundTrips;
+    uint32_t ulRoundTrip;
+    uint64_t ullStartNs;
+    uint64_t ullWallStartNs = 0U;
+    uint64_t ullCpuStartNs = 0U;
+    uint64_t ullWallNs;
+    uint64_t ullCpuNs;
+    uint64_t ullTotalNs = 0U;
+    double dBytes;
+
+    ulRoundTrips = benchmarkBYTES_PER_PAYLOAD_SIZE / ( uint32_t ) xPayloadSize;
+
+    if( ulRoundTrips < benchmarkMIN_ROUND_TRIPS )
+    {
+        ulRoundTrips = benchmarkMIN_ROUND_TRIPS;
+    }
+    else if( ulRoundTrips > benchmarkMAX_ROUND_TRIPS )
+    {
+        ulRoundTrips = benchmarkMAX_ROUND_TRIPS;
+    }
+
+    for( ulRoundTrip = 0U; ( ulRoundTrip < ( benchmarkWARMUP_ROUND_TRIPS + ulRoundTrips ) ) && ( xStatus == pdPASS ); ulRoundTrip++ )
+    {
+        if( ulRoundTrip == benchmarkWARMUP_ROUND_TRIPS )
+        {
+            ullWallStartNs = prvNanoseconds( CLOCK_MONOTONIC );
+            ullCpuStartNs = prvNanoseconds( CLOCK_PROCESS_CPUTIME_ID );
+        }
+
+        ullStartNs = prvNanoseconds( CLOCK_MONOTONIC );
+
+        xStatus = prvSendAll( pxTransport, ucClientTxBuffer, xPayloadSize );
+
+        if( xStatus == pdPASS )
+        {
+            xStatus = prvRecvAll( pxTransport, ucClientRxBuffer, xPayloadSize );
+        }
+
+        if( ulRoundTrip >= benchmarkWARMUP_ROUND_TRIPS )
+        {
+            ullLatenciesNs[ ulRoundTrip - benchmarkWARMUP_ROUND_TRIPS ] = prvNanoseconds( CLOCK_MONOTONIC ) - ullStartNs;
+        }
+    }
+
+    ullWallNs = prvNanoseconds( CLOCK_MONOTONIC ) - ullWallStartNs;
+    ullCpuNs = prvNanoseconds( CLOCK_PROCESS_CPUTIME_ID ) - ullCpuStartNs;
+
+    if( ( xStatus == pdPASS ) &&
+        ( memcmp( ucClientTxBuffer, ucClientRxBuffer, xPayloadSize ) != 0 ) )
+    {
+        printf( "%-46s %7u echoed data does not match\r\n", pcName, ( unsigned ) xPayloadSize );
+        xStatus = pdFAIL;
+    }
+
+    if( xStatus == pdPASS )
+    {
+        qsort( ullLatenciesNs, ulRoundTrips, sizeof( ullLatenciesNs[ 0 ] ), prvCompareLatencies );
+
+        for( ulRoundTrip = 0U; ulRoundTrip < ulRoundTrips; ulRoundTrip++ )
+        {
+            ullTotalNs += ullLatenciesNs[ ulRoundTrip ];
+        }
+
+        dBytes = ( double ) xPayloadSize * ( double ) ulRoundTrips;
+
+        printf( "%-46s %7u %9.1f %9.1f %9.1f %9.1f %9.2f %10.2f\r\n",
+                pcName,
+                ( unsigned ) xPayloadSize,
+                ( double ) ullLatenciesNs[ 0 ] / 1000.0,
+                ( double ) ullTotalNs / ( double ) ulRoundTrips / 1000.0,
+                ( double ) ullLatenciesNs[ ( ulRoundTrips * 99U ) / 100U ] / 1000.0,
+                ( double ) ullLatenciesNs[ ulRoundTrips - 1U ] / 1000.0,
+                ( dBytes * 1000.0 ) / ( double ) ullWallNs,
+                ( ( double ) ullCpuNs * ( double ) benchmarkCPU_FREQUENCY_MHZ ) / ( dBytes * 1000.0 ) );
+    }
+    else
+    {
+        printf( "%-46s %7u transfer failed\r\n", pcName, ( unsigned ) xPayloadSize );
+    }
+
+    return xStatus;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvSendAll( const TransportInterface_t * pxTransport,
+                              const uint8_t * pucData,
+                              size_t xLength )
+{
+    int32_t lSent;
+    size_t xOffset = 0U;
+
+    while( xOffset < xLength )
+    {
+        lSent = pxTransport->send( pxTransport->pNetworkContext, &( pucData[ xOffset ] ), xLength - xOffset );
+
+        if( lSent < 0 )
+        {
+            break;
+        }
+
+        xOffset += ( size_t ) lSent;
+    }
+
+    return ( xOffset == xLength ) ? pdPASS : pdFAIL;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvRecvAll( const TransportInterface_t * pxTransport,
+                              uint8_t * pucData,
+                              size_t xLength )
+{
+    int32_t lReceived;
+    size_t xOffset = 0U;
+
+    while( xOffset < xLength )
+    {
+        lReceived = pxTransport->recv( pxTransport->pNetworkContext, &( pucData[ xOffset ] ), xLength - xOffset );
+
+        if( lReceived < 0 )
+        {
+            break;
+        }
+
+        xOffset += ( size_t ) lReceived;
+    }
+
+    return ( xOffset == xLength ) ? pdPASS : pdFAIL;
+}
+/*-----------------------------------------------------------*/
+
+static uint64_t prvNanoseconds( clockid_t xClock )
+{
+    struct timespec xNow;
+
+    ( void ) clock_gettime( xClock, &xNow );
+
+    return ( ( uint64_t ) xNow.tv_sec * 1000000000ULL ) + ( uint64_t ) xNow.tv_nsec;
+}
+/*-----------------------------------------------------------*/
+
+static int prvCompareLatencies( const void * pvLeft,
+                                const void * pvRight )
+{
+    uint64_t ullLeft = *( ( const uint64_t * ) pvLeft );
+    uint64_t ullRight = *( ( const uint64_t * ) pvRight );
+
+    return ( ullLeft > ullRight ) - ( ullLeft < ullRight );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,91 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef USER_SETTINGS_H
+#define USER_SETTINGS_H
+
+/* The benchmark provides its own I/O callbacks on top of the TCP sockets
+ * wrapper. */
+#define WOLFSSL_USER_IO
+#define WOLFSSL_IGNORE_FILE_WARN
+
+/*-- Cipher related definitions  -----------------------------------------------
+ *
+ * The cipher suites listed in benchmark_tls_server_wolfssl.c must all be
+ * enabled here.
+ *----------------------------------------------------------------------------*/
+#define WOLFSSL_HAVE_MAX
+#define WOLFSSL_HAVE_MIN
+
+#define HAVE_TLS_EXTENSIONS
+#define HAVE_SUPPORTED_CURVES
+#define HAVE_EXTENDED_MASTER
+#define HAVE_ENCRYPT_THEN_MAC
+
+#ifndef WOLFSSL_OPTIONS_IGNORE_SYS
+    #undef  _POSIX_THREADS
+    #define _POSIX_THREADS
+#endif
+
+#define HAVE_THREAD_LS
+#define TFM_TIMING_RESISTANT
+#define ECC_TIMING_RESISTANT
+
+#define HAVE_AESGCM
+#define HAVE_CHACHA
+#define HAVE_POLY1305
+#define HAVE_ONE_TIME_AUTH
+
+#define WOLFSSL_SHA384
+#define WOLFSSL_SHA512
+#define HAVE_HKDF
+
+#define HAVE_ECC
+#define TFM_ECC256
+#define ECC_SHAMIR
+#define HAVE_HASHDRBG
+
+#define USE_FAST_MATH
+#define WC_NO_ASYNC_THREADING
+#define HAVE___UINT128_T    1
+
+#define NO_DSA
+#define NO_HC128
+#define NO_RABBIT
+#define NO_RC4
+#define NO_PSK
+#define NO_MD4
+#define NO_PWDBASED
+
+/*-- Debugging options  ------------------------------------------------------
+ *
+ * "DEBUG_WOLFSSL" definition enables log to output into stdout.
+ * Note: wolfSSL_Debugging_ON() must be called just after wolfSSL_Init().
+ *----------------------------------------------------------------------------*/
+
+/*#define DEBUG_WOLFSSL*/
+
+#endif /* USER_SETTINGS_H */
@@ -491,6 +491,9 @@ static MQTTStatus_t prvMQTTInit( void )
     MQTTFixedBuffer_t xFixedBuffer = { .pBuffer = xNetworkBuffer, .size = MQTT_AGENT_NETWORK_BUFFER_SIZE };
     static uint8_t staticQueueStorageArea[ MQTT_AGENT_COMMAND_QUEUE_LENGTH * sizeof( MQTTAgentCommand_t * ) ];
     static StaticQueue_t staticQueueStructure;
+    static AgentMailbox_t xCommandMailbox;
+    static MQTTAgentCommand_t * pxCommandRing[ MQTT_AGENT_COMMAND_QUEUE_LENGTH ];
+    bool xMailboxCreated;
     MQTTAgentMessageInterface_t messageInterface =
     {
         .pMsgCtx        = NULL,
@@ -500,10 +503,17 @@ static MQTTStatus_t prvMQTTInit( void )
         .releaseCommand = Agent_ReleaseCommand
     };
 
-    LogDebug( ( "Creating command queue." ) );
-    xCommandQueue.queue = xQueueCreate( MQTT_AGENT_COMMAND_QUEUE_LENGTH,
-                                        sizeof( MQTTAgentCommand_t * ) );
-    configASSERT( xCommandQueue.queue );
+    /* Commands are passed to the agent through a batched mailbox, so the
+     * agent task is only woken when it is waiting for a command, and takes all
+     * the pending commands each time it is. */
+    LogDebug( ( "Creating command mailbox." ) );
+    xMailboxCreated = Agent_InitializeMailbox( &xCommandQueue,
+                                               &xCommandMailbox,
+                                               pxCommandRing,
+                                               MQTT_AGENT_COMMAND_QUEUE_LENGTH,
+                                               AgentMailboxBlock,
+                                               NULL );
+    configASSERT( xMailboxCreated );
     messageInterface.pMsgCtx = &xCommandQueue;
 
     /* Initialize the task pool. */
@@ -896,7 +906,7 @@ static void prvMQTTClientSocketWakeupCallback( Socket_t pxSocket )
 
     /* A socket used by the MQTT task may need attention.  Send an event
      * to the MQTT task to make sure the task is not blocked on xCommandQueue. */
-    if( ( uxQueueMessagesWaiting( xCommandQueue.queue ) == 0U ) && ( FreeRTOS_recvcount( pxSocket ) > 0 ) )
+    if( ( Agent_GetPendingCommandCount( &xCommandQueue ) == 0U ) && ( FreeRTOS_recvcount( pxSocket ) > 0 ) )
     {
         /* Don't block as this is called from the context of the IP task. */
         xCommandParams.blockTimeMs = 0U;
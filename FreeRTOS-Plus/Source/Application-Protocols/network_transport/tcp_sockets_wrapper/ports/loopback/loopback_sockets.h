@@ -0,0 +1,125 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file loopback_sockets.h
+ * @brief Server side of the in-process loopback TCP sockets wrapper.
+ *
+ * The loopback port implements tcp_sockets_wrapper.h on top of a pair of
+ * FreeRTOS stream buffers so transports can be exercised without a network
+ * stack. A task calls Loopback_Sockets_Listen() on a port, after which any
+ * TCP_Sockets_Connect() to that port (the host name is ignored) creates a
+ * connection whose server end is returned by Loopback_Sockets_Accept(). Both
+ * ends are then used with TCP_Sockets_Send(), TCP_Sockets_Recv() and
+ * TCP_Sockets_Disconnect().
+ */
+
+#ifndef LOOPBACK_SOCKETS_H
+#define LOOPBACK_SOCKETS_H
+
+/* TCP Sockets Wrapper include.*/
+#include "tcp_sockets_wrapper.h"
+
+/**
+ * @brief Size, in bytes, of the stream buffer used for each direction of a
+ * loopback connection.
+ */
+#ifndef loopbackconfigSTREAM_BUFFER_SIZE
+    #define loopbackconfigSTREAM_BUFFER_SIZE    ( 16384U )
+#endif
+
+/**
+ * @brief Maximum number of ports that can be listened on at the same time.
+ */
+#ifndef loopbackconfigMAX_LISTENERS
+    #define loopbackconfigMAX_LISTENERS    ( 4U )
+#endif
+
+/**
+ * @brief Maximum number of connections waiting to be accepted on a port.
+ */
+#ifndef loopbackconfigACCEPT_BACKLOG
+    #define loopbackconfigACCEPT_BACKLOG    ( 4U )
+#endif
+
+/**
+ * @brief Longest time, in ticks, that a blocked send, receive or accept waits
+ * before checking whether the other end of the connection, or the listener,
+ * has been closed. Closing never wakes a blocked task directly, so this bounds
+ * how long the task takes to notice.
+ */
+#ifndef loopbackconfigPOLL_TICKS
+    #define loopbackconfigPOLL_TICKS    ( pdMS_TO_TICKS( 10U ) )
+#endif
+
+/**
+ * @brief Start accepting loopback connections on a port.
+ *
+ * @param[in] port The port that clients pass to TCP_Sockets_Connect().
+ *
+ * @return #TCP_SOCKETS_ERRNO_NONE on success, #TCP_SOCKETS_ERRNO_EISCONN if
+ * the port is already being listened on, or #TCP_SOCKETS_ERRNO_ENOMEM if no
+ * listener slot or accept queue is available.
+ */
+BaseType_t Loopback_Sockets_Listen( uint16_t port );
+
+/**
+ * @brief Wait for a client to connect to a listening port.
+ *
+ * @param[in] port The port previously passed to Loopback_Sockets_Listen().
+ * @param[out] pTcpSocket Set to the server end of the new connection.
+ * @param[in] receiveTimeoutMs Receive timeout of the accepted socket.
+ * @param[in] sendTimeoutMs Send timeout of the accepted socket.
+ * @param[in] acceptTimeout Ticks to wait for a connection.
+ *
+ * @note A send or receive timeout of 0 means infinite timeout.
+ *
+ * @return #TCP_SOCKETS_ERRNO_NONE on success, #TCP_SOCKETS_ERRNO_EINVAL if the
+ * port is not being listened on, or #TCP_SOCKETS_ERRNO_EWOULDBLOCK if no
+ * client connected before the timeout expired.
+ */
+BaseType_t Loopback_Sockets_Accept( uint16_t port,
+                                    Socket_t * pTcpSocket,
+                                    uint32_t receiveTimeoutMs,
+                                    uint32_t sendTimeoutMs,
+                                    TickType_t acceptTimeout );
+
+/**
+ * @brief Stop accepting loopback connections on a port.
+ *
+ * Connections that were made but not yet accepted are closed, so their
+ * clients see the connection reset, and a task blocked in
+ * Loopback_Sockets_Accept() on the port returns #TCP_SOCKETS_ERRNO_EINVAL.
+ * Connections that were already accepted are not affected.
+ *
+ * @param[in] port The port previously passed to Loopback_Sockets_Listen().
+ *
+ * @return #TCP_SOCKETS_ERRNO_NONE on success, or #TCP_SOCKETS_ERRNO_EINVAL if
+ * the port is not being listened on.
+ */
+BaseType_t Loopback_Sockets_Close( uint16_t port );
+
+#endif /* ifndef LOOPBACK_SOCKETS_H */
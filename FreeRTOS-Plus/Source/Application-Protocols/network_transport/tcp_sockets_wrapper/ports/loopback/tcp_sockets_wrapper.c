@@ -0,0 +1,712 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file tcp_sockets_wrapper.c
+ * @brief In-process loopback implementation of the TCP sockets wrapper, built
+ * on FreeRTOS stream buffers.
+ */
+
+/* Include header that defines log levels. */
+#include "logging_levels.h"
+
+/* Logging configuration for the Sockets. */
+#ifndef LIBRARY_LOG_NAME
+    #define LIBRARY_LOG_NAME     "LoopbackSockets"
+#endif
+#ifndef LIBRARY_LOG_LEVEL
+    #define LIBRARY_LOG_LEVEL    LOG_ERROR
+#endif
+
+extern void vLoggingPrintf( const char * pcFormatString,
+                            ... );
+
+#include "logging_stack.h"
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "stream_buffer.h"
+
+/* TCP Sockets Wrapper include.*/
+#include "tcp_sockets_wrapper.h"
+
+/* Loopback sockets include. */
+#include "loopback_sockets.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Index of the client end of a connection in #LoopbackConnection_t.
+ */
+#define LOOPBACK_CLIENT_END    ( 0U )
+
+/**
+ * @brief Index of the server end of a connection in #LoopbackConnection_t.
+ */
+#define LOOPBACK_SERVER_END    ( 1U )
+
+/*-----------------------------------------------------------*/
+
+struct LoopbackConnection;
+
+/**
+ * @brief One end of a loopback connection.
+ */
+typedef struct xSOCKET
+{
+    StreamBufferHandle_t rxStream;           /**< @brief Bytes written by the peer, read by this end. */
+    StreamBufferHandle_t txStream;           /**< @brief Bytes written by this end, read by the peer. */
+    TickType_t receiveTimeout;               /**< @brief Block time of TCP_Sockets_Recv(). */
+    TickType_t sendTimeout;                  /**< @brief Block time of TCP_Sockets_Send(). */
+    volatile BaseType_t isOpen;              /**< @brief pdFALSE once TCP_Sockets_Disconnect() is called. */
+    struct xSOCKET * pPeer;                  /**< @brief The other end of the connection. */
+    struct LoopbackConnection * pConnection; /**< @brief The connection this end belongs to. */
+} LoopbackSocket_t;
+
+/**
+ * @brief Both ends of a connection and the stream buffers they share.
+ *
+ * The connection is freed when both ends have been disconnected.
+ */
+typedef struct LoopbackConnection
+{
+    LoopbackSocket_t ends[ 2 ];
+    StreamBufferHandle_t streams[ 2 ];
+    UBaseType_t openEnds;
+} LoopbackConnection_t;
+
+/**
+ * @brief A port being listened on and its queue of unaccepted server ends.
+ */
+typedef struct LoopbackListener
+{
+    uint16_t port;             /**< @brief The port, or 0 once Loopback_Sockets_Close() is called. */
+    QueueHandle_t acceptQueue; /**< @brief Unaccepted server ends, NULL when the slot is free. */
+    UBaseType_t users;         /**< @brief Tasks in TCP_Sockets_Connect() or Loopback_Sockets_Accept() on the port. */
+} LoopbackListener_t;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Ports currently being listened on. A NULL accept queue marks a free
+ * slot.
+ */
+static LoopbackListener_t listeners[ loopbackconfigMAX_LISTENERS ];
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Convert a millisecond timeout to ticks, treating 0 as infinite.
+ *
+ * @param[in] timeoutMs The timeout in milliseconds.
+ *
+ * @return The timeout in ticks.
+ */
+static TickType_t timeoutToTicks( uint32_t timeoutMs );
+
+/**
+ * @brief Limit one wait of a blocking call to #loopbackconfigPOLL_TICKS, so
+ * the caller can check whether the connection was closed in the meantime.
+ *
+ * @param[in] remaining Ticks left before the call times out.
+ *
+ * @return The ticks to block for.
+ */
+static TickType_t pollTicks( TickType_t remaining );
+
+/**
+ * @brief Find the listener for a port.
+ *
+ * @param[in] port The port to look up.
+ *
+ * @return The listener, or NULL if nobody is listening on @p port.
+ */
+static LoopbackListener_t * findListener( uint16_t port );
+
+/**
+ * @brief Find the listener for a port and register the calling task as a user
+ * of its accept queue, so the queue is not deleted under it.
+ *
+ * @param[in] port The port to look up.
+ *
+ * @return The listener, or NULL if nobody is listening on @p port.
+ */
+static LoopbackListener_t * listenerAcquire( uint16_t port );
+
+/**
+ * @brief Unregister a user added by listenerAcquire().
+ *
+ * @param[in] pListener The listener returned by listenerAcquire().
+ */
+static void listenerRelease( LoopbackListener_t * pListener );
+
+/**
+ * @brief Free the stream buffers and memory of a connection.
+ *
+ * @param[in] pConnection The connection to free.
+ */
+static void connectionFree( LoopbackConnection_t * pConnection );
+
+/*-----------------------------------------------------------*/
+
+static TickType_t timeoutToTicks( uint32_t timeoutMs )
+{
+    TickType_t ticks = portMAX_DELAY;
+
+    if( timeoutMs != 0U )
+    {
+        ticks = pdMS_TO_TICKS( timeoutMs );
+    }
+
+    return ticks;
+}
+/*-----------------------------------------------------------*/
+
+static TickType_t pollTicks( TickType_t remaining )
+{
+    TickType_t ticks = loopbackconfigPOLL_TICKS;
+
+    if( ticks == 0U )
+    {
+        ticks = 1U;
+    }
+
+    if( remaining < ticks )
+    {
+        ticks = remaining;
+    }
+
+    return ticks;
+}
+/*-----------------------------------------------------------*/
+
+static LoopbackListener_t * findListener( uint16_t port )
+{
+    LoopbackListener_t * pListener = NULL;
+    UBaseType_t index;
+
+    for( index = 0U; index < loopbackconfigMAX_LISTENERS; index++ )
+    {
+        if( ( listeners[ index ].port == port ) && ( listeners[ index ].acceptQueue != NULL ) )
+        {
+            pListener = &( listeners[ index ] );
+            break;
+        }
+    }
+
+    return pListener;
+}
+/*-----------------------------------------------------------*/
+
+static LoopbackListener_t * listenerAcquire( uint16_t port )
+{
+    LoopbackListener_t * pListener = NULL;
+
+    if( port != 0U )
+    {
+        taskENTER_CRITICAL();
+        {
+            pListener = findListener( port );
+
+            if( pListener != NULL )
+            {
+                pListener->users++;
+            }
+        }
+        taskEXIT_CRITICAL();
+    }
+
+    return pListener;
+}
+/*-----------------------------------------------------------*/
+
+static void listenerRelease( LoopbackListener_t * pListener )
+{
+    taskENTER_CRITICAL();
+    {
+        pListener->users--;
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+static void connectionFree( LoopbackConnection_t * pConnection )
+{
+    if( pConnection->streams[ 0 ] != NULL )
+    {
+        vStreamBufferDelete( pConnection->streams[ 0 ] );
+    }
+
+    if( pConnection->streams[ 1 ] != NULL )
+    {
+        vStreamBufferDelete( pConnection->streams[ 1 ] );
+    }
+
+    vPortFree( pConnection );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t Loopback_Sockets_Listen( uint16_t port )
+{
+    BaseType_t status = TCP_SOCKETS_ERRNO_NONE;
+    LoopbackListener_t * pListener = NULL;
+    QueueHandle_t acceptQueue = NULL;
+    UBaseType_t index;
+
+    configASSERT( port != 0U );
+
+    acceptQueue = xQueueCreate( loopbackconfigACCEPT_BACKLOG, sizeof( LoopbackSocket_t * ) );
+
+    if( acceptQueue == NULL )
+    {
+        LogError( ( "Failed to create the accept queue for port %u.", port ) );
+        status = TCP_SOCKETS_ERRNO_ENOMEM;
+    }
+    else
+    {
+        taskENTER_CRITICAL();
+        {
+            if( findListener( port ) != NULL )
+            {
+                status = TCP_SOCKETS_ERRNO_EISCONN;
+            }
+            else
+            {
+                for( index = 0U; index < loopbackconfigMAX_LISTENERS; index++ )
+                {
+                    if( listeners[ index ].acceptQueue == NULL )
+                    {
+                        pListener = &( listeners[ index ] );
+                        break;
+                    }
+                }
+
+                if( pListener == NULL )
+                {
+                    status = TCP_SOCKETS_ERRNO_ENOMEM;
+                }
+                else
+                {
+                    pListener->acceptQueue = acceptQueue;
+                    pListener->port = port;
+                    pListener->users = 0U;
+                }
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        if( status != TCP_SOCKETS_ERRNO_NONE )
+        {
+            LogError( ( "Failed to listen on port %u: Error=%d.", port, ( int ) status ) );
+            vQueueDelete( acceptQueue );
+        }
+    }
+
+    return status;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t Loopback_Sockets_Accept( uint16_t port,
+                                    Socket_t * pTcpSocket,
+                                    uint32_t receiveTimeoutMs,
+                                    uint32_t sendTimeoutMs,
+                                    TickType_t acceptTimeout )
+{
+    BaseType_t status = TCP_SOCKETS_ERRNO_NONE;
+    LoopbackListener_t * pListener = NULL;
+    LoopbackSocket_t * pServerEnd = NULL;
+    TimeOut_t timeOut;
+    TickType_t remaining = acceptTimeout;
+
+    configASSERT( pTcpSocket != NULL );
+
+    pListener = listenerAcquire( port );
+
+    if( pListener == NULL )
+    {
+        LogError( ( "Not listening on port %u.", port ) );
+        status = TCP_SOCKETS_ERRNO_EINVAL;
+    }
+    else
+    {
+        vTaskSetTimeOutState( &timeOut );
+
+        /* Wait in slices so that a Loopback_Sockets_Close() is noticed. */
+        while( xQueueReceive( pListener->acceptQueue, &pServerEnd, pollTicks( remaining ) ) != pdPASS )
+        {
+            if( pListener->port != port )
+            {
+                status = TCP_SOCKETS_ERRNO_EINVAL;
+                break;
+            }
+            else if( xTaskCheckForTimeOut( &timeOut, &remaining ) == pdTRUE )
+            {
+                status = TCP_SOCKETS_ERRNO_EWOULDBLOCK;
+                break;
+            }
+            else
+            {
+                /* Keep waiting. */
+            }
+        }
+
+        listenerRelease( pListener );
+    }
+
+    if( status == TCP_SOCKETS_ERRNO_NONE )
+    {
+        pServerEnd->receiveTimeout = timeoutToTicks( receiveTimeoutMs );
+        pServerEnd->sendTimeout = timeoutToTicks( sendTimeoutMs );
+        *pTcpSocket = pServerEnd;
+
+        LogDebug( ( "Accepted loopback connection on port %u.", port ) );
+    }
+
+    return status;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t Loopback_Sockets_Close( uint16_t port )
+{
+    BaseType_t status = TCP_SOCKETS_ERRNO_NONE;
+    LoopbackListener_t * pListener = NULL;
+    LoopbackSocket_t * pServerEnd = NULL;
+    UBaseType_t users;
+
+    taskENTER_CRITICAL();
+    {
+        pListener = ( port != 0U ) ? findListener( port ) : NULL;
+
+        if( pListener != NULL )
+        {
+            /* Clearing the port stops new connections and makes the tasks
+             * waiting on the accept queue give up; the slot stays in use until
+             * the queue is deleted below. */
+            pListener->port = 0U;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    if( pListener == NULL )
+    {
+        LogError( ( "Not listening on port %u.", port ) );
+        status = TCP_SOCKETS_ERRNO_EINVAL;
+    }
+    else
+    {
+        do
+        {
+            taskENTER_CRITICAL();
+            {
+                users = pListener->users;
+            }
+            taskEXIT_CRITICAL();
+
+            if( users != 0U )
+            {
+                vTaskDelay( pollTicks( portMAX_DELAY ) );
+            }
+        } while( users != 0U );
+
+        /* Reset the connections nobody accepted. */
+        while( xQueueReceive( pListener->acceptQueue, &pServerEnd, 0U ) == pdPASS )
+        {
+            TCP_Sockets_Disconnect( pServerEnd );
+        }
+
+        vQueueDelete( pListener->acceptQueue );
+
+        taskENTER_CRITICAL();
+        {
+            pListener->acceptQueue = NULL;
+        }
+        taskEXIT_CRITICAL();
+    }
+
+    return status;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t TCP_Sockets_Connect( Socket_t * pTcpSocket,
+                                const char * pHostName,
+                                uint16_t port,
+                                uint32_t receiveTimeoutMs,
+                                uint32_t sendTimeoutMs )
+{
+    BaseType_t status = TCP_SOCKETS_ERRNO_NONE;
+    LoopbackListener_t * pListener = NULL;
+    LoopbackConnection_t * pConnection = NULL;
+    LoopbackSocket_t * pServerEnd = NULL;
+    TimeOut_t timeOut;
+    TickType_t remaining;
+
+    configASSERT( pTcpSocket != NULL );
+    configASSERT( pHostName != NULL );
+
+    pListener = listenerAcquire( port );
+
+    if( pListener == NULL )
+    {
+        LogError( ( "Failed to connect to %s: nothing is listening on port %u.",
+                    pHostName,
+                    port ) );
+        status = TCP_SOCKETS_ERRNO_ERROR;
+    }
+    else
+    {
+        pConnection = pvPortMalloc( sizeof( LoopbackConnection_t ) );
+
+        if( pConnection == NULL )
+        {
+            LogError( ( "Failed to allocate new loopback connection." ) );
+            status = TCP_SOCKETS_ERRNO_ENOMEM;
+        }
+    }
+
+    if( status == TCP_SOCKETS_ERRNO_NONE )
+    {
+        ( void ) memset( pConnection, 0, sizeof( LoopbackConnection_t ) );
+
+        /* A trigger level of 1 lets a reader return as soon as any bytes are
+         * available, which matches the behaviour of a TCP socket. */
+        pConnection->streams[ 0 ] = xStreamBufferCreate( loopbackconfigSTREAM_BUFFER_SIZE, 1U );
+        pConnection->streams[ 1 ] = xStreamBufferCreate( loopbackconfigSTREAM_BUFFER_SIZE, 1U );
+
+        if( ( pConnection->streams[ 0 ] == NULL ) || ( pConnection->streams[ 1 ] == NULL ) )
+        {
+            LogError( ( "Failed to create the loopback stream buffers." ) );
+            connectionFree( pConnection );
+            status = TCP_SOCKETS_ERRNO_ENOMEM;
+        }
+    }
+
+    if( status == TCP_SOCKETS_ERRNO_NONE )
+    {
+        /* The client writes into stream 0 and reads from stream 1; the
+         * server does the reverse. */
+        pConnection->ends[ LOOPBACK_CLIENT_END ].txStream = pConnection->streams[ 0 ];
+        pConnection->ends[ LOOPBACK_CLIENT_END ].rxStream = pConnection->streams[ 1 ];
+        pConnection->ends[ LOOPBACK_CLIENT_END ].receiveTimeout = timeoutToTicks( receiveTimeoutMs );
+        pConnection->ends[ LOOPBACK_CLIENT_END ].sendTimeout = timeoutToTicks( sendTimeoutMs );
+        pConnection->ends[ LOOPBACK_CLIENT_END ].pPeer = &( pConnection->ends[ LOOPBACK_SERVER_END ] );
+
+        pConnection->ends[ LOOPBACK_SERVER_END ].txStream = pConnection->streams[ 1 ];
+        pConnection->ends[ LOOPBACK_SERVER_END ].rxStream = pConnection->streams[ 0 ];
+        pConnection->ends[ LOOPBACK_SERVER_END ].pPeer = &( pConnection->ends[ LOOPBACK_CLIENT_END ] );
+
+        pConnection->ends[ LOOPBACK_CLIENT_END ].pConnection = pConnection;
+        pConnection->ends[ LOOPBACK_SERVER_END ].pConnection = pConnection;
+        pConnection->ends[ LOOPBACK_CLIENT_END ].isOpen = pdTRUE;
+        pConnection->ends[ LOOPBACK_SERVER_END ].isOpen = pdTRUE;
+        pConnection->openEnds = 2U;
+
+        pServerEnd = &( pConnection->ends[ LOOPBACK_SERVER_END ] );
+        remaining = timeoutToTicks( sendTimeoutMs );
+        vTaskSetTimeOutState( &timeOut );
+
+        /* Wait in slices so that a Loopback_Sockets_Close() is noticed. */
+        while( xQueueSend( pListener->acceptQueue, &pServerEnd, pollTicks( remaining ) ) != pdPASS )
+        {
+            if( ( pListener->port != port ) ||
+                ( xTaskCheckForTimeOut( &timeOut, &remaining ) == pdTRUE ) )
+            {
+                status = TCP_SOCKETS_ERRNO_ERROR;
+                break;
+            }
+        }
+
+        if( status != TCP_SOCKETS_ERRNO_NONE )
+        {
+            LogError( ( "Connection to port %u refused: accept backlog is full or the port was closed.", port ) );
+            connectionFree( pConnection );
+        }
+        else
+        {
+            *pTcpSocket = &( pConnection->ends[ LOOPBACK_CLIENT_END ] );
+            LogDebug( ( "Established loopback connection with %s:%u.", pHostName, port ) );
+        }
+    }
+
+    if( pListener != NULL )
+    {
+        listenerRelease( pListener );
+    }
+
+    return status;
+}
+/*-----------------------------------------------------------*/
+
+void TCP_Sockets_Disconnect( Socket_t tcpSocket )
+{
+    LoopbackSocket_t * pSocket = ( LoopbackSocket_t * ) tcpSocket;
+    BaseType_t isLastEnd = pdFALSE;
+
+    if( ( pSocket != NULL ) && ( pSocket->isOpen == pdTRUE ) )
+    {
+        taskENTER_CRITICAL();
+        {
+            pSocket->isOpen = pdFALSE;
+            pSocket->pConnection->openEnds--;
+
+            if( pSocket->pConnection->openEnds == 0U )
+            {
+                isLastEnd = pdTRUE;
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        /* A peer blocked in TCP_Sockets_Send() or TCP_Sockets_Recv() notices
+         * within loopbackconfigPOLL_TICKS. It may still be draining its
+         * receive stream, so the connection is only freed once both ends are
+         * closed. */
+        if( isLastEnd == pdTRUE )
+        {
+            connectionFree( pSocket->pConnection );
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+int32_t TCP_Sockets_Send( Socket_t xSocket,
+                          const void * pvBuffer,
+                          size_t xDataLength )
+{
+    LoopbackSocket_t * pSocket = ( LoopbackSocket_t * ) xSocket;
+    int32_t returnStatus = TCP_SOCKETS_ERRNO_ERROR;
+    size_t bytesSent = 0;
+    TimeOut_t timeOut;
+    TickType_t remaining;
+
+    configASSERT( pSocket != NULL );
+    configASSERT( pvBuffer != NULL );
+
+    if( pSocket->isOpen == pdFALSE )
+    {
+        returnStatus = TCP_SOCKETS_ERRNO_EINVAL;
+    }
+    else
+    {
+        remaining = pSocket->sendTimeout;
+        vTaskSetTimeOutState( &timeOut );
+
+        /* Block in slices, so that a peer that disconnects instead of reading
+         * does not leave this task waiting for space forever. */
+        while( pSocket->pPeer->isOpen == pdTRUE )
+        {
+            bytesSent = xStreamBufferSend( pSocket->txStream,
+                                           pvBuffer,
+                                           xDataLength,
+                                           pollTicks( remaining ) );
+
+            if( ( bytesSent > 0U ) ||
+                ( xTaskCheckForTimeOut( &timeOut, &remaining ) == pdTRUE ) )
+            {
+                break;
+            }
+        }
+
+        if( ( bytesSent == 0U ) && ( pSocket->pPeer->isOpen == pdFALSE ) )
+        {
+            returnStatus = TCP_SOCKETS_ERRNO_ENOTCONN;
+        }
+        else if( bytesSent == 0U )
+        {
+            /* A timeout occurred before any data could be sent as the stream
+             * buffer was full. */
+            returnStatus = TCP_SOCKETS_ERRNO_ENOSPC;
+        }
+        else
+        {
+            returnStatus = ( int32_t ) bytesSent;
+        }
+    }
+
+    return returnStatus;
+}
+/*-----------------------------------------------------------*/
+
+int32_t TCP_Sockets_Recv( Socket_t xSocket,
+                          void * pvBuffer,
+                          size_t xBufferLength )
+{
+    LoopbackSocket_t * pSocket = ( LoopbackSocket_t * ) xSocket;
+    int32_t returnStatus = TCP_SOCKETS_ERRNO_ERROR;
+    size_t bytesReceived = 0;
+    BaseType_t peerIsOpen;
+    TimeOut_t timeOut;
+    TickType_t remaining;
+
+    configASSERT( pSocket != NULL );
+    configASSERT( pvBuffer != NULL );
+
+    if( pSocket->isOpen == pdFALSE )
+    {
+        returnStatus = TCP_SOCKETS_ERRNO_EINVAL;
+    }
+    else
+    {
+        remaining = pSocket->receiveTimeout;
+        vTaskSetTimeOutState( &timeOut );
+
+        /* Block in slices, so that a peer that disconnects is noticed. The
+         * peer's state is read before each receive, so once it is seen closed
+         * the stream is drained without blocking on a stream the peer will
+         * never write to again. */
+        do
+        {
+            peerIsOpen = pSocket->pPeer->isOpen;
+            bytesReceived = xStreamBufferReceive( pSocket->rxStream,
+                                                  pvBuffer,
+                                                  xBufferLength,
+                                                  ( peerIsOpen == pdTRUE ) ? pollTicks( remaining ) : 0U );
+        } while( ( bytesReceived == 0U ) &&
+                 ( peerIsOpen == pdTRUE ) &&
+                 ( xTaskCheckForTimeOut( &timeOut, &remaining ) == pdFALSE ) );
+
+        if( bytesReceived > 0U )
+        {
+            returnStatus = ( int32_t ) bytesReceived;
+        }
+        else if( peerIsOpen == pdFALSE )
+        {
+            /* The peer closed the connection and all its data has been read. */
+            returnStatus = TCP_SOCKETS_ERRNO_ENOTCONN;
+        }
+        else
+        {
+            /* Timed out without receiving any data. */
+            returnStatus = 0;
+        }
+    }
+
+    return returnStatus;
+}
+/*-----------------------------------------------------------*/
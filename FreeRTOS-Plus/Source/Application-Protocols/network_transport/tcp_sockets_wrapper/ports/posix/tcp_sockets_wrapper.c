@@ -0,0 +1,348 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file tcp_sockets_wrapper.c
+ * @brief TCP sockets wrapper implemented with the host's BSD sockets, for use
+ * with the FreeRTOS Linux (Posix) port.
+ *
+ * @note The FreeRTOS Posix port runs each task in its own pthread, so a task
+ * blocked in a socket call does not stop the scheduler, but the blocking time
+ * is not visible to FreeRTOS.
+ */
+
+/* Include header that defines log levels. */
+#include "logging_levels.h"
+
+/* Logging configuration for the Sockets. */
+#ifndef LIBRARY_LOG_NAME
+    #define LIBRARY_LOG_NAME     "PosixSockets"
+#endif
+#ifndef LIBRARY_LOG_LEVEL
+    #define LIBRARY_LOG_LEVEL    LOG_ERROR
+#endif
+
+extern void vLoggingPrintf( const char * pcFormatString,
+                            ... );
+
+#include "logging_stack.h"
+
+/* Standard includes. */
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Posix includes. */
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/* TCP Sockets Wrapper include.*/
+#include "tcp_sockets_wrapper.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Host socket wrapped so it can be passed around as a Socket_t.
+ */
+typedef struct xSOCKET
+{
+    int fd; /**< @brief Host socket descriptor. */
+} PosixSocket_t;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Set a send or receive timeout on a host socket.
+ *
+ * @param[in] fd The socket descriptor.
+ * @param[in] option SO_RCVTIMEO or SO_SNDTIMEO.
+ * @param[in] timeoutMs The timeout in milliseconds; 0 means infinite.
+ *
+ * @return 0 on success, -1 on failure.
+ */
+static int setTimeout( int fd,
+                       int option,
+                       uint32_t timeoutMs );
+
+/**
+ * @brief Map an errno value from send() or recv() to a TCP_SOCKETS_ERRNO_*
+ * code.
+ *
+ * @param[in] error The errno value.
+ * @param[in] isSend pdTRUE when @p error came from send().
+ *
+ * @return 0 for a receive timeout, otherwise a negative TCP_SOCKETS_ERRNO_*
+ * value.
+ */
+static int32_t mapErrno( int error,
+                         BaseType_t isSend );
+
+/*-----------------------------------------------------------*/
+
+static int setTimeout( int fd,
+                       int option,
+                       uint32_t timeoutMs )
+{
+    struct timeval timeout;
+
+    /* A zero timeval disables the timeout, which matches the
+     * "0 means infinite" contract of TCP_Sockets_Connect(). */
+    timeout.tv_sec = ( time_t ) ( timeoutMs / 1000U );
+    timeout.tv_usec = ( suseconds_t ) ( ( timeoutMs % 1000U ) * 1000U );
+
+    return setsockopt( fd, SOL_SOCKET, option, &timeout, sizeof( timeout ) );
+}
+/*-----------------------------------------------------------*/
+
+static int32_t mapErrno( int error,
+                         BaseType_t isSend )
+{
+    int32_t returnStatus;
+
+    switch( error )
+    {
+        /* The send or receive timeout expired. */
+        case EAGAIN:
+        #if ( EWOULDBLOCK != EAGAIN )
+            case EWOULDBLOCK:
+        #endif
+            returnStatus = ( isSend == pdTRUE ) ? TCP_SOCKETS_ERRNO_ENOSPC : 0;
+            break;
+
+        case EINTR:
+            returnStatus = TCP_SOCKETS_ERRNO_EINTR;
+            break;
+
+        case ENOMEM:
+        case ENOBUFS:
+            returnStatus = TCP_SOCKETS_ERRNO_ENOMEM;
+            break;
+
+        case EBADF:
+        case EINVAL:
+        case ENOTSOCK:
+            returnStatus = TCP_SOCKETS_ERRNO_EINVAL;
+            break;
+
+        case ENOTCONN:
+        case ECONNRESET:
+        case EPIPE:
+            returnStatus = TCP_SOCKETS_ERRNO_ENOTCONN;
+            break;
+
+        default:
+            returnStatus = TCP_SOCKETS_ERRNO_ERROR;
+            break;
+    }
+
+    return returnStatus;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t TCP_Sockets_Connect( Socket_t * pTcpSocket,
+                                const char * pHostName,
+                                uint16_t port,
+                                uint32_t receiveTimeoutMs,
+                                uint32_t sendTimeoutMs )
+{
+    BaseType_t socketStatus = TCP_SOCKETS_ERRNO_NONE;
+    PosixSocket_t * pPosixSocket = NULL;
+    struct addrinfo hints;
+    struct addrinfo * pAddressList = NULL;
+    struct addrinfo * pAddress = NULL;
+    char portString[ 6 ];
+    int fd = -1;
+    int noDelay = 1;
+
+    configASSERT( pTcpSocket != NULL );
+    configASSERT( pHostName != NULL );
+
+    ( void ) memset( &hints, 0, sizeof( hints ) );
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+    ( void ) snprintf( portString, sizeof( portString ), "%u", ( unsigned ) port );
+
+    if( getaddrinfo( pHostName, portString, &hints, &pAddressList ) != 0 )
+    {
+        LogError( ( "Failed to connect to server: DNS resolution failed: Hostname=%s.",
+                    pHostName ) );
+        socketStatus = TCP_SOCKETS_ERRNO_ERROR;
+    }
+    else
+    {
+        /* Try each resolved address until one connects. */
+        for( pAddress = pAddressList; pAddress != NULL; pAddress = pAddress->ai_next )
+        {
+            fd = socket( pAddress->ai_family, pAddress->ai_socktype, pAddress->ai_protocol );
+
+            if( fd >= 0 )
+            {
+                if( connect( fd, pAddress->ai_addr, pAddress->ai_addrlen ) == 0 )
+                {
+                    break;
+                }
+
+                ( void ) close( fd );
+                fd = -1;
+            }
+        }
+
+        freeaddrinfo( pAddressList );
+
+        if( fd < 0 )
+        {
+            LogError( ( "Failed to connect to server: Hostname=%s, Port=%u, errno=%d.",
+                        pHostName,
+                        port,
+                        errno ) );
+            socketStatus = TCP_SOCKETS_ERRNO_ERROR;
+        }
+    }
+
+    if( socketStatus == TCP_SOCKETS_ERRNO_NONE )
+    {
+        /* The transport interface sends whole MQTT/HTTP/TLS units, so there
+         * is nothing to gain from Nagle's algorithm. */
+        ( void ) setsockopt( fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof( noDelay ) );
+
+        if( ( setTimeout( fd, SO_RCVTIMEO, receiveTimeoutMs ) != 0 ) ||
+            ( setTimeout( fd, SO_SNDTIMEO, sendTimeoutMs ) != 0 ) )
+        {
+            LogError( ( "Failed to set socket timeouts: errno=%d.", errno ) );
+            socketStatus = TCP_SOCKETS_ERRNO_ENOPROTOOPT;
+        }
+    }
+
+    if( socketStatus == TCP_SOCKETS_ERRNO_NONE )
+    {
+        pPosixSocket = pvPortMalloc( sizeof( PosixSocket_t ) );
+
+        if( pPosixSocket == NULL )
+        {
+            LogError( ( "Failed to allocate new socket context." ) );
+            socketStatus = TCP_SOCKETS_ERRNO_ENOMEM;
+        }
+    }
+
+    /* Clean up on failure. */
+    if( socketStatus != TCP_SOCKETS_ERRNO_NONE )
+    {
+        if( fd >= 0 )
+        {
+            ( void ) close( fd );
+        }
+    }
+    else
+    {
+        pPosixSocket->fd = fd;
+        *pTcpSocket = pPosixSocket;
+        LogDebug( ( "Established TCP connection with %s.", pHostName ) );
+    }
+
+    return socketStatus;
+}
+/*-----------------------------------------------------------*/
+
+void TCP_Sockets_Disconnect( Socket_t tcpSocket )
+{
+    PosixSocket_t * pPosixSocket = ( PosixSocket_t * ) tcpSocket;
+
+    if( pPosixSocket != NULL )
+    {
+        ( void ) shutdown( pPosixSocket->fd, SHUT_RDWR );
+        ( void ) close( pPosixSocket->fd );
+        vPortFree( pPosixSocket );
+    }
+}
+/*-----------------------------------------------------------*/
+
+int32_t TCP_Sockets_Send( Socket_t xSocket,
+                          const void * pvBuffer,
+                          size_t xDataLength )
+{
+    PosixSocket_t * pPosixSocket = ( PosixSocket_t * ) xSocket;
+    ssize_t bytesSent;
+    int32_t returnStatus;
+
+    configASSERT( pPosixSocket != NULL );
+    configASSERT( pvBuffer != NULL );
+
+    /* MSG_NOSIGNAL reports a closed peer as EPIPE instead of raising SIGPIPE,
+     * which would otherwise terminate the simulator. */
+    bytesSent = send( pPosixSocket->fd, pvBuffer, xDataLength, MSG_NOSIGNAL );
+
+    if( bytesSent >= 0 )
+    {
+        returnStatus = ( int32_t ) bytesSent;
+    }
+    else
+    {
+        returnStatus = mapErrno( errno, pdTRUE );
+    }
+
+    return returnStatus;
+}
+/*-----------------------------------------------------------*/
+
+int32_t TCP_Sockets_Recv( Socket_t xSocket,
+                          void * pvBuffer,
+                          size_t xBufferLength )
+{
+    PosixSocket_t * pPosixSocket = ( PosixSocket_t * ) xSocket;
+    ssize_t bytesReceived;
+    int32_t returnStatus;
+
+    configASSERT( pPosixSocket != NULL );
+    configASSERT( pvBuffer != NULL );
+
+    bytesReceived = recv( pPosixSocket->fd, pvBuffer, xBufferLength, 0 );
+
+    if( bytesReceived > 0 )
+    {
+        returnStatus = ( int32_t ) bytesReceived;
+    }
+    else if( bytesReceived == 0 )
+    {
+        /* An orderly shutdown by the peer. */
+        returnStatus = TCP_SOCKETS_ERRNO_ENOTCONN;
+    }
+    else
+    {
+        returnStatus = mapErrno( errno, pdFALSE );
+    }
+
+    return returnStatus;
+}
+/*-----------------------------------------------------------*/
@@ -47,6 +47,7 @@
 
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
+#include "task.h"
 
 /* MBedTLS Includes */
 #if !defined( MBEDTLS_CONFIG_FILE )
@@ -118,6 +119,33 @@ static const char * pNoLowLevelMbedTlsCodeStr = "<No-Low-Level-Code>";
 
 /*-----------------------------------------------------------*/
 
+#if ( transportconfigTLS_POOL_SLOTS > 0 )
+
+/**
+ * @brief Number of record buffers in the pool, an input and an output
+ * buffer for each slot.
+ */
+    #define POOL_BUFFER_COUNT    ( transportconfigTLS_POOL_SLOTS * 2U )
+
+/**
+ * @brief Statically allocated record buffers. uint64_t keeps them aligned
+ * for any type mbedTLS stores in them.
+ */
+    static uint64_t poolBuffers[ POOL_BUFFER_COUNT ][ ( transportconfigMBEDTLS_POOL_BUFFER_SIZE + 7U ) / 8U ];
+
+/**
+ * @brief Bytes handed out from each pool buffer, 0 when the buffer is free.
+ */
+    static size_t poolBufferUsed[ POOL_BUFFER_COUNT ];
+
+/**
+ * @brief Total bytes currently handed out from the pool buffers.
+ */
+    static size_t poolBytesInUse = 0U;
+
+/*-----------------------------------------------------------*/
+#endif /* transportconfigTLS_POOL_SLOTS > 0 */
+
 /**
  * @brief Initialize the mbed TLS structures in a network connection.
  *
@@ -477,9 +505,10 @@ static void setOptionalConfigurations( SSLContext_t * pSslContext,
         /* Enable the max fragment extension. 4096 bytes is currently the largest fragment size permitted.
          * See RFC 8449 https://tools.ietf.org/html/rfc8449 for more information.
          *
-         * Smaller values can be found in "mbedtls/include/ssl.h".
+         * Smaller values can be found in "mbedtls/include/ssl.h" and selected
+         * with transportconfigMBEDTLS_MAX_FRAGMENT_LENGTH.
          */
-        mbedtlsError = mbedtls_ssl_conf_max_frag_len( &( pSslContext->config ), MBEDTLS_SSL_MAX_FRAG_LEN_4096 );
+        mbedtlsError = mbedtls_ssl_conf_max_frag_len( &( pSslContext->config ), transportconfigMBEDTLS_MAX_FRAGMENT_LENGTH );
 
         if( mbedtlsError != 0 )
         {
@@ -592,13 +621,29 @@ static TlsTransportStatus_t tlsHandshake( NetworkContext_t * pNetworkContext,
 
     if( returnStatus == TLS_TRANSPORT_SUCCESS )
     {
+        #if ( transportconfigMETRICS_ENABLED == 1 )
+            uint32_t startTimeUs = transportMETRICS_GET_TIME_US();
+        #endif
+
         /* Perform the TLS handshake. */
         do
         {
             mbedtlsError = mbedtls_ssl_handshake( &( pTlsTransportParams->sslContext.context ) );
+
+            #if ( transportconfigMETRICS_ENABLED == 1 )
+                if( ( mbedtlsError == MBEDTLS_ERR_SSL_WANT_READ ) ||
+                    ( mbedtlsError == MBEDTLS_ERR_SSL_WANT_WRITE ) )
+                {
+                    pTlsTransportParams->metrics.handshakeRetries++;
+                }
+            #endif
         } while( ( mbedtlsError == MBEDTLS_ERR_SSL_WANT_READ ) ||
                  ( mbedtlsError == MBEDTLS_ERR_SSL_WANT_WRITE ) );
 
+        #if ( transportconfigMETRICS_ENABLED == 1 )
+            pTlsTransportParams->metrics.handshakeTimeUs = transportMETRICS_GET_TIME_US() - startTimeUs;
+        #endif
+
         if( mbedtlsError != 0 )
         {
             LogError( ( "Failed to perform TLS handshake: mbedTLSError= %s : %s.",
@@ -693,6 +738,15 @@ TlsTransportStatus_t TLS_FreeRTOS_Connect( NetworkContext_t * pNetworkContext,
     BaseType_t socketStatus = 0;
     BaseType_t isSocketConnected = pdFALSE, isTlsSetup = pdFALSE;
 
+    #if ( transportconfigTLS_POOL_SLOTS > 0 )
+        BaseType_t isPoolSlotHeld = pdFALSE;
+        int32_t poolSlot;
+    #endif
+
+    #if ( transportconfigMETRICS_ENABLED == 1 )
+        uint32_t startTimeUs = 0U;
+    #endif
+
     if( ( pNetworkContext == NULL ) ||
         ( pNetworkContext->pParams == NULL ) ||
         ( pHostName == NULL ) ||
@@ -715,6 +769,27 @@ TlsTransportStatus_t TLS_FreeRTOS_Connect( NetworkContext_t * pNetworkContext,
         /* Empty else for MISRA 15.7 compliance. */
     }
 
+    #if ( transportconfigTLS_POOL_SLOTS > 0 )
+        /* Reserve the pool memory before doing any network work, so a busy
+         * pool fails the connection attempt cheaply. */
+        if( returnStatus == TLS_TRANSPORT_SUCCESS )
+        {
+            poolSlot = TlsPool_AcquireSlot();
+
+            if( poolSlot < 0 )
+            {
+                LogError( ( "All %u TLS connection pool slots are in use.",
+                            ( unsigned ) transportconfigTLS_POOL_SLOTS ) );
+                returnStatus = TLS_TRANSPORT_INSUFFICIENT_MEMORY;
+            }
+            else
+            {
+                pNetworkContext->pParams->poolSlot = poolSlot + 1;
+                isPoolSlotHeld = pdTRUE;
+            }
+        }
+    #endif /* transportconfigTLS_POOL_SLOTS > 0 */
+
     /* Establish a TCP connection with the server. */
     if( returnStatus == TLS_TRANSPORT_SUCCESS )
     {
@@ -723,12 +798,21 @@ TlsTransportStatus_t TLS_FreeRTOS_Connect( NetworkContext_t * pNetworkContext,
         /* Initialize tcpSocket. */
         pTlsTransportParams->tcpSocket = NULL;
 
+        #if ( transportconfigMETRICS_ENABLED == 1 )
+            TransportMetrics_Reset( &( pTlsTransportParams->metrics ) );
+            startTimeUs = transportMETRICS_GET_TIME_US();
+        #endif
+
         socketStatus = TCP_Sockets_Connect( &( pTlsTransportParams->tcpSocket ),
                                             pHostName,
                                             port,
                                             receiveTimeoutMs,
                                             sendTimeoutMs );
 
+        #if ( transportconfigMETRICS_ENABLED == 1 )
+            pTlsTransportParams->metrics.connectTimeUs = transportMETRICS_GET_TIME_US() - startTimeUs;
+        #endif
+
         if( socketStatus != 0 )
         {
             LogError( ( "Failed to connect to %s with error %d.",
@@ -776,6 +860,15 @@ TlsTransportStatus_t TLS_FreeRTOS_Connect( NetworkContext_t * pNetworkContext,
             TCP_Sockets_Disconnect( pTlsTransportParams->tcpSocket );
             pTlsTransportParams->tcpSocket = NULL;
         }
+
+        #if ( transportconfigTLS_POOL_SLOTS > 0 )
+            /* Return the slot if one was reserved. */
+            if( isPoolSlotHeld == pdTRUE )
+            {
+                TlsPool_ReleaseSlot( pNetworkContext->pParams->poolSlot - 1 );
+                pNetworkContext->pParams->poolSlot = TLS_POOL_SLOT_UNASSIGNED;
+            }
+        #endif
     }
     else
     {
@@ -830,6 +923,16 @@ void TLS_FreeRTOS_Disconnect( NetworkContext_t * pNetworkContext )
 
         /* Free mbed TLS contexts. */
         sslContextFree( &( pTlsTransportParams->sslContext ) );
+
+        #if ( transportconfigTLS_POOL_SLOTS > 0 )
+            /* The record buffers were returned to the pool by
+             * sslContextFree(), so the slot can be reused. */
+            if( pTlsTransportParams->poolSlot != TLS_POOL_SLOT_UNASSIGNED )
+            {
+                TlsPool_ReleaseSlot( pTlsTransportParams->poolSlot - 1 );
+                pTlsTransportParams->poolSlot = TLS_POOL_SLOT_UNASSIGNED;
+            }
+        #endif
     }
 }
 /*-----------------------------------------------------------*/
@@ -841,6 +944,10 @@ int32_t TLS_FreeRTOS_recv( NetworkContext_t * pNetworkContext,
     TlsTransportParams_t * pTlsTransportParams = NULL;
     int32_t tlsStatus = 0;
 
+    #if ( transportconfigMETRICS_ENABLED == 1 )
+        uint32_t startTimeUs = transportMETRICS_GET_TIME_US();
+    #endif
+
     if( ( pNetworkContext == NULL ) || ( pNetworkContext->pParams == NULL ) )
     {
         LogError( ( "invalid input, pNetworkContext=%p", pNetworkContext ) );
@@ -893,6 +1000,14 @@ int32_t TLS_FreeRTOS_recv( NetworkContext_t * pNetworkContext,
         {
             /* Empty else marker. */
         }
+
+        #if ( transportconfigMETRICS_ENABLED == 1 )
+            /* mbedtls_ssl_read() never returns data from more than one record. */
+            TransportMetrics_RecordRecv( &( pTlsTransportParams->metrics ),
+                                         tlsStatus,
+                                         1U,
+                                         startTimeUs );
+        #endif
     }
 
     return tlsStatus;
@@ -906,6 +1021,11 @@ int32_t TLS_FreeRTOS_send( NetworkContext_t * pNetworkContext,
     TlsTransportParams_t * pTlsTransportParams = NULL;
     int32_t tlsStatus = 0;
 
+    #if ( transportconfigMETRICS_ENABLED == 1 )
+        uint32_t startTimeUs = transportMETRICS_GET_TIME_US();
+        int32_t maxRecordPayload = 0;
+    #endif
+
     if( ( pNetworkContext == NULL ) || ( pNetworkContext->pParams == NULL ) )
     {
         LogError( ( "invalid input, pNetworkContext=%p", pNetworkContext ) );
@@ -958,8 +1078,151 @@ int32_t TLS_FreeRTOS_send( NetworkContext_t * pNetworkContext,
         {
             /* Empty else marker. */
         }
+
+        #if ( transportconfigMETRICS_ENABLED == 1 )
+            /* The written bytes are split into records of at most the maximum
+             * outgoing record payload. */
+            maxRecordPayload = ( int32_t ) mbedtls_ssl_get_max_out_record_payload( &( pTlsTransportParams->sslContext.context ) );
+
+            if( maxRecordPayload <= 0 )
+            {
+                maxRecordPayload = tlsStatus;
+            }
+
+            TransportMetrics_RecordSend( &( pTlsTransportParams->metrics ),
+                                         tlsStatus,
+                                         ( tlsStatus > 0 ) ? ( uint32_t ) ( ( tlsStatus + maxRecordPayload - 1 ) / maxRecordPayload ) : 0U,
+                                         startTimeUs );
+        #endif
     }
 
     return tlsStatus;
 }
 /*-----------------------------------------------------------*/
+
+#if ( transportconfigMETRICS_ENABLED == 1 )
+    TlsTransportStatus_t TLS_FreeRTOS_GetMetrics( const NetworkContext_t * pNetworkContext,
+                                                  TransportMetrics_t * pMetrics )
+    {
+        TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
+
+        if( ( pNetworkContext == NULL ) || ( pNetworkContext->pParams == NULL ) || ( pMetrics == NULL ) )
+        {
+            LogError( ( "invalid input, pNetworkContext=%p, pMetrics=%p", pNetworkContext, pMetrics ) );
+            returnStatus = TLS_TRANSPORT_INVALID_PARAMETER;
+        }
+        else
+        {
+            ( void ) memcpy( pMetrics, &( pNetworkContext->pParams->metrics ), sizeof( TransportMetrics_t ) );
+        }
+
+        return returnStatus;
+    }
+#endif /* transportconfigMETRICS_ENABLED == 1 */
+/*-----------------------------------------------------------*/
+
+#if ( transportconfigTLS_POOL_SLOTS > 0 )
+    void * TLS_FreeRTOS_PoolCalloc( size_t nmemb,
+                                    size_t size )
+    {
+        size_t totalSize = nmemb * size;
+        size_t bytesInUse = 0U;
+        void * pBuffer = NULL;
+        uint32_t i;
+
+        /* Check that neither nmemb nor size were 0, and for overflow. */
+        if( ( totalSize > 0U ) && ( ( totalSize / size ) == nmemb ) )
+        {
+            if( ( totalSize >= transportconfigMBEDTLS_POOL_MIN_ALLOCATION ) &&
+                ( totalSize <= transportconfigMBEDTLS_POOL_BUFFER_SIZE ) )
+            {
+                taskENTER_CRITICAL();
+                {
+                    for( i = 0U; i < POOL_BUFFER_COUNT; i++ )
+                    {
+                        if( poolBufferUsed[ i ] == 0U )
+                        {
+                            poolBufferUsed[ i ] = totalSize;
+                            poolBytesInUse += totalSize;
+                            bytesInUse = poolBytesInUse;
+                            pBuffer = poolBuffers[ i ];
+                            break;
+                        }
+                    }
+                }
+                taskEXIT_CRITICAL();
+
+                if( pBuffer != NULL )
+                {
+                    TlsPool_RecordBytesInUse( bytesInUse );
+                }
+                else
+                {
+                    TlsPool_RecordHeapFallback();
+                }
+            }
+
+            if( pBuffer == NULL )
+            {
+                pBuffer = pvPortMalloc( totalSize );
+            }
+
+            if( pBuffer != NULL )
+            {
+                ( void ) memset( pBuffer, 0, totalSize );
+            }
+        }
+
+        return pBuffer;
+    }
+/*-----------------------------------------------------------*/
+
+    void TLS_FreeRTOS_PoolFree( void * ptr )
+    {
+        const uint8_t * pPoolStart = ( const uint8_t * ) poolBuffers;
+        const uint8_t * pPoolEnd = pPoolStart + sizeof( poolBuffers );
+        size_t index;
+
+        if( ( ( const uint8_t * ) ptr >= pPoolStart ) && ( ( const uint8_t * ) ptr < pPoolEnd ) )
+        {
+            index = ( size_t ) ( ( const uint8_t * ) ptr - pPoolStart ) / sizeof( poolBuffers[ 0 ] );
+
+            taskENTER_CRITICAL();
+            {
+                configASSERT( poolBufferUsed[ index ] != 0U );
+
+                poolBytesInUse -= poolBufferUsed[ index ];
+                poolBufferUsed[ index ] = 0U;
+            }
+            taskEXIT_CRITICAL();
+        }
+        else if( ptr != NULL )
+        {
+            vPortFree( ptr );
+        }
+        else
+        {
+            /* Nothing to free. */
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    TlsTransportStatus_t TLS_FreeRTOS_GetPoolStats( TlsPoolStats_t * pStats )
+    {
+        TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
+
+        if( pStats == NULL )
+        {
+            LogError( ( "invalid input, pStats=%p", pStats ) );
+            returnStatus = TLS_TRANSPORT_INVALID_PARAMETER;
+        }
+        else
+        {
+            TlsPool_GetStats( pStats );
+            pStats->slotSize = 2U * sizeof( poolBuffers[ 0 ] );
+        }
+
+        return returnStatus;
+    }
+#endif /* transportconfigTLS_POOL_SLOTS > 0 */
+/*-----------------------------------------------------------*/
@@ -93,6 +93,53 @@ extern void vLoggingPrintf( const char * pcFormatString,
 /* Transport interface include. */
 #include "transport_interface.h"
 
+/* Transport metrics include. */
+#include "transport_metrics.h"
+
+/* Connection pool include. */
+#include "transport_tls_pool.h"
+
+/**
+ * @brief Maximum fragment length requested from the server when
+ * MBEDTLS_SSL_MAX_FRAGMENT_LENGTH is enabled in the mbedTLS config.
+ *
+ * One of the MBEDTLS_SSL_MAX_FRAG_LEN_* values in "mbedtls/ssl.h". If
+ * MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH is also enabled, mbedTLS shrinks the
+ * record buffers to the negotiated fragment length once the handshake
+ * completes, which frees most of a connection's memory for its lifetime.
+ */
+#ifndef transportconfigMBEDTLS_MAX_FRAGMENT_LENGTH
+    #define transportconfigMBEDTLS_MAX_FRAGMENT_LENGTH    MBEDTLS_SSL_MAX_FRAG_LEN_4096
+#endif
+
+#if ( transportconfigTLS_POOL_SLOTS > 0 )
+
+/**
+ * @brief Size of each statically allocated record buffer in the pool.
+ *
+ * Each slot holds two of these, one for the input and one for the output
+ * record buffer. The default fits the largest record mbedTLS will allocate
+ * for the configured content lengths, plus its header and cipher overhead.
+ */
+    #ifndef transportconfigMBEDTLS_POOL_BUFFER_SIZE
+        #if ( MBEDTLS_SSL_IN_CONTENT_LEN > MBEDTLS_SSL_OUT_CONTENT_LEN )
+            #define transportconfigMBEDTLS_POOL_BUFFER_SIZE    ( MBEDTLS_SSL_IN_CONTENT_LEN + 512U )
+        #else
+            #define transportconfigMBEDTLS_POOL_BUFFER_SIZE    ( MBEDTLS_SSL_OUT_CONTENT_LEN + 512U )
+        #endif
+    #endif
+
+/**
+ * @brief Smallest allocation that is served from the pool.
+ *
+ * Smaller allocations, including record buffers that mbedTLS has shrunk
+ * after the handshake, keep using the FreeRTOS heap.
+ */
+    #ifndef transportconfigMBEDTLS_POOL_MIN_ALLOCATION
+        #define transportconfigMBEDTLS_POOL_MIN_ALLOCATION    ( transportconfigMBEDTLS_POOL_BUFFER_SIZE / 2U )
+    #endif
+#endif /* transportconfigTLS_POOL_SLOTS > 0 */
+
 /**
  * @brief Secured connection context.
  */
@@ -116,6 +163,12 @@ typedef struct TlsTransportParams
 {
     Socket_t tcpSocket;
     SSLContext_t sslContext;
+    #if ( transportconfigMETRICS_ENABLED == 1 )
+        TransportMetrics_t metrics;
+    #endif
+    #if ( transportconfigTLS_POOL_SLOTS > 0 )
+        int32_t poolSlot; /**< @brief Connection pool slot held by this connection plus one, #TLS_POOL_SLOT_UNASSIGNED if none. */
+    #endif
 } TlsTransportParams_t;
 
 /**
@@ -224,6 +277,69 @@ int32_t TLS_FreeRTOS_send( NetworkContext_t * pNetworkContext,
                            const void * pBuffer,
                            size_t bytesToSend );
 
+#if ( transportconfigMETRICS_ENABLED == 1 )
+
+/**
+ * @brief Get a snapshot of the statistics collected for a TLS connection.
+ *
+ * The statistics are cleared by TLS_FreeRTOS_Connect() and remain readable
+ * after TLS_FreeRTOS_Disconnect() until the next connection attempt.
+ *
+ * @param[in] pNetworkContext The network context.
+ * @param[out] pMetrics Set to a copy of the connection's statistics.
+ *
+ * @return #TLS_TRANSPORT_SUCCESS, or #TLS_TRANSPORT_INVALID_PARAMETER.
+ */
+    TlsTransportStatus_t TLS_FreeRTOS_GetMetrics( const NetworkContext_t * pNetworkContext,
+                                                  TransportMetrics_t * pMetrics );
+#endif /* transportconfigMETRICS_ENABLED == 1 */
+
+#if ( transportconfigTLS_POOL_SLOTS > 0 )
+
+/**
+ * @brief mbedTLS allocator that serves record buffers from the connection
+ * pool.
+ *
+ * mbedTLS has no API to hand it caller owned record buffers, so the pool is
+ * plugged in through the platform layer instead. Point the allocator macros
+ * at these functions in the mbedTLS config file:
+ *
+ * @code
+ * #define MBEDTLS_PLATFORM_MEMORY
+ * #define MBEDTLS_PLATFORM_CALLOC_MACRO    TLS_FreeRTOS_PoolCalloc
+ * #define MBEDTLS_PLATFORM_FREE_MACRO      TLS_FreeRTOS_PoolFree
+ * @endcode
+ *
+ * Allocations of at least #transportconfigMBEDTLS_POOL_MIN_ALLOCATION bytes
+ * come from the pool, everything else from pvPortMalloc().
+ *
+ * @param[in] nmemb Number of elements to allocate.
+ * @param[in] size Size of each element.
+ *
+ * @return Zeroed memory, or NULL if none is available.
+ */
+    void * TLS_FreeRTOS_PoolCalloc( size_t nmemb,
+                                    size_t size );
+
+/**
+ * @brief Free memory obtained from TLS_FreeRTOS_PoolCalloc().
+ *
+ * @param[in] ptr The memory to free, may be NULL.
+ */
+    void TLS_FreeRTOS_PoolFree( void * ptr );
+
+/**
+ * @brief Get the usage statistics of the connection pool.
+ *
+ * bytesHighWater is the most record buffer memory that has been handed out
+ * from the pool at the same time, across all connections.
+ *
+ * @param[out] pStats Set to the current statistics.
+ *
+ * @return #TLS_TRANSPORT_SUCCESS, or #TLS_TRANSPORT_INVALID_PARAMETER.
+ */
+    TlsTransportStatus_t TLS_FreeRTOS_GetPoolStats( TlsPoolStats_t * pStats );
+#endif /* transportconfigTLS_POOL_SLOTS > 0 */
 
 #ifdef MBEDTLS_DEBUG_C
 
@@ -0,0 +1,218 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file transport_metrics.c
+ * @brief Helpers used by the network transports to maintain per-connection
+ * statistics.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+#include <string.h>
+
+/* Transport metrics include. */
+#include "transport_metrics.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Map a latency to its histogram bucket.
+ *
+ * @param[in] latencyUs The latency in microseconds.
+ *
+ * @return Index of the bucket that counts @p latencyUs.
+ */
+static uint32_t latencyToBucket( uint32_t latencyUs );
+
+/**
+ * @brief Append formatted text to a buffer, tracking how much has been used.
+ *
+ * @param[in] pBuffer Start of the output buffer.
+ * @param[in] bufferLength Total length of the output buffer.
+ * @param[in] used Number of characters already written to the buffer.
+ * @param[in] pFormat printf style format string.
+ * @param[in] value The single value referenced by @p pFormat.
+ *
+ * @return The new number of characters used in the buffer.
+ */
+static size_t appendLine( char * pBuffer,
+                          size_t bufferLength,
+                          size_t used,
+                          const char * pFormat,
+                          unsigned long long value );
+
+/*-----------------------------------------------------------*/
+
+static uint32_t latencyToBucket( uint32_t latencyUs )
+{
+    uint32_t bucket = 0U;
+
+    /* The bucket is the number of significant bits in the latency. */
+    while( ( latencyUs != 0U ) && ( bucket < ( transportconfigMETRICS_HISTOGRAM_BUCKETS - 1U ) ) )
+    {
+        latencyUs >>= 1U;
+        bucket++;
+    }
+
+    return bucket;
+}
+/*-----------------------------------------------------------*/
+
+static size_t appendLine( char * pBuffer,
+                          size_t bufferLength,
+                          size_t used,
+                          const char * pFormat,
+                          unsigned long long value )
+{
+    int written = 0;
+
+    if( used < bufferLength )
+    {
+        written = snprintf( &( pBuffer[ used ] ), bufferLength - used, pFormat, value );
+
+        if( written > 0 )
+        {
+            used += ( size_t ) written;
+
+            /* Clamp on truncation so the return value stays within the buffer. */
+            if( used >= bufferLength )
+            {
+                used = bufferLength - 1U;
+            }
+        }
+    }
+
+    return used;
+}
+/*-----------------------------------------------------------*/
+
+void TransportMetrics_Reset( TransportMetrics_t * pMetrics )
+{
+    configASSERT( pMetrics != NULL );
+
+    ( void ) memset( pMetrics, 0, sizeof( TransportMetrics_t ) );
+}
+/*-----------------------------------------------------------*/
+
+void TransportMetrics_RecordSend( TransportMetrics_t * pMetrics,
+                                  int32_t result,
+                                  uint32_t records,
+                                  uint32_t startTimeUs )
+{
+    uint32_t latencyUs = transportMETRICS_GET_TIME_US() - startTimeUs;
+
+    configASSERT( pMetrics != NULL );
+
+    pMetrics->sendCalls++;
+    pMetrics->sendLatencyHistogram[ latencyToBucket( latencyUs ) ]++;
+
+    if( result > 0 )
+    {
+        pMetrics->bytesSent += ( uint64_t ) result;
+        pMetrics->recordsSent += records;
+    }
+    else if( result == 0 )
+    {
+        pMetrics->wantWriteRetries++;
+    }
+    else
+    {
+        pMetrics->sendErrors++;
+    }
+}
+/*-----------------------------------------------------------*/
+
+void TransportMetrics_RecordRecv( TransportMetrics_t * pMetrics,
+                                  int32_t result,
+                                  uint32_t records,
+                                  uint32_t startTimeUs )
+{
+    uint32_t latencyUs = transportMETRICS_GET_TIME_US() - startTimeUs;
+
+    configASSERT( pMetrics != NULL );
+
+    pMetrics->recvCalls++;
+    pMetrics->recvLatencyHistogram[ latencyToBucket( latencyUs ) ]++;
+
+    if( result > 0 )
+    {
+        pMetrics->bytesReceived += ( uint64_t ) result;
+        pMetrics->recordsReceived += records;
+    }
+    else if( result == 0 )
+    {
+        pMetrics->wantReadRetries++;
+    }
+    else
+    {
+        pMetrics->recvErrors++;
+    }
+}
+/*-----------------------------------------------------------*/
+
+size_t TransportMetrics_Format( const TransportMetrics_t * pMetrics,
+                                char * pBuffer,
+                                size_t bufferLength )
+{
+    size_t used = 0U;
+    uint32_t bucket;
+
+    if( ( pMetrics != NULL ) && ( pBuffer != NULL ) && ( bufferLength > 0U ) )
+    {
+        pBuffer[ 0 ] = '\0';
+
+        used = appendLine( pBuffer, bufferLength, used, "Bytes sent:          %llu\r\n", pMetrics->bytesSent );
+        used = appendLine( pBuffer, bufferLength, used, "Bytes received:      %llu\r\n", pMetrics->bytesReceived );
+        used = appendLine( pBuffer, bufferLength, used, "Records sent:        %llu\r\n", pMetrics->recordsSent );
+        used = appendLine( pBuffer, bufferLength, used, "Records received:    %llu\r\n", pMetrics->recordsReceived );
+        used = appendLine( pBuffer, bufferLength, used, "Send calls:          %llu\r\n", pMetrics->sendCalls );
+        used = appendLine( pBuffer, bufferLength, used, "Recv calls:          %llu\r\n", pMetrics->recvCalls );
+        used = appendLine( pBuffer, bufferLength, used, "WANT_READ retries:   %llu\r\n", pMetrics->wantReadRetries );
+        used = appendLine( pBuffer, bufferLength, used, "WANT_WRITE retries:  %llu\r\n", pMetrics->wantWriteRetries );
+        used = appendLine( pBuffer, bufferLength, used, "Send errors:         %llu\r\n", pMetrics->sendErrors );
+        used = appendLine( pBuffer, bufferLength, used, "Recv errors:         %llu\r\n", pMetrics->recvErrors );
+        used = appendLine( pBuffer, bufferLength, used, "Connect time (us):   %llu\r\n", pMetrics->connectTimeUs );
+        used = appendLine( pBuffer, bufferLength, used, "Handshake time (us): %llu\r\n", pMetrics->handshakeTimeUs );
+        used = appendLine( pBuffer, bufferLength, used, "Handshake retries:   %llu\r\n"
+                                                        "Latency (us)  send       recv\r\n", pMetrics->handshakeRetries );
+
+        for( bucket = 0U; bucket < transportconfigMETRICS_HISTOGRAM_BUCKETS; bucket++ )
+        {
+            /* Skip empty buckets to keep the output short. */
+            if( ( pMetrics->sendLatencyHistogram[ bucket ] != 0U ) ||
+                ( pMetrics->recvLatencyHistogram[ bucket ] != 0U ) )
+            {
+                used = appendLine( pBuffer, bufferLength, used, "<%-11llu ", 1ULL << bucket );
+                used = appendLine( pBuffer, bufferLength, used, "%-10llu ", pMetrics->sendLatencyHistogram[ bucket ] );
+                used = appendLine( pBuffer, bufferLength, used, "%llu\r\n", pMetrics->recvLatencyHistogram[ bucket ] );
+            }
+        }
+    }
+
+    return used;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,156 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file transport_metrics.h
+ * @brief Per-connection statistics collected by the network transport
+ * implementations (plaintext, mbedTLS and wolfSSL).
+ *
+ * Metrics are disabled by default. Define transportconfigMETRICS_ENABLED to 1
+ * (for example in the demo_config.h or on the compiler command line) and build
+ * transport_metrics.c to enable them. When enabled, each transport keeps a
+ * #TransportMetrics_t in its per-connection parameters, which can be read
+ * back with the transport's GetMetrics() function.
+ */
+
+#ifndef TRANSPORT_METRICS_H
+#define TRANSPORT_METRICS_H
+
+/* Standard includes. */
+#include <stddef.h>
+#include <stdint.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/**
+ * @brief Set to 1 to collect per-connection transport statistics.
+ */
+#ifndef transportconfigMETRICS_ENABLED
+    #define transportconfigMETRICS_ENABLED    0
+#endif
+
+/**
+ * @brief Number of buckets in each send/recv latency histogram.
+ *
+ * Bucket 0 counts calls that completed in under 1us. Bucket n (n > 0) counts
+ * calls whose latency was in the range [2^(n-1), 2^n) microseconds. The last
+ * bucket also accumulates everything longer than that.
+ */
+#ifndef transportconfigMETRICS_HISTOGRAM_BUCKETS
+    #define transportconfigMETRICS_HISTOGRAM_BUCKETS    20U
+#endif
+
+/**
+ * @brief Timestamp source, in microseconds, used to measure latencies.
+ *
+ * The default is derived from the tick count, so it only advances once per
+ * tick and most send/recv calls fall into the first histogram bucket. Ports
+ * should supply a real microsecond clock, for example one derived from a free
+ * running timer or from the DWT CYCCNT cycle counter on Cortex-M.
+ */
+#ifndef transportMETRICS_GET_TIME_US
+    #define transportMETRICS_GET_TIME_US()    ( ( uint32_t ) ( ( ( uint64_t ) xTaskGetTickCount() * 1000000ULL ) / ( uint64_t ) configTICK_RATE_HZ ) )
+#endif
+
+/**
+ * @brief Statistics for a single network connection.
+ */
+typedef struct TransportMetrics
+{
+    uint64_t bytesSent;                                                         /**< @brief Application bytes successfully sent. */
+    uint64_t bytesReceived;                                                     /**< @brief Application bytes successfully received. */
+    uint32_t recordsSent;                                                       /**< @brief TLS records (or TCP writes for plaintext) sent. */
+    uint32_t recordsReceived;                                                   /**< @brief TLS records (or TCP reads for plaintext) received. */
+    uint32_t sendCalls;                                                         /**< @brief Number of calls to the transport send function. */
+    uint32_t recvCalls;                                                         /**< @brief Number of calls to the transport recv function. */
+    uint32_t wantReadRetries;                                                   /**< @brief Calls that returned WANT_READ (or a recv timeout). */
+    uint32_t wantWriteRetries;                                                  /**< @brief Calls that returned WANT_WRITE (or a send timeout). */
+    uint32_t sendErrors;                                                        /**< @brief Send calls that failed with a non retryable error. */
+    uint32_t recvErrors;                                                        /**< @brief Recv calls that failed with a non retryable error. */
+    uint32_t connectTimeUs;                                                     /**< @brief Time taken to establish the TCP connection. */
+    uint32_t handshakeTimeUs;                                                   /**< @brief Time taken by the TLS handshake, 0 for plaintext. */
+    uint32_t handshakeRetries;                                                  /**< @brief WANT_READ/WANT_WRITE retries during the handshake. */
+    uint32_t sendLatencyHistogram[ transportconfigMETRICS_HISTOGRAM_BUCKETS ]; /**< @brief Send call latency, log2 microsecond buckets. */
+    uint32_t recvLatencyHistogram[ transportconfigMETRICS_HISTOGRAM_BUCKETS ]; /**< @brief Recv call latency, log2 microsecond buckets. */
+} TransportMetrics_t;
+
+/**
+ * @brief Clear all the counters in a metrics block.
+ *
+ * @param[out] pMetrics The metrics block to clear.
+ */
+void TransportMetrics_Reset( TransportMetrics_t * pMetrics );
+
+/**
+ * @brief Account for one call to a transport send function.
+ *
+ * @param[in,out] pMetrics The connection's metrics block.
+ * @param[in] result The value returned by the send function: bytes sent when
+ * positive, 0 when the call should be retried, negative on error.
+ * @param[in] records Number of records the sent bytes were split into.
+ * @param[in] startTimeUs Value of transportMETRICS_GET_TIME_US() taken before
+ * the send was started.
+ */
+void TransportMetrics_RecordSend( TransportMetrics_t * pMetrics,
+                                  int32_t result,
+                                  uint32_t records,
+                                  uint32_t startTimeUs );
+
+/**
+ * @brief Account for one call to a transport recv function.
+ *
+ * @param[in,out] pMetrics The connection's metrics block.
+ * @param[in] result The value returned by the recv function: bytes received
+ * when positive, 0 when the call should be retried, negative on error.
+ * @param[in] records Number of records the received bytes came from.
+ * @param[in] startTimeUs Value of transportMETRICS_GET_TIME_US() taken before
+ * the recv was started.
+ */
+void TransportMetrics_RecordRecv( TransportMetrics_t * pMetrics,
+                                  int32_t result,
+                                  uint32_t records,
+                                  uint32_t startTimeUs );
+
+/**
+ * @brief Format a metrics block as human readable text.
+ *
+ * The output is intended to be returned from a FreeRTOS+CLI command or
+ * printed to a console. It is truncated, but always NULL terminated, if
+ * the buffer is too small.
+ *
+ * @param[in] pMetrics The metrics block to format.
+ * @param[out] pBuffer Buffer into which the text is written.
+ * @param[in] bufferLength Length of pBuffer in bytes.
+ *
+ * @return The number of characters written, excluding the NULL terminator.
+ */
+size_t TransportMetrics_Format( const TransportMetrics_t * pMetrics,
+                                char * pBuffer,
+                                size_t bufferLength );
+
+#endif /* ifndef TRANSPORT_METRICS_H */
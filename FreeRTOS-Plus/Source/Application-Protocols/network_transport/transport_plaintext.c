@@ -60,6 +60,10 @@ PlaintextTransportStatus_t Plaintext_FreeRTOS_Connect( NetworkContext_t * pNetwo
     PlaintextTransportStatus_t plaintextStatus = PLAINTEXT_TRANSPORT_SUCCESS;
     BaseType_t socketStatus = 0;
 
+    #if ( transportconfigMETRICS_ENABLED == 1 )
+        uint32_t startTimeUs = 0U;
+    #endif
+
     if( ( pNetworkContext == NULL ) || ( pNetworkContext->pParams == NULL ) || ( pHostName == NULL ) )
     {
         LogError( ( "Invalid input parameter(s): Arguments cannot be NULL. pNetworkContext=%p, "
@@ -75,6 +79,11 @@ PlaintextTransportStatus_t Plaintext_FreeRTOS_Connect( NetworkContext_t * pNetwo
         /* Initialize tcpSocket. */
         pPlaintextTransportParams->tcpSocket = NULL;
 
+        #if ( transportconfigMETRICS_ENABLED == 1 )
+            TransportMetrics_Reset( &( pPlaintextTransportParams->metrics ) );
+            startTimeUs = transportMETRICS_GET_TIME_US();
+        #endif
+
         /* Establish a TCP connection with the server. */
         socketStatus = TCP_Sockets_Connect( &( pPlaintextTransportParams->tcpSocket ),
                                             pHostName,
@@ -82,6 +91,10 @@ PlaintextTransportStatus_t Plaintext_FreeRTOS_Connect( NetworkContext_t * pNetwo
                                             receiveTimeoutMs,
                                             sendTimeoutMs );
 
+        #if ( transportconfigMETRICS_ENABLED == 1 )
+            pPlaintextTransportParams->metrics.connectTimeUs = transportMETRICS_GET_TIME_US() - startTimeUs;
+        #endif
+
         /* A non zero status is an error. */
         if( socketStatus != 0 )
         {
@@ -122,6 +135,10 @@ int32_t Plaintext_FreeRTOS_recv( NetworkContext_t * pNetworkContext,
     PlaintextTransportParams_t * pPlaintextTransportParams = NULL;
     int32_t socketStatus = 1;
 
+    #if ( transportconfigMETRICS_ENABLED == 1 )
+        uint32_t startTimeUs = transportMETRICS_GET_TIME_US();
+    #endif
+
     if( ( pNetworkContext == NULL ) || ( pNetworkContext->pParams == NULL ) )
     {
         LogError( ( "invalid input, pNetworkContext=%p", pNetworkContext ) );
@@ -144,6 +161,13 @@ int32_t Plaintext_FreeRTOS_recv( NetworkContext_t * pNetworkContext,
         socketStatus = TCP_Sockets_Recv( pPlaintextTransportParams->tcpSocket,
                                          pBuffer,
                                          bytesToRecv );
+
+        #if ( transportconfigMETRICS_ENABLED == 1 )
+            TransportMetrics_RecordRecv( &( pPlaintextTransportParams->metrics ),
+                                         socketStatus,
+                                         1U,
+                                         startTimeUs );
+        #endif
     }
 
     return socketStatus;
@@ -156,6 +180,10 @@ int32_t Plaintext_FreeRTOS_send( NetworkContext_t * pNetworkContext,
     PlaintextTransportParams_t * pPlaintextTransportParams = NULL;
     int32_t socketStatus = 0;
 
+    #if ( transportconfigMETRICS_ENABLED == 1 )
+        uint32_t startTimeUs = transportMETRICS_GET_TIME_US();
+    #endif
+
     if( ( pNetworkContext == NULL ) || ( pNetworkContext->pParams == NULL ) )
     {
         LogError( ( "invalid input, pNetworkContext=%p", pNetworkContext ) );
@@ -177,7 +205,34 @@ int32_t Plaintext_FreeRTOS_send( NetworkContext_t * pNetworkContext,
         socketStatus = TCP_Sockets_Send( pPlaintextTransportParams->tcpSocket,
                                          pBuffer,
                                          bytesToSend );
+
+        #if ( transportconfigMETRICS_ENABLED == 1 )
+            TransportMetrics_RecordSend( &( pPlaintextTransportParams->metrics ),
+                                         socketStatus,
+                                         1U,
+                                         startTimeUs );
+        #endif
     }
 
     return socketStatus;
 }
+
+#if ( transportconfigMETRICS_ENABLED == 1 )
+    PlaintextTransportStatus_t Plaintext_FreeRTOS_GetMetrics( const NetworkContext_t * pNetworkContext,
+                                                              TransportMetrics_t * pMetrics )
+    {
+        PlaintextTransportStatus_t plaintextStatus = PLAINTEXT_TRANSPORT_SUCCESS;
+
+        if( ( pNetworkContext == NULL ) || ( pNetworkContext->pParams == NULL ) || ( pMetrics == NULL ) )
+        {
+            LogError( ( "invalid input, pNetworkContext=%p, pMetrics=%p", pNetworkContext, pMetrics ) );
+            plaintextStatus = PLAINTEXT_TRANSPORT_INVALID_PARAMETER;
+        }
+        else
+        {
+            ( void ) memcpy( pMetrics, &( pNetworkContext->pParams->metrics ), sizeof( TransportMetrics_t ) );
+        }
+
+        return plaintextStatus;
+    }
+#endif /* transportconfigMETRICS_ENABLED == 1 */
@@ -71,12 +71,18 @@ extern void vLoggingPrintf( const char * pcFormatString,
 /* Transport interface include. */
 #include "transport_interface.h"
 
+/* Transport metrics include. */
+#include "transport_metrics.h"
+
 /**
  * @brief Parameters for the network context that uses FreeRTOS+TCP sockets.
  */
 typedef struct PlaintextTransportParams
 {
     Socket_t tcpSocket;
+    #if ( transportconfigMETRICS_ENABLED == 1 )
+        TransportMetrics_t metrics;
+    #endif
 } PlaintextTransportParams_t;
 
 /**
@@ -149,4 +155,22 @@ int32_t Plaintext_FreeRTOS_send( NetworkContext_t * pNetworkContext,
                                  const void * pBuffer,
                                  size_t bytesToSend );
 
+#if ( transportconfigMETRICS_ENABLED == 1 )
+
+/**
+ * @brief Get a snapshot of the statistics collected for a TCP connection.
+ *
+ * For plaintext connections a record is a single successful send or receive
+ * on the socket, and retries count the calls that timed out.
+ *
+ * @param[in] pNetworkContext The network context containing the TCP socket
+ * handle.
+ * @param[out] pMetrics Set to a copy of the connection's statistics.
+ *
+ * @return #PLAINTEXT_TRANSPORT_SUCCESS, or #PLAINTEXT_TRANSPORT_INVALID_PARAMETER.
+ */
+    PlaintextTransportStatus_t Plaintext_FreeRTOS_GetMetrics( const NetworkContext_t * pNetworkContext,
+                                                              TransportMetrics_t * pMetrics );
+#endif /* transportconfigMETRICS_ENABLED == 1 */
+
 #endif /* ifndef USING_PLAINTEXT_H */
@@ -0,0 +1,147 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file transport_tls_pool.c
+ * @brief Slot accounting shared by the TLS transports' connection pools.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Connection pool include. */
+#include "transport_tls_pool.h"
+
+#if ( transportconfigTLS_POOL_SLOTS > 0 )
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Which slots are currently held by a connection.
+ */
+    static uint8_t slotInUse[ transportconfigTLS_POOL_SLOTS ];
+
+/**
+ * @brief Pool statistics, protected by a critical section.
+ */
+    static TlsPoolStats_t poolStats;
+
+/*-----------------------------------------------------------*/
+
+    int32_t TlsPool_AcquireSlot( void )
+    {
+        int32_t slot = -1;
+        uint32_t i;
+
+        taskENTER_CRITICAL();
+        {
+            for( i = 0U; i < transportconfigTLS_POOL_SLOTS; i++ )
+            {
+                if( slotInUse[ i ] == 0U )
+                {
+                    slotInUse[ i ] = 1U;
+                    slot = ( int32_t ) i;
+                    break;
+                }
+            }
+
+            if( slot >= 0 )
+            {
+                poolStats.slotsInUse++;
+
+                if( poolStats.slotsInUse > poolStats.slotsHighWater )
+                {
+                    poolStats.slotsHighWater = poolStats.slotsInUse;
+                }
+            }
+            else
+            {
+                poolStats.slotExhaustions++;
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        return slot;
+    }
+/*-----------------------------------------------------------*/
+
+    void TlsPool_ReleaseSlot( int32_t slot )
+    {
+        configASSERT( ( slot >= 0 ) && ( slot < ( int32_t ) transportconfigTLS_POOL_SLOTS ) );
+
+        taskENTER_CRITICAL();
+        {
+            configASSERT( slotInUse[ slot ] != 0U );
+
+            slotInUse[ slot ] = 0U;
+            poolStats.slotsInUse--;
+        }
+        taskEXIT_CRITICAL();
+    }
+/*-----------------------------------------------------------*/
+
+    void TlsPool_RecordBytesInUse( size_t bytesInUse )
+    {
+        taskENTER_CRITICAL();
+        {
+            if( bytesInUse > poolStats.bytesHighWater )
+            {
+                poolStats.bytesHighWater = bytesInUse;
+            }
+        }
+        taskEXIT_CRITICAL();
+    }
+/*-----------------------------------------------------------*/
+
+    void TlsPool_RecordHeapFallback( void )
+    {
+        taskENTER_CRITICAL();
+        {
+            poolStats.heapFallbacks++;
+        }
+        taskEXIT_CRITICAL();
+    }
+/*-----------------------------------------------------------*/
+
+    void TlsPool_GetStats( TlsPoolStats_t * pStats )
+    {
+        configASSERT( pStats != NULL );
+
+        taskENTER_CRITICAL();
+        {
+            ( void ) memcpy( pStats, &poolStats, sizeof( TlsPoolStats_t ) );
+        }
+        taskEXIT_CRITICAL();
+
+        pStats->slotCount = transportconfigTLS_POOL_SLOTS;
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* transportconfigTLS_POOL_SLOTS > 0 */
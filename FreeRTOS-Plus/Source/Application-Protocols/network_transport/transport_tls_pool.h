@@ -0,0 +1,122 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file transport_tls_pool.h
+ * @brief Fixed pool of connection slots used by the TLS transports to hold
+ * their per-connection TLS memory in statically allocated buffers.
+ *
+ * The pool is disabled by default, in which case the TLS libraries allocate
+ * everything from the FreeRTOS heap on every connection. Define
+ * transportconfigTLS_POOL_SLOTS to the maximum number of simultaneous TLS
+ * connections and build transport_tls_pool.c to enable it. When enabled,
+ * TLS_FreeRTOS_Connect() reserves a slot for the lifetime of the connection
+ * and fails with #TLS_TRANSPORT_INSUFFICIENT_MEMORY when all slots are in
+ * use. How a slot's memory is used depends on the TLS library; see
+ * transport_mbedtls.h and transport_wolfSSL.h.
+ */
+
+#ifndef TRANSPORT_TLS_POOL_H
+#define TRANSPORT_TLS_POOL_H
+
+/* Standard includes. */
+#include <stddef.h>
+#include <stdint.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/**
+ * @brief Number of connection slots in the pool, 0 to disable the pool.
+ */
+#ifndef transportconfigTLS_POOL_SLOTS
+    #define transportconfigTLS_POOL_SLOTS    ( 0U )
+#endif
+
+/**
+ * @brief Usage statistics of the connection pool.
+ */
+typedef struct TlsPoolStats
+{
+    uint32_t slotCount;       /**< @brief Number of slots in the pool. */
+    size_t slotSize;          /**< @brief Bytes of static memory behind each slot. */
+    uint32_t slotsInUse;      /**< @brief Slots currently held by a connection. */
+    uint32_t slotsHighWater;  /**< @brief Most slots that have been in use at the same time. */
+    uint32_t slotExhaustions; /**< @brief Connection attempts refused because every slot was in use. */
+    size_t bytesHighWater;    /**< @brief Most pool bytes in use; see the transport for what is counted. */
+    uint32_t heapFallbacks;   /**< @brief Pool sized allocations that had to be served by the heap. */
+} TlsPoolStats_t;
+
+#if ( transportconfigTLS_POOL_SLOTS > 0 )
+
+/**
+ * @brief Value of a transport's poolSlot member when it holds no slot.
+ *
+ * The transports store the index of the slot they hold plus one, so that
+ * parameters that are zero initialised and were never connected hold no slot,
+ * and disconnecting them does not release one.
+ */
+    #define TLS_POOL_SLOT_UNASSIGNED    ( 0 )
+
+/**
+ * @brief Reserve a free slot for a new connection.
+ *
+ * @return Index of the reserved slot, or -1 if every slot is in use.
+ */
+    int32_t TlsPool_AcquireSlot( void );
+
+/**
+ * @brief Return a slot obtained from TlsPool_AcquireSlot() to the pool.
+ *
+ * @param[in] slot The slot index.
+ */
+    void TlsPool_ReleaseSlot( int32_t slot );
+
+/**
+ * @brief Report how many bytes of pool memory are in use, so the high-water
+ * mark can be updated.
+ *
+ * @param[in] bytesInUse The number of bytes currently in use.
+ */
+    void TlsPool_RecordBytesInUse( size_t bytesInUse );
+
+/**
+ * @brief Account for an allocation that should have come from the pool but
+ * was served by the heap instead.
+ */
+    void TlsPool_RecordHeapFallback( void );
+
+/**
+ * @brief Get a snapshot of the pool statistics.
+ *
+ * @param[out] pStats Set to the current statistics. The slotSize member is
+ * left at 0 for the calling transport to fill in.
+ */
+    void TlsPool_GetStats( TlsPoolStats_t * pStats );
+
+#endif /* transportconfigTLS_POOL_SLOTS > 0 */
+
+#endif /* ifndef TRANSPORT_TLS_POOL_H */
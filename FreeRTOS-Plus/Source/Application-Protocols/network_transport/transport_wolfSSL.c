@@ -36,10 +36,6 @@
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
 
-/* FreeRTOS+TCP includes. */
-#include "FreeRTOS_IP.h"
-#include "FreeRTOS_Sockets.h"
-
 /* TLS transport header. */
 #include "transport_wolfSSL.h"
 
@@ -52,6 +48,15 @@
 /* Demo Specific configs. */
 #include "demo_config.h"
 
+#if ( transportconfigTLS_POOL_SLOTS > 0 )
+
+/**
+ * @brief Static memory regions handed to wolfSSL, one per pool slot.
+ * uint64_t keeps them aligned for wolfSSL's memory manager.
+ */
+    static uint64_t poolSlotMemory[ transportconfigTLS_POOL_SLOTS ][ ( transportconfigWOLFSSL_POOL_SLOT_SIZE + 7U ) / 8U ];
+#endif
+
 /**
  * @brief Initialize the TLS structures in a network connection.
  *
@@ -143,11 +148,11 @@ static int wolfSSL_IORecvGlue( WOLFSSL * ssl,
     read = TCP_Sockets_Recv( xSocket, ( void * ) buf, ( size_t ) sz );
 
     if( ( read == 0 ) ||
-        ( read == -TCP_SOCKETS_ERRNO_EWOULDBLOCK ) )
+        ( read == TCP_SOCKETS_ERRNO_EWOULDBLOCK ) )
     {
         read = WOLFSSL_CBIO_ERR_WANT_READ;
     }
-    else if( read == -TCP_SOCKETS_ERRNO_ENOTCONN )
+    else if( read == TCP_SOCKETS_ERRNO_ENOTCONN )
     {
         read = WOLFSSL_CBIO_ERR_CONN_CLOSE;
     }
@@ -169,11 +174,13 @@ static int wolfSSL_IOSendGlue( WOLFSSL * ssl,
     Socket_t xSocket = ( Socket_t ) context;
     BaseType_t sent = TCP_Sockets_Send( xSocket, ( void * ) buf, ( size_t ) sz );
 
-    if( sent == -TCP_SOCKETS_ERRNO_EWOULDBLOCK )
+    if( ( sent == 0 ) ||
+        ( sent == TCP_SOCKETS_ERRNO_EWOULDBLOCK ) ||
+        ( sent == TCP_SOCKETS_ERRNO_ENOSPC ) )
     {
         sent = WOLFSSL_CBIO_ERR_WANT_WRITE;
     }
-    else if( sent == -TCP_SOCKETS_ERRNO_ENOTCONN )
+    else if( sent == TCP_SOCKETS_ERRNO_ENOTCONN )
     {
         sent = WOLFSSL_CBIO_ERR_CONN_CLOSE;
     }
@@ -284,6 +291,11 @@ static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetCtx,
 {
     TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
     Socket_t xSocket = { 0 };
+    int handshakeStatus = 0;
+
+    #if ( transportconfigMETRICS_ENABLED == 1 )
+        uint32_t startTimeUs = 0U;
+    #endif
 
     configASSERT( pNetCtx != NULL );
     configASSERT( pHostName != NULL );
@@ -293,9 +305,34 @@ static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetCtx,
 
     if( pNetCtx->sslContext.ctx == NULL )
     {
-        /* Attempt to create a context that uses the TLS 1.3 or 1.2 */
-        pNetCtx->sslContext.ctx =
-            wolfSSL_CTX_new( wolfSSLv23_client_method_ex( NULL ) );
+        #if ( transportconfigTLS_POOL_SLOTS > 0 )
+            /* Build the context, and everything later allocated through it,
+             * inside a static region instead of the heap. */
+            pNetCtx->poolSlot = TlsPool_AcquireSlot() + 1;
+
+            if( pNetCtx->poolSlot == TLS_POOL_SLOT_UNASSIGNED )
+            {
+                LogError( ( "All %u TLS connection pool slots are in use.",
+                            ( unsigned ) transportconfigTLS_POOL_SLOTS ) );
+            }
+            else if( wolfSSL_CTX_load_static_memory( &( pNetCtx->sslContext.ctx ),
+                                                     wolfSSLv23_client_method_ex,
+                                                     ( unsigned char * ) poolSlotMemory[ pNetCtx->poolSlot - 1 ],
+                                                     ( unsigned int ) sizeof( poolSlotMemory[ 0 ] ),
+                                                     WOLFMEM_TRACK_STATS,
+                                                     1 ) != WOLFSSL_SUCCESS )
+            {
+                pNetCtx->sslContext.ctx = NULL;
+            }
+            else
+            {
+                /* Context created in the slot. */
+            }
+        #else
+            /* Attempt to create a context that uses the TLS 1.3 or 1.2 */
+            pNetCtx->sslContext.ctx =
+                wolfSSL_CTX_new( wolfSSLv23_client_method_ex( NULL ) );
+        #endif /* transportconfigTLS_POOL_SLOTS > 0 */
     }
 
     if( pNetCtx->sslContext.ctx != NULL )
@@ -321,9 +358,18 @@ static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetCtx,
                 wolfSSL_SetIOReadCtx( pNetCtx->sslContext.ssl, xSocket );
                 wolfSSL_SetIOWriteCtx( pNetCtx->sslContext.ssl, xSocket );
 
+                #if ( transportconfigMETRICS_ENABLED == 1 )
+                    startTimeUs = transportMETRICS_GET_TIME_US();
+                #endif
+
                 /* let wolfSSL perform tls handshake */
-                if( wolfSSL_connect( pNetCtx->sslContext.ssl )
-                    == SSL_SUCCESS )
+                handshakeStatus = wolfSSL_connect( pNetCtx->sslContext.ssl );
+
+                #if ( transportconfigMETRICS_ENABLED == 1 )
+                    pNetCtx->metrics.handshakeTimeUs = transportMETRICS_GET_TIME_US() - startTimeUs;
+                #endif
+
+                if( handshakeStatus == SSL_SUCCESS )
                 {
                     returnStatus = TLS_TRANSPORT_SUCCESS;
                 }
@@ -361,8 +407,25 @@ static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetCtx,
     {
         LogError( ( "Failed to create a wolfSSL_CTX" ) );
         returnStatus = TLS_TRANSPORT_CONNECT_FAILURE;
+
+        #if ( transportconfigTLS_POOL_SLOTS > 0 )
+            if( pNetCtx->poolSlot == TLS_POOL_SLOT_UNASSIGNED )
+            {
+                returnStatus = TLS_TRANSPORT_INSUFFICIENT_MEMORY;
+            }
+        #endif
     }
 
+    #if ( transportconfigTLS_POOL_SLOTS > 0 )
+        /* Every failure path above has freed the context, so the slot's
+         * memory is no longer referenced. */
+        if( ( returnStatus != TLS_TRANSPORT_SUCCESS ) && ( pNetCtx->poolSlot != TLS_POOL_SLOT_UNASSIGNED ) )
+        {
+            TlsPool_ReleaseSlot( pNetCtx->poolSlot - 1 );
+            pNetCtx->poolSlot = TLS_POOL_SLOT_UNASSIGNED;
+        }
+    #endif
+
     return returnStatus;
 }
 
@@ -382,6 +445,10 @@ TlsTransportStatus_t TLS_FreeRTOS_Connect( NetworkContext_t * pNetworkContext,
     BaseType_t socketStatus = 0;
     BaseType_t isSocketConnected = pdFALSE;
 
+    #if ( transportconfigMETRICS_ENABLED == 1 )
+        uint32_t startTimeUs = 0U;
+    #endif
+
     if( ( pNetworkContext == NULL ) ||
         ( pHostName == NULL ) ||
         ( pNetworkCredentials == NULL ) )
@@ -404,12 +471,25 @@ TlsTransportStatus_t TLS_FreeRTOS_Connect( NetworkContext_t * pNetworkContext,
     {
         pNetworkContext->tcpSocket = NULL;
 
+        #if ( transportconfigTLS_POOL_SLOTS > 0 )
+            pNetworkContext->poolSlot = TLS_POOL_SLOT_UNASSIGNED;
+        #endif
+
+        #if ( transportconfigMETRICS_ENABLED == 1 )
+            TransportMetrics_Reset( &( pNetworkContext->metrics ) );
+            startTimeUs = transportMETRICS_GET_TIME_US();
+        #endif
+
         socketStatus = TCP_Sockets_Connect( &( pNetworkContext->tcpSocket ),
                                             pHostName,
                                             port,
                                             receiveTimeoutMs,
                                             sendTimeoutMs );
 
+        #if ( transportconfigMETRICS_ENABLED == 1 )
+            pNetworkContext->metrics.connectTimeUs = transportMETRICS_GET_TIME_US() - startTimeUs;
+        #endif
+
         if( socketStatus != 0 )
         {
             LogError( ( "Failed to connect to %s with error %d.",
@@ -459,9 +539,23 @@ void TLS_FreeRTOS_Disconnect( NetworkContext_t * pNetworkContext )
     WOLFSSL * pSsl = pNetworkContext->sslContext.ssl;
     WOLFSSL_CTX * pCtx = NULL;
 
+    #if ( transportconfigTLS_POOL_SLOTS > 0 )
+        WOLFSSL_MEM_CONN_STATS memStats;
+    #endif
+
     /* shutdown an active TLS connection */
     wolfSSL_shutdown( pSsl );
 
+    #if ( transportconfigTLS_POOL_SLOTS > 0 )
+        /* Record how much of the slot this connection needed at most. */
+        ( void ) memset( &memStats, 0, sizeof( memStats ) );
+
+        if( wolfSSL_is_static_memory( pSsl, &memStats ) == 1 )
+        {
+            TlsPool_RecordBytesInUse( ( size_t ) memStats.peakMem );
+        }
+    #endif
+
     /* cleanup WOLFSSL object */
     wolfSSL_free( pSsl );
     pNetworkContext->sslContext.ssl = NULL;
@@ -475,6 +569,14 @@ void TLS_FreeRTOS_Disconnect( NetworkContext_t * pNetworkContext )
     wolfSSL_CTX_free( pCtx );
     pNetworkContext->sslContext.ctx = NULL;
 
+    #if ( transportconfigTLS_POOL_SLOTS > 0 )
+        if( pNetworkContext->poolSlot != TLS_POOL_SLOT_UNASSIGNED )
+        {
+            TlsPool_ReleaseSlot( pNetworkContext->poolSlot - 1 );
+            pNetworkContext->poolSlot = TLS_POOL_SLOT_UNASSIGNED;
+        }
+    #endif
+
     wolfSSL_Cleanup();
 }
 
@@ -488,6 +590,10 @@ int32_t TLS_FreeRTOS_recv( NetworkContext_t * pNetworkContext,
     int iResult = 0;
     WOLFSSL * pSsl = NULL;
 
+    #if ( transportconfigMETRICS_ENABLED == 1 )
+        uint32_t startTimeUs = transportMETRICS_GET_TIME_US();
+    #endif
+
     if( ( pNetworkContext == NULL ) || ( pNetworkContext->sslContext.ssl == NULL ) )
     {
         LogError( ( "invalid input, pNetworkContext=%p", pNetworkContext ) );
@@ -523,6 +629,16 @@ int32_t TLS_FreeRTOS_recv( NetworkContext_t * pNetworkContext,
             LogError( ( "Error from wolfSSL_read %d : %s ",
                         iResult, wolfSSL_ERR_reason_error_string( tlsStatus ) ) );
         }
+
+        #if ( transportconfigMETRICS_ENABLED == 1 )
+            /* wolfSSL_read() never returns data from more than one record.
+             * wolfSSL_state() values are not byte counts, so errors are
+             * accounted as -1. */
+            TransportMetrics_RecordRecv( &( pNetworkContext->metrics ),
+                                         ( iResult > 0 ) ? iResult : ( ( tlsStatus == 0 ) ? 0 : -1 ),
+                                         1U,
+                                         startTimeUs );
+        #endif
     }
 
     return tlsStatus;
@@ -538,6 +654,11 @@ int32_t TLS_FreeRTOS_send( NetworkContext_t * pNetworkContext,
     int iResult = 0;
     WOLFSSL * pSsl = NULL;
 
+    #if ( transportconfigMETRICS_ENABLED == 1 )
+        uint32_t startTimeUs = transportMETRICS_GET_TIME_US();
+        int maxRecordPayload = 0;
+    #endif
+
     if( ( pNetworkContext == NULL ) || ( pNetworkContext->sslContext.ssl == NULL ) )
     {
         LogError( ( "invalid input, pNetworkContext=%p", pNetworkContext ) );
@@ -573,8 +694,66 @@ int32_t TLS_FreeRTOS_send( NetworkContext_t * pNetworkContext,
             LogError( ( "Error from wolfSL_write %d : %s ",
                         iResult, wolfSSL_ERR_reason_error_string( tlsStatus ) ) );
         }
+
+        #if ( transportconfigMETRICS_ENABLED == 1 )
+            /* The written bytes are split into records of at most the maximum
+             * output fragment size. */
+            maxRecordPayload = wolfSSL_GetMaxOutputSize( pSsl );
+
+            if( maxRecordPayload <= 0 )
+            {
+                maxRecordPayload = ( iResult > 0 ) ? iResult : 1;
+            }
+
+            TransportMetrics_RecordSend( &( pNetworkContext->metrics ),
+                                         ( iResult > 0 ) ? iResult : ( ( tlsStatus == 0 ) ? 0 : -1 ),
+                                         ( iResult > 0 ) ? ( uint32_t ) ( ( iResult + maxRecordPayload - 1 ) / maxRecordPayload ) : 0U,
+                                         startTimeUs );
+        #endif
     }
 
     return tlsStatus;
 }
 /*-----------------------------------------------------------*/
+
+#if ( transportconfigMETRICS_ENABLED == 1 )
+    TlsTransportStatus_t TLS_FreeRTOS_GetMetrics( const NetworkContext_t * pNetworkContext,
+                                                  TransportMetrics_t * pMetrics )
+    {
+        TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
+
+        if( ( pNetworkContext == NULL ) || ( pMetrics == NULL ) )
+        {
+            LogError( ( "invalid input, pNetworkContext=%p, pMetrics=%p", pNetworkContext, pMetrics ) );
+            returnStatus = TLS_TRANSPORT_INVALID_PARAMETER;
+        }
+        else
+        {
+            ( void ) memcpy( pMetrics, &( pNetworkContext->metrics ), sizeof( TransportMetrics_t ) );
+        }
+
+        return returnStatus;
+    }
+#endif /* transportconfigMETRICS_ENABLED == 1 */
+/*-----------------------------------------------------------*/
+
+#if ( transportconfigTLS_POOL_SLOTS > 0 )
+    TlsTransportStatus_t TLS_FreeRTOS_GetPoolStats( TlsPoolStats_t * pStats )
+    {
+        TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
+
+        if( pStats == NULL )
+        {
+            LogError( ( "invalid input, pStats=%p", pStats ) );
+            returnStatus = TLS_TRANSPORT_INVALID_PARAMETER;
+        }
+        else
+        {
+            TlsPool_GetStats( pStats );
+            pStats->slotSize = sizeof( poolSlotMemory[ 0 ] );
+        }
+
+        return returnStatus;
+    }
+#endif /* transportconfigTLS_POOL_SLOTS > 0 */
+/*-----------------------------------------------------------*/
@@ -57,8 +57,8 @@
 
 /************ End of logging configuration ****************/
 
-/* FreeRTOS+TCP include. */
-#include "FreeRTOS_Sockets.h"
+/* TCP Sockets Wrapper include.*/
+#include "tcp_sockets_wrapper.h"
 
 /* Transport interface include. */
 #include "transport_interface.h"
@@ -66,6 +66,29 @@
 /* wolfSSL interface include. */
 #include "wolfssl/ssl.h"
 
+/* Transport metrics include. */
+#include "transport_metrics.h"
+
+/* Connection pool include. */
+#include "transport_tls_pool.h"
+
+#if ( transportconfigTLS_POOL_SLOTS > 0 )
+    #ifndef WOLFSSL_STATIC_MEMORY
+        #error "The wolfSSL connection pool requires WOLFSSL_STATIC_MEMORY in user_settings.h."
+    #endif
+
+/**
+ * @brief Size of the static memory region behind each pool slot.
+ *
+ * Each connection's WOLFSSL_CTX, WOLFSSL object and I/O buffers are carved
+ * out of its slot with wolfSSL_CTX_load_static_memory(), so the slot must be
+ * large enough for the certificates, the handshake and two records.
+ */
+    #ifndef transportconfigWOLFSSL_POOL_SLOT_SIZE
+        #define transportconfigWOLFSSL_POOL_SLOT_SIZE    ( 96U * 1024U )
+    #endif
+#endif /* transportconfigTLS_POOL_SLOTS > 0 */
+
 /**
  * @brief Secured connection context.
  */
@@ -83,6 +106,12 @@ struct NetworkContext
 {
     Socket_t tcpSocket;
     SSLContext_t sslContext;
+    #if ( transportconfigMETRICS_ENABLED == 1 )
+        TransportMetrics_t metrics;
+    #endif
+    #if ( transportconfigTLS_POOL_SLOTS > 0 )
+        int32_t poolSlot; /**< @brief Connection pool slot held by this connection plus one, #TLS_POOL_SLOT_UNASSIGNED if none. */
+    #endif
 };
 
 /**
@@ -196,4 +225,38 @@ int32_t TLS_FreeRTOS_send( NetworkContext_t * pNetworkContext,
                            const void * pBuffer,
                            size_t bytesToSend );
 
+#if ( transportconfigMETRICS_ENABLED == 1 )
+
+/**
+ * @brief Get a snapshot of the statistics collected for a TLS connection.
+ *
+ * The statistics are cleared by TLS_FreeRTOS_Connect() and remain readable
+ * after TLS_FreeRTOS_Disconnect() until the next connection attempt.
+ *
+ * @param[in] pNetworkContext The network context.
+ * @param[out] pMetrics Set to a copy of the connection's statistics.
+ *
+ * @return #TLS_TRANSPORT_SUCCESS, or #TLS_TRANSPORT_INVALID_PARAMETER.
+ */
+    TlsTransportStatus_t TLS_FreeRTOS_GetMetrics( const NetworkContext_t * pNetworkContext,
+                                                  TransportMetrics_t * pMetrics );
+#endif /* transportconfigMETRICS_ENABLED == 1 */
+
+#if ( transportconfigTLS_POOL_SLOTS > 0 )
+
+/**
+ * @brief Get the usage statistics of the connection pool.
+ *
+ * wolfSSL only tracks memory per static region, so bytesHighWater is the
+ * peak usage of the busiest single connection, measured at disconnect. It
+ * shows how much headroom #transportconfigWOLFSSL_POOL_SLOT_SIZE has.
+ * heapFallbacks is always 0 as wolfSSL never falls back to the heap.
+ *
+ * @param[out] pStats Set to the current statistics.
+ *
+ * @return #TLS_TRANSPORT_SUCCESS, or #TLS_TRANSPORT_INVALID_PARAMETER.
+ */
+    TlsTransportStatus_t TLS_FreeRTOS_GetPoolStats( TlsPoolStats_t * pStats );
+#endif /* transportconfigTLS_POOL_SLOTS > 0 */
+
 #endif /* ifndef USING_WOLFSSL_H */
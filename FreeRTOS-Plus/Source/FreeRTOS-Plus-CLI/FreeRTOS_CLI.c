@@ -45,6 +45,17 @@
     #define configAPPLICATION_PROVIDES_cOutputBuffer    0
 #endif
 
+/* Registered commands are looked up in a hash table with this many buckets,
+ * so the time taken to find a command does not grow with the number of
+ * commands that are registered.  Must be a power of 2. */
+#ifndef configCOMMAND_INT_HASH_BUCKETS
+    #define configCOMMAND_INT_HASH_BUCKETS    32
+#endif
+
+#if ( ( configCOMMAND_INT_HASH_BUCKETS & ( configCOMMAND_INT_HASH_BUCKETS - 1 ) ) != 0 )
+    #error configCOMMAND_INT_HASH_BUCKETS must be a power of 2
+#endif
+
 /*
  * Register the command passed in using the pxCommandToRegister parameter
  * and using pxCliDefinitionListItemBuffer as the memory for command line
@@ -63,6 +74,50 @@ static BaseType_t prvHelpCommand( char * pcWriteBuffer,
                                   size_t xWriteBufferLen,
                                   const char * pcCommandString );
 
+/*
+ * The "help" command as run within pxSession, which holds the position in the
+ * list of commands between calls.
+ */
+static BaseType_t prvHelpCommandSession( CLI_Session_t * pxSession,
+                                         char * pcWriteBuffer,
+                                         size_t xWriteBufferLen );
+
+/*
+ * Run pcCommandInput within pxSession, writing its output to pcWriteBuffer.
+ */
+static BaseType_t prvProcessCommand( CLI_Session_t * pxSession,
+                                     const char * const pcCommandInput,
+                                     char * pcWriteBuffer,
+                                     size_t xWriteBufferLen );
+
+/*
+ * Return pdTRUE if pcCommandInput has the number of parameters expected by
+ * pxCommand, otherwise pdFALSE.
+ */
+static BaseType_t prvCheckNumberOfParameters( const CLI_Definition_List_Item_t * pxCommand,
+                                              const char * pcCommandInput );
+
+/*
+ * The write function of the sink through which a streaming command writes into
+ * the output buffer of FreeRTOS_CLIProcessCommand() and
+ * FreeRTOS_CLIProcessCommandSession().
+ */
+static BaseType_t prvBufferSinkWrite( void * pvContext,
+                                      const char * pcData,
+                                      size_t xDataLength );
+
+/*
+ * Find the registered command that matches the first word of pcCommandInput,
+ * or return NULL if there is none.
+ */
+static const CLI_Definition_List_Item_t * prvFindCommand( const char * pcCommandInput );
+
+/*
+ * Return the hash table bucket for the xLength long command name pcCommand.
+ */
+static UBaseType_t prvHashCommand( const char * pcCommand,
+                                   size_t xLength );
+
 /*
  * Return the number of parameters that follow the command name.
  */
@@ -75,7 +130,8 @@ static const CLI_Command_Definition_t xHelpCommand =
     "help",
     "\r\nhelp:\r\n Lists all the registered commands\r\n\r\n",
     prvHelpCommand,
-    0
+    0,
+    NULL
 };
 
 /* The definition of the list of commands.  Commands that are registered are
@@ -83,9 +139,28 @@ static const CLI_Command_Definition_t xHelpCommand =
 static CLI_Definition_List_Item_t xRegisteredCommands =
 {
     &xHelpCommand, /* The first command in the list is always the help command, defined in this file. */
-    NULL           /* The next pointer is initialised to NULL, as there are no other registered commands yet. */
+    NULL,          /* The next pointer is initialised to NULL, as there are no other registered commands yet. */
+    NULL           /* The help command is not stored in the hash table, prvFindCommand() checks it first. */
 };
 
+/* The hash table of registered commands, other than "help".  Commands with the
+ * same hash are chained in the order in which they were registered, so if a
+ * name is registered twice the first registration is found, as when the list
+ * of commands was searched from its start. */
+static CLI_Definition_List_Item_t * pxCommandBuckets[ configCOMMAND_INT_HASH_BUCKETS ];
+
+/* The session used by FreeRTOS_CLIProcessCommand(), which predates sessions. */
+static CLI_Session_t xDefaultSession;
+
+/* The context of the sink created by prvProcessCommand() when a streaming
+ * command is run by one of the functions that return output in a buffer. */
+typedef struct xBUFFER_SINK_CONTEXT
+{
+    char * pcBuffer;       /* The buffer passed to prvProcessCommand(). */
+    size_t xBufferLength;  /* The size of pcBuffer in bytes. */
+    size_t xBytesWritten;  /* The number of bytes written so far, excluding the terminating NULL. */
+} BufferSinkContext_t;
+
 /* A buffer into which command outputs can be written is declared here, rather
 * than in the command console implementation, to allow multiple command consoles
 * to share the same buffer.  For example, an application may allow access to the
@@ -154,66 +229,106 @@ BaseType_t FreeRTOS_CLIProcessCommand( const char * const pcCommandInput,
                                        char * pcWriteBuffer,
                                        size_t xWriteBufferLen )
 {
-    static const CLI_Definition_List_Item_t * pxCommand = NULL;
-    BaseType_t xReturn = pdTRUE;
-    const char * pcRegisteredCommandString;
-    size_t xCommandStringLength;
-
     /* Note:  This function is not re-entrant.  It must not be called from more
      * thank one task. */
+    return prvProcessCommand( &xDefaultSession, pcCommandInput, pcWriteBuffer, xWriteBufferLen );
+}
+/*-----------------------------------------------------------*/
+
+void FreeRTOS_CLIInitSession( CLI_Session_t * pxSession,
+                              char * pcOutputBuffer,
+                              size_t xOutputBufferLength )
+{
+    configASSERT( pxSession != NULL );
+    configASSERT( pcOutputBuffer != NULL );
+
+    pxSession->pxCommand = NULL;
+    pxSession->pxHelpCommand = NULL;
+    pxSession->pcOutputBuffer = pcOutputBuffer;
+    pxSession->xOutputBufferLength = xOutputBufferLength;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t FreeRTOS_CLIProcessCommandSession( CLI_Session_t * pxSession,
+                                              const char * const pcCommandInput )
+{
+    configASSERT( pxSession != NULL );
+    configASSERT( pxSession->pcOutputBuffer != NULL );
+
+    return prvProcessCommand( pxSession, pcCommandInput, pxSession->pcOutputBuffer, pxSession->xOutputBufferLength );
+}
+/*-----------------------------------------------------------*/
 
-    if( pxCommand == NULL )
+static BaseType_t prvProcessCommand( CLI_Session_t * pxSession,
+                                     const char * const pcCommandInput,
+                                     char * pcWriteBuffer,
+                                     size_t xWriteBufferLen )
+{
+    BaseType_t xReturn = pdTRUE;
+
+    if( pxSession->pxCommand == NULL )
     {
-        /* Search for the command string in the list of registered commands. */
-        for( pxCommand = &xRegisteredCommands; pxCommand != NULL; pxCommand = pxCommand->pxNext )
+        /* Search for the command string in the registered commands. */
+        pxSession->pxCommand = prvFindCommand( pcCommandInput );
+
+        if( pxSession->pxCommand != NULL )
         {
-            pcRegisteredCommandString = pxCommand->pxCommandLineDefinition->pcCommand;
-            xCommandStringLength = strlen( pcRegisteredCommandString );
-
-            /* To ensure the string lengths match exactly, so as not to pick up
-             * a sub-string of a longer command, check the byte after the expected
-             * end of the string is either the end of the string or a space before
-             * a parameter. */
-            if( strncmp( pcCommandInput, pcRegisteredCommandString, xCommandStringLength ) == 0 )
-            {
-                if( ( pcCommandInput[ xCommandStringLength ] == ' ' ) || ( pcCommandInput[ xCommandStringLength ] == 0x00 ) )
-                {
-                    /* The command has been found.  Check it has the expected
-                     * number of parameters.  If cExpectedNumberOfParameters is -1,
-                     * then there could be a variable number of parameters and no
-                     * check is made. */
-                    if( pxCommand->pxCommandLineDefinition->cExpectedNumberOfParameters >= 0 )
-                    {
-                        if( prvGetNumberOfParameters( pcCommandInput ) != pxCommand->pxCommandLineDefinition->cExpectedNumberOfParameters )
-                        {
-                            xReturn = pdFALSE;
-                        }
-                    }
-
-                    break;
-                }
-            }
+            /* The command has been found.  Check it has the expected
+             * number of parameters. */
+            xReturn = prvCheckNumberOfParameters( pxSession->pxCommand, pcCommandInput );
         }
     }
 
-    if( ( pxCommand != NULL ) && ( xReturn == pdFALSE ) )
+    if( ( pxSession->pxCommand != NULL ) && ( xReturn == pdFALSE ) )
     {
         /* The command was found, but the number of parameters with the command
          * was incorrect. */
         strncpy( pcWriteBuffer, "Incorrect command parameter(s).  Enter \"help\" to view a list of available commands.\r\n\r\n", xWriteBufferLen );
-        pxCommand = NULL;
+        pxSession->pxCommand = NULL;
     }
-    else if( pxCommand != NULL )
+    else if( pxSession->pxCommand != NULL )
     {
-        /* Call the callback function that is registered to this command. */
-        xReturn = pxCommand->pxCommandLineDefinition->pxCommandInterpreter( pcWriteBuffer, xWriteBufferLen, pcCommandInput );
+        /* Call the callback function that is registered to this command.  The
+         * help command keeps its position in the session, so it is called
+         * directly rather than through its callback. */
+        if( pxSession->pxCommand == &xRegisteredCommands )
+        {
+            xReturn = prvHelpCommandSession( pxSession, pcWriteBuffer, xWriteBufferLen );
+        }
+        else if( pxSession->pxCommand->pxCommandLineDefinition->pxSinkInterpreter != NULL )
+        {
+            BufferSinkContext_t xContext;
+            CLI_Output_Sink_t xSink;
+
+            /* A streaming command cannot be resumed, so its output is written
+             * into pcWriteBuffer in one go, and truncated if it does not fit. */
+            xContext.pcBuffer = pcWriteBuffer;
+            xContext.xBufferLength = xWriteBufferLen;
+            xContext.xBytesWritten = 0;
+
+            if( xWriteBufferLen > 0 )
+            {
+                pcWriteBuffer[ 0 ] = 0x00;
+            }
+
+            xSink.pxWrite = prvBufferSinkWrite;
+            xSink.pxFlush = NULL;
+            xSink.pvContext = &xContext;
+
+            ( void ) pxSession->pxCommand->pxCommandLineDefinition->pxSinkInterpreter( &xSink, pcCommandInput );
+            xReturn = pdFALSE;
+        }
+        else
+        {
+            xReturn = pxSession->pxCommand->pxCommandLineDefinition->pxCommandInterpreter( pcWriteBuffer, xWriteBufferLen, pcCommandInput );
+        }
 
         /* If xReturn is pdFALSE, then no further strings will be returned
          * after this one, and	pxCommand can be reset to NULL ready to search
          * for the next entered command. */
         if( xReturn == pdFALSE )
         {
-            pxCommand = NULL;
+            pxSession->pxCommand = NULL;
         }
     }
     else
@@ -227,6 +342,185 @@ BaseType_t FreeRTOS_CLIProcessCommand( const char * const pcCommandInput,
 }
 /*-----------------------------------------------------------*/
 
+BaseType_t FreeRTOS_CLIProcessCommandToSink( CLI_Session_t * pxSession,
+                                             const char * const pcCommandInput,
+                                             const CLI_Output_Sink_t * pxSink )
+{
+    const CLI_Definition_List_Item_t * pxCommand;
+    BaseType_t xMoreDataToFollow;
+    BaseType_t xReturn = pdPASS;
+
+    configASSERT( pxSession != NULL );
+    configASSERT( pxSink != NULL );
+    configASSERT( pxSink->pxWrite != NULL );
+
+    /* The session must not be part way through a command started by
+     * FreeRTOS_CLIProcessCommandSession(). */
+    configASSERT( pxSession->pxCommand == NULL );
+
+    pxCommand = prvFindCommand( pcCommandInput );
+
+    if( ( pxCommand != NULL ) &&
+        ( pxCommand->pxCommandLineDefinition->pxSinkInterpreter != NULL ) &&
+        ( prvCheckNumberOfParameters( pxCommand, pcCommandInput ) != pdFALSE ) )
+    {
+        /* The command writes its output straight to the sink. */
+        xReturn = pxCommand->pxCommandLineDefinition->pxSinkInterpreter( pxSink, pcCommandInput );
+    }
+    else
+    {
+        /* Commands that use an output buffer, and the error messages, go
+         * through the output buffer of the session, each string being written
+         * to the sink as soon as it is returned. */
+        configASSERT( ( pxSession->pcOutputBuffer != NULL ) && ( pxSession->xOutputBufferLength > 0 ) );
+
+        do
+        {
+            pxSession->pcOutputBuffer[ 0 ] = 0x00;
+            xMoreDataToFollow = prvProcessCommand( pxSession, pcCommandInput, pxSession->pcOutputBuffer, pxSession->xOutputBufferLength );
+
+            /* strncpy() does not terminate a string that fills the buffer. */
+            pxSession->pcOutputBuffer[ pxSession->xOutputBufferLength - 1 ] = 0x00;
+
+            if( pxSink->pxWrite( pxSink->pvContext, pxSession->pcOutputBuffer, strlen( pxSession->pcOutputBuffer ) ) != pdPASS )
+            {
+                /* Abandon the rest of the command. */
+                pxSession->pxCommand = NULL;
+                pxSession->pxHelpCommand = NULL;
+                xReturn = pdFAIL;
+                break;
+            }
+        } while( xMoreDataToFollow != pdFALSE );
+    }
+
+    if( pxSink->pxFlush != NULL )
+    {
+        pxSink->pxFlush( pxSink->pvContext );
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t FreeRTOS_CLIWriteString( const CLI_Output_Sink_t * pxSink,
+                                    const char * pcString )
+{
+    return pxSink->pxWrite( pxSink->pvContext, pcString, strlen( pcString ) );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvBufferSinkWrite( void * pvContext,
+                                      const char * pcData,
+                                      size_t xDataLength )
+{
+    BufferSinkContext_t * pxContext = ( BufferSinkContext_t * ) pvContext;
+    BaseType_t xReturn = pdPASS;
+    size_t xSpace;
+
+    if( pxContext->xBufferLength == 0 )
+    {
+        xReturn = pdFAIL;
+    }
+    else
+    {
+        /* Leave space for the terminating NULL. */
+        xSpace = pxContext->xBufferLength - pxContext->xBytesWritten - 1;
+
+        if( xDataLength > xSpace )
+        {
+            /* The output is truncated.  Failing tells the command there is no
+             * point generating any more. */
+            xDataLength = xSpace;
+            xReturn = pdFAIL;
+        }
+
+        memcpy( &( pxContext->pcBuffer[ pxContext->xBytesWritten ] ), pcData, xDataLength );
+        pxContext->xBytesWritten += xDataLength;
+        pxContext->pcBuffer[ pxContext->xBytesWritten ] = 0x00;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvCheckNumberOfParameters( const CLI_Definition_List_Item_t * pxCommand,
+                                              const char * pcCommandInput )
+{
+    BaseType_t xReturn = pdTRUE;
+
+    /* If cExpectedNumberOfParameters is -1, then there could be a variable
+     * number of parameters and no check is made. */
+    if( pxCommand->pxCommandLineDefinition->cExpectedNumberOfParameters >= 0 )
+    {
+        if( prvGetNumberOfParameters( pcCommandInput ) != pxCommand->pxCommandLineDefinition->cExpectedNumberOfParameters )
+        {
+            xReturn = pdFALSE;
+        }
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static const CLI_Definition_List_Item_t * prvFindCommand( const char * pcCommandInput )
+{
+    const CLI_Definition_List_Item_t * pxCommand;
+    const char * pcRegisteredCommandString;
+    size_t xCommandStringLength = 0;
+
+    /* The command name is the first word of the input. */
+    while( ( pcCommandInput[ xCommandStringLength ] != 0x00 ) && ( pcCommandInput[ xCommandStringLength ] != ' ' ) )
+    {
+        xCommandStringLength++;
+    }
+
+    /* The help command is always present, and is not in the hash table. */
+    pxCommand = &xRegisteredCommands;
+
+    while( pxCommand != NULL )
+    {
+        pcRegisteredCommandString = pxCommand->pxCommandLineDefinition->pcCommand;
+
+        /* To ensure the string lengths match exactly, so as not to pick up
+         * a sub-string of a longer command, check the registered string ends
+         * where the first word of the input ends. */
+        if( ( strncmp( pcCommandInput, pcRegisteredCommandString, xCommandStringLength ) == 0 ) &&
+            ( pcRegisteredCommandString[ xCommandStringLength ] == 0x00 ) )
+        {
+            break;
+        }
+
+        if( pxCommand == &xRegisteredCommands )
+        {
+            pxCommand = pxCommandBuckets[ prvHashCommand( pcCommandInput, xCommandStringLength ) ];
+        }
+        else
+        {
+            pxCommand = pxCommand->pxNextInBucket;
+        }
+    }
+
+    return pxCommand;
+}
+/*-----------------------------------------------------------*/
+
+static UBaseType_t prvHashCommand( const char * pcCommand,
+                                   size_t xLength )
+{
+    uint32_t ulHash = 2166136261UL;
+    size_t x;
+
+    /* FNV-1a. */
+    for( x = 0; x < xLength; x++ )
+    {
+        ulHash ^= ( uint32_t ) ( uint8_t ) pcCommand[ x ];
+        ulHash *= 16777619UL;
+    }
+
+    return ( UBaseType_t ) ( ulHash & ( configCOMMAND_INT_HASH_BUCKETS - 1UL ) );
+}
+/*-----------------------------------------------------------*/
+
 char * FreeRTOS_CLIGetOutputBuffer( void )
 {
     return cOutputBuffer;
@@ -296,11 +590,15 @@ static void prvRegisterCommand( const CLI_Command_Definition_t * const pxCommand
                                 CLI_Definition_List_Item_t * pxCliDefinitionListItemBuffer )
 {
     static CLI_Definition_List_Item_t * pxLastCommandInList = &xRegisteredCommands;
+    CLI_Definition_List_Item_t ** ppxBucket;
+    UBaseType_t uxBucket;
 
     /* Check the parameters are not NULL. */
     configASSERT( pxCommandToRegister != NULL );
     configASSERT( pxCliDefinitionListItemBuffer != NULL );
 
+    uxBucket = prvHashCommand( pxCommandToRegister->pcCommand, strlen( pxCommandToRegister->pcCommand ) );
+
     taskENTER_CRITICAL();
     {
         /* Reference the command being registered from the newly created
@@ -317,6 +615,15 @@ static void prvRegisterCommand( const CLI_Command_Definition_t * const pxCommand
 
         /* Set the end of list marker to the new list item. */
         pxLastCommandInList = pxCliDefinitionListItemBuffer;
+
+        /* Also add the new list item to the end of its hash bucket. */
+        pxCliDefinitionListItemBuffer->pxNextInBucket = NULL;
+
+        for( ppxBucket = &( pxCommandBuckets[ uxBucket ] ); *ppxBucket != NULL; ppxBucket = &( ( *ppxBucket )->pxNextInBucket ) )
+        {
+        }
+
+        *ppxBucket = pxCliDefinitionListItemBuffer;
     }
     taskEXIT_CRITICAL();
 }
@@ -326,23 +633,32 @@ static BaseType_t prvHelpCommand( char * pcWriteBuffer,
                                   size_t xWriteBufferLen,
                                   const char * pcCommandString )
 {
-    static const CLI_Definition_List_Item_t * pxCommand = NULL;
-    BaseType_t xReturn;
-
     ( void ) pcCommandString;
 
-    if( pxCommand == NULL )
+    /* prvProcessCommand() calls prvHelpCommandSession() directly, this is
+     * only reached if the callback is called some other way. */
+    return prvHelpCommandSession( &xDefaultSession, pcWriteBuffer, xWriteBufferLen );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvHelpCommandSession( CLI_Session_t * pxSession,
+                                         char * pcWriteBuffer,
+                                         size_t xWriteBufferLen )
+{
+    BaseType_t xReturn;
+
+    if( pxSession->pxHelpCommand == NULL )
     {
-        /* Reset the pxCommand pointer back to the start of the list. */
-        pxCommand = &xRegisteredCommands;
+        /* Reset the pxHelpCommand pointer back to the start of the list. */
+        pxSession->pxHelpCommand = &xRegisteredCommands;
     }
 
     /* Return the next command help string, before moving the pointer on to
      * the next command in the list. */
-    strncpy( pcWriteBuffer, pxCommand->pxCommandLineDefinition->pcHelpString, xWriteBufferLen );
-    pxCommand = pxCommand->pxNext;
+    strncpy( pcWriteBuffer, pxSession->pxHelpCommand->pxCommandLineDefinition->pcHelpString, xWriteBufferLen );
+    pxSession->pxHelpCommand = pxSession->pxHelpCommand->pxNext;
 
-    if( pxCommand == NULL )
+    if( pxSession->pxHelpCommand == NULL )
     {
         /* There are no more commands in the list, so there will be no more
          *  strings to return after this one and pdFALSE should be returned. */
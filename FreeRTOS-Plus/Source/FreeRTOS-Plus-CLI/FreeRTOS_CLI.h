@@ -42,23 +42,61 @@ typedef BaseType_t (* pdCOMMAND_LINE_CALLBACK)( char * pcWriteBuffer,
                                                 size_t xWriteBufferLen,
                                                 const char * pcCommandString );
 
+/* The destination of the output of a streaming command.  pxWrite is called
+ * with each piece of output as it is generated, and returns pdPASS, or pdFAIL
+ * if the output could not be delivered, for example because the connection
+ * was lost.  pxFlush, which can be NULL, is called once the command has
+ * completed.  pvContext is passed to both, and would typically reference the
+ * UART or socket that the output is written to. */
+typedef struct xCLI_OUTPUT_SINK
+{
+    BaseType_t (* pxWrite)( void * pvContext,
+                            const char * pcData,
+                            size_t xDataLength );
+    void (* pxFlush)( void * pvContext );
+    void * pvContext;
+} CLI_Output_Sink_t;
+
+/* The prototype to which callback functions of streaming commands must comply.
+ * Rather than filling a buffer, and being called again for the next part of
+ * the output, a streaming command is called once and writes all its output to
+ * pxSink.  pcCommandString is the entire string as input by the user.  Return
+ * pdPASS, or pdFAIL if writing to pxSink failed. */
+typedef BaseType_t (* pdCOMMAND_LINE_SINK_CALLBACK)( const CLI_Output_Sink_t * pxSink,
+                                                     const char * pcCommandString );
+
 /* The structure that defines command line commands.  A command line command
  * should be defined by declaring a const structure of this type. */
 typedef struct xCOMMAND_LINE_INPUT
 {
-    const char * const pcCommand;                       /* The command that causes pxCommandInterpreter to be executed.  For example "help".  Must be all lower case. */
-    const char * const pcHelpString;                    /* String that describes how to use the command.  Should start with the command itself, and end with "\r\n".  For example "help: Returns a list of all the commands\r\n". */
-    const pdCOMMAND_LINE_CALLBACK pxCommandInterpreter; /* A pointer to the callback function that will return the output generated by the command. */
-    int8_t cExpectedNumberOfParameters;                 /* Commands expect a fixed number of parameters, which may be zero. */
+    const char * const pcCommand;                         /* The command that causes pxCommandInterpreter to be executed.  For example "help".  Must be all lower case. */
+    const char * const pcHelpString;                      /* String that describes how to use the command.  Should start with the command itself, and end with "\r\n".  For example "help: Returns a list of all the commands\r\n". */
+    const pdCOMMAND_LINE_CALLBACK pxCommandInterpreter;   /* A pointer to the callback function that will return the output generated by the command. */
+    int8_t cExpectedNumberOfParameters;                   /* Commands expect a fixed number of parameters, which may be zero. */
+    const pdCOMMAND_LINE_SINK_CALLBACK pxSinkInterpreter; /* Optional.  If not NULL, it is called instead of pxCommandInterpreter, which can then be NULL. */
 } CLI_Command_Definition_t;
 
 /* The structure that defines a command line list entry. */
 typedef struct xCOMMAND_INPUT_LIST
 {
     const CLI_Command_Definition_t * pxCommandLineDefinition;
-    struct xCOMMAND_INPUT_LIST * pxNext;
+    struct xCOMMAND_INPUT_LIST * pxNext;         /* Next command in the order of registration, as listed by "help". */
+    struct xCOMMAND_INPUT_LIST * pxNextInBucket; /* Next command with the same hash, used to look commands up. */
 } CLI_Definition_List_Item_t;
 
+/* The state of one command console.  Each console (UART, telnet, MQTT, ...)
+ * that can run commands at the same time as another console must own one of
+ * these, as it holds the command that is being executed until its callback
+ * returns pdFALSE.  The members are private to FreeRTOS_CLI.c, initialise a
+ * session with FreeRTOS_CLIInitSession(). */
+typedef struct xCLI_SESSION
+{
+    const CLI_Definition_List_Item_t * pxCommand;     /* The command being executed, or NULL. */
+    const CLI_Definition_List_Item_t * pxHelpCommand; /* The next command to be listed by "help". */
+    char * pcOutputBuffer;                            /* The buffer into which the command output is written. */
+    size_t xOutputBufferLength;                       /* The size, in bytes, of pcOutputBuffer. */
+} CLI_Session_t;
+
 /* For backward compatibility. */
 #define xCommandLineInput    CLI_Command_Definition_t
 
@@ -85,17 +123,64 @@ typedef struct xCOMMAND_INPUT_LIST
  * Runs the command interpreter for the command string "pcCommandInput".  Any
  * output generated by running the command will be placed into pcWriteBuffer.
  * xWriteBufferLen must indicate the size, in bytes, of the buffer pointed to
- * by pcWriteBuffer.
+ * by pcWriteBuffer.  The output of a streaming command is truncated to fit
+ * pcWriteBuffer, FreeRTOS_CLIProcessCommandToSink() does not have that limit.
  *
  * FreeRTOS_CLIProcessCommand should be called repeatedly until it returns pdFALSE.
  *
- * pcCmdIntProcessCommand is not reentrant.  It must not be called from more
- * than one task - or at least - by more than one task at a time.
+ * FreeRTOS_CLIProcessCommand is not reentrant.  It must not be called from more
+ * than one task - or at least - by more than one task at a time.  Consoles
+ * that run concurrently should each use a session, see
+ * FreeRTOS_CLIProcessCommandSession().
  */
 BaseType_t FreeRTOS_CLIProcessCommand( const char * const pcCommandInput,
                                        char * pcWriteBuffer,
                                        size_t xWriteBufferLen );
 
+/*
+ * Prepare pxSession for use by a command console.  The output of commands run
+ * in the session is written to pcOutputBuffer, which is xOutputBufferLength
+ * bytes long and must remain valid for as long as the session is used.
+ */
+void FreeRTOS_CLIInitSession( CLI_Session_t * pxSession,
+                              char * pcOutputBuffer,
+                              size_t xOutputBufferLength );
+
+/*
+ * Reentrant version of FreeRTOS_CLIProcessCommand().  Runs the command
+ * interpreter for pcCommandInput within pxSession, and places any output in
+ * the output buffer of the session.  As with FreeRTOS_CLIProcessCommand(), the
+ * function should be called repeatedly until it returns pdFALSE.
+ *
+ * Different tasks can process commands at the same time, provided each uses
+ * its own session.  A session must not be used by more than one task at a
+ * time.  The command callbacks themselves must also be safe to run
+ * concurrently if they are used from more than one session.
+ */
+BaseType_t FreeRTOS_CLIProcessCommandSession( CLI_Session_t * pxSession,
+                                              const char * const pcCommandInput );
+
+/*
+ * Runs the command interpreter for pcCommandInput within pxSession, and writes
+ * all the output of the command to pxSink before returning, so unlike the
+ * functions above it is only called once per command.  Streaming commands
+ * write to pxSink directly.  Commands that use an output buffer are called
+ * repeatedly, and each string they return is copied from the output buffer of
+ * the session to pxSink.  pxSink->pxFlush is called at the end.
+ *
+ * Returns pdPASS, or pdFAIL if pxSink failed to deliver the output.
+ */
+BaseType_t FreeRTOS_CLIProcessCommandToSink( CLI_Session_t * pxSession,
+                                             const char * const pcCommandInput,
+                                             const CLI_Output_Sink_t * pxSink );
+
+/*
+ * Write the NULL terminated string pcString to pxSink.  A convenience for
+ * streaming commands.
+ */
+BaseType_t FreeRTOS_CLIWriteString( const CLI_Output_Sink_t * pxSink,
+                                    const char * pcString );
+
 /*-----------------------------------------------------------*/
 
 /*
@@ -106,6 +191,8 @@ BaseType_t FreeRTOS_CLIProcessCommand( const char * const pcCommandInput,
  * the command interpreter itself is not re-entrant, so only one command
  * console interface can be used at any one time.  For that reason, no attempt
  * is made to provide any mutual exclusion mechanism on the output buffer.
+ * Consoles that use sessions should each give their session its own buffer
+ * instead.
  *
  * FreeRTOS_CLIGetOutputBuffer() returns the address of the output buffer.
  */
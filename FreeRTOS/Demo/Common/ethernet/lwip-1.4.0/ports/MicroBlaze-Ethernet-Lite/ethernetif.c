@@ -42,6 +42,7 @@
 #include <lwip/stats.h>
 #include <lwip/snmp.h>
 #include "netif/etharp.h"
+#include "lwip/tcpip.h"
 
 /* Define those to better describe your network interface. */
 #define IFNAME0 'e'
@@ -85,12 +86,25 @@ static void prvLowLevelInit( struct netif *pxNetIf );
 static void prvRxHandler( void *pvNetIf );
 static void prvTxHandler( void *pvUnused );
 
+/*
+ * Pass a received packet to the stack, either on its own or, if
+ * LWIP_TCPIP_INPUT_BATCH is set, as part of the batch being collected by the
+ * Rx handler.
+ */
+static err_t prvPassToStack( struct pbuf *p, struct netif *pxNetIf );
+
 
 /*-----------------------------------------------------------*/
 
 /* The instance of the xEmacLite IP being used in this driver. */
 static XEmacLite xEMACInstance;
 
+#if LWIP_TCPIP_INPUT_BATCH
+	/* The packets received in one Rx interrupt are collected here, then
+	passed to tcpip_thread with a single mailbox post. */
+	static struct tcpip_input_batch *pxInputBatch = NULL;
+#endif
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -426,42 +440,96 @@ struct netif *pxNetIf = ( struct netif * ) pvNetIf;
 	sections. */
 	xInsideISR++;
 
-	usInputLength = ( long ) XEmacLite_Recv( &xEMACInstance, ucBuffer );
-
-	/* move received packet into a new pbuf */
-	p = prvLowLevelInput( ucBuffer, usInputLength );
+	#if LWIP_TCPIP_INPUT_BATCH
+	{
+		/* Both the ping and the pong buffer may hold a packet, so drain them
+		and pass everything received to tcpip_thread together. */
+		pxInputBatch = tcpip_input_batch_new( pxNetIf );
+	}
+	#endif
 
-	/* no packet could be read, silently ignore this */
-	if( p != NULL )
+	do
 	{
-		/* points to packet payload, which starts with an Ethernet header */
-		pxHeader = p->payload;
+		usInputLength = ( long ) XEmacLite_Recv( &xEMACInstance, ucBuffer );
 
-		switch( htons( pxHeader->type ) )
+		/* move received packet into a new pbuf */
+		p = prvLowLevelInput( ucBuffer, usInputLength );
+
+		/* no packet could be read, silently ignore this */
+		if( p != NULL )
 		{
-			/* IP or ARP packet? */
-			case ETHTYPE_IP:
-			case ETHTYPE_ARP:
-								/* full packet send to tcpip_thread to process */
-								if( pxNetIf->input( p, pxNetIf ) != ERR_OK )
-								{
-									LWIP_DEBUGF(NETIF_DEBUG, ( "ethernetif_input: IP input error\n" ) );
-									pbuf_free(p);
+			/* points to packet payload, which starts with an Ethernet header */
+			pxHeader = p->payload;
+
+			switch( htons( pxHeader->type ) )
+			{
+				/* IP or ARP packet? */
+				case ETHTYPE_IP:
+				case ETHTYPE_ARP:
+									/* full packet send to tcpip_thread to process */
+									if( prvPassToStack( p, pxNetIf ) != ERR_OK )
+									{
+										LWIP_DEBUGF(NETIF_DEBUG, ( "ethernetif_input: IP input error\n" ) );
+										pbuf_free(p);
+										p = NULL;
+									}
+									break;
+
+				default:
+									pbuf_free( p );
 									p = NULL;
-								}
-								break;
+				break;
+			}
+		}
+	} while( ( LWIP_TCPIP_INPUT_BATCH != 0 ) && ( usInputLength != 0U ) );
+
+	#if LWIP_TCPIP_INPUT_BATCH
+	{
+		if( pxInputBatch != NULL )
+		{
+			/* The batch is consumed even if it cannot be posted, in which case
+			its packets are dropped. */
+			if( tcpip_input_batch_post( pxInputBatch ) != ERR_OK )
+			{
+				LWIP_DEBUGF( NETIF_DEBUG, ( "ethernetif_input: input batch dropped\n" ) );
+			}
 
-			default:
-								pbuf_free( p );
-								p = NULL;
-			break;
+			pxInputBatch = NULL;
 		}
 	}
+	#endif
 
 	xInsideISR--;
 }
 /*-----------------------------------------------------------*/
 
+static err_t prvPassToStack( struct pbuf *p, struct netif *pxNetIf )
+{
+err_t xReturn;
+
+	#if LWIP_TCPIP_INPUT_BATCH
+	{
+		if( ( pxInputBatch != NULL ) && ( tcpip_input_batch_add( pxInputBatch, p ) == ERR_OK ) )
+		{
+			xReturn = ERR_OK;
+		}
+		else
+		{
+			/* No batch could be allocated, or it is full, so pass this packet
+			on its own. */
+			xReturn = pxNetIf->input( p, pxNetIf );
+		}
+	}
+	#else
+	{
+		xReturn = pxNetIf->input( p, pxNetIf );
+	}
+	#endif
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
 static void prvTxHandler( void *pvUnused )
 {
 	( void ) pvUnused;
@@ -42,6 +42,7 @@
 #include <lwip/stats.h>
 #include <lwip/snmp.h>
 #include "netif/etharp.h"
+#include "lwip/tcpip.h"
 
 /* Define those to better describe your network interface. */
 #define IFNAME0 'w'
@@ -61,6 +62,24 @@ struct xEthernetIf
  */
 static void prvEthernetInput( const unsigned char * const pucInputData, long lInputLength );
 
+/*
+ * Pass a received packet to the stack, either on its own or, if
+ * LWIP_TCPIP_INPUT_BATCH is set, as part of the pending input batch.
+ */
+static err_t prvPassToStack( struct pbuf *p );
+
+#if LWIP_TCPIP_INPUT_BATCH
+	/*
+	 * Called by pcap_dispatch() for each packet read from the WinPCap buffer.
+	 */
+	static void prvPacketHandler( unsigned char *pucUser, const struct pcap_pkthdr *pxHeader, const unsigned char *pucPacketData );
+
+	/*
+	 * Post the pending input batch, if any, to tcpip_thread.
+	 */
+	static void prvFlushInputBatch( void );
+#endif
+
 /*
  * Copy the received data into a pbuf.
  */
@@ -111,6 +130,12 @@ static char cErrorBuffer[ PCAP_ERRBUF_SIZE ];
 /* The network interface that was opened. */
 static struct netif *pxlwIPNetIf = NULL;
 
+#if LWIP_TCPIP_INPUT_BATCH
+	/* The packets read from one WinPCap buffer are collected here, then
+	passed to tcpip_thread with a single mailbox post. */
+	static struct tcpip_input_batch *pxInputBatch = NULL;
+#endif
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -354,7 +379,7 @@ struct pbuf *p;
 			case ETHTYPE_IP:
 			case ETHTYPE_ARP:
 								/* full packet send to tcpip_thread to process */
-								if( pxlwIPNetIf->input( p, pxlwIPNetIf ) != ERR_OK )
+								if( prvPassToStack( p ) != ERR_OK )
 								{ 
 									LWIP_DEBUGF(NETIF_DEBUG, ( "ethernetif_input: IP input error\n" ) );
 									pbuf_free(p);
@@ -370,6 +395,74 @@ struct pbuf *p;
 	}
 }
 
+static err_t prvPassToStack( struct pbuf *p )
+{
+err_t xReturn;
+
+	#if LWIP_TCPIP_INPUT_BATCH
+	{
+		if( ( pxInputBatch != NULL ) && tcpip_input_batch_full( pxInputBatch ) )
+		{
+			prvFlushInputBatch();
+		}
+
+		if( pxInputBatch == NULL )
+		{
+			pxInputBatch = tcpip_input_batch_new( pxlwIPNetIf );
+		}
+
+		if( pxInputBatch != NULL )
+		{
+			xReturn = tcpip_input_batch_add( pxInputBatch, p );
+		}
+		else
+		{
+			/* All the batches are still waiting to be processed, so pass this
+			packet on its own. */
+			xReturn = pxlwIPNetIf->input( p, pxlwIPNetIf );
+		}
+	}
+	#else
+	{
+		xReturn = pxlwIPNetIf->input( p, pxlwIPNetIf );
+	}
+	#endif
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+#if LWIP_TCPIP_INPUT_BATCH
+
+	static void prvFlushInputBatch( void )
+	{
+		if( pxInputBatch != NULL )
+		{
+			/* The batch is consumed even if it cannot be posted, in which case
+			its packets are dropped. */
+			if( tcpip_input_batch_post( pxInputBatch ) != ERR_OK )
+			{
+				LWIP_DEBUGF( NETIF_DEBUG, ( "ethernetif_input: input batch dropped\n" ) );
+			}
+
+			pxInputBatch = NULL;
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvPacketHandler( unsigned char *pucUser, const struct pcap_pkthdr *pxHeader, const unsigned char *pucPacketData )
+	{
+		( void ) pucUser;
+
+		if( pxlwIPNetIf != NULL )
+		{
+			prvEthernetInput( pucPacketData, pxHeader->len );
+		}
+	}
+
+#endif /* LWIP_TCPIP_INPUT_BATCH */
+/*-----------------------------------------------------------*/
+
 /**
  * Should be called at the beginning of the program to set up the
  * network interface. It calls the function prvLowLevelInit() to do the
@@ -546,8 +639,10 @@ long x;
 
 static void prvInterruptSimulator( void *pvParameters )
 {
-static struct pcap_pkthdr *pxHeader;
-const unsigned char *pucPacketData;
+#if !LWIP_TCPIP_INPUT_BATCH
+	static struct pcap_pkthdr *pxHeader;
+	const unsigned char *pucPacketData;
+#endif
 extern QueueHandle_t xEMACEventQueue;
 long lResult;
 
@@ -556,16 +651,28 @@ long lResult;
 
 	for( ;; )
 	{
-		/* Get the next packet. */
-		lResult = pcap_next_ex( pxOpenedInterfaceHandle, &pxHeader, &pucPacketData );
-		if( lResult == 1 )
+		#if LWIP_TCPIP_INPUT_BATCH
 		{
-			if( pxlwIPNetIf != NULL )
+			/* Process all the packets in the next WinPCap buffer, then pass
+			them to tcpip_thread together. */
+			lResult = pcap_dispatch( pxOpenedInterfaceHandle, -1, prvPacketHandler, NULL );
+			prvFlushInputBatch();
+		}
+		#else
+		{
+			/* Get the next packet. */
+			lResult = pcap_next_ex( pxOpenedInterfaceHandle, &pxHeader, &pucPacketData );
+			if( lResult == 1 )
 			{
-				prvEthernetInput( pucPacketData, pxHeader->len );
+				if( pxlwIPNetIf != NULL )
+				{
+					prvEthernetInput( pucPacketData, pxHeader->len );
+				}
 			}
 		}
-		else
+		#endif
+
+		if( lResult <= 0 )
 		{
 			/* There is no real way of simulating an interrupt.  
 			Make sure other tasks can run. */
@@ -48,6 +48,12 @@
 #include "lwip/mem.h"
 #include "lwip/stats.h"
 
+#if LWIP_TCPIP_CORE_LOCKING && ( configUSE_MUTEXES != 1 )
+	/* The core lock must be a real mutex so the priority of a task holding it
+	is raised while tcpip_thread waits for it. */
+	#error configUSE_MUTEXES must be set to 1 in FreeRTOSConfig.h when LWIP_TCPIP_CORE_LOCKING is used.
+#endif
+
 /*---------------------------------------------------------------------------*
  * Routine:  sys_mbox_new
  *---------------------------------------------------------------------------*
@@ -357,6 +363,9 @@ unsigned long ulReturn;
 }
 
 /** Create a new mutex
+ * FreeRTOS mutexes use priority inheritance, which LWIP_TCPIP_CORE_LOCKING
+ * relies on: a low priority task that holds the core lock inherits the
+ * priority of tcpip_thread (or any other task) that is waiting for it.
  * @param mutex pointer to the mutex to create
  * @return a new mutex */
 err_t sys_mutex_new( sys_mutex_t *pxMutex )
@@ -596,6 +596,20 @@ netconn_write(struct netconn *conn, const void *dataptr, size_t size, u8_t apifl
     return ERR_OK;
   }
 
+#if LWIP_TCP && LWIP_TCPIP_CORE_LOCKING
+  /* Fast path: if the data fits into the send buffer right away, call
+     tcp_write() and tcp_output() from this thread. */
+  if (size <= 0xffff) {
+    LOCK_TCPIP_CORE();
+    err = do_write_inline(conn, dataptr, (u16_t)size, apiflags);
+    UNLOCK_TCPIP_CORE();
+    if (err != ERR_INPROGRESS) {
+      NETCONN_SET_SAFE_ERR(conn, err);
+      return err;
+    }
+  }
+#endif /* LWIP_TCP && LWIP_TCPIP_CORE_LOCKING */
+
   /* @todo: for non-blocking write, check if 'size' would ever fit into
             snd_queue or snd_buf */
   msg.function = do_write;
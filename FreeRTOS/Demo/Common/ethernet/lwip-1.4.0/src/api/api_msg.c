@@ -1358,6 +1358,56 @@ do_write(struct api_msg_msg *msg)
   TCPIP_APIMSG_ACK(msg);
 }
 
+#if LWIP_TCP && LWIP_TCPIP_CORE_LOCKING
+/**
+ * Send data on a TCP netconn directly from the application thread, without
+ * setting up a do_write operation. This only succeeds if the netconn is idle
+ * and all data fits into the send buffer and queue at once; otherwise nothing
+ * is written and the caller has to go through do_write instead.
+ * Called from netconn_write with the core locked.
+ *
+ * @param conn the TCP netconn to write to
+ * @param dataptr data to send
+ * @param len number of bytes to send
+ * @param apiflags NETCONN_COPY, NETCONN_MORE and/or NETCONN_DONTBLOCK
+ * @return ERR_OK if all data was enqueued,
+ *         ERR_INPROGRESS if the data has to be written by do_write,
+ *         any other err_t on error
+ */
+err_t
+do_write_inline(struct netconn *conn, const void *dataptr, u16_t len, u8_t apiflags)
+{
+  struct tcp_pcb *pcb = conn->pcb.tcp;
+  err_t err;
+
+  if (ERR_IS_FATAL(conn->last_err)) {
+    return conn->last_err;
+  }
+  /* checking the send buffer and queue first keeps tcp_write() from
+     failing (and setting TF_NAGLEMEMERR) in the common low-space case */
+  if ((conn->state != NETCONN_NONE) || (pcb == NULL) ||
+      (len > tcp_sndbuf(pcb)) || (tcp_sndqueuelen(pcb) >= TCP_SND_QUEUELEN)) {
+    return ERR_INPROGRESS;
+  }
+
+  err = tcp_write(pcb, dataptr, len, apiflags);
+  if (err == ERR_MEM) {
+    /* nothing was enqueued, let do_write block or fail as required */
+    return ERR_INPROGRESS;
+  }
+  if (err == ERR_OK) {
+    if ((tcp_sndbuf(pcb) <= TCP_SNDLOWAT) ||
+        (tcp_sndqueuelen(pcb) >= TCP_SNDQUEUELOWAT)) {
+      /* The queued byte- or pbuf-count exceeds the configured low-water limit,
+         let select mark this pcb as non-writable. */
+      API_EVENT(conn, NETCONN_EVT_SENDMINUS, len);
+    }
+    tcp_output(pcb);
+  }
+  return err;
+}
+#endif /* LWIP_TCP && LWIP_TCPIP_CORE_LOCKING */
+
 /**
  * Return a connection's local or remote address
  * Called from netconn_getaddr
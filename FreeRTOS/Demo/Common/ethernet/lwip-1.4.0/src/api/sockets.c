@@ -742,6 +742,161 @@ lwip_recv(int s, void *mem, size_t len, int flags)
   return lwip_recvfrom(s, mem, len, flags, NULL, NULL);
 }
 
+#if LWIP_SOCKET_RECV_PBUF
+/**
+ * Receive without copying: hands the next received pbuf chain (a TCP
+ * segment queue or a whole datagram) to the application, which may read it
+ * in place but must not modify it, and must give it back with
+ * lwip_recv_pbuf_release() before closing the socket.
+ *
+ * @param s the socket to receive from
+ * @param p where to store the received pbuf chain
+ * @param flags only MSG_DONTWAIT is supported
+ * @param from if != NULL, where to store the address of the sender
+ * @param fromlen size of from, updated to the length stored
+ * @return the number of bytes in *p, 0 if the connection was closed or -1
+ *         on error (with errno set)
+ */
+int
+lwip_recv_pbuf(int s, struct pbuf **p, int flags,
+        struct sockaddr *from, socklen_t *fromlen)
+{
+  struct lwip_sock *sock;
+  void             *buf;
+  struct pbuf      *q;
+  ip_addr_t        fromaddr;
+  ip_addr_t        *addr;
+  u16_t            port;
+  err_t            err;
+
+  LWIP_DEBUGF(SOCKETS_DEBUG, ("lwip_recv_pbuf(%d, %p, 0x%x, ..)\n", s, (void *)p, flags));
+  sock = get_socket(s);
+  if (!sock) {
+    return -1;
+  }
+  if ((flags & MSG_PEEK) != 0) {
+    sock_set_errno(sock, EOPNOTSUPP);
+    return -1;
+  }
+
+  /* Check if there is data left from the last recv operation. */
+  if (sock->lastdata) {
+    buf = sock->lastdata;
+  } else {
+    /* If this is non-blocking call, then check first */
+    if (((flags & MSG_DONTWAIT) || netconn_is_nonblocking(sock->conn)) &&
+        (sock->rcvevent <= 0)) {
+      LWIP_DEBUGF(SOCKETS_DEBUG, ("lwip_recv_pbuf(%d): returning EWOULDBLOCK\n", s));
+      sock_set_errno(sock, EWOULDBLOCK);
+      return -1;
+    }
+
+    if (netconn_type(sock->conn) == NETCONN_TCP) {
+      err = netconn_recv_tcp_pbuf(sock->conn, (struct pbuf **)&buf);
+    } else {
+      err = netconn_recv(sock->conn, (struct netbuf **)&buf);
+    }
+    if (err != ERR_OK) {
+      LWIP_DEBUGF(SOCKETS_DEBUG, ("lwip_recv_pbuf(%d): error is \"%s\"!\n",
+        s, lwip_strerr(err)));
+      sock_set_errno(sock, err_to_errno(err));
+      if (err == ERR_CLSD) {
+        return 0;
+      } else {
+        return -1;
+      }
+    }
+    LWIP_ASSERT("buf != NULL", buf != NULL);
+  }
+
+  if (netconn_type(sock->conn) == NETCONN_TCP) {
+    *p = (struct pbuf *)buf;
+    /* Drop what lwip_recvfrom() already copied out of a partly read chain:
+       first the pbufs it consumed completely, then the start of the next. */
+    while (sock->lastoffset >= (*p)->len) {
+      sock->lastoffset -= (*p)->len;
+      q = *p;
+      *p = q->next;
+      q->next = NULL;
+      pbuf_free(q);
+    }
+    if (sock->lastoffset > 0) {
+      pbuf_header(*p, -(s16_t)sock->lastoffset);
+    }
+    /* Append the segments that are already queued, so that the chain (and
+       the window update when it is released) covers all data available.
+       Unreleased data never exceeds TCP_WND, so tot_len cannot overflow. */
+    while (sock->rcvevent > 0) {
+      if (netconn_recv_tcp_pbuf(sock->conn, &q) != ERR_OK) {
+        /* closed or reset: reported by the next call */
+        break;
+      }
+      LWIP_ASSERT("received data exceeds the window",
+        (u32_t)(*p)->tot_len + q->tot_len <= TCP_WND);
+      pbuf_cat(*p, q);
+    }
+    addr = &fromaddr;
+    netconn_getaddr(sock->conn, addr, &port, 0);
+  } else {
+    *p = ((struct netbuf *)buf)->p;
+    ((struct netbuf *)buf)->p = NULL;
+    addr = netbuf_fromaddr((struct netbuf *)buf);
+    port = netbuf_fromport((struct netbuf *)buf);
+  }
+  sock->lastdata = NULL;
+  sock->lastoffset = 0;
+
+  if (from && fromlen) {
+    struct sockaddr_in sin;
+
+    memset(&sin, 0, sizeof(sin));
+    sin.sin_len = sizeof(sin);
+    sin.sin_family = AF_INET;
+    sin.sin_port = htons(port);
+    inet_addr_from_ipaddr(&sin.sin_addr, addr);
+
+    if (*fromlen > sizeof(sin)) {
+      *fromlen = sizeof(sin);
+    }
+
+    MEMCPY(from, &sin, *fromlen);
+  }
+
+  LWIP_DEBUGF(SOCKETS_DEBUG, ("lwip_recv_pbuf(%d): addr=", s));
+  ip_addr_debug_print(SOCKETS_DEBUG, addr);
+  LWIP_DEBUGF(SOCKETS_DEBUG, (" port=%"U16_F" len=%"U16_F"\n", port, (*p)->tot_len));
+
+  if (netconn_type(sock->conn) != NETCONN_TCP) {
+    /* the netbuf only held the pbuf and the address */
+    netbuf_delete((struct netbuf *)buf);
+  }
+  sock_set_errno(sock, 0);
+  return (*p)->tot_len;
+}
+
+/**
+ * Give back a pbuf chain received with lwip_recv_pbuf(). For TCP, this is
+ * what opens the receive window again, so holding on to received chains
+ * throttles the sender.
+ *
+ * @param s the socket the chain was received from
+ * @param p the pbuf chain returned by lwip_recv_pbuf()
+ */
+void
+lwip_recv_pbuf_release(int s, struct pbuf *p)
+{
+  struct lwip_sock *sock;
+
+  LWIP_DEBUGF(SOCKETS_DEBUG, ("lwip_recv_pbuf_release(%d, %p)\n", s, (void *)p));
+  sock = get_socket(s);
+  if (sock) {
+    /* update receive window */
+    netconn_recved(sock->conn, (u32_t)p->tot_len);
+  }
+  pbuf_free(p);
+}
+#endif /* LWIP_SOCKET_RECV_PBUF */
+
 int
 lwip_send(int s, const void *data, size_t size, int flags)
 {
@@ -2090,6 +2245,12 @@ lwip_setsockopt_internal(void *arg)
       } else {
         sock->conn->pcb.ip->so_options &= ~optname;
       }
+#if LWIP_TCP && LWIP_TCP_PCB_TIMERS
+      if ((optname == SO_KEEPALIVE) && (sock->conn->type == NETCONN_TCP)) {
+        /* an idle connection's timer has to wake up for the keepalive */
+        tcp_timer_kick(sock->conn->pcb.tcp);
+      }
+#endif /* LWIP_TCP && LWIP_TCP_PCB_TIMERS */
       LWIP_DEBUGF(SOCKETS_DEBUG, ("lwip_setsockopt(%d, SOL_SOCKET, optname=0x%x, ..) -> %s\n",
                   s, optname, (*(int*)optval?"on":"off")));
       break;
@@ -2211,6 +2372,10 @@ lwip_setsockopt_internal(void *arg)
       LWIP_ASSERT("unhandled optname", 0);
       break;
     }  /* switch (optname) */
+#if LWIP_TCP_PCB_TIMERS
+    /* reschedule an idle connection for the new keepalive settings */
+    tcp_timer_kick(sock->conn->pcb.tcp);
+#endif /* LWIP_TCP_PCB_TIMERS */
     break;
 #endif /* LWIP_TCP*/
 #if LWIP_UDP && LWIP_UDPLITE
@@ -60,6 +60,33 @@ sys_mutex_t lock_tcpip_core;
 #endif /* LWIP_TCPIP_CORE_LOCKING */
 
 
+#if LWIP_TCPIP_INPUT_BATCH
+/**
+ * Process all packets of a batch and free it.
+ * Called with the core locked (or from tcpip_thread).
+ *
+ * @param batch the batch to process
+ */
+static void
+tcpip_input_batch_process(struct tcpip_input_batch *batch)
+{
+  struct netif *inp = batch->netif;
+  u16_t i;
+
+  for (i = 0; i < batch->count; i++) {
+#if LWIP_ETHERNET
+    if (inp->flags & (NETIF_FLAG_ETHARP | NETIF_FLAG_ETHERNET)) {
+      ethernet_input(batch->p[i], inp);
+    } else
+#endif /* LWIP_ETHERNET */
+    {
+      ip_input(batch->p[i], inp);
+    }
+  }
+  memp_free(MEMP_TCPIP_INPUT_BATCH, batch);
+}
+#endif /* LWIP_TCPIP_INPUT_BATCH */
+
 /**
  * The main lwIP thread. This thread has exclusive access to lwIP core functions
  * (unless access to them is not locked). Other threads communicate with this
@@ -110,6 +137,13 @@ tcpip_thread(void *arg)
       break;
 #endif /* LWIP_TCPIP_CORE_LOCKING_INPUT */
 
+#if LWIP_TCPIP_INPUT_BATCH
+    case TCPIP_MSG_INPKT_BATCH:
+      LWIP_DEBUGF(TCPIP_DEBUG, ("tcpip_thread: PACKET BATCH %p\n", (void *)msg));
+      tcpip_input_batch_process(msg->msg.batch);
+      break;
+#endif /* LWIP_TCPIP_INPUT_BATCH */
+
 #if LWIP_NETIF_API
     case TCPIP_MSG_NETIFAPI:
       LWIP_DEBUGF(TCPIP_DEBUG, ("tcpip_thread: Netif API message %p\n", (void *)msg));
@@ -191,6 +225,90 @@ tcpip_input(struct pbuf *p, struct netif *inp)
 #endif /* LWIP_TCPIP_CORE_LOCKING_INPUT */
 }
 
+#if LWIP_TCPIP_INPUT_BATCH
+/**
+ * Allocate an empty batch to collect received packets in.
+ *
+ * @param inp the network interface the packets are received on
+ * @return the new batch, or NULL if MEMP_NUM_TCPIP_INPUT_BATCH batches are
+ *         already in use
+ */
+struct tcpip_input_batch *
+tcpip_input_batch_new(struct netif *inp)
+{
+  struct tcpip_input_batch *batch;
+
+  batch = (struct tcpip_input_batch *)memp_malloc(MEMP_TCPIP_INPUT_BATCH);
+  if (batch != NULL) {
+    batch->netif = inp;
+    batch->count = 0;
+  }
+  return batch;
+}
+
+/**
+ * Add a received packet to a batch.
+ *
+ * @param batch the batch to add to
+ * @param p the received packet, as passed to tcpip_input()
+ * @return ERR_OK if p was added,
+ *         ERR_MEM if the batch is full (p is not added, post the batch first)
+ */
+err_t
+tcpip_input_batch_add(struct tcpip_input_batch *batch, struct pbuf *p)
+{
+  if (tcpip_input_batch_full(batch)) {
+    return ERR_MEM;
+  }
+  batch->p[batch->count++] = p;
+  return ERR_OK;
+}
+
+/**
+ * Pass all packets of a batch to tcpip_thread for input processing, with a
+ * single mailbox post. With LWIP_TCPIP_CORE_LOCKING_INPUT, the packets are
+ * processed right away, locking the core once.
+ *
+ * Unlike tcpip_input(), the batch is always consumed: if it can't be posted,
+ * its packets are freed and ERR_MEM is returned.
+ *
+ * @param batch the batch to post, allocated by tcpip_input_batch_new()
+ * @return ERR_OK if the packets were passed on, ERR_MEM if they were dropped
+ */
+err_t
+tcpip_input_batch_post(struct tcpip_input_batch *batch)
+{
+#if !LWIP_TCPIP_CORE_LOCKING_INPUT
+  u16_t i;
+#endif /* !LWIP_TCPIP_CORE_LOCKING_INPUT */
+
+  LWIP_DEBUGF(TCPIP_DEBUG, ("tcpip_input_batch_post: %"U16_F" packets\n", batch->count));
+#if LWIP_TCPIP_CORE_LOCKING_INPUT
+  LOCK_TCPIP_CORE();
+  tcpip_input_batch_process(batch);
+  UNLOCK_TCPIP_CORE();
+  return ERR_OK;
+#else /* LWIP_TCPIP_CORE_LOCKING_INPUT */
+  if (batch->count == 0) {
+    memp_free(MEMP_TCPIP_INPUT_BATCH, batch);
+    return ERR_OK;
+  }
+  if (sys_mbox_valid(&mbox)) {
+    batch->msg.type = TCPIP_MSG_INPKT_BATCH;
+    batch->msg.msg.batch = batch;
+    if (sys_mbox_trypost(&mbox, &batch->msg) == ERR_OK) {
+      return ERR_OK;
+    }
+  }
+  for (i = 0; i < batch->count; i++) {
+    pbuf_free(batch->p[i]);
+  }
+  memp_free(MEMP_TCPIP_INPUT_BATCH, batch);
+  return ERR_MEM;
+#endif /* LWIP_TCPIP_CORE_LOCKING_INPUT */
+}
+#endif /* LWIP_TCPIP_INPUT_BATCH */
+
 /**
  * Call a specific function in the thread context of
  * tcpip_thread for easy access synchronization.
@@ -114,6 +114,30 @@
 #if (LWIP_TCP && TCP_LISTEN_BACKLOG && (TCP_DEFAULT_LISTEN_BACKLOG < 0) || (TCP_DEFAULT_LISTEN_BACKLOG > 0xff))
   #error "If you want to use TCP backlog, TCP_DEFAULT_LISTEN_BACKLOG must fit into an u8_t"
 #endif
+#if (LWIP_TCP && LWIP_TCP_PCB_HASH && (((TCP_PCB_HASH_SIZE & (TCP_PCB_HASH_SIZE - 1)) != 0) || ((TCP_LISTEN_HASH_SIZE & (TCP_LISTEN_HASH_SIZE - 1)) != 0)))
+  #error "If you want to use the TCP pcb hash, TCP_PCB_HASH_SIZE and TCP_LISTEN_HASH_SIZE must be powers of 2"
+#endif
+#if (LWIP_TCP && LWIP_TCP_PCB_TIMERS && !(LWIP_TIMERS && LWIP_TIMERS_WHEEL))
+  #error "If you want to use per-pcb TCP timers, you have to define LWIP_TIMERS_WHEEL=1 and enable timers in your lwipopts.h"
+#endif
+#if (LWIP_UDP && LWIP_UDP_PCB_HASH && ((UDP_PCB_HASH_SIZE & (UDP_PCB_HASH_SIZE - 1)) != 0))
+  #error "If you want to use the UDP pcb hash, UDP_PCB_HASH_SIZE must be a power of 2"
+#endif
+#if (LWIP_ARP && LWIP_ARP_HASH && (((ARP_HASH_SIZE & (ARP_HASH_SIZE - 1)) != 0) || ((ETHARP_NETIF_HINTS & (ETHARP_NETIF_HINTS - 1)) != 0)))
+  #error "If you want to use the ARP hash, ARP_HASH_SIZE and ETHARP_NETIF_HINTS must be powers of 2"
+#endif
+#if (LWIP_TIMERS && LWIP_TIMERS_WHEEL && (((SYS_TIMEOUT_WHEEL_SIZE & (SYS_TIMEOUT_WHEEL_SIZE - 1)) != 0) || ((SYS_TIMEOUT_WHEEL_TICK & (SYS_TIMEOUT_WHEEL_TICK - 1)) != 0) || ((SYS_TIMEOUT_HASH_SIZE & (SYS_TIMEOUT_HASH_SIZE - 1)) != 0)))
+  #error "If you want to use the timing wheel, SYS_TIMEOUT_WHEEL_SIZE, SYS_TIMEOUT_WHEEL_TICK and SYS_TIMEOUT_HASH_SIZE must be powers of 2"
+#endif
+#if (MEM_TLSF && ((MEM_TLSF_SL_LOG2 < 1) || (MEM_TLSF_SL_LOG2 > 5)))
+  #error "If you want to use the TLSF heap, MEM_TLSF_SL_LOG2 must be between 1 and 5"
+#endif
+#if (MEMP_LOCKFREE && (MEMP_MEM_MALLOC || MEMP_SANITY_CHECK))
+  #error "MEMP_LOCKFREE does not work with MEMP_MEM_MALLOC or MEMP_SANITY_CHECK"
+#endif
+#if ((MEMP_CACHE_SIZE > 0) && (!MEMP_LOCKFREE || (MEMP_CACHE_SIZE < 2) || (MEMP_NUM_CORES < 1)))
+  #error "If you want to use memp caches, you have to define MEMP_LOCKFREE=1, MEMP_CACHE_SIZE>=2 and MEMP_NUM_CORES>=1 in your lwipopts.h"
+#endif
 #if (LWIP_IGMP && (MEMP_NUM_IGMP_GROUP<=1))
   #error "If you want to use IGMP, you have to define MEMP_NUM_IGMP_GROUP>1 in your lwipopts.h"
 #endif
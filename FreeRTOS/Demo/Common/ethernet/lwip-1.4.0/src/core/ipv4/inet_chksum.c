@@ -52,7 +52,7 @@
  * #define LWIP_CHKSUM <your_checksum_routine> 
  *
  * Or you can select from the implementations below by defining
- * LWIP_CHKSUM_ALGORITHM to 1, 2 or 3.
+ * LWIP_CHKSUM_ALGORITHM to 1, 2, 3 or 4.
  */
 
 #ifndef LWIP_CHKSUM
@@ -256,6 +256,143 @@ lwip_standard_chksum(void *dataptr, int len)
 }
 #endif
 
+#if (LWIP_CHKSUM_ALGORITHM == 4) /* Alternative version #4 */
+/* Use SSE2 or NEON for the bulk of the data when the compiler targets them.
+   Define LWIP_CHKSUM_VECTOR to 0 to use the portable loop only. */
+#ifndef LWIP_CHKSUM_VECTOR
+#if defined(__SSE2__) || defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define LWIP_CHKSUM_VECTOR 1
+#else
+#define LWIP_CHKSUM_VECTOR 0
+#endif
+#endif /* LWIP_CHKSUM_VECTOR */
+
+#if LWIP_CHKSUM_VECTOR
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#else
+#include <arm_neon.h>
+#endif
+#endif /* LWIP_CHKSUM_VECTOR */
+
+/**
+ * A word-parallel checksum routine. 32-bit words are added into a 64-bit
+ * accumulator, so the carries never need to be handled inside the loop, and
+ * the loop sums 16 bytes at a time. With LWIP_CHKSUM_VECTOR, 32 bytes at a
+ * time are summed into 64-bit vector lanes instead.
+ *
+ * Needs a compiler with a 64-bit unsigned long long.
+ *
+ * @arg start of buffer to be checksummed. May be an odd byte address.
+ * @len number of bytes in the buffer to be checksummed.
+ * @return host order (!) lwip checksum (non-inverted Internet sum) 
+ */
+
+static u16_t
+lwip_standard_chksum(void *dataptr, int len)
+{
+  u8_t *pb = (u8_t *)dataptr;
+  u32_t *pl;
+  u16_t t = 0;
+  u32_t sum32;
+  unsigned long long sum = 0;
+  /* starts at odd byte address? */
+  int odd = ((mem_ptr_t)pb & 1);
+
+  if (odd && len > 0) {
+    ((u8_t *)&t)[1] = *pb++;
+    len--;
+  }
+
+  /* get aligned to u32_t */
+  if (((mem_ptr_t)pb & 2) && len > 1) {
+    sum += *(u16_t *)pb;
+    pb += 2;
+    len -= 2;
+  }
+
+#if LWIP_CHKSUM_VECTOR && defined(__SSE2__)
+  if (len >= 32) {
+    __m128i zero = _mm_setzero_si128();
+    __m128i acc0 = zero, acc1 = zero, v;
+    unsigned long long lanes[2];
+
+    do {
+      /* widen each 32-bit word to a 64-bit lane and add */
+      v = _mm_loadu_si128((const __m128i *)pb);
+      acc0 = _mm_add_epi64(acc0, _mm_unpacklo_epi32(v, zero));
+      acc1 = _mm_add_epi64(acc1, _mm_unpackhi_epi32(v, zero));
+      v = _mm_loadu_si128((const __m128i *)(pb + 16));
+      acc0 = _mm_add_epi64(acc0, _mm_unpacklo_epi32(v, zero));
+      acc1 = _mm_add_epi64(acc1, _mm_unpackhi_epi32(v, zero));
+      pb += 32;
+      len -= 32;
+    } while (len >= 32);
+
+    _mm_storeu_si128((__m128i *)lanes, _mm_add_epi64(acc0, acc1));
+    sum += lanes[0] + lanes[1];
+  }
+#elif LWIP_CHKSUM_VECTOR
+  if (len >= 32) {
+    uint64x2_t acc0 = vdupq_n_u64(0), acc1 = vdupq_n_u64(0);
+
+    do {
+      /* add pairs of 32-bit words into the 64-bit lanes */
+      acc0 = vpadalq_u32(acc0, vreinterpretq_u32_u8(vld1q_u8(pb)));
+      acc1 = vpadalq_u32(acc1, vreinterpretq_u32_u8(vld1q_u8(pb + 16)));
+      pb += 32;
+      len -= 32;
+    } while (len >= 32);
+
+    acc0 = vaddq_u64(acc0, acc1);
+    sum += vgetq_lane_u64(acc0, 0) + vgetq_lane_u64(acc0, 1);
+  }
+#endif /* LWIP_CHKSUM_VECTOR */
+
+  pl = (u32_t *)pb;
+
+  while (len > 15) {
+    sum += (unsigned long long)pl[0] + pl[1] + pl[2] + pl[3];
+    pl += 4;
+    len -= 16;
+  }
+
+  while (len > 3) {
+    sum += *pl++;
+    len -= 4;
+  }
+
+  pb = (u8_t *)pl;
+
+  /* 16-bit aligned word remaining? */
+  if (len > 1) {
+    sum += *(u16_t *)pb;
+    pb += 2;
+    len -= 2;
+  }
+
+  /* dangling tail byte remaining? */
+  if (len > 0) {                /* include odd byte */
+    ((u8_t *)&t)[0] = *pb;
+  }
+
+  sum += t;                     /* add end bytes */
+
+  /* Fold 64-bit sum to 32 bits, then to 16 bits */
+  sum = (sum >> 32) + (sum & 0xffffffffULL);
+  sum = (sum >> 32) + (sum & 0xffffffffULL);
+  sum32 = (u32_t)sum;
+  sum32 = FOLD_U32T(sum32);
+  sum32 = FOLD_U32T(sum32);
+
+  if (odd) {
+    sum32 = SWAP_BYTES_IN_WORD(sum32);
+  }
+
+  return (u16_t)sum32;
+}
+#endif
+
 /* inet_chksum_pseudo:
  *
  * Calculates the pseudo Internet checksum used by TCP and UDP for a pbuf chain.
@@ -434,6 +571,10 @@ inet_chksum_pbuf(struct pbuf *p)
  * performance-sensitive function, you might want to create your own version
  * in assembly targeted at your hardware by defining it in lwipopts.h:
  *   #define LWIP_CHKSUM_COPY(dst, src, len) your_chksum_copy(dst, src, len)
+ *
+ * Or you can select from the implementations below by defining
+ * LWIP_CHKSUM_COPY_ALGORITHM to 1 or 2. tcp_write() uses this when
+ * LWIP_CHECKSUM_ON_COPY is enabled.
  */
 
 #if (LWIP_CHKSUM_COPY_ALGORITHM == 1) /* Version #1 */
@@ -448,3 +589,45 @@ lwip_chksum_copy(void *dst, const void *src, u16_t len)
   return LWIP_CHKSUM(dst, len);
 }
 #endif /* (LWIP_CHKSUM_COPY_ALGORITHM == 1) */
+
+#if (LWIP_CHKSUM_COPY_ALGORITHM == 2) /* Version #2 */
+/** Copy and checksum in one pass: 16 bytes at a time are loaded into
+ * registers, stored to dst and added into a 64-bit accumulator, so the
+ * data is only read once. Neither buffer needs to be aligned. The tail is
+ * copied and then summed with LWIP_CHKSUM.
+ * Needs a compiler with a 64-bit unsigned long long.
+ */
+u16_t
+lwip_chksum_copy(void *dst, const void *src, u16_t len)
+{
+  u8_t *pd = (u8_t *)dst;
+  const u8_t *ps = (const u8_t *)src;
+  u32_t w[4];
+  u32_t sum32;
+  unsigned long long sum = 0;
+  u16_t left = len;
+
+  while (left > 15) {
+    /* fixed size copies through w compile to unaligned loads and stores */
+    MEMCPY(w, ps, sizeof(w));
+    MEMCPY(pd, w, sizeof(w));
+    sum += (unsigned long long)w[0] + w[1] + w[2] + w[3];
+    ps += 16;
+    pd += 16;
+    left -= 16;
+  }
+
+  if (left > 0) {
+    /* the tail starts at an even offset, so its sum simply adds on */
+    MEMCPY(pd, ps, left);
+    sum += LWIP_CHKSUM(pd, left);
+  }
+
+  sum = (sum >> 32) + (sum & 0xffffffffULL);
+  sum = (sum >> 32) + (sum & 0xffffffffULL);
+  sum32 = (u32_t)sum;
+  sum32 = FOLD_U32T(sum32);
+  sum32 = FOLD_U32T(sum32);
+  return (u16_t)sum32;
+}
+#endif /* (LWIP_CHKSUM_COPY_ALGORITHM == 2) */
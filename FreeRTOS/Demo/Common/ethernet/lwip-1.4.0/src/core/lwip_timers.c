@@ -58,8 +58,36 @@
 #include "lwip/dns.h"
 
 
+#if LWIP_TIMERS_WHEEL
+
+/** The wheel slot a timeout expiring at 'time' goes into */
+#define SYS_TIMEOUT_WHEEL_SLOT(time) \
+  (((time) / SYS_TIMEOUT_WHEEL_TICK) & (SYS_TIMEOUT_WHEEL_SIZE - 1))
+/** Start of the wheel tick that contains 'time' */
+#define SYS_TIMEOUT_WHEEL_ALIGN(time) ((time) & ~(u32_t)(SYS_TIMEOUT_WHEEL_TICK - 1))
+/** Whether time a is before time b, caring for wraparounds */
+#define SYS_TIMEOUT_BEFORE(a, b) ((s32_t)((u32_t)(a) - (u32_t)(b)) < 0)
+
+/** The slots of the timing wheel, each an unsorted list of timeouts */
+static struct sys_timeo *timeouts_wheel[SYS_TIMEOUT_WHEEL_SIZE];
+/** Timeouts set with sys_timeout(), by handler and argument */
+static struct sys_timeo *timeouts_hash[SYS_TIMEOUT_HASH_SIZE];
+/** Timeouts that have expired and are waiting for their handler to run */
+static struct sys_timeo *timeouts_due;
+static struct sys_timeo **timeouts_due_tail = &timeouts_due;
+/** Start of the tick the wheel was last advanced to */
+static u32_t timeouts_wheel_time;
+/** No timeout expires before this time */
+static u32_t timeouts_next_time;
+/** Number of timeouts in the wheel or the due list */
+static u32_t timeouts_pending;
+/** Set while a handler is called; new timeouts then count from its expiry */
+static u8_t timeouts_in_handler;
+static u32_t timeouts_handler_time;
+#else /* LWIP_TIMERS_WHEEL */
 /** The one and only timeout list */
 static struct sys_timeo *next_timeout;
+#endif /* LWIP_TIMERS_WHEEL */
 #if NO_SYS
 static u32_t timeouts_last_time;
 #endif /* NO_SYS */
@@ -220,6 +248,9 @@ dns_timer(void *arg)
 /** Initialize this module */
 void sys_timeouts_init(void)
 {
+#if LWIP_TIMERS_WHEEL
+  timeouts_wheel_time = SYS_TIMEOUT_WHEEL_ALIGN(sys_now());
+#endif /* LWIP_TIMERS_WHEEL */
 #if IP_REASSEMBLY
   sys_timeout(IP_TMR_INTERVAL, ip_reass_timer, NULL);
 #endif /* IP_REASSEMBLY */
@@ -246,6 +277,414 @@ void sys_timeouts_init(void)
 #endif
 }
 
+#if LWIP_TIMERS_WHEEL
+
+/**
+ * Returns the sys_untimeout() hash bucket for a handler and its argument.
+ */
+static u16_t
+sys_timeout_hash(sys_timeout_handler handler, void *arg)
+{
+  mem_ptr_t key = (mem_ptr_t)arg ^ ((mem_ptr_t)handler >> 2);
+
+  key ^= key >> 5;
+  key ^= key >> 11;
+  return (u16_t)(key & (SYS_TIMEOUT_HASH_SIZE - 1));
+}
+
+/**
+ * Unlinks an active timeout from its wheel slot or the due list.
+ *
+ * @param timeout the timeout to unlink
+ */
+static void
+sys_timeout_unlink(struct sys_timeo *timeout)
+{
+  *timeout->pprev = timeout->next;
+  if (timeout->next != NULL) {
+    timeout->next->pprev = timeout->pprev;
+  } else if (timeouts_due_tail == &timeout->next) {
+    timeouts_due_tail = timeout->pprev;
+  }
+  timeout->flags &= ~SYS_TIMEO_ACTIVE;
+  timeouts_pending--;
+}
+
+/**
+ * Puts a timeout into the wheel slot for its expiry time.
+ *
+ * @param timeout the timeout to insert
+ * @param msecs time in milliseconds after that the timeout should expire
+ */
+static void
+sys_timeout_insert(struct sys_timeo *timeout, u32_t msecs)
+{
+  struct sys_timeo **slot;
+  u32_t base;
+
+  /* Timeouts set from a handler count from when that handler was due, so
+     periodic timers do not drift when they are run late. */
+  base = timeouts_in_handler ? timeouts_handler_time : sys_now();
+  if (timeouts_pending == 0) {
+    timeouts_wheel_time = SYS_TIMEOUT_WHEEL_ALIGN(base);
+  }
+  timeout->time = base + msecs;
+
+  /* A timeout that is due before the current tick goes into the current
+     slot, which is looked at every time the wheel advances. */
+  if (SYS_TIMEOUT_BEFORE(timeout->time, timeouts_wheel_time)) {
+    slot = &timeouts_wheel[SYS_TIMEOUT_WHEEL_SLOT(timeouts_wheel_time)];
+  } else {
+    slot = &timeouts_wheel[SYS_TIMEOUT_WHEEL_SLOT(timeout->time)];
+  }
+  timeout->next = *slot;
+  if (timeout->next != NULL) {
+    timeout->next->pprev = &timeout->next;
+  }
+  timeout->pprev = slot;
+  *slot = timeout;
+  timeout->flags |= SYS_TIMEO_ACTIVE;
+
+  if ((timeouts_pending == 0) || SYS_TIMEOUT_BEFORE(timeout->time, timeouts_next_time)) {
+    timeouts_next_time = timeout->time;
+  }
+  timeouts_pending++;
+}
+
+/**
+ * Moves every timeout that has expired by 'now' from the wheel to the due
+ * list, visiting the slots for the ticks since the wheel last advanced.
+ *
+ * @param now the current sys_now() time
+ */
+static void
+sys_timeouts_advance(u32_t now)
+{
+  struct sys_timeo *t, *next;
+  u32_t ticks, slot;
+
+  ticks = (SYS_TIMEOUT_WHEEL_ALIGN(now) - timeouts_wheel_time) / SYS_TIMEOUT_WHEEL_TICK;
+  if (ticks >= SYS_TIMEOUT_WHEEL_SIZE) {
+    ticks = SYS_TIMEOUT_WHEEL_SIZE - 1;
+  }
+  slot = SYS_TIMEOUT_WHEEL_SLOT(timeouts_wheel_time);
+  for (;;) {
+    for (t = timeouts_wheel[slot]; t != NULL; t = next) {
+      next = t->next;
+      if (!SYS_TIMEOUT_BEFORE(now, t->time)) {
+        /* move it to the end of the due list */
+        *t->pprev = next;
+        if (next != NULL) {
+          next->pprev = t->pprev;
+        }
+        t->next = NULL;
+        t->pprev = timeouts_due_tail;
+        *timeouts_due_tail = t;
+        timeouts_due_tail = &t->next;
+      }
+    }
+    if (ticks == 0) {
+      break;
+    }
+    ticks--;
+    slot = (slot + 1) & (SYS_TIMEOUT_WHEEL_SIZE - 1);
+  }
+  timeouts_wheel_time = SYS_TIMEOUT_WHEEL_ALIGN(now);
+}
+
+/**
+ * Finds a time no later than the earliest pending timeout: the exact
+ * expiry time for the current slot, else the start of the first later slot
+ * that is not empty.
+ */
+static void
+sys_timeouts_update_next(void)
+{
+  struct sys_timeo *t;
+  u32_t slot, i;
+  int found = 0;
+
+  slot = SYS_TIMEOUT_WHEEL_SLOT(timeouts_wheel_time);
+  for (t = timeouts_wheel[slot]; t != NULL; t = t->next) {
+    if (!found || SYS_TIMEOUT_BEFORE(t->time, timeouts_next_time)) {
+      timeouts_next_time = t->time;
+      found = 1;
+    }
+  }
+  for (i = 1; i < SYS_TIMEOUT_WHEEL_SIZE; i++) {
+    slot = (slot + 1) & (SYS_TIMEOUT_WHEEL_SIZE - 1);
+    if (timeouts_wheel[slot] != NULL) {
+      u32_t start = timeouts_wheel_time + i * SYS_TIMEOUT_WHEEL_TICK;
+      if (!found || SYS_TIMEOUT_BEFORE(start, timeouts_next_time)) {
+        timeouts_next_time = start;
+      }
+      break;
+    }
+  }
+}
+
+/**
+ * Calls the handlers of all timeouts that have expired by 'now'.
+ * Timeouts set to expire by 'now' from within a handler are run as well.
+ *
+ * @param now the current sys_now() time
+ */
+static void
+sys_timeouts_run(u32_t now)
+{
+  struct sys_timeo *t;
+  struct sys_timeo **bucket;
+  sys_timeout_handler handler;
+  void *arg;
+
+  if ((timeouts_pending == 0) || SYS_TIMEOUT_BEFORE(now, timeouts_next_time)) {
+    return;
+  }
+  for (;;) {
+    sys_timeouts_advance(now);
+    if (timeouts_due == NULL) {
+      break;
+    }
+    while ((t = timeouts_due) != NULL) {
+      sys_timeout_unlink(t);
+      handler = t->h;
+      arg = t->arg;
+      timeouts_handler_time = t->time;
+#if LWIP_DEBUG_TIMERNAMES
+      if (handler != NULL) {
+        LWIP_DEBUGF(TIMERS_DEBUG, ("stw calling h=%s arg=%p\n",
+          t->handler_name, arg));
+      }
+#endif /* LWIP_DEBUG_TIMERNAMES */
+      if (!(t->flags & SYS_TIMEO_STATIC)) {
+        bucket = &timeouts_hash[sys_timeout_hash(handler, arg)];
+        while (*bucket != t) {
+          bucket = &(*bucket)->hash_next;
+        }
+        *bucket = t->hash_next;
+        memp_free(MEMP_SYS_TIMEOUT, t);
+      }
+      if (handler != NULL) {
+        timeouts_in_handler = 1;
+        handler(arg);
+        timeouts_in_handler = 0;
+      }
+#if !NO_SYS
+      LWIP_TCPIP_THREAD_ALIVE();
+#endif /* !NO_SYS */
+    }
+  }
+  if (timeouts_pending != 0) {
+    sys_timeouts_update_next();
+  }
+}
+
+/**
+ * Create a one-shot timer (aka timeout). Timeouts are processed in the
+ * following cases:
+ * - while waiting for a message using sys_timeouts_mbox_fetch()
+ * - by calling sys_check_timeouts() (NO_SYS==1 only)
+ *
+ * @param msecs time in milliseconds after that the timer should expire
+ * @param handler callback function to call when msecs have elapsed
+ * @param arg argument to pass to the callback function
+ */
+#if LWIP_DEBUG_TIMERNAMES
+void
+sys_timeout_debug(u32_t msecs, sys_timeout_handler handler, void *arg, const char* handler_name)
+#else /* LWIP_DEBUG_TIMERNAMES */
+void
+sys_timeout(u32_t msecs, sys_timeout_handler handler, void *arg)
+#endif /* LWIP_DEBUG_TIMERNAMES */
+{
+  struct sys_timeo *timeout;
+  struct sys_timeo **bucket;
+
+  timeout = (struct sys_timeo *)memp_malloc(MEMP_SYS_TIMEOUT);
+  if (timeout == NULL) {
+    LWIP_ASSERT("sys_timeout: timeout != NULL, pool MEMP_SYS_TIMEOUT is empty", timeout != NULL);
+    return;
+  }
+  timeout->h = handler;
+  timeout->arg = arg;
+  timeout->flags = 0;
+#if LWIP_DEBUG_TIMERNAMES
+  timeout->handler_name = handler_name;
+  LWIP_DEBUGF(TIMERS_DEBUG, ("sys_timeout: %p msecs=%"U32_F" handler=%s arg=%p\n",
+    (void *)timeout, msecs, handler_name, (void *)arg));
+#endif /* LWIP_DEBUG_TIMERNAMES */
+
+  bucket = &timeouts_hash[sys_timeout_hash(handler, arg)];
+  timeout->hash_next = *bucket;
+  *bucket = timeout;
+  sys_timeout_insert(timeout, msecs);
+}
+
+/**
+ * Remove the first timeout set with sys_timeout() for handler and arg,
+ * even though the timeout has not triggered yet. Timeouts started with
+ * sys_timeout_start() are stopped with sys_timeout_stop() instead.
+ *
+ * @note This function only works as expected if there is only one timeout
+ * calling 'handler' in the list of timeouts.
+ *
+ * @param handler callback function that would be called by the timeout
+ * @param arg callback argument that would be passed to handler
+*/
+void
+sys_untimeout(sys_timeout_handler handler, void *arg)
+{
+  struct sys_timeo **bucket, *t;
+
+  for (bucket = &timeouts_hash[sys_timeout_hash(handler, arg)];
+       (t = *bucket) != NULL; bucket = &t->hash_next) {
+    if ((t->h == handler) && (t->arg == arg)) {
+      *bucket = t->hash_next;
+      sys_timeout_unlink(t);
+      memp_free(MEMP_SYS_TIMEOUT, t);
+      return;
+    }
+  }
+}
+
+/**
+ * Start a timeout that is owned by the caller, typically embedded in another
+ * structure, so it cannot run out of MEMP_SYS_TIMEOUT entries. If it is
+ * already running it is restarted.
+ *
+ * @param timeout the timeout to start
+ * @param msecs time in milliseconds after that the timer should expire
+ * @param handler callback function to call when msecs have elapsed
+ * @param arg argument to pass to the callback function
+ */
+void
+sys_timeout_start(struct sys_timeo *timeout, u32_t msecs, sys_timeout_handler handler, void *arg)
+{
+  if (timeout->flags & SYS_TIMEO_ACTIVE) {
+    sys_timeout_unlink(timeout);
+  }
+  timeout->h = handler;
+  timeout->arg = arg;
+  timeout->flags = SYS_TIMEO_STATIC;
+#if LWIP_DEBUG_TIMERNAMES
+  timeout->handler_name = "sys_timeout_start";
+#endif /* LWIP_DEBUG_TIMERNAMES */
+  sys_timeout_insert(timeout, msecs);
+}
+
+/**
+ * Stop a timeout started with sys_timeout_start(). Does nothing if it is
+ * not running.
+ *
+ * @param timeout the timeout to stop
+ */
+void
+sys_timeout_stop(struct sys_timeo *timeout)
+{
+  if (timeout->flags & SYS_TIMEO_ACTIVE) {
+    LWIP_ASSERT("sys_timeout_stop: not started by sys_timeout_start",
+      (timeout->flags & SYS_TIMEO_STATIC) != 0);
+    sys_timeout_unlink(timeout);
+  }
+}
+
+#if NO_SYS
+
+/** Handle timeouts for NO_SYS==1 (i.e. without using
+ * tcpip_thread/sys_timeouts_mbox_fetch(). Uses sys_now() to call timeout
+ * handler functions when timeouts expire.
+ *
+ * Must be called periodically from your main loop.
+ */
+void
+sys_check_timeouts(void)
+{
+  u32_t now;
+
+  now = sys_now();
+  sys_timeouts_run(now);
+  timeouts_last_time = now;
+}
+
+/** Set back the timestamp of the last call to sys_check_timeouts()
+ * This is necessary if sys_check_timeouts() hasn't been called for a long
+ * time (e.g. while saving energy) to prevent all timer functions of that
+ * period being called.
+ */
+void
+sys_restart_timeouts(void)
+{
+  struct sys_timeo *list = NULL, *t;
+  u32_t now, slot, diff, time;
+
+  now = sys_now();
+  diff = now - timeouts_last_time;
+  timeouts_last_time = now;
+  if (timeouts_pending == 0) {
+    return;
+  }
+
+  /* push every timeout back by the time that was skipped */
+  for (slot = 0; slot < SYS_TIMEOUT_WHEEL_SIZE; slot++) {
+    while ((t = timeouts_wheel[slot]) != NULL) {
+      sys_timeout_unlink(t);
+      t->next = list;
+      list = t;
+    }
+  }
+  timeouts_wheel_time = SYS_TIMEOUT_WHEEL_ALIGN(now);
+  while ((t = list) != NULL) {
+    list = t->next;
+    time = t->time + diff;
+    sys_timeout_insert(t, SYS_TIMEOUT_BEFORE(time, now) ? 0 : time - now);
+  }
+}
+
+#else /* NO_SYS */
+
+/**
+ * Wait (forever) for a message to arrive in an mbox.
+ * While waiting, timeouts are processed.
+ *
+ * @param mbox the mbox to fetch the message from
+ * @param msg the place to store the message
+ */
+void
+sys_timeouts_mbox_fetch(sys_mbox_t *mbox, void **msg)
+{
+  u32_t now, sleeptime;
+  int pending;
+
+ again:
+  /* With LWIP_TCPIP_CORE_LOCKING, other threads may start timeouts. */
+  LOCK_TCPIP_CORE();
+  pending = (timeouts_pending != 0);
+  now = sys_now();
+  sleeptime = 0;
+  if (pending && SYS_TIMEOUT_BEFORE(now, timeouts_next_time)) {
+    sleeptime = timeouts_next_time - now;
+  }
+  UNLOCK_TCPIP_CORE();
+
+  if (!pending) {
+    sys_arch_mbox_fetch(mbox, msg, 0);
+  } else if ((sleeptime == 0) ||
+             (sys_arch_mbox_fetch(mbox, msg, sleeptime) == SYS_ARCH_TIMEOUT)) {
+    /* The earliest timeout is due; handlers are called with the core
+       locked (for LWIP_TCPIP_CORE_LOCKING) */
+    LOCK_TCPIP_CORE();
+    sys_timeouts_run(sys_now());
+    UNLOCK_TCPIP_CORE();
+
+    /* We try again to fetch a message from the mbox. */
+    goto again;
+  }
+}
+
+#endif /* NO_SYS */
+
+#else /* LWIP_TIMERS_WHEEL */
+
 /**
  * Create a one-shot timer (aka timeout). Timeouts are processed in the
  * following cases:
@@ -473,6 +912,8 @@ sys_timeouts_mbox_fetch(sys_mbox_t *mbox, void **msg)
 
 #endif /* NO_SYS */
 
+#endif /* LWIP_TIMERS_WHEEL */
+
 #else /* LWIP_TIMERS */
 /* Satisfy the TCP code which calls this function */
 void
@@ -186,8 +186,10 @@ u8_t ram_heap[MEM_SIZE_ALIGNED + (2*SIZEOF_STRUCT_MEM) + MEM_ALIGNMENT];
 static u8_t *ram;
 /** the last entry, always unused! */
 static struct mem *ram_end;
+#if !MEM_TLSF
 /** pointer to the lowest free block, this is used for faster search */
 static struct mem *lfree;
+#endif /* !MEM_TLSF */
 
 /** concurrent access protection */
 static sys_mutex_t mem_mutex;
@@ -217,6 +219,216 @@ static volatile u8_t mem_free_count;
 
 #endif /* LWIP_ALLOW_MEM_FREE_FROM_OTHER_CONTEXT */
 
+#if MEM_STATS
+/** the most blocks one mem_malloc() call has looked at */
+static mem_size_t mem_max_search;
+#define MEM_STATS_SEARCHED(n) do { if ((n) > mem_max_search) { mem_max_search = (n); } } while(0)
+#else /* MEM_STATS */
+#define MEM_STATS_SEARCHED(n)
+#endif /* MEM_STATS */
+
+#if MEM_TLSF
+/* The free blocks are kept in lists by size class, in two levels: the first
+ * level is a power of 2 and the second level splits it into
+ * MEM_TLSF_SL_COUNT classes of equal width. Sizes are counted in units of
+ * MEM_ALIGNMENT. Class (0, sl) holds sizes of exactly sl units, class
+ * (fl > 0, sl) sizes from (MEM_TLSF_SL_COUNT + sl) << (fl - 1) units up to
+ * the next class. A bitmap per level tells which lists are not empty.
+ */
+#define MEM_TLSF_SL_COUNT    (1UL << MEM_TLSF_SL_LOG2)
+
+/* floor(log2(x)) of a constant, for sizing the tables */
+#define MEM_LOG2_4(x)        ((x) >= 8 ? 3 : (x) >= 4 ? 2 : (x) >= 2 ? 1 : 0)
+#define MEM_LOG2_8(x)        ((x) >= 0x10 ? 4 + MEM_LOG2_4((x) >> 4) : MEM_LOG2_4(x))
+#define MEM_LOG2_16(x)       ((x) >= 0x100 ? 8 + MEM_LOG2_8((x) >> 8) : MEM_LOG2_8(x))
+#define MEM_LOG2_32(x)       ((x) >= 0x10000UL ? 16 + MEM_LOG2_16((x) >> 16) : MEM_LOG2_16(x))
+
+#define MEM_TLSF_MAX_UNITS   ((u32_t)MEM_SIZE_ALIGNED / MEM_ALIGNMENT)
+/** the number of first level classes: enough for a block as big as the heap */
+#define MEM_TLSF_FL_COUNT    ((MEM_LOG2_32(MEM_TLSF_MAX_UNITS) >= MEM_TLSF_SL_LOG2) ? \
+                              (MEM_LOG2_32(MEM_TLSF_MAX_UNITS) - MEM_TLSF_SL_LOG2 + 2) : 1)
+
+/** A free block links to the other free blocks of its size class in the
+ * space that holds data while it is used */
+struct mem_free {
+  /** index (-> ram[next_free]) of the next free block, MEM_SIZE_ALIGNED at the end */
+  mem_size_t next_free;
+  /** index (-> ram[prev_free]) of the previous free block, MEM_SIZE_ALIGNED at the start */
+  mem_size_t prev_free;
+};
+#define MEM_FREE_LINKS(ptr)  ((struct mem_free *)(void *)&ram[(ptr) + SIZEOF_STRUCT_MEM])
+
+/** bit fl is set if a list of first level class fl is not empty */
+static u32_t mem_fl_bitmap;
+/** bit sl of mem_sl_bitmap[fl] is set if mem_free_lists[fl][sl] is not empty */
+static u32_t mem_sl_bitmap[MEM_TLSF_FL_COUNT];
+/** index of the first free block of each size class, MEM_SIZE_ALIGNED if none */
+static mem_size_t mem_free_lists[MEM_TLSF_FL_COUNT][MEM_TLSF_SL_COUNT];
+
+#ifdef __GNUC__
+/** index of the lowest bit set in x (x != 0) */
+#define mem_tlsf_ffs(x)      ((u8_t)__builtin_ctz(x))
+/** index of the highest bit set in x (x != 0) */
+#define mem_tlsf_fls(x)      ((u8_t)(31 - __builtin_clz(x)))
+#else /* __GNUC__ */
+static const u8_t mem_tlsf_debruijn[32] = {
+  0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
+  31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9
+};
+
+/** index of the lowest bit set in x (x != 0) */
+static u8_t
+mem_tlsf_ffs(u32_t x)
+{
+  return mem_tlsf_debruijn[(u32_t)((x & (0UL - x)) * 0x077CB531UL) >> 27];
+}
+
+/** index of the highest bit set in x (x != 0) */
+static u8_t
+mem_tlsf_fls(u32_t x)
+{
+  x |= x >> 1;
+  x |= x >> 2;
+  x |= x >> 4;
+  x |= x >> 8;
+  x |= x >> 16;
+  return mem_tlsf_ffs(x - (x >> 1));
+}
+#endif /* __GNUC__ */
+
+/**
+ * Get the size class of a block.
+ *
+ * @param units size of the data of the block in units of MEM_ALIGNMENT
+ * @param fl returns the first level class
+ * @param sl returns the second level class
+ */
+static void
+mem_tlsf_mapping(u32_t units, u8_t *fl, u8_t *sl)
+{
+  u8_t lg;
+
+  if (units < MEM_TLSF_SL_COUNT) {
+    *fl = 0;
+    *sl = (u8_t)units;
+  } else {
+    lg = mem_tlsf_fls(units);
+    *fl = (u8_t)(lg - MEM_TLSF_SL_LOG2 + 1);
+    *sl = (u8_t)((units >> (lg - MEM_TLSF_SL_LOG2)) & (MEM_TLSF_SL_COUNT - 1));
+  }
+}
+
+/**
+ * Put a free block on the list of its size class.
+ *
+ * @param ptr index of the block
+ */
+static void
+mem_tlsf_insert(mem_size_t ptr)
+{
+  struct mem *mem = (struct mem *)(void *)&ram[ptr];
+  struct mem_free *links = MEM_FREE_LINKS(ptr);
+  mem_size_t head;
+  u8_t fl, sl;
+
+  mem_tlsf_mapping((u32_t)(mem->next - ptr - SIZEOF_STRUCT_MEM) / MEM_ALIGNMENT, &fl, &sl);
+  head = mem_free_lists[fl][sl];
+  links->next_free = head;
+  links->prev_free = MEM_SIZE_ALIGNED;
+  if (head != MEM_SIZE_ALIGNED) {
+    MEM_FREE_LINKS(head)->prev_free = ptr;
+  }
+  mem_free_lists[fl][sl] = ptr;
+  mem_fl_bitmap |= 1UL << fl;
+  mem_sl_bitmap[fl] |= 1UL << sl;
+}
+
+/**
+ * Take a free block off the list of its size class.
+ *
+ * @param ptr index of the block
+ */
+static void
+mem_tlsf_remove(mem_size_t ptr)
+{
+  struct mem *mem = (struct mem *)(void *)&ram[ptr];
+  struct mem_free *links = MEM_FREE_LINKS(ptr);
+  u8_t fl, sl;
+
+  if (links->next_free != MEM_SIZE_ALIGNED) {
+    MEM_FREE_LINKS(links->next_free)->prev_free = links->prev_free;
+  }
+  if (links->prev_free != MEM_SIZE_ALIGNED) {
+    MEM_FREE_LINKS(links->prev_free)->next_free = links->next_free;
+  } else {
+    mem_tlsf_mapping((u32_t)(mem->next - ptr - SIZEOF_STRUCT_MEM) / MEM_ALIGNMENT, &fl, &sl);
+    LWIP_ASSERT("mem_tlsf_remove: block is first of its list", mem_free_lists[fl][sl] == ptr);
+    mem_free_lists[fl][sl] = links->next_free;
+    if (links->next_free == MEM_SIZE_ALIGNED) {
+      mem_sl_bitmap[fl] &= ~(1UL << sl);
+      if (mem_sl_bitmap[fl] == 0) {
+        mem_fl_bitmap &= ~(1UL << fl);
+      }
+    }
+  }
+}
+
+/**
+ * Find a free block with room for size bytes of data.
+ *
+ * The size is rounded up to the next size class, so that any block of the
+ * class found is big enough and no list has to be searched. Only if no such
+ * block is free is the list of the size's own class searched.
+ *
+ * @param size the size of the data, aligned
+ * @return index of the block, or MEM_SIZE_ALIGNED if none is free
+ */
+static mem_size_t
+mem_tlsf_find(mem_size_t size)
+{
+  u32_t units = (u32_t)size / MEM_ALIGNMENT;
+  u32_t map;
+  mem_size_t ptr;
+  u8_t fl, sl;
+#if MEM_STATS
+  mem_size_t searched = 1;
+#endif /* MEM_STATS */
+
+  if (units >= MEM_TLSF_SL_COUNT) {
+    units += (1UL << (mem_tlsf_fls(units) - MEM_TLSF_SL_LOG2)) - 1;
+  }
+  mem_tlsf_mapping(units, &fl, &sl);
+  if (fl < MEM_TLSF_FL_COUNT) {
+    map = mem_sl_bitmap[fl] & (~0UL << sl);
+    if ((map == 0) && (fl + 1 < MEM_TLSF_FL_COUNT)) {
+      map = mem_fl_bitmap & (~0UL << (fl + 1));
+      if (map != 0) {
+        fl = mem_tlsf_ffs(map);
+        map = mem_sl_bitmap[fl];
+      }
+    }
+    if (map != 0) {
+      MEM_STATS_SEARCHED(searched);
+      return mem_free_lists[fl][mem_tlsf_ffs(map)];
+    }
+  }
+
+  /* Nothing bigger is free: try the blocks of the size's own class. */
+  mem_tlsf_mapping((u32_t)size / MEM_ALIGNMENT, &fl, &sl);
+  for (ptr = mem_free_lists[fl][sl]; ptr != MEM_SIZE_ALIGNED;
+       ptr = MEM_FREE_LINKS(ptr)->next_free) {
+#if MEM_STATS
+    searched++;
+#endif /* MEM_STATS */
+    if (((struct mem *)(void *)&ram[ptr])->next - (ptr + SIZEOF_STRUCT_MEM) >= size) {
+      break;
+    }
+  }
+  MEM_STATS_SEARCHED(searched);
+  return ptr;
+}
+
+#else /* MEM_TLSF */
 
 /**
  * "Plug holes" by combining adjacent empty struct mems.
@@ -263,6 +475,7 @@ plug_holes(struct mem *mem)
     ((struct mem *)(void *)&ram[mem->next])->prev = (mem_size_t)((u8_t *)pmem - ram);
   }
 }
+#endif /* MEM_TLSF */
 
 /**
  * Zero the heap and initialize start, end and lowest-free
@@ -271,6 +484,9 @@ void
 mem_init(void)
 {
   struct mem *mem;
+#if MEM_TLSF
+  u8_t i, j;
+#endif /* MEM_TLSF */
 
   LWIP_ASSERT("Sanity check alignment",
     (SIZEOF_STRUCT_MEM & (MEM_ALIGNMENT-1)) == 0);
@@ -288,8 +504,22 @@ mem_init(void)
   ram_end->next = MEM_SIZE_ALIGNED;
   ram_end->prev = MEM_SIZE_ALIGNED;
 
+#if MEM_TLSF
+  LWIP_ASSERT("Sanity check free block size",
+    sizeof(struct mem_free) <= MIN_SIZE_ALIGNED);
+  for (i = 0; i < MEM_TLSF_FL_COUNT; i++) {
+    for (j = 0; j < MEM_TLSF_SL_COUNT; j++) {
+      mem_free_lists[i][j] = MEM_SIZE_ALIGNED;
+    }
+    mem_sl_bitmap[i] = 0;
+  }
+  mem_fl_bitmap = 0;
+  /* the whole heap is one free block */
+  mem_tlsf_insert(0);
+#else /* MEM_TLSF */
   /* initialize the lowest-free pointer to the start of the heap */
   lfree = (struct mem *)(void *)ram;
+#endif /* MEM_TLSF */
 
   MEM_STATS_AVAIL(avail, MEM_SIZE_ALIGNED);
 
@@ -308,6 +538,10 @@ void
 mem_free(void *rmem)
 {
   struct mem *mem;
+#if MEM_TLSF
+  struct mem *nmem, *pmem;
+  mem_size_t ptr;
+#endif /* MEM_TLSF */
   LWIP_MEM_FREE_DECL_PROTECT();
 
   if (rmem == NULL) {
@@ -337,15 +571,36 @@ mem_free(void *rmem)
   /* ... and is now unused. */
   mem->used = 0;
 
+#if !MEM_TLSF
   if (mem < lfree) {
     /* the newly freed struct is now the lowest */
     lfree = mem;
   }
+#endif /* !MEM_TLSF */
 
   MEM_STATS_DEC_USED(used, mem->next - (mem_size_t)(((u8_t *)mem - ram)));
 
+#if MEM_TLSF
+  ptr = (mem_size_t)((u8_t *)mem - ram);
+  /* merge with the next block and the previous block if they are free */
+  nmem = (struct mem *)(void *)&ram[mem->next];
+  if (nmem->used == 0) {
+    mem_tlsf_remove(mem->next);
+    mem->next = nmem->next;
+    ((struct mem *)(void *)&ram[nmem->next])->prev = ptr;
+  }
+  pmem = (struct mem *)(void *)&ram[mem->prev];
+  if (pmem != mem && pmem->used == 0) {
+    mem_tlsf_remove(mem->prev);
+    pmem->next = mem->next;
+    ((struct mem *)(void *)&ram[mem->next])->prev = mem->prev;
+    ptr = mem->prev;
+  }
+  mem_tlsf_insert(ptr);
+#else /* MEM_TLSF */
   /* finally, see if prev or next are free also */
   plug_holes(mem);
+#endif /* MEM_TLSF */
 #if LWIP_ALLOW_MEM_FREE_FROM_OTHER_CONTEXT
   mem_free_count = 1;
 #endif /* LWIP_ALLOW_MEM_FREE_FROM_OTHER_CONTEXT */
@@ -421,11 +676,17 @@ mem_trim(void *rmem, mem_size_t newsize)
     mem_size_t next;
     /* remember the old next pointer */
     next = mem2->next;
+#if MEM_TLSF
+    /* it changes size, and so its size class */
+    mem_tlsf_remove(mem->next);
+#endif /* MEM_TLSF */
     /* create new struct mem which is moved directly after the shrinked mem */
     ptr2 = ptr + SIZEOF_STRUCT_MEM + newsize;
+#if !MEM_TLSF
     if (lfree == mem2) {
       lfree = (struct mem *)(void *)&ram[ptr2];
     }
+#endif /* !MEM_TLSF */
     mem2 = (struct mem *)(void *)&ram[ptr2];
     mem2->used = 0;
     /* restore the next pointer */
@@ -440,6 +701,9 @@ mem_trim(void *rmem, mem_size_t newsize)
     if (mem2->next != MEM_SIZE_ALIGNED) {
       ((struct mem *)(void *)&ram[mem2->next])->prev = ptr2;
     }
+#if MEM_TLSF
+    mem_tlsf_insert(ptr2);
+#endif /* MEM_TLSF */
     MEM_STATS_DEC_USED(used, (size - newsize));
     /* no need to plug holes, we've already done that */
   } else if (newsize + SIZEOF_STRUCT_MEM + MIN_SIZE_ALIGNED <= size) {
@@ -452,9 +716,11 @@ mem_trim(void *rmem, mem_size_t newsize)
      *       the 2 regions would be combined, resulting in more free memory */
     ptr2 = ptr + SIZEOF_STRUCT_MEM + newsize;
     mem2 = (struct mem *)(void *)&ram[ptr2];
+#if !MEM_TLSF
     if (mem2 < lfree) {
       lfree = mem2;
     }
+#endif /* !MEM_TLSF */
     mem2->used = 0;
     mem2->next = mem->next;
     mem2->prev = ptr;
@@ -462,6 +728,9 @@ mem_trim(void *rmem, mem_size_t newsize)
     if (mem2->next != MEM_SIZE_ALIGNED) {
       ((struct mem *)(void *)&ram[mem2->next])->prev = ptr2;
     }
+#if MEM_TLSF
+    mem_tlsf_insert(ptr2);
+#endif /* MEM_TLSF */
     MEM_STATS_DEC_USED(used, (size - newsize));
     /* the original mem->next is used, so no need to plug holes! */
   }
@@ -478,6 +747,84 @@ mem_trim(void *rmem, mem_size_t newsize)
   return rmem;
 }
 
+#if MEM_TLSF
+/**
+ * Allocate a block of memory with a minimum of 'size' bytes, from the free
+ * lists. Takes the same time however many blocks the heap has.
+ *
+ * @param size is the minimum size of the requested block in bytes.
+ * @return pointer to allocated memory or NULL if no free memory was found.
+ *
+ * Note that the returned value will always be aligned (as defined by MEM_ALIGNMENT).
+ */
+void *
+mem_malloc(mem_size_t size)
+{
+  mem_size_t ptr, ptr2;
+  struct mem *mem, *mem2;
+  LWIP_MEM_ALLOC_DECL_PROTECT();
+
+  if (size == 0) {
+    return NULL;
+  }
+
+  /* Expand the size of the allocated memory region so that we can
+     adjust for alignment. */
+  size = LWIP_MEM_ALIGN_SIZE(size);
+
+  if(size < MIN_SIZE_ALIGNED) {
+    /* every data block must be at least MIN_SIZE_ALIGNED long */
+    size = MIN_SIZE_ALIGNED;
+  }
+
+  if (size > MEM_SIZE_ALIGNED) {
+    return NULL;
+  }
+
+  /* protect the heap from concurrent access */
+  sys_mutex_lock(&mem_mutex);
+  LWIP_MEM_ALLOC_PROTECT();
+
+  ptr = mem_tlsf_find(size);
+  if (ptr == MEM_SIZE_ALIGNED) {
+    LWIP_DEBUGF(MEM_DEBUG | LWIP_DBG_LEVEL_SERIOUS, ("mem_malloc: could not allocate %"S16_F" bytes\n", (s16_t)size));
+    MEM_STATS_INC(err);
+    LWIP_MEM_ALLOC_UNPROTECT();
+    sys_mutex_unlock(&mem_mutex);
+    return NULL;
+  }
+  mem_tlsf_remove(ptr);
+  mem = (struct mem *)(void *)&ram[ptr];
+
+  if (mem->next - (ptr + SIZEOF_STRUCT_MEM) >= (size + SIZEOF_STRUCT_MEM + MIN_SIZE_ALIGNED)) {
+    /* split the block and put the remainder back on the free lists; the
+       block after it is used, since free blocks are always merged */
+    ptr2 = ptr + SIZEOF_STRUCT_MEM + size;
+    mem2 = (struct mem *)(void *)&ram[ptr2];
+    mem2->used = 0;
+    mem2->next = mem->next;
+    mem2->prev = ptr;
+    mem->next = ptr2;
+    if (mem2->next != MEM_SIZE_ALIGNED) {
+      ((struct mem *)(void *)&ram[mem2->next])->prev = ptr2;
+    }
+    mem_tlsf_insert(ptr2);
+  }
+  mem->used = 1;
+  MEM_STATS_INC_USED(used, mem->next - ptr);
+
+  LWIP_MEM_ALLOC_UNPROTECT();
+  sys_mutex_unlock(&mem_mutex);
+  LWIP_ASSERT("mem_malloc: allocated memory not above ram_end.",
+   (mem_ptr_t)mem + SIZEOF_STRUCT_MEM + size <= (mem_ptr_t)ram_end);
+  LWIP_ASSERT("mem_malloc: allocated memory properly aligned.",
+   ((mem_ptr_t)mem + SIZEOF_STRUCT_MEM) % MEM_ALIGNMENT == 0);
+
+  return (u8_t *)mem + SIZEOF_STRUCT_MEM;
+}
+
+#else /* MEM_TLSF */
+
 /**
  * Adam's mem_malloc() plus solution for bug #17922
  * Allocate a block of memory with a minimum of 'size' bytes.
@@ -495,6 +842,9 @@ mem_malloc(mem_size_t size)
 #if LWIP_ALLOW_MEM_FREE_FROM_OTHER_CONTEXT
   u8_t local_mem_free_count = 0;
 #endif /* LWIP_ALLOW_MEM_FREE_FROM_OTHER_CONTEXT */
+#if MEM_STATS
+  mem_size_t searched = 0;
+#endif /* MEM_STATS */
   LWIP_MEM_ALLOC_DECL_PROTECT();
 
   if (size == 0) {
@@ -529,6 +879,9 @@ mem_malloc(mem_size_t size)
     for (ptr = (mem_size_t)((u8_t *)lfree - ram); ptr < MEM_SIZE_ALIGNED - size;
          ptr = ((struct mem *)(void *)&ram[ptr])->next) {
       mem = (struct mem *)(void *)&ram[ptr];
+#if MEM_STATS
+      searched++;
+#endif /* MEM_STATS */
 #if LWIP_ALLOW_MEM_FREE_FROM_OTHER_CONTEXT
       mem_free_count = 0;
       LWIP_MEM_ALLOC_UNPROTECT();
@@ -592,6 +945,7 @@ mem_malloc(mem_size_t size)
           }
           LWIP_ASSERT("mem_malloc: !lfree->used", ((lfree == ram_end) || (!lfree->used)));
         }
+        MEM_STATS_SEARCHED(searched);
         LWIP_MEM_ALLOC_UNPROTECT();
         sys_mutex_unlock(&mem_mutex);
         LWIP_ASSERT("mem_malloc: allocated memory not above ram_end.",
@@ -610,10 +964,48 @@ mem_malloc(mem_size_t size)
 #endif /* LWIP_ALLOW_MEM_FREE_FROM_OTHER_CONTEXT */
   LWIP_DEBUGF(MEM_DEBUG | LWIP_DBG_LEVEL_SERIOUS, ("mem_malloc: could not allocate %"S16_F" bytes\n", (s16_t)size));
   MEM_STATS_INC(err);
+  MEM_STATS_SEARCHED(searched);
   LWIP_MEM_ALLOC_UNPROTECT();
   sys_mutex_unlock(&mem_mutex);
   return NULL;
 }
+#endif /* MEM_TLSF */
+
+#if MEM_STATS
+/**
+ * Take a snapshot of how fragmented the heap is. This walks all blocks of
+ * the heap with it locked, so it is meant for diagnostics, not the data path.
+ *
+ * @param stats filled in with the free space and the largest free block
+ */
+void
+mem_heap_stats(struct mem_heap_stats *stats)
+{
+  mem_size_t ptr, size;
+  struct mem *mem;
+  /* use the FREE_PROTECT here: it protects with sem OR SYS_ARCH_PROTECT */
+  LWIP_MEM_FREE_DECL_PROTECT();
+
+  stats->free = 0;
+  stats->largest_free = 0;
+  stats->free_blocks = 0;
+
+  LWIP_MEM_FREE_PROTECT();
+  for (ptr = 0; ptr < MEM_SIZE_ALIGNED; ptr = mem->next) {
+    mem = (struct mem *)(void *)&ram[ptr];
+    if (!mem->used) {
+      size = mem->next - ptr - SIZEOF_STRUCT_MEM;
+      stats->free += size;
+      stats->free_blocks++;
+      if (size > stats->largest_free) {
+        stats->largest_free = size;
+      }
+    }
+  }
+  stats->max_search = mem_max_search;
+  LWIP_MEM_FREE_UNPROTECT();
+}
+#endif /* MEM_STATS */
 
 #endif /* MEM_USE_POOLS */
 /**
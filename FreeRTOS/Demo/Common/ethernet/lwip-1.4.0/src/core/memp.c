@@ -64,7 +64,12 @@
 #if !MEMP_MEM_MALLOC /* don't build if not configured for use in lwipopts.h */
 
 struct memp {
+#if MEMP_LOCKFREE
+  /* index + 1 of the next free element, 0 at the end of the list */
+  u16_t next;
+#else /* MEMP_LOCKFREE */
   struct memp *next;
+#endif /* MEMP_LOCKFREE */
 #if MEMP_OVERFLOW_CHECK
   const char *file;
   int line;
@@ -100,6 +105,8 @@ struct memp {
 /* MEMP_SIZE: save space for struct memp and for sanity check */
 #define MEMP_SIZE          (LWIP_MEM_ALIGN_SIZE(sizeof(struct memp)) + MEMP_SANITY_REGION_BEFORE_ALIGNED)
 #define MEMP_ALIGN_SIZE(x) (LWIP_MEM_ALIGN_SIZE(x) + MEMP_SANITY_REGION_AFTER_ALIGNED)
+/* MEMP_ELEMENT_SIZE: distance between the elements of a pool */
+#define MEMP_ELEMENT_SIZE(type) (MEMP_SIZE + memp_sizes[type] + MEMP_SANITY_REGION_AFTER_ALIGNED)
 
 #else /* MEMP_OVERFLOW_CHECK */
 
@@ -109,12 +116,23 @@ struct memp {
  */
 #define MEMP_SIZE           0
 #define MEMP_ALIGN_SIZE(x) (LWIP_MEM_ALIGN_SIZE(x))
+#define MEMP_ELEMENT_SIZE(type) (MEMP_SIZE + memp_sizes[type])
 
 #endif /* MEMP_OVERFLOW_CHECK */
 
+#if MEMP_LOCKFREE
+/** This array holds the free list of each pool: the index + 1 of the first
+ *  free element in the low 16 bits (0 if the pool is empty), and a tag in
+ *  the high 16 bits that changes on every update. The tag makes
+ *  SYS_ARCH_CAS32 fail if the list changed since it was read, even if the
+ *  same element is first again (unless a reader was held up for exactly a
+ *  multiple of 65536 updates). */
+static volatile u32_t memp_tab[MEMP_MAX];
+#else /* MEMP_LOCKFREE */
 /** This array holds the first free element of each pool.
  *  Elements form a linked list. */
 static struct memp *memp_tab[MEMP_MAX];
+#endif /* MEMP_LOCKFREE */
 
 #else /* MEMP_MEM_MALLOC */
 
@@ -328,6 +346,145 @@ memp_overflow_init(void)
 }
 #endif /* MEMP_OVERFLOW_CHECK */
 
+#if MEMP_LOCKFREE
+/** This array holds the first element of each pool */
+static u8_t *memp_base[MEMP_MAX];
+
+/** Get an element of a pool from its index + 1 */
+#define MEMP_ELEMENT(type, idx) \
+  ((struct memp *)(void *)(memp_base[type] + (mem_ptr_t)((idx) - 1) * MEMP_ELEMENT_SIZE(type)))
+/** Get the index + 1 of an element of a pool */
+#define MEMP_INDEX(type, memp) \
+  ((u16_t)(((mem_ptr_t)((u8_t *)(memp) - memp_base[type]) / MEMP_ELEMENT_SIZE(type)) + 1))
+/** A free list head starting with element idx, tagged as newer than old */
+#define MEMP_HEAD(old, idx) ((((old) + 0x10000UL) & 0xffff0000UL) | (u32_t)(idx))
+
+#if MEMP_CACHE_SIZE
+/** The free elements of one pool that one core keeps for itself, linked
+ *  through next like the free list of the pool */
+struct memp_cache {
+  u16_t first;
+  u16_t last;
+  u16_t count;
+};
+
+/** This array holds the caches of every core. Each one is only used by its
+ *  own core, inside SYS_ARCH_LOCAL_PROTECT. */
+static struct memp_cache memp_caches[MEMP_NUM_CORES][MEMP_MAX];
+#endif /* MEMP_CACHE_SIZE */
+
+#if MEMP_STATS
+/** These arrays hold the number of elements taken off the free list of each
+ *  pool (including those in the caches), the most there have been and the
+ *  number of failed allocations. They are updated with SYS_ARCH_CAS32 and
+ *  copied to lwip_stats.memp[], which is only a snapshot. */
+static volatile u32_t memp_used[MEMP_MAX];
+static volatile u32_t memp_max[MEMP_MAX];
+static volatile u32_t memp_err[MEMP_MAX];
+
+/**
+ * Atomically add to a counter.
+ *
+ * @param counter the counter to add to
+ * @param delta the value to add (wraps around to subtract)
+ * @return the new value of the counter
+ */
+static u32_t
+memp_atomic_add(volatile u32_t *counter, u32_t delta)
+{
+  u32_t old;
+
+  do {
+    old = *counter;
+  } while (!SYS_ARCH_CAS32(counter, old, old + delta));
+  return old + delta;
+}
+
+/**
+ * Count elements taken off or put back on the free list of a pool, and
+ * update its high-water mark.
+ */
+static void
+memp_stats_used(memp_t type, u32_t delta)
+{
+  u32_t used, max;
+
+  used = memp_atomic_add(&memp_used[type], delta);
+  lwip_stats.memp[type].used = (mem_size_t)used;
+  do {
+    max = memp_max[type];
+    if (used <= max) {
+      return;
+    }
+  } while (!SYS_ARCH_CAS32(&memp_max[type], max, used));
+  lwip_stats.memp[type].max = (mem_size_t)used;
+}
+
+#define MEMP_USED_ADD(type, n) memp_stats_used((type), (u32_t)(n))
+#define MEMP_USED_SUB(type, n) memp_stats_used((type), (u32_t)0 - (u32_t)(n))
+#define MEMP_ERR_INC(type) \
+  lwip_stats.memp[type].err = (STAT_COUNTER)memp_atomic_add(&memp_err[type], 1)
+#else /* MEMP_STATS */
+#define MEMP_USED_ADD(type, n)
+#define MEMP_USED_SUB(type, n)
+#define MEMP_ERR_INC(type)
+#endif /* MEMP_STATS */
+
+/**
+ * Put a chain of elements on the free list of a pool.
+ *
+ * @param type the pool to put them on
+ * @param first index + 1 of the first element of the chain
+ * @param last the last element of the chain; its next is overwritten
+ */
+static void
+memp_push(memp_t type, u16_t first, struct memp *last)
+{
+  u32_t head;
+
+  do {
+    head = memp_tab[type];
+    last->next = (u16_t)head;
+  } while (!SYS_ARCH_CAS32(&memp_tab[type], head, MEMP_HEAD(head, first)));
+}
+
+/**
+ * Take a chain of elements off the free list of a pool.
+ *
+ * @param type the pool to take them from
+ * @param max the most elements to take
+ * @param first returns index + 1 of the first element taken
+ * @param last returns index + 1 of the last element taken; the elements
+ *        before it are linked through next
+ * @return the number of elements taken, 0 if the pool is empty
+ */
+static u16_t
+memp_pop(memp_t type, u16_t max, u16_t *first, u16_t *last)
+{
+  u32_t head;
+  u16_t idx, n;
+
+  for (;;) {
+    head = memp_tab[type];
+    idx = (u16_t)head;
+    if (idx == 0) {
+      return 0;
+    }
+    for (n = 0; (idx != 0) && (idx <= memp_num[type]) && (n < max); n++) {
+      *last = idx;
+      idx = MEMP_ELEMENT(type, idx)->next;
+    }
+    /* If next was out of range, someone else took that element and wrote
+       over it after we read the head: don't follow it, just start over. */
+    if ((idx <= memp_num[type]) &&
+        SYS_ARCH_CAS32(&memp_tab[type], head, MEMP_HEAD(head, idx))) {
+      *first = (u16_t)head;
+      return n;
+    }
+  }
+}
+#endif /* MEMP_LOCKFREE */
+
 /**
  * Initialize this module.
  * 
@@ -344,21 +501,40 @@ memp_init(void)
     MEMP_STATS_AVAIL(max, i, 0);
     MEMP_STATS_AVAIL(err, i, 0);
     MEMP_STATS_AVAIL(avail, i, memp_num[i]);
+#if MEMP_LOCKFREE && MEMP_STATS
+    memp_used[i] = 0;
+    memp_max[i] = 0;
+    memp_err[i] = 0;
+#endif /* MEMP_LOCKFREE && MEMP_STATS */
   }
+#if MEMP_LOCKFREE && MEMP_CACHE_SIZE
+  memset(memp_caches, 0, sizeof(memp_caches));
+#endif /* MEMP_LOCKFREE && MEMP_CACHE_SIZE */
 
 #if !MEMP_SEPARATE_POOLS
   memp = (struct memp *)LWIP_MEM_ALIGN(memp_memory);
 #endif /* !MEMP_SEPARATE_POOLS */
   /* for every pool: */
   for (i = 0; i < MEMP_MAX; ++i) {
-    memp_tab[i] = NULL;
 #if MEMP_SEPARATE_POOLS
     memp = (struct memp*)memp_bases[i];
 #endif /* MEMP_SEPARATE_POOLS */
+#if MEMP_LOCKFREE
+    LWIP_ASSERT("memp_init: pool too large for MEMP_LOCKFREE", memp_num[i] < 0xffff);
+    memp_base[i] = (u8_t *)memp;
+    memp_tab[i] = 0;
+#else /* MEMP_LOCKFREE */
+    memp_tab[i] = NULL;
+#endif /* MEMP_LOCKFREE */
     /* create a linked list of memp elements */
     for (j = 0; j < memp_num[i]; ++j) {
+#if MEMP_LOCKFREE
+      memp->next = (u16_t)memp_tab[i];
+      memp_tab[i] = (u32_t)j + 1;
+#else /* MEMP_LOCKFREE */
       memp->next = memp_tab[i];
       memp_tab[i] = memp;
+#endif /* MEMP_LOCKFREE */
       memp = (struct memp *)(void *)((u8_t *)memp + MEMP_SIZE + memp_sizes[i]
 #if MEMP_OVERFLOW_CHECK
         + MEMP_SANITY_REGION_AFTER_ALIGNED
@@ -373,6 +549,170 @@ memp_init(void)
 #endif /* MEMP_OVERFLOW_CHECK */
 }
 
+#if MEMP_LOCKFREE
+/**
+ * Get an element from a specific pool, without a lock. Can be called from
+ * interrupt handlers.
+ *
+ * @param type the pool to get an element from
+ *
+ * the debug version has two more parameters:
+ * @param file file name calling this function
+ * @param line number of line where this function is called
+ *
+ * @return a pointer to the allocated memory or a NULL pointer on error
+ */
+void *
+#if !MEMP_OVERFLOW_CHECK
+memp_malloc(memp_t type)
+#else
+memp_malloc_fn(memp_t type, const char* file, const int line)
+#endif
+{
+  struct memp *memp;
+  u16_t idx, last, n;
+#if MEMP_CACHE_SIZE
+  struct memp_cache *cache;
+  SYS_ARCH_DECL_LOCAL_PROTECT(old_level);
+#endif /* MEMP_CACHE_SIZE */
+
+  LWIP_ERROR("memp_malloc: type < MEMP_MAX", (type < MEMP_MAX), return NULL;);
+
+#if MEMP_OVERFLOW_CHECK >= 2
+  memp_overflow_check_all();
+#endif /* MEMP_OVERFLOW_CHECK >= 2 */
+
+#if MEMP_CACHE_SIZE
+  SYS_ARCH_LOCAL_PROTECT(old_level);
+  cache = &memp_caches[SYS_ARCH_CORE_ID()][type];
+  idx = cache->first;
+  if (idx != 0) {
+    cache->first = MEMP_ELEMENT(type, idx)->next;
+    cache->count--;
+  }
+  SYS_ARCH_LOCAL_UNPROTECT(old_level);
+
+  if (idx == 0) {
+    /* This core's cache is empty: take a batch from the pool, keep the
+       first element and put the rest in the cache. */
+    n = memp_pop(type, MEMP_CACHE_SIZE / 2, &idx, &last);
+    if (n > 0) {
+      MEMP_USED_ADD(type, n);
+    }
+    if (n > 1) {
+      SYS_ARCH_LOCAL_PROTECT(old_level);
+      cache = &memp_caches[SYS_ARCH_CORE_ID()][type];
+      MEMP_ELEMENT(type, last)->next = cache->first;
+      if (cache->first == 0) {
+        cache->last = last;
+      }
+      cache->first = MEMP_ELEMENT(type, idx)->next;
+      cache->count = (u16_t)(cache->count + n - 1);
+      SYS_ARCH_LOCAL_UNPROTECT(old_level);
+    }
+  }
+#else /* MEMP_CACHE_SIZE */
+  n = memp_pop(type, 1, &idx, &last);
+  if (n == 0) {
+    idx = 0;
+  } else {
+    MEMP_USED_ADD(type, 1);
+  }
+#endif /* MEMP_CACHE_SIZE */
+
+  if (idx == 0) {
+    LWIP_DEBUGF(MEMP_DEBUG | LWIP_DBG_LEVEL_SERIOUS, ("memp_malloc: out of memory in pool %s\n", memp_desc[type]));
+    MEMP_ERR_INC(type);
+    return NULL;
+  }
+
+  memp = MEMP_ELEMENT(type, idx);
+#if MEMP_OVERFLOW_CHECK
+  memp->next = 0;
+  memp->file = file;
+  memp->line = line;
+#endif /* MEMP_OVERFLOW_CHECK */
+  LWIP_ASSERT("memp_malloc: memp properly aligned",
+              ((mem_ptr_t)memp % MEM_ALIGNMENT) == 0);
+  return (u8_t*)memp + MEMP_SIZE;
+}
+
+/**
+ * Put an element back into its pool, without a lock. Can be called from
+ * interrupt handlers.
+ *
+ * @param type the pool where to put mem
+ * @param mem the memp element to free
+ */
+void
+memp_free(memp_t type, void *mem)
+{
+  struct memp *memp;
+  u16_t idx;
+#if MEMP_CACHE_SIZE
+  struct memp_cache *cache;
+  u16_t first, last, mid, n;
+  SYS_ARCH_DECL_LOCAL_PROTECT(old_level);
+#endif /* MEMP_CACHE_SIZE */
+
+  if (mem == NULL) {
+    return;
+  }
+  LWIP_ASSERT("memp_free: mem properly aligned",
+                ((mem_ptr_t)mem % MEM_ALIGNMENT) == 0);
+
+  memp = (struct memp *)(void *)((u8_t*)mem - MEMP_SIZE);
+  idx = MEMP_INDEX(type, memp);
+  LWIP_ASSERT("memp_free: mem is an element of the pool",
+              (idx > 0) && (idx <= memp_num[type]) && (MEMP_ELEMENT(type, idx) == memp));
+
+#if MEMP_OVERFLOW_CHECK
+#if MEMP_OVERFLOW_CHECK >= 2
+  memp_overflow_check_all();
+#else
+  memp_overflow_check_element_overflow(memp, type);
+  memp_overflow_check_element_underflow(memp, type);
+#endif /* MEMP_OVERFLOW_CHECK >= 2 */
+#endif /* MEMP_OVERFLOW_CHECK */
+
+#if MEMP_CACHE_SIZE
+  first = last = n = 0;
+  SYS_ARCH_LOCAL_PROTECT(old_level);
+  cache = &memp_caches[SYS_ARCH_CORE_ID()][type];
+  if (cache->count >= MEMP_CACHE_SIZE) {
+    /* This core's cache is full: keep the newer half and give the older
+       half back to the pool. */
+    mid = cache->first;
+    for (n = 1; n < MEMP_CACHE_SIZE / 2; n++) {
+      mid = MEMP_ELEMENT(type, mid)->next;
+    }
+    first = MEMP_ELEMENT(type, mid)->next;
+    last = cache->last;
+    n = (u16_t)(cache->count - n);
+    MEMP_ELEMENT(type, mid)->next = 0;
+    cache->last = mid;
+    cache->count = MEMP_CACHE_SIZE / 2;
+  }
+  memp->next = cache->first;
+  if (cache->first == 0) {
+    cache->last = idx;
+  }
+  cache->first = idx;
+  cache->count++;
+  SYS_ARCH_LOCAL_UNPROTECT(old_level);
+
+  if (first != 0) {
+    MEMP_USED_SUB(type, n);
+    memp_push(type, first, MEMP_ELEMENT(type, last));
+  }
+#else /* MEMP_CACHE_SIZE */
+  MEMP_USED_SUB(type, 1);
+  memp_push(type, idx, memp);
+#endif /* MEMP_CACHE_SIZE */
+}
+
+#else /* MEMP_LOCKFREE */
+
 /**
  * Get an element from a specific pool.
  *
@@ -466,4 +806,6 @@ memp_free(memp_t type, void *mem)
   SYS_ARCH_UNPROTECT(old_level);
 }
 
+#endif /* MEMP_LOCKFREE */
+
 #endif /* MEMP_MEM_MALLOC */
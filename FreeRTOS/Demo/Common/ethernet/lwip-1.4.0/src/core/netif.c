@@ -138,6 +138,9 @@ netif_add(struct netif *netif, ip_addr_t *ipaddr, ip_addr_t *netmask,
   ip_addr_t *gw, void *state, netif_init_fn init, netif_input_fn input)
 {
   static u8_t netifnum = 0;
+#if LWIP_ARP && LWIP_ARP_HASH
+  u16_t i;
+#endif /* LWIP_ARP && LWIP_ARP_HASH */
 
   LWIP_ASSERT("No init function given", init != NULL);
 
@@ -175,6 +178,11 @@ netif_add(struct netif *netif, ip_addr_t *ipaddr, ip_addr_t *netmask,
 #if LWIP_NETIF_HWADDRHINT
   netif->addr_hint = NULL;
 #endif /* LWIP_NETIF_HWADDRHINT*/
+#if LWIP_ARP && LWIP_ARP_HASH
+  for (i = 0; i < ETHARP_NETIF_HINTS; i++) {
+    netif->arp_hint[i] = ARP_TABLE_SIZE;
+  }
+#endif /* LWIP_ARP && LWIP_ARP_HASH */
 #if ENABLE_LOOPBACK && LWIP_LOOPBACK_MAX_PBUFS
   netif->loop_cnt_current = 0;
 #endif /* ENABLE_LOOPBACK && LWIP_LOOPBACK_MAX_PBUFS */
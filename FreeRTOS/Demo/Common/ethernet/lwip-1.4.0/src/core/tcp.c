@@ -97,6 +97,13 @@ struct tcp_pcb ** const tcp_pcb_lists[] = {&tcp_listen_pcbs.pcbs, &tcp_bound_pcb
 /** Only used for temporary storage. */
 struct tcp_pcb *tcp_tmp_pcb;
 
+#if LWIP_TCP_PCB_HASH
+/** Hash table over tcp_active_pcbs and tcp_tw_pcbs, keyed on the 4-tuple */
+struct tcp_pcb *tcp_conn_hash[TCP_PCB_HASH_SIZE];
+/** Hash table over tcp_listen_pcbs, keyed on the local port */
+struct tcp_pcb_listen *tcp_listen_hash[TCP_LISTEN_HASH_SIZE];
+#endif /* LWIP_TCP_PCB_HASH */
+
 /** Timer counter to handle calling slow-timer from tcp_tmr() */ 
 static u8_t tcp_timer;
 static u16_t tcp_new_port(void);
@@ -108,6 +115,13 @@ static u16_t tcp_new_port(void);
 void
 tcp_tmr(void)
 {
+#if LWIP_TCP_PCB_TIMERS
+  /* Each pcb runs its own timer (tcp_pcb_timer()), only keep tcp_ticks
+     going at the rate tcp_slowtmr() would. */
+  if (++tcp_timer & 1) {
+    ++tcp_ticks;
+  }
+#else /* LWIP_TCP_PCB_TIMERS */
   /* Call tcp_fasttmr() every 250 ms */
   tcp_fasttmr();
 
@@ -116,6 +130,7 @@ tcp_tmr(void)
        tcp_tmr() is called. */
     tcp_slowtmr();
   }
+#endif /* LWIP_TCP_PCB_TIMERS */
 }
 
 /**
@@ -496,7 +511,12 @@ tcp_listen_with_backlog(struct tcp_pcb *pcb, u8_t backlog)
     /* Since SOF_REUSEADDR allows reusing a local address before the pcb's usage
        is declared (listen-/connection-pcb), we have to make sure now that
        this port is only used once for every local IP. */
+#if LWIP_TCP_PCB_HASH
+    for(lpcb = tcp_listen_hash[TCP_LISTEN_HASH_INDEX(pcb->local_port)];
+        lpcb != NULL; lpcb = lpcb->hash_next) {
+#else /* LWIP_TCP_PCB_HASH */
     for(lpcb = tcp_listen_pcbs.listen_pcbs; lpcb != NULL; lpcb = lpcb->next) {
+#endif /* LWIP_TCP_PCB_HASH */
       if (lpcb->local_port == pcb->local_port) {
         if (ip_addr_cmp(&lpcb->local_ip, &pcb->local_ip)) {
           /* this address/port is already used */
@@ -684,6 +704,13 @@ tcp_connect(struct tcp_pcb *pcb, ip_addr_t *ipaddr, u16_t port,
   if ((pcb->so_options & SOF_REUSEADDR) != 0) {
     /* Since SOF_REUSEADDR allows reusing a local address, we have to make sure
        now that the 5-tuple is unique. */
+#if LWIP_TCP_PCB_HASH
+    /* The active- and TIME-WAIT PCBs are all in the connection hash. */
+    if (tcp_conn_hash_lookup(&pcb->local_ip, pcb->local_port, ipaddr, port) != NULL) {
+      /* linux returns EISCONN here, but ERR_USE should be OK for us */
+      return ERR_USE;
+    }
+#else /* LWIP_TCP_PCB_HASH */
     struct tcp_pcb *cpcb;
     int i;
     /* Don't check listen- and bound-PCBs, check active- and TIME-WAIT PCBs. */
@@ -698,6 +725,7 @@ tcp_connect(struct tcp_pcb *pcb, ip_addr_t *ipaddr, u16_t port,
         }
       }
     }
+#endif /* LWIP_TCP_PCB_HASH */
   }
 #endif /* SO_REUSE */
   iss = tcp_next_iss();
@@ -740,168 +768,186 @@ tcp_connect(struct tcp_pcb *pcb, ip_addr_t *ipaddr, u16_t port,
 }
 
 /**
- * Called every 500 ms and implements the retransmission timer and the timer that
- * removes PCBs that have been in TIME-WAIT for enough time. It also increments
- * various timers such as the inactivity timer in each PCB.
+ * Runs the retransmission, persist, keepalive and state timeouts of one
+ * active PCB. Called every 500 ms for each PCB from tcp_slowtmr().
  *
- * Automatically called from tcp_tmr().
+ * @param pcb the tcp_pcb to check
+ * @param pcb_reset set to 1 if a RST should be sent when removing the pcb
+ * @return nonzero if the pcb should be removed
  */
-void
-tcp_slowtmr(void)
+static u8_t
+tcp_slowtmr_check(struct tcp_pcb *pcb, u8_t *pcb_reset)
 {
-  struct tcp_pcb *pcb, *prev;
   u16_t eff_wnd;
   u8_t pcb_remove;      /* flag if a PCB should be removed */
-  u8_t pcb_reset;       /* flag if a RST should be sent when removing */
-  err_t err;
 
-  err = ERR_OK;
-
-  ++tcp_ticks;
+  pcb_remove = 0;
+  *pcb_reset = 0;
 
-  /* Steps through all of the active PCBs. */
-  prev = NULL;
-  pcb = tcp_active_pcbs;
-  if (pcb == NULL) {
-    LWIP_DEBUGF(TCP_DEBUG, ("tcp_slowtmr: no active pcbs\n"));
+  if (pcb->state == SYN_SENT && pcb->nrtx == TCP_SYNMAXRTX) {
+    ++pcb_remove;
+    LWIP_DEBUGF(TCP_DEBUG, ("tcp_slowtmr: max SYN retries reached\n"));
   }
-  while (pcb != NULL) {
-    LWIP_DEBUGF(TCP_DEBUG, ("tcp_slowtmr: processing active pcb\n"));
-    LWIP_ASSERT("tcp_slowtmr: active pcb->state != CLOSED\n", pcb->state != CLOSED);
-    LWIP_ASSERT("tcp_slowtmr: active pcb->state != LISTEN\n", pcb->state != LISTEN);
-    LWIP_ASSERT("tcp_slowtmr: active pcb->state != TIME-WAIT\n", pcb->state != TIME_WAIT);
-
-    pcb_remove = 0;
-    pcb_reset = 0;
-
-    if (pcb->state == SYN_SENT && pcb->nrtx == TCP_SYNMAXRTX) {
-      ++pcb_remove;
-      LWIP_DEBUGF(TCP_DEBUG, ("tcp_slowtmr: max SYN retries reached\n"));
-    }
-    else if (pcb->nrtx == TCP_MAXRTX) {
-      ++pcb_remove;
-      LWIP_DEBUGF(TCP_DEBUG, ("tcp_slowtmr: max DATA retries reached\n"));
+  else if (pcb->nrtx == TCP_MAXRTX) {
+    ++pcb_remove;
+    LWIP_DEBUGF(TCP_DEBUG, ("tcp_slowtmr: max DATA retries reached\n"));
+  } else {
+    if (pcb->persist_backoff > 0) {
+      /* If snd_wnd is zero, use persist timer to send 1 byte probes
+       * instead of using the standard retransmission mechanism. */
+      pcb->persist_cnt++;
+      if (pcb->persist_cnt >= tcp_persist_backoff[pcb->persist_backoff-1]) {
+        pcb->persist_cnt = 0;
+        if (pcb->persist_backoff < sizeof(tcp_persist_backoff)) {
+          pcb->persist_backoff++;
+        }
+        tcp_zero_window_probe(pcb);
+      }
     } else {
-      if (pcb->persist_backoff > 0) {
-        /* If snd_wnd is zero, use persist timer to send 1 byte probes
-         * instead of using the standard retransmission mechanism. */
-        pcb->persist_cnt++;
-        if (pcb->persist_cnt >= tcp_persist_backoff[pcb->persist_backoff-1]) {
-          pcb->persist_cnt = 0;
-          if (pcb->persist_backoff < sizeof(tcp_persist_backoff)) {
-            pcb->persist_backoff++;
-          }
-          tcp_zero_window_probe(pcb);
+      /* Increase the retransmission timer if it is running */
+      if(pcb->rtime >= 0)
+        ++pcb->rtime;
+
+      if (pcb->unacked != NULL && pcb->rtime >= pcb->rto) {
+        /* Time for a retransmission. */
+        LWIP_DEBUGF(TCP_RTO_DEBUG, ("tcp_slowtmr: rtime %"S16_F
+                                    " pcb->rto %"S16_F"\n",
+                                    pcb->rtime, pcb->rto));
+
+        /* Double retransmission time-out unless we are trying to
+         * connect to somebody (i.e., we are in SYN_SENT). */
+        if (pcb->state != SYN_SENT) {
+          pcb->rto = ((pcb->sa >> 3) + pcb->sv) << tcp_backoff[pcb->nrtx];
         }
-      } else {
-        /* Increase the retransmission timer if it is running */
-        if(pcb->rtime >= 0)
-          ++pcb->rtime;
-
-        if (pcb->unacked != NULL && pcb->rtime >= pcb->rto) {
-          /* Time for a retransmission. */
-          LWIP_DEBUGF(TCP_RTO_DEBUG, ("tcp_slowtmr: rtime %"S16_F
-                                      " pcb->rto %"S16_F"\n",
-                                      pcb->rtime, pcb->rto));
-
-          /* Double retransmission time-out unless we are trying to
-           * connect to somebody (i.e., we are in SYN_SENT). */
-          if (pcb->state != SYN_SENT) {
-            pcb->rto = ((pcb->sa >> 3) + pcb->sv) << tcp_backoff[pcb->nrtx];
-          }
 
-          /* Reset the retransmission timer. */
-          pcb->rtime = 0;
+        /* Reset the retransmission timer. */
+        pcb->rtime = 0;
 
-          /* Reduce congestion window and ssthresh. */
-          eff_wnd = LWIP_MIN(pcb->cwnd, pcb->snd_wnd);
-          pcb->ssthresh = eff_wnd >> 1;
-          if (pcb->ssthresh < (pcb->mss << 1)) {
-            pcb->ssthresh = (pcb->mss << 1);
-          }
-          pcb->cwnd = pcb->mss;
-          LWIP_DEBUGF(TCP_CWND_DEBUG, ("tcp_slowtmr: cwnd %"U16_F
-                                       " ssthresh %"U16_F"\n",
-                                       pcb->cwnd, pcb->ssthresh));
- 
-          /* The following needs to be called AFTER cwnd is set to one
-             mss - STJ */
-          tcp_rexmit_rto(pcb);
+        /* Reduce congestion window and ssthresh. */
+        eff_wnd = LWIP_MIN(pcb->cwnd, pcb->snd_wnd);
+        pcb->ssthresh = eff_wnd >> 1;
+        if (pcb->ssthresh < (pcb->mss << 1)) {
+          pcb->ssthresh = (pcb->mss << 1);
         }
+        pcb->cwnd = pcb->mss;
+        LWIP_DEBUGF(TCP_CWND_DEBUG, ("tcp_slowtmr: cwnd %"U16_F
+                                     " ssthresh %"U16_F"\n",
+                                     pcb->cwnd, pcb->ssthresh));
+ 
+        /* The following needs to be called AFTER cwnd is set to one
+           mss - STJ */
+        tcp_rexmit_rto(pcb);
       }
     }
-    /* Check if this PCB has stayed too long in FIN-WAIT-2 */
-    if (pcb->state == FIN_WAIT_2) {
-      if ((u32_t)(tcp_ticks - pcb->tmr) >
-          TCP_FIN_WAIT_TIMEOUT / TCP_SLOW_INTERVAL) {
-        ++pcb_remove;
-        LWIP_DEBUGF(TCP_DEBUG, ("tcp_slowtmr: removing pcb stuck in FIN-WAIT-2\n"));
-      }
+  }
+  /* Check if this PCB has stayed too long in FIN-WAIT-2 */
+  if (pcb->state == FIN_WAIT_2) {
+    if ((u32_t)(tcp_ticks - pcb->tmr) >
+        TCP_FIN_WAIT_TIMEOUT / TCP_SLOW_INTERVAL) {
+      ++pcb_remove;
+      LWIP_DEBUGF(TCP_DEBUG, ("tcp_slowtmr: removing pcb stuck in FIN-WAIT-2\n"));
     }
+  }
 
-    /* Check if KEEPALIVE should be sent */
-    if((pcb->so_options & SOF_KEEPALIVE) &&
-       ((pcb->state == ESTABLISHED) ||
-        (pcb->state == CLOSE_WAIT))) {
+  /* Check if KEEPALIVE should be sent */
+  if((pcb->so_options & SOF_KEEPALIVE) &&
+     ((pcb->state == ESTABLISHED) ||
+      (pcb->state == CLOSE_WAIT))) {
 #if LWIP_TCP_KEEPALIVE
-      if((u32_t)(tcp_ticks - pcb->tmr) >
-         (pcb->keep_idle + (pcb->keep_cnt*pcb->keep_intvl))
-         / TCP_SLOW_INTERVAL)
+    if((u32_t)(tcp_ticks - pcb->tmr) >
+       (pcb->keep_idle + (pcb->keep_cnt*pcb->keep_intvl))
+       / TCP_SLOW_INTERVAL)
 #else      
-      if((u32_t)(tcp_ticks - pcb->tmr) >
-         (pcb->keep_idle + TCP_MAXIDLE) / TCP_SLOW_INTERVAL)
+    if((u32_t)(tcp_ticks - pcb->tmr) >
+       (pcb->keep_idle + TCP_MAXIDLE) / TCP_SLOW_INTERVAL)
 #endif /* LWIP_TCP_KEEPALIVE */
-      {
-        LWIP_DEBUGF(TCP_DEBUG, ("tcp_slowtmr: KEEPALIVE timeout. Aborting connection to %"U16_F".%"U16_F".%"U16_F".%"U16_F".\n",
-                                ip4_addr1_16(&pcb->remote_ip), ip4_addr2_16(&pcb->remote_ip),
-                                ip4_addr3_16(&pcb->remote_ip), ip4_addr4_16(&pcb->remote_ip)));
-        
-        ++pcb_remove;
-        ++pcb_reset;
-      }
+    {
+      LWIP_DEBUGF(TCP_DEBUG, ("tcp_slowtmr: KEEPALIVE timeout. Aborting connection to %"U16_F".%"U16_F".%"U16_F".%"U16_F".\n",
+                              ip4_addr1_16(&pcb->remote_ip), ip4_addr2_16(&pcb->remote_ip),
+                              ip4_addr3_16(&pcb->remote_ip), ip4_addr4_16(&pcb->remote_ip)));
+      
+      ++pcb_remove;
+      ++(*pcb_reset);
+    }
 #if LWIP_TCP_KEEPALIVE
-      else if((u32_t)(tcp_ticks - pcb->tmr) > 
-              (pcb->keep_idle + pcb->keep_cnt_sent * pcb->keep_intvl)
-              / TCP_SLOW_INTERVAL)
+    else if((u32_t)(tcp_ticks - pcb->tmr) > 
+            (pcb->keep_idle + pcb->keep_cnt_sent * pcb->keep_intvl)
+            / TCP_SLOW_INTERVAL)
 #else
-      else if((u32_t)(tcp_ticks - pcb->tmr) > 
-              (pcb->keep_idle + pcb->keep_cnt_sent * TCP_KEEPINTVL_DEFAULT) 
-              / TCP_SLOW_INTERVAL)
+    else if((u32_t)(tcp_ticks - pcb->tmr) > 
+            (pcb->keep_idle + pcb->keep_cnt_sent * TCP_KEEPINTVL_DEFAULT) 
+            / TCP_SLOW_INTERVAL)
 #endif /* LWIP_TCP_KEEPALIVE */
-      {
-        tcp_keepalive(pcb);
-        pcb->keep_cnt_sent++;
-      }
+    {
+      tcp_keepalive(pcb);
+      pcb->keep_cnt_sent++;
     }
+  }
 
-    /* If this PCB has queued out of sequence data, but has been
-       inactive for too long, will drop the data (it will eventually
-       be retransmitted). */
+  /* If this PCB has queued out of sequence data, but has been
+     inactive for too long, will drop the data (it will eventually
+     be retransmitted). */
 #if TCP_QUEUE_OOSEQ
-    if (pcb->ooseq != NULL &&
-        (u32_t)tcp_ticks - pcb->tmr >= pcb->rto * TCP_OOSEQ_TIMEOUT) {
-      tcp_segs_free(pcb->ooseq);
-      pcb->ooseq = NULL;
-      LWIP_DEBUGF(TCP_CWND_DEBUG, ("tcp_slowtmr: dropping OOSEQ queued data\n"));
-    }
+  if (pcb->ooseq != NULL &&
+      (u32_t)tcp_ticks - pcb->tmr >= pcb->rto * TCP_OOSEQ_TIMEOUT) {
+    tcp_segs_free(pcb->ooseq);
+    pcb->ooseq = NULL;
+    LWIP_DEBUGF(TCP_CWND_DEBUG, ("tcp_slowtmr: dropping OOSEQ queued data\n"));
+  }
 #endif /* TCP_QUEUE_OOSEQ */
 
-    /* Check if this PCB has stayed too long in SYN-RCVD */
-    if (pcb->state == SYN_RCVD) {
-      if ((u32_t)(tcp_ticks - pcb->tmr) >
-          TCP_SYN_RCVD_TIMEOUT / TCP_SLOW_INTERVAL) {
-        ++pcb_remove;
-        LWIP_DEBUGF(TCP_DEBUG, ("tcp_slowtmr: removing pcb stuck in SYN-RCVD\n"));
-      }
+  /* Check if this PCB has stayed too long in SYN-RCVD */
+  if (pcb->state == SYN_RCVD) {
+    if ((u32_t)(tcp_ticks - pcb->tmr) >
+        TCP_SYN_RCVD_TIMEOUT / TCP_SLOW_INTERVAL) {
+      ++pcb_remove;
+      LWIP_DEBUGF(TCP_DEBUG, ("tcp_slowtmr: removing pcb stuck in SYN-RCVD\n"));
     }
+  }
 
-    /* Check if this PCB has stayed too long in LAST-ACK */
-    if (pcb->state == LAST_ACK) {
-      if ((u32_t)(tcp_ticks - pcb->tmr) > 2 * TCP_MSL / TCP_SLOW_INTERVAL) {
-        ++pcb_remove;
-        LWIP_DEBUGF(TCP_DEBUG, ("tcp_slowtmr: removing pcb stuck in LAST-ACK\n"));
-      }
+  /* Check if this PCB has stayed too long in LAST-ACK */
+  if (pcb->state == LAST_ACK) {
+    if ((u32_t)(tcp_ticks - pcb->tmr) > 2 * TCP_MSL / TCP_SLOW_INTERVAL) {
+      ++pcb_remove;
+      LWIP_DEBUGF(TCP_DEBUG, ("tcp_slowtmr: removing pcb stuck in LAST-ACK\n"));
     }
+  }
+
+  return pcb_remove;
+}
+
+/**
+ * Called every 500 ms and implements the retransmission timer and the timer that
+ * removes PCBs that have been in TIME-WAIT for enough time. It also increments
+ * various timers such as the inactivity timer in each PCB.
+ *
+ * Automatically called from tcp_tmr().
+ */
+void
+tcp_slowtmr(void)
+{
+  struct tcp_pcb *pcb, *prev;
+  u8_t pcb_remove;      /* flag if a PCB should be removed */
+  u8_t pcb_reset;       /* flag if a RST should be sent when removing */
+  err_t err;
+
+  err = ERR_OK;
+
+  ++tcp_ticks;
+
+  /* Steps through all of the active PCBs. */
+  prev = NULL;
+  pcb = tcp_active_pcbs;
+  if (pcb == NULL) {
+    LWIP_DEBUGF(TCP_DEBUG, ("tcp_slowtmr: no active pcbs\n"));
+  }
+  while (pcb != NULL) {
+    LWIP_DEBUGF(TCP_DEBUG, ("tcp_slowtmr: processing active pcb\n"));
+    LWIP_ASSERT("tcp_slowtmr: active pcb->state != CLOSED\n", pcb->state != CLOSED);
+    LWIP_ASSERT("tcp_slowtmr: active pcb->state != LISTEN\n", pcb->state != LISTEN);
+    LWIP_ASSERT("tcp_slowtmr: active pcb->state != TIME-WAIT\n", pcb->state != TIME_WAIT);
+
+    pcb_remove = tcp_slowtmr_check(pcb, &pcb_reset);
 
     /* If the PCB should be removed, do it. */
     if (pcb_remove) {
@@ -916,6 +962,8 @@ tcp_slowtmr(void)
         LWIP_ASSERT("tcp_slowtmr: first pcb == tcp_active_pcbs", tcp_active_pcbs == pcb);
         tcp_active_pcbs = pcb->next;
       }
+      TCP_HASH_RMV(&tcp_active_pcbs, pcb);
+      TCP_TIMER_RMV(&tcp_active_pcbs, pcb);
 
       TCP_EVENT_ERR(pcb->errf, pcb->callback_arg, ERR_ABRT);
       if (pcb_reset) {
@@ -973,6 +1021,8 @@ tcp_slowtmr(void)
         LWIP_ASSERT("tcp_slowtmr: first pcb == tcp_tw_pcbs", tcp_tw_pcbs == pcb);
         tcp_tw_pcbs = pcb->next;
       }
+      TCP_HASH_RMV(&tcp_tw_pcbs, pcb);
+      TCP_TIMER_RMV(&tcp_tw_pcbs, pcb);
       pcb2 = pcb;
       pcb = pcb->next;
       memp_free(MEMP_TCP_PCB, pcb2);
@@ -983,6 +1033,40 @@ tcp_slowtmr(void)
   }
 }
 
+/**
+ * Processes data previously "refused" by upper layer (application) and
+ * sends the delayed ACK of one active PCB.
+ *
+ * @param pcb the tcp_pcb to process
+ * @return ERR_ABRT if the pcb was aborted (and deallocated), ERR_OK otherwise
+ */
+static err_t
+tcp_fasttmr_pcb(struct tcp_pcb *pcb)
+{
+  /* If there is data which was previously "refused" by upper layer */
+  if (pcb->refused_data != NULL) {
+    /* Notify again application with data previously received. */
+    err_t err;
+    LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_fasttmr: notify kept packet\n"));
+    TCP_EVENT_RECV(pcb, pcb->refused_data, ERR_OK, err);
+    if (err == ERR_OK) {
+      pcb->refused_data = NULL;
+    } else if (err == ERR_ABRT) {
+      /* if err == ERR_ABRT, 'pcb' is already deallocated */
+      return ERR_ABRT;
+    }
+  }
+
+  /* send delayed ACKs */
+  if (pcb->flags & TF_ACK_DELAY) {
+    LWIP_DEBUGF(TCP_DEBUG, ("tcp_fasttmr: delayed ACK\n"));
+    tcp_ack_now(pcb);
+    tcp_output(pcb);
+    pcb->flags &= ~(TF_ACK_DELAY | TF_ACK_NOW);
+  }
+  return ERR_OK;
+}
+
 /**
  * Is called every TCP_FAST_INTERVAL (250 ms) and process data previously
  * "refused" by upper layer (application) and sends delayed ACKs.
@@ -996,32 +1080,234 @@ tcp_fasttmr(void)
 
   while(pcb != NULL) {
     struct tcp_pcb *next = pcb->next;
-    /* If there is data which was previously "refused" by upper layer */
-    if (pcb->refused_data != NULL) {
-      /* Notify again application with data previously received. */
-      err_t err;
-      LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_fasttmr: notify kept packet\n"));
-      TCP_EVENT_RECV(pcb, pcb->refused_data, ERR_OK, err);
-      if (err == ERR_OK) {
-        pcb->refused_data = NULL;
-      } else if (err == ERR_ABRT) {
-        /* if err == ERR_ABRT, 'pcb' is already deallocated */
-        pcb = NULL;
+    tcp_fasttmr_pcb(pcb);
+    pcb = next;
+  }
+}
+
+#if LWIP_TCP_PCB_TIMERS
+static void tcp_pcb_timer(void *arg);
+
+/** Interval between keepalive probes, in milliseconds */
+#if LWIP_TCP_KEEPALIVE
+#define TCP_KEEPINTVL(pcb) ((pcb)->keep_intvl)
+#else /* LWIP_TCP_KEEPALIVE */
+#define TCP_KEEPINTVL(pcb) TCP_KEEPINTVL_DEFAULT
+#endif /* LWIP_TCP_KEEPALIVE */
+
+/**
+ * Counts the slow timer ticks a parked pcb missed towards its poll
+ * interval, stopping one short of it so the next slow timer run polls.
+ *
+ * @param pcb the tcp_pcb that is no longer idle
+ */
+static void
+tcp_timer_unpark(struct tcp_pcb *pcb)
+{
+  u32_t polltmr;
+
+  if (pcb->timer_flags & TCP_TIMER_PARKED) {
+    polltmr = pcb->polltmr + (u32_t)(tcp_ticks - pcb->timer_parked);
+    if ((pcb->pollinterval > 0) && (polltmr >= pcb->pollinterval)) {
+      polltmr = pcb->pollinterval - 1;
+    }
+    pcb->polltmr = (u8_t)LWIP_MIN(polltmr, 0xff);
+    pcb->timer_flags &= ~TCP_TIMER_PARKED;
+  }
+}
+
+/**
+ * Starts the timer of a TIME-WAIT pcb so that it runs when the pcb has
+ * stayed long enough in TIME-WAIT.
+ *
+ * @param pcb the tcp_pcb in TIME-WAIT
+ */
+static void
+tcp_timer_time_wait(struct tcp_pcb *pcb)
+{
+  u32_t elapsed = (u32_t)(tcp_ticks - pcb->tmr);
+
+  pcb->timer_flags = 0;
+  sys_timeout_start(&pcb->timer,
+    (2 * TCP_MSL / TCP_SLOW_INTERVAL + 1 - LWIP_MIN(elapsed, 2 * TCP_MSL / TCP_SLOW_INTERVAL)) * TCP_SLOW_INTERVAL,
+    tcp_pcb_timer, pcb);
+}
+
+/**
+ * Restarts the timer of an active pcb after it has run. A pcb with anything
+ * in flight, an ACK or refused data pending or outside the ESTABLISHED and
+ * CLOSE-WAIT states runs every TCP_FAST_INTERVAL. Otherwise it is parked
+ * until its poll callback or next keepalive is due, or stopped if neither
+ * is set, until tcp_timer_kick() wakes it.
+ *
+ * @param pcb the tcp_pcb to schedule
+ */
+static void
+tcp_timer_schedule(struct tcp_pcb *pcb)
+{
+  u32_t ticks = 0, due, elapsed;
+
+  if ((pcb->refused_data != NULL) ||
+      (pcb->flags & (TF_ACK_DELAY | TF_ACK_NOW)) ||
+      ((pcb->state != ESTABLISHED) && (pcb->state != CLOSE_WAIT)) ||
+      (pcb->unsent != NULL) || (pcb->unacked != NULL) ||
+#if TCP_QUEUE_OOSEQ
+      (pcb->ooseq != NULL) ||
+#endif /* TCP_QUEUE_OOSEQ */
+      (pcb->persist_backoff > 0)) {
+    pcb->timer_flags |= TCP_TIMER_BUSY;
+    sys_timeout_start(&pcb->timer, TCP_FAST_INTERVAL, tcp_pcb_timer, pcb);
+    return;
+  }
+
+  pcb->timer_flags = TCP_TIMER_PARKED;
+  pcb->timer_parked = tcp_ticks;
+#if LWIP_CALLBACK_API
+  if (pcb->poll != NULL)
+#endif /* LWIP_CALLBACK_API */
+  {
+    ticks = (pcb->pollinterval > pcb->polltmr) ? (u32_t)(pcb->pollinterval - pcb->polltmr) : 1;
+  }
+  if (pcb->so_options & SOF_KEEPALIVE) {
+    elapsed = (u32_t)(tcp_ticks - pcb->tmr);
+    due = (pcb->keep_idle + pcb->keep_cnt_sent * TCP_KEEPINTVL(pcb)) / TCP_SLOW_INTERVAL + 1;
+    due = (due > elapsed) ? due - elapsed : 1;
+    if ((ticks == 0) || (due < ticks)) {
+      ticks = due;
+    }
+  }
+  if (ticks == 0) {
+    sys_timeout_stop(&pcb->timer);
+  } else {
+    sys_timeout_start(&pcb->timer, ticks * TCP_SLOW_INTERVAL, tcp_pcb_timer, pcb);
+  }
+}
+
+/**
+ * Timer of one active or TIME-WAIT pcb. Does the work of tcp_fasttmr() for
+ * the pcb on every run and that of tcp_slowtmr() on every other run.
+ *
+ * @param arg the tcp_pcb
+ */
+static void
+tcp_pcb_timer(void *arg)
+{
+  struct tcp_pcb *pcb = (struct tcp_pcb *)arg;
+  u8_t pcb_reset;
+  err_t err;
+
+  if (pcb->state == TIME_WAIT) {
+    /* Check if this PCB has stayed long enough in TIME-WAIT */
+    if ((u32_t)(tcp_ticks - pcb->tmr) > 2 * TCP_MSL / TCP_SLOW_INTERVAL) {
+      tcp_pcb_purge(pcb);
+      TCP_RMV(&tcp_tw_pcbs, pcb);
+      memp_free(MEMP_TCP_PCB, pcb);
+    } else {
+      /* the peer restarted TIME-WAIT */
+      tcp_timer_time_wait(pcb);
+    }
+    return;
+  }
+
+  LWIP_ASSERT("tcp_pcb_timer: active pcb->state != CLOSED", pcb->state != CLOSED);
+  LWIP_ASSERT("tcp_pcb_timer: active pcb->state != LISTEN", pcb->state != LISTEN);
+  tcp_timer_unpark(pcb);
+  /* tcp_output() must not kick the timer while it runs */
+  pcb->timer_flags |= TCP_TIMER_BUSY;
+
+  if (tcp_fasttmr_pcb(pcb) == ERR_ABRT) {
+    return;
+  }
+
+  if (!(pcb->timer_flags & TCP_TIMER_FAST_ONLY)) {
+    pcb->timer_flags |= TCP_TIMER_FAST_ONLY;
+    if (tcp_slowtmr_check(pcb, &pcb_reset)) {
+      tcp_pcb_purge(pcb);
+      TCP_RMV(&tcp_active_pcbs, pcb);
+
+      TCP_EVENT_ERR(pcb->errf, pcb->callback_arg, ERR_ABRT);
+      if (pcb_reset) {
+        tcp_rst(pcb->snd_nxt, pcb->rcv_nxt, &pcb->local_ip, &pcb->remote_ip,
+          pcb->local_port, pcb->remote_port);
       }
+      memp_free(MEMP_TCP_PCB, pcb);
+      return;
     }
 
-    /* send delayed ACKs */
-    if (pcb && (pcb->flags & TF_ACK_DELAY)) {
-      LWIP_DEBUGF(TCP_DEBUG, ("tcp_fasttmr: delayed ACK\n"));
-      tcp_ack_now(pcb);
-      tcp_output(pcb);
-      pcb->flags &= ~(TF_ACK_DELAY | TF_ACK_NOW);
+    /* We check if we should poll the connection. */
+    ++pcb->polltmr;
+    if (pcb->polltmr >= pcb->pollinterval) {
+      pcb->polltmr = 0;
+      LWIP_DEBUGF(TCP_DEBUG, ("tcp_pcb_timer: polling application\n"));
+      TCP_EVENT_POLL(pcb, err);
+      /* if err == ERR_ABRT, 'pcb' is already deallocated */
+      if (err == ERR_ABRT) {
+        return;
+      }
+      if (err == ERR_OK) {
+        tcp_output(pcb);
+      }
     }
+  } else {
+    pcb->timer_flags &= ~TCP_TIMER_FAST_ONLY;
+  }
 
-    pcb = next;
+  tcp_timer_schedule(pcb);
+}
+
+/**
+ * Wakes the timer of an idle pcb so it runs every TCP_FAST_INTERVAL again.
+ * Called through TCP_TIMER_KICK whenever a pcb may have been given work,
+ * e.g. from tcp_output(). Does nothing for pcbs that are not active.
+ *
+ * @param pcb the tcp_pcb to wake
+ */
+void
+tcp_timer_kick(struct tcp_pcb *pcb)
+{
+  if ((pcb->state == CLOSED) || (pcb->state == LISTEN) ||
+      (pcb->state == TIME_WAIT) || (pcb->timer_flags & TCP_TIMER_BUSY)) {
+    return;
   }
+  tcp_timer_unpark(pcb);
+  pcb->timer_flags |= TCP_TIMER_BUSY;
+  sys_timeout_start(&pcb->timer, TCP_FAST_INTERVAL, tcp_pcb_timer, pcb);
 }
 
+/**
+ * Starts the timer of a PCB that has just been registered with a PCB list.
+ * Called from TCP_REG.
+ *
+ * @param pcbs the PCB list the PCB was added to
+ * @param pcb the PCB to start the timer of
+ */
+void
+tcp_pcb_timer_reg(struct tcp_pcb **pcbs, struct tcp_pcb *pcb)
+{
+  if (pcbs == &tcp_active_pcbs) {
+    tcp_timer_kick(pcb);
+  } else if (pcbs == &tcp_tw_pcbs) {
+    tcp_timer_time_wait(pcb);
+  }
+}
+
+/**
+ * Stops the timer of a PCB that has just been removed from a PCB list.
+ * Called from TCP_RMV.
+ *
+ * @param pcbs the PCB list the PCB was removed from
+ * @param pcb the PCB to stop the timer of
+ */
+void
+tcp_pcb_timer_rmv(struct tcp_pcb **pcbs, struct tcp_pcb *pcb)
+{
+  if ((pcbs == &tcp_active_pcbs) || (pcbs == &tcp_tw_pcbs)) {
+    sys_timeout_stop(&pcb->timer);
+    pcb->timer_flags = 0;
+  }
+}
+#endif /* LWIP_TCP_PCB_TIMERS */
+
 /**
  * Deallocates a list of TCP segments (tcp_seg structures).
  *
@@ -1351,6 +1637,9 @@ tcp_poll(struct tcp_pcb *pcb, tcp_poll_fn poll, u8_t interval)
   LWIP_UNUSED_ARG(poll);
 #endif /* LWIP_CALLBACK_API */  
   pcb->pollinterval = interval;
+#if LWIP_TCP_PCB_TIMERS
+  tcp_timer_kick(pcb);
+#endif /* LWIP_TCP_PCB_TIMERS */
 }
 
 /**
@@ -1451,10 +1740,162 @@ tcp_pcb_remove(struct tcp_pcb **pcblist, struct tcp_pcb *pcb)
   }
 
   pcb->state = CLOSED;
+  /* sending the delayed ACK above may have kicked the timer again */
+  TCP_TIMER_RMV(pcblist, pcb);
 
   LWIP_ASSERT("tcp_pcb_remove: tcp_pcbs_sane()", tcp_pcbs_sane());
 }
 
+#if LWIP_TCP_PCB_HASH
+/**
+ * Calculates the connection hash table bucket for a 4-tuple.
+ */
+static u16_t
+tcp_conn_hash_index(ip_addr_t *local_ip, u16_t local_port,
+                    ip_addr_t *remote_ip, u16_t remote_port)
+{
+  u32_t hash;
+
+  hash = ip4_addr_get_u32(local_ip) ^ ip4_addr_get_u32(remote_ip) ^
+         (((u32_t)local_port << 16) | remote_port);
+  /* Mix the high bits into the low bits that select the bucket. */
+  hash ^= hash >> 16;
+  hash *= 0x9e3779b1UL;
+  hash ^= hash >> 16;
+  return (u16_t)(hash & (TCP_PCB_HASH_SIZE - 1));
+}
+
+/**
+ * Adds a PCB to the hash table that matches the list it has just been
+ * registered with. Called from TCP_REG.
+ *
+ * @param pcbs the PCB list the PCB was added to
+ * @param pcb the PCB to hash
+ */
+void
+tcp_pcb_hash_add(struct tcp_pcb **pcbs, struct tcp_pcb *pcb)
+{
+  u16_t index;
+
+  if ((pcbs == &tcp_active_pcbs) || (pcbs == &tcp_tw_pcbs)) {
+    index = tcp_conn_hash_index(&pcb->local_ip, pcb->local_port,
+                                &pcb->remote_ip, pcb->remote_port);
+    pcb->hash_next = tcp_conn_hash[index];
+    tcp_conn_hash[index] = pcb;
+  } else if (pcbs == &tcp_listen_pcbs.pcbs) {
+    struct tcp_pcb_listen *lpcb = (struct tcp_pcb_listen *)pcb;
+
+    index = TCP_LISTEN_HASH_INDEX(lpcb->local_port);
+    lpcb->hash_next = tcp_listen_hash[index];
+    tcp_listen_hash[index] = lpcb;
+  }
+}
+
+/**
+ * Removes a PCB from the hash table that matches the list it has just been
+ * removed from. Called from TCP_RMV. Nothing is done if the PCB is not in
+ * the table.
+ *
+ * @param pcbs the PCB list the PCB was removed from
+ * @param pcb the PCB to remove
+ */
+void
+tcp_pcb_hash_remove(struct tcp_pcb **pcbs, struct tcp_pcb *pcb)
+{
+  if ((pcbs == &tcp_active_pcbs) || (pcbs == &tcp_tw_pcbs)) {
+    struct tcp_pcb **link;
+
+    link = &tcp_conn_hash[tcp_conn_hash_index(&pcb->local_ip, pcb->local_port,
+                                              &pcb->remote_ip, pcb->remote_port)];
+    for (; *link != NULL; link = &(*link)->hash_next) {
+      if (*link == pcb) {
+        *link = pcb->hash_next;
+        break;
+      }
+    }
+    pcb->hash_next = NULL;
+  } else if (pcbs == &tcp_listen_pcbs.pcbs) {
+    struct tcp_pcb_listen *lpcb = (struct tcp_pcb_listen *)pcb;
+    struct tcp_pcb_listen **link;
+
+    link = &tcp_listen_hash[TCP_LISTEN_HASH_INDEX(lpcb->local_port)];
+    for (; *link != NULL; link = &(*link)->hash_next) {
+      if (*link == lpcb) {
+        *link = lpcb->hash_next;
+        break;
+      }
+    }
+    lpcb->hash_next = NULL;
+  }
+}
+
+/**
+ * Finds the active or TIME-WAIT PCB for a 4-tuple.
+ *
+ * @return the matching PCB or NULL if there is none
+ */
+struct tcp_pcb *
+tcp_conn_hash_lookup(ip_addr_t *local_ip, u16_t local_port,
+                     ip_addr_t *remote_ip, u16_t remote_port)
+{
+  struct tcp_pcb *pcb;
+
+  pcb = tcp_conn_hash[tcp_conn_hash_index(local_ip, local_port, remote_ip, remote_port)];
+  for (; pcb != NULL; pcb = pcb->hash_next) {
+    if ((pcb->remote_port == remote_port) &&
+        (pcb->local_port == local_port) &&
+        ip_addr_cmp(&(pcb->remote_ip), remote_ip) &&
+        ip_addr_cmp(&(pcb->local_ip), local_ip)) {
+      break;
+    }
+  }
+  return pcb;
+}
+
+/**
+ * Finds the listening PCB that accepts connections to a local address and
+ * port. A PCB bound to the address itself is preferred over one bound to
+ * IP_ADDR_ANY, as in the list walk done without the hash.
+ *
+ * @return the matching listening PCB or NULL if there is none
+ */
+struct tcp_pcb_listen *
+tcp_listen_hash_lookup(ip_addr_t *local_ip, u16_t local_port)
+{
+  struct tcp_pcb_listen *lpcb;
+#if SO_REUSE
+  struct tcp_pcb_listen *lpcb_any = NULL;
+#endif /* SO_REUSE */
+
+  for (lpcb = tcp_listen_hash[TCP_LISTEN_HASH_INDEX(local_port)];
+       lpcb != NULL; lpcb = lpcb->hash_next) {
+    if (lpcb->local_port == local_port) {
+#if SO_REUSE
+      if (ip_addr_cmp(&(lpcb->local_ip), local_ip)) {
+        /* found an exact match */
+        return lpcb;
+      } else if (ip_addr_isany(&(lpcb->local_ip))) {
+        /* found an ANY-match */
+        lpcb_any = lpcb;
+      }
+#else /* SO_REUSE */
+      if (ip_addr_cmp(&(lpcb->local_ip), local_ip) ||
+          ip_addr_isany(&(lpcb->local_ip))) {
+        /* found a match */
+        return lpcb;
+      }
+#endif /* SO_REUSE */
+    }
+  }
+#if SO_REUSE
+  /* only pass to ANY if no specific local IP has been found */
+  return lpcb_any;
+#else /* SO_REUSE */
+  return NULL;
+#endif /* SO_REUSE */
+}
+#endif /* LWIP_TCP_PCB_HASH */
+
 /**
  * Calculates a new initial sequence number for new connections.
  *
@@ -91,12 +91,15 @@ static err_t tcp_timewait_input(struct tcp_pcb *pcb);
 void
 tcp_input(struct pbuf *p, struct netif *inp)
 {
-  struct tcp_pcb *pcb, *prev;
+  struct tcp_pcb *pcb;
   struct tcp_pcb_listen *lpcb;
+#if !LWIP_TCP_PCB_HASH
+  struct tcp_pcb *prev;
 #if SO_REUSE
   struct tcp_pcb *lpcb_prev = NULL;
   struct tcp_pcb_listen *lpcb_any = NULL;
 #endif /* SO_REUSE */
+#endif /* !LWIP_TCP_PCB_HASH */
   u8_t hdrlen;
   err_t err;
 
@@ -174,6 +177,32 @@ tcp_input(struct pbuf *p, struct netif *inp)
   flags = TCPH_FLAGS(tcphdr);
   tcplen = p->tot_len + ((flags & (TCP_FIN | TCP_SYN)) ? 1 : 0);
 
+#if LWIP_TCP_PCB_HASH
+  /* Demultiplex an incoming segment. A single hash lookup finds the
+     connection, whether it is active or in TIME-WAIT. */
+  pcb = tcp_conn_hash_lookup(&current_iphdr_dest, tcphdr->dest,
+                             &current_iphdr_src, tcphdr->src);
+  if (pcb != NULL) {
+    LWIP_ASSERT("tcp_input: connection pcb->state != CLOSED", pcb->state != CLOSED);
+    LWIP_ASSERT("tcp_input: connection pcb->state != LISTEN", pcb->state != LISTEN);
+    if (pcb->state == TIME_WAIT) {
+      LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_input: packed for TIME_WAITing connection.\n"));
+      tcp_timewait_input(pcb);
+      pbuf_free(p);
+      return;
+    }
+  } else {
+    /* If it did not go to a connection, we check the PCBs that are
+       LISTENing for incoming connections. */
+    lpcb = tcp_listen_hash_lookup(&current_iphdr_dest, tcphdr->dest);
+    if (lpcb != NULL) {
+      LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_input: packed for LISTENing connection.\n"));
+      tcp_listen_input(lpcb);
+      pbuf_free(p);
+      return;
+    }
+  }
+#else /* LWIP_TCP_PCB_HASH */
   /* Demultiplex an incoming segment. First, we check if it is destined
      for an active connection. */
   prev = NULL;
@@ -272,6 +301,7 @@ tcp_input(struct pbuf *p, struct netif *inp)
       return;
     }
   }
+#endif /* LWIP_TCP_PCB_HASH */
 
 #if TCP_INPUT_DEBUG
   LWIP_DEBUGF(TCP_INPUT_DEBUG, ("+-+-+-+-+-+-+-+-+-+-+-+-+-+- tcp_input: flags "));
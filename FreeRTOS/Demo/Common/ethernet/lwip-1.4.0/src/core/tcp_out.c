@@ -381,6 +381,8 @@ tcp_write(struct tcp_pcb *pcb, const void *arg, u16_t len, u8_t apiflags)
   if (err != ERR_OK) {
     return err;
   }
+  /* the segments queued below need the timer even if not sent yet */
+  TCP_TIMER_KICK(pcb);
   queuelen = pcb->snd_queuelen;
 
 #if LWIP_TCP_TIMESTAMPS
@@ -897,6 +899,10 @@ tcp_output(struct tcp_pcb *pcb)
   s16_t i = 0;
 #endif /* TCP_CWND_DEBUG */
 
+  /* An idle pcb is about to have something in flight (or an ACK or
+     data to process if called from tcp_input), so it needs its timer. */
+  TCP_TIMER_KICK(pcb);
+
   /* First, check if we are invoked by the TCP input processing
      code. If so, we do not output anything. Instead, we rely on the
      input processing code to call us when input processing is done
@@ -68,6 +68,145 @@
 /* exported in udp.h (was static) */
 struct udp_pcb *udp_pcbs;
 
+#if LWIP_UDP_PCB_HASH
+/* The PCBs in udp_pcbs, hashed on the local port and chained through
+   hash_next. */
+static struct udp_pcb *udp_port_hash[UDP_PCB_HASH_SIZE];
+/* The connected PCBs in udp_pcbs that have a remote IP address, hashed on
+   the local port and the remote address and port and chained through
+   conn_next. */
+static struct udp_pcb *udp_conn_hash[UDP_PCB_HASH_SIZE];
+
+#define UDP_PORT_HASH_INDEX(port) \
+  ((u16_t)((port) ^ ((port) >> 8)) & (UDP_PCB_HASH_SIZE - 1))
+
+/**
+ * Calculates the udp_conn_hash bucket for a local port and remote address
+ * and port.
+ */
+static u16_t
+udp_conn_hash_index(u16_t local_port, ip_addr_t *remote_ip, u16_t remote_port)
+{
+  u32_t hash;
+
+  hash = ip4_addr_get_u32(remote_ip) ^ (((u32_t)local_port << 16) | remote_port);
+  /* Mix the high bits into the low bits that select the bucket. */
+  hash ^= hash >> 16;
+  hash *= 0x9e3779b1UL;
+  hash ^= hash >> 16;
+  return (u16_t)(hash & (UDP_PCB_HASH_SIZE - 1));
+}
+
+/**
+ * Checks whether a PCB is in udp_pcbs by looking in the bucket of its
+ * local port.
+ */
+static u8_t
+udp_port_hash_contains(struct udp_pcb *pcb)
+{
+  struct udp_pcb *ipcb;
+
+  for (ipcb = udp_port_hash[UDP_PORT_HASH_INDEX(pcb->local_port)];
+       ipcb != NULL; ipcb = ipcb->hash_next) {
+    if (ipcb == pcb) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/** Adds a PCB to udp_port_hash. Must be called after it is added to udp_pcbs. */
+static void
+udp_port_hash_add(struct udp_pcb *pcb)
+{
+  u16_t index = UDP_PORT_HASH_INDEX(pcb->local_port);
+
+  pcb->hash_next = udp_port_hash[index];
+  udp_port_hash[index] = pcb;
+}
+
+/** Removes a PCB from udp_port_hash, if it is there. */
+static void
+udp_port_hash_remove(struct udp_pcb *pcb)
+{
+  struct udp_pcb **link;
+
+  for (link = &udp_port_hash[UDP_PORT_HASH_INDEX(pcb->local_port)];
+       *link != NULL; link = &(*link)->hash_next) {
+    if (*link == pcb) {
+      *link = pcb->hash_next;
+      break;
+    }
+  }
+  pcb->hash_next = NULL;
+}
+
+/** Adds a PCB to udp_conn_hash if it is connected to a remote IP address. */
+static void
+udp_conn_hash_add(struct udp_pcb *pcb)
+{
+  u16_t index;
+
+  if (((pcb->flags & UDP_FLAGS_CONNECTED) != 0) && !ip_addr_isany(&pcb->remote_ip)) {
+    index = udp_conn_hash_index(pcb->local_port, &pcb->remote_ip, pcb->remote_port);
+    pcb->conn_next = udp_conn_hash[index];
+    udp_conn_hash[index] = pcb;
+  }
+}
+
+/**
+ * Removes a PCB from udp_conn_hash, if it is there. Must be called before
+ * the local port or the remote address or port of the PCB change.
+ */
+static void
+udp_conn_hash_remove(struct udp_pcb *pcb)
+{
+  struct udp_pcb **link;
+
+  if (!ip_addr_isany(&pcb->remote_ip)) {
+    for (link = &udp_conn_hash[udp_conn_hash_index(pcb->local_port, &pcb->remote_ip,
+                                                   pcb->remote_port)];
+         *link != NULL; link = &(*link)->conn_next) {
+      if (*link == pcb) {
+        *link = pcb->conn_next;
+        break;
+      }
+    }
+  }
+  pcb->conn_next = NULL;
+}
+
+/**
+ * Finds the connected PCB that exactly matches a unicast datagram.
+ *
+ * @return the matching PCB or NULL if there is none
+ */
+static struct udp_pcb *
+udp_conn_hash_lookup(u16_t local_port, ip_addr_t *local_ip,
+                     u16_t remote_port, ip_addr_t *remote_ip)
+{
+  struct udp_pcb *pcb;
+
+  for (pcb = udp_conn_hash[udp_conn_hash_index(local_port, remote_ip, remote_port)];
+       pcb != NULL; pcb = pcb->conn_next) {
+    if ((pcb->local_port == local_port) &&
+        (pcb->remote_port == remote_port) &&
+        ip_addr_cmp(&(pcb->remote_ip), remote_ip) &&
+        (ip_addr_isany(&pcb->local_ip) || ip_addr_cmp(&(pcb->local_ip), local_ip))) {
+      break;
+    }
+  }
+  return pcb;
+}
+
+/* Walk only the PCBs that could be bound to the port. */
+#define UDP_PCBS_FOR_PORT(port)  udp_port_hash[UDP_PORT_HASH_INDEX(port)]
+#define UDP_PCBS_NEXT(pcb)       ((pcb)->hash_next)
+#else /* LWIP_UDP_PCB_HASH */
+#define UDP_PCBS_FOR_PORT(port)  udp_pcbs
+#define UDP_PCBS_NEXT(pcb)       ((pcb)->next)
+#endif /* LWIP_UDP_PCB_HASH */
+
 /**
  * Process an incoming UDP datagram.
  *
@@ -84,7 +223,10 @@ void
 udp_input(struct pbuf *p, struct netif *inp)
 {
   struct udp_hdr *udphdr;
-  struct udp_pcb *pcb, *prev;
+  struct udp_pcb *pcb;
+#if !LWIP_UDP_PCB_HASH
+  struct udp_pcb *prev;
+#endif /* !LWIP_UDP_PCB_HASH */
   struct udp_pcb *uncon_pcb;
   struct ip_hdr *iphdr;
   u16_t src, dest;
@@ -151,15 +293,24 @@ udp_input(struct pbuf *p, struct netif *inp)
     }
   } else
 #endif /* LWIP_DHCP */
+#if LWIP_UDP_PCB_HASH
+  /* A unicast datagram for a connected pcb is matched by one lookup. */
+  if (!broadcast && !ip_addr_ismulticast(&current_iphdr_dest) &&
+      ((pcb = udp_conn_hash_lookup(dest, &current_iphdr_dest, src, &current_iphdr_src)) != NULL)) {
+    UDP_STATS_INC(udp.cachehit);
+  } else
+#endif /* LWIP_UDP_PCB_HASH */
   {
+#if !LWIP_UDP_PCB_HASH
     prev = NULL;
+#endif /* !LWIP_UDP_PCB_HASH */
     local_match = 0;
     uncon_pcb = NULL;
     /* Iterate through the UDP pcb list for a matching pcb.
      * 'Perfect match' pcbs (connected to the remote port & ip address) are
      * preferred. If no perfect match is found, the first unconnected pcb that
      * matches the local port and ip address gets the datagram. */
-    for (pcb = udp_pcbs; pcb != NULL; pcb = pcb->next) {
+    for (pcb = UDP_PCBS_FOR_PORT(dest); pcb != NULL; pcb = UDP_PCBS_NEXT(pcb)) {
       local_match = 0;
       /* print the PCB local and remote address */
       LWIP_DEBUGF(UDP_DEBUG,
@@ -195,6 +346,7 @@ udp_input(struct pbuf *p, struct netif *inp)
           (ip_addr_isany(&pcb->remote_ip) ||
            ip_addr_cmp(&(pcb->remote_ip), &current_iphdr_src))) {
         /* the first fully matching PCB */
+#if !LWIP_UDP_PCB_HASH
         if (prev != NULL) {
           /* move the pcb to the front of udp_pcbs so that is
              found faster next time */
@@ -204,9 +356,12 @@ udp_input(struct pbuf *p, struct netif *inp)
         } else {
           UDP_STATS_INC(udp.cachehit);
         }
+#endif /* !LWIP_UDP_PCB_HASH */
         break;
       }
+#if !LWIP_UDP_PCB_HASH
       prev = pcb;
+#endif /* !LWIP_UDP_PCB_HASH */
     }
     /* no fully matching pcb found? then look for an unconnected pcb */
     if (pcb == NULL) {
@@ -283,7 +438,7 @@ udp_input(struct pbuf *p, struct netif *inp)
            if SOF_REUSEADDR is set on the first match */
         struct udp_pcb *mpcb;
         u8_t p_header_changed = 0;
-        for (mpcb = udp_pcbs; mpcb != NULL; mpcb = mpcb->next) {
+        for (mpcb = UDP_PCBS_FOR_PORT(dest); mpcb != NULL; mpcb = UDP_PCBS_NEXT(mpcb)) {
           if (mpcb != pcb) {
             /* compare PCB local addr+port to UDP destination addr+port */
             if ((mpcb->local_port == dest) &&
@@ -678,6 +833,44 @@ udp_sendto_if_chksum(struct udp_pcb *pcb, struct pbuf *p, ip_addr_t *dst_ip,
   return err;
 }
 
+#if LWIP_UDP_PCB_HASH
+/**
+ * Allocate a new local UDP port. Ports are handed out in turn, and only the
+ * hash bucket of each candidate is checked, so this takes constant time
+ * unless almost the whole range is in use.
+ *
+ * @return a new (free) local UDP port number, or 0 if there is none
+ */
+static u16_t
+udp_new_port(void)
+{
+  u16_t n = 0;
+  struct udp_pcb *pcb;
+#ifndef UDP_LOCAL_PORT_RANGE_START
+/* From http://www.iana.org/assignments/port-numbers:
+   "The Dynamic and/or Private Ports are those from 49152 through 65535" */
+#define UDP_LOCAL_PORT_RANGE_START  0xc000
+#define UDP_LOCAL_PORT_RANGE_END    0xffff
+#endif
+  static u16_t port = UDP_LOCAL_PORT_RANGE_START;
+
+ again:
+  if (port++ >= UDP_LOCAL_PORT_RANGE_END) {
+    port = UDP_LOCAL_PORT_RANGE_START;
+  }
+  for (pcb = UDP_PCBS_FOR_PORT(port); pcb != NULL; pcb = UDP_PCBS_NEXT(pcb)) {
+    if (pcb->local_port == port) {
+      if (++n > (UDP_LOCAL_PORT_RANGE_END - UDP_LOCAL_PORT_RANGE_START)) {
+        /* every port in the range is in use */
+        return 0;
+      }
+      goto again;
+    }
+  }
+  return port;
+}
+#endif /* LWIP_UDP_PCB_HASH */
+
 /**
  * Bind an UDP PCB.
  *
@@ -708,6 +901,18 @@ udp_bind(struct udp_pcb *pcb, ip_addr_t *ipaddr, u16_t port)
   LWIP_DEBUGF(UDP_DEBUG | LWIP_DBG_TRACE, (", port = %"U16_F")\n", port));
 
   rebind = 0;
+#if LWIP_UDP_PCB_HASH
+  /* pcb already in list? then just rebind */
+  rebind = udp_port_hash_contains(pcb);
+  /* Only the pcbs hashed with the port can be bound to it. A port of 0 is
+     replaced by a free one below. */
+  for (ipcb = (port != 0) ? UDP_PCBS_FOR_PORT(port) : NULL;
+       ipcb != NULL; ipcb = UDP_PCBS_NEXT(ipcb)) {
+    if (pcb == ipcb) {
+      /* already counted as a rebind */
+      continue;
+    }
+#else /* LWIP_UDP_PCB_HASH */
   /* Check for double bind and rebind of the same pcb */
   for (ipcb = udp_pcbs; ipcb != NULL; ipcb = ipcb->next) {
     /* is this UDP PCB already on active list? */
@@ -716,17 +921,19 @@ udp_bind(struct udp_pcb *pcb, ip_addr_t *ipaddr, u16_t port)
       LWIP_ASSERT("rebind == 0", rebind == 0);
       /* pcb already in list, just rebind */
       rebind = 1;
+      continue;
     }
+#endif /* LWIP_UDP_PCB_HASH */
 
     /* By default, we don't allow to bind to a port that any other udp
        PCB is alread bound to, unless *all* PCBs with that port have tha
        REUSEADDR flag set. */
 #if SO_REUSE
-    else if (((pcb->so_options & SOF_REUSEADDR) == 0) &&
-             ((ipcb->so_options & SOF_REUSEADDR) == 0)) {
+    if (((pcb->so_options & SOF_REUSEADDR) == 0) &&
+        ((ipcb->so_options & SOF_REUSEADDR) == 0)) {
 #else /* SO_REUSE */
     /* port matches that of PCB in list and REUSEADDR not set -> reject */
-    else {
+    {
 #endif /* SO_REUSE */
       if ((ipcb->local_port == port) &&
           /* IP address matches, or one is IP_ADDR_ANY? */
@@ -745,6 +952,14 @@ udp_bind(struct udp_pcb *pcb, ip_addr_t *ipaddr, u16_t port)
 
   /* no port specified? */
   if (port == 0) {
+#if LWIP_UDP_PCB_HASH
+    port = udp_new_port();
+    if (port == 0) {
+      /* no more ports available in local range */
+      LWIP_DEBUGF(UDP_DEBUG, ("udp_bind: out of free UDP ports\n"));
+      return ERR_USE;
+    }
+#else /* LWIP_UDP_PCB_HASH */
 #ifndef UDP_LOCAL_PORT_RANGE_START
 /* From http://www.iana.org/assignments/port-numbers:
    "The Dynamic and/or Private Ports are those from 49152 through 65535" */
@@ -769,7 +984,15 @@ udp_bind(struct udp_pcb *pcb, ip_addr_t *ipaddr, u16_t port)
       LWIP_DEBUGF(UDP_DEBUG, ("udp_bind: out of free UDP ports\n"));
       return ERR_USE;
     }
+#endif /* LWIP_UDP_PCB_HASH */
+  }
+#if LWIP_UDP_PCB_HASH
+  if (rebind != 0) {
+    /* the hash buckets depend on the port */
+    udp_port_hash_remove(pcb);
+    udp_conn_hash_remove(pcb);
   }
+#endif /* LWIP_UDP_PCB_HASH */
   pcb->local_port = port;
   snmp_insert_udpidx_tree(pcb);
   /* pcb not active yet? */
@@ -778,6 +1001,10 @@ udp_bind(struct udp_pcb *pcb, ip_addr_t *ipaddr, u16_t port)
     pcb->next = udp_pcbs;
     udp_pcbs = pcb;
   }
+#if LWIP_UDP_PCB_HASH
+  udp_port_hash_add(pcb);
+  udp_conn_hash_add(pcb);
+#endif /* LWIP_UDP_PCB_HASH */
   LWIP_DEBUGF(UDP_DEBUG | LWIP_DBG_TRACE | LWIP_DBG_STATE,
               ("udp_bind: bound to %"U16_F".%"U16_F".%"U16_F".%"U16_F", port %"U16_F"\n",
                ip4_addr1_16(&pcb->local_ip), ip4_addr2_16(&pcb->local_ip),
@@ -805,7 +1032,9 @@ udp_bind(struct udp_pcb *pcb, ip_addr_t *ipaddr, u16_t port)
 err_t
 udp_connect(struct udp_pcb *pcb, ip_addr_t *ipaddr, u16_t port)
 {
+#if !LWIP_UDP_PCB_HASH
   struct udp_pcb *ipcb;
+#endif /* !LWIP_UDP_PCB_HASH */
 
   if (pcb->local_port == 0) {
     err_t err = udp_bind(pcb, &pcb->local_ip, pcb->local_port);
@@ -814,6 +1043,10 @@ udp_connect(struct udp_pcb *pcb, ip_addr_t *ipaddr, u16_t port)
     }
   }
 
+#if LWIP_UDP_PCB_HASH
+  /* the connection hash bucket depends on the remote address and port */
+  udp_conn_hash_remove(pcb);
+#endif /* LWIP_UDP_PCB_HASH */
   ip_addr_set(&pcb->remote_ip, ipaddr);
   pcb->remote_port = port;
   pcb->flags |= UDP_FLAGS_CONNECTED;
@@ -843,6 +1076,15 @@ udp_connect(struct udp_pcb *pcb, ip_addr_t *ipaddr, u16_t port)
                pcb->local_port));
 
   /* Insert UDP PCB into the list of active UDP PCBs. */
+#if LWIP_UDP_PCB_HASH
+  if (!udp_port_hash_contains(pcb)) {
+    /* PCB not yet on the list, add PCB now */
+    pcb->next = udp_pcbs;
+    udp_pcbs = pcb;
+    udp_port_hash_add(pcb);
+  }
+  udp_conn_hash_add(pcb);
+#else /* LWIP_UDP_PCB_HASH */
   for (ipcb = udp_pcbs; ipcb != NULL; ipcb = ipcb->next) {
     if (pcb == ipcb) {
       /* already on the list, just return */
@@ -852,6 +1094,7 @@ udp_connect(struct udp_pcb *pcb, ip_addr_t *ipaddr, u16_t port)
   /* PCB not yet on the list, add PCB now */
   pcb->next = udp_pcbs;
   udp_pcbs = pcb;
+#endif /* LWIP_UDP_PCB_HASH */
   return ERR_OK;
 }
 
@@ -863,6 +1106,9 @@ udp_connect(struct udp_pcb *pcb, ip_addr_t *ipaddr, u16_t port)
 void
 udp_disconnect(struct udp_pcb *pcb)
 {
+#if LWIP_UDP_PCB_HASH
+  udp_conn_hash_remove(pcb);
+#endif /* LWIP_UDP_PCB_HASH */
   /* reset remote address association */
   ip_addr_set_any(&pcb->remote_ip);
   pcb->remote_port = 0;
@@ -901,6 +1147,10 @@ udp_remove(struct udp_pcb *pcb)
   struct udp_pcb *pcb2;
 
   snmp_delete_udpidx_tree(pcb);
+#if LWIP_UDP_PCB_HASH
+  udp_port_hash_remove(pcb);
+  udp_conn_hash_remove(pcb);
+#endif /* LWIP_UDP_PCB_HASH */
   /* pcb to be removed is first in list? */
   if (udp_pcbs == pcb) {
     /* make list start at 2nd pcb */
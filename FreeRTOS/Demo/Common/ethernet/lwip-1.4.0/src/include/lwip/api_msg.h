@@ -151,6 +151,9 @@ void do_listen          ( struct api_msg_msg *msg);
 void do_send            ( struct api_msg_msg *msg);
 void do_recv            ( struct api_msg_msg *msg);
 void do_write           ( struct api_msg_msg *msg);
+#if LWIP_TCP && LWIP_TCPIP_CORE_LOCKING
+err_t do_write_inline   ( struct netconn *conn, const void *dataptr, u16_t len, u8_t apiflags);
+#endif /* LWIP_TCP && LWIP_TCPIP_CORE_LOCKING */
 void do_getaddr         ( struct api_msg_msg *msg);
 void do_close           ( struct api_msg_msg *msg);
 void do_shutdown        ( struct api_msg_msg *msg);
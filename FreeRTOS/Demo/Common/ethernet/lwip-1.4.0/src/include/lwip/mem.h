@@ -86,6 +86,21 @@ typedef u16_t mem_size_t;
 /* lwIP alternative malloc */
 void  mem_init(void);
 void *mem_trim(void *mem, mem_size_t size);
+
+#if MEM_STATS
+/** A snapshot of the heap, filled in by mem_heap_stats() */
+struct mem_heap_stats {
+  /** free bytes in total */
+  mem_size_t free;
+  /** the largest mem_malloc() that would succeed now */
+  mem_size_t largest_free;
+  /** the number of free blocks */
+  mem_size_t free_blocks;
+  /** the most blocks one mem_malloc() call has looked at */
+  mem_size_t max_search;
+};
+void  mem_heap_stats(struct mem_heap_stats *stats);
+#endif /* MEM_STATS */
 #endif /* MEM_USE_POOLS */
 void *mem_malloc(mem_size_t size);
 void *mem_calloc(mem_size_t count, mem_size_t size);
@@ -61,6 +61,9 @@ LWIP_MEMPOOL(TCPIP_MSG_API,  MEMP_NUM_TCPIP_MSG_API,   sizeof(struct tcpip_msg),
 #if !LWIP_TCPIP_CORE_LOCKING_INPUT
 LWIP_MEMPOOL(TCPIP_MSG_INPKT,MEMP_NUM_TCPIP_MSG_INPKT, sizeof(struct tcpip_msg),      "TCPIP_MSG_INPKT")
 #endif /* !LWIP_TCPIP_CORE_LOCKING_INPUT */
+#if LWIP_TCPIP_INPUT_BATCH
+LWIP_MEMPOOL(TCPIP_INPUT_BATCH, MEMP_NUM_TCPIP_INPUT_BATCH, sizeof(struct tcpip_input_batch), "TCPIP_INPUT_BATCH")
+#endif /* LWIP_TCPIP_INPUT_BATCH */
 #endif /* NO_SYS==0 */
 
 #if ARP_QUEUEING
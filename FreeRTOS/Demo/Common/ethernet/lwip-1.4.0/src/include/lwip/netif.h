@@ -215,6 +215,11 @@ struct netif {
 #if LWIP_NETIF_HWADDRHINT
   u8_t *addr_hint;
 #endif /* LWIP_NETIF_HWADDRHINT */
+#if LWIP_ARP && LWIP_ARP_HASH
+  /** ARP table entries last used to send on this netif, indexed by a hash
+      of the destination address (ARP_TABLE_SIZE if unused) */
+  u16_t arp_hint[ETHARP_NETIF_HINTS];
+#endif /* LWIP_ARP && LWIP_ARP_HASH */
 #if ENABLE_LOOPBACK
   /* List of packets to be queued for ourselves. */
   struct pbuf *loop_first;
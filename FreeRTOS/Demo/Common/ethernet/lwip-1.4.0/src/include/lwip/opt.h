@@ -76,6 +76,45 @@
 #define NO_SYS_NO_TIMERS                0
 #endif
 
+/**
+ * LWIP_TIMERS_WHEEL==1: Keep sys_timeout() timeouts in a hashed timing wheel
+ * instead of a sorted list. Adding and removing a timeout then takes constant
+ * time however many are pending, where the list is walked each time. Also
+ * provides sys_timeout_start()/sys_timeout_stop() for timeouts embedded in
+ * other structures, which LWIP_TCP_PCB_TIMERS uses.
+ */
+#ifndef LWIP_TIMERS_WHEEL
+#define LWIP_TIMERS_WHEEL               0
+#endif
+
+/**
+ * SYS_TIMEOUT_WHEEL_SIZE: Number of slots in the timing wheel used when
+ * LWIP_TIMERS_WHEEL==1. Must be a power of 2. Timeouts further away than
+ * SYS_TIMEOUT_WHEEL_SIZE * SYS_TIMEOUT_WHEEL_TICK milliseconds share slots
+ * with nearer ones and are passed over until they are due.
+ */
+#ifndef SYS_TIMEOUT_WHEEL_SIZE
+#define SYS_TIMEOUT_WHEEL_SIZE          256
+#endif
+
+/**
+ * SYS_TIMEOUT_WHEEL_TICK: Time in milliseconds covered by one slot of the
+ * timing wheel. Must be a power of 2. Timeouts still expire to the
+ * millisecond, this only sets how many of them share a slot.
+ */
+#ifndef SYS_TIMEOUT_WHEEL_TICK
+#define SYS_TIMEOUT_WHEEL_TICK          16
+#endif
+
+/**
+ * SYS_TIMEOUT_HASH_SIZE: Number of buckets in the table sys_untimeout() finds
+ * timeouts in when LWIP_TIMERS_WHEEL==1. Must be a power of 2; a quarter of
+ * MEMP_NUM_SYS_TIMEOUT or more keeps the buckets short.
+ */
+#ifndef SYS_TIMEOUT_HASH_SIZE
+#define SYS_TIMEOUT_HASH_SIZE           16
+#endif
+
 /**
  * MEMCPY: override this if you have a faster implementation at hand than the
  * one included in your C library
@@ -132,6 +171,26 @@
 #define MEM_SIZE                        1600
 #endif
 
+/**
+ * MEM_TLSF==1: manage the heap with a two-level segregated fit allocator
+ * instead of a first-fit walk. Free blocks are kept in lists by size class
+ * and found through two levels of bitmaps, so mem_malloc() and mem_free()
+ * take the same time however fragmented the heap is. Not used with
+ * MEM_LIBC_MALLOC or MEM_USE_POOLS.
+ */
+#ifndef MEM_TLSF
+#define MEM_TLSF                        0
+#endif
+
+/**
+ * MEM_TLSF_SL_LOG2: with MEM_TLSF, log2 of the number of size classes
+ * between two powers of 2 (1 to 5). More classes let mem_malloc() pick
+ * blocks closer to the size asked for, and cost a list head each.
+ */
+#ifndef MEM_TLSF_SL_LOG2
+#define MEM_TLSF_SL_LOG2                3
+#endif
+
 /**
  * MEMP_SEPARATE_POOLS: if defined to 1, each pool is placed in its own array.
  * This can be used to individually change the location of each pool.
@@ -162,6 +221,36 @@
 #define MEMP_SANITY_CHECK               0
 #endif
 
+/**
+ * MEMP_LOCKFREE==1: manage the free list of each pool with compare-and-swap
+ * (SYS_ARCH_CAS32, see sys.h) instead of SYS_ARCH_PROTECT, so that
+ * memp_malloc() and memp_free() never take a global lock and can be called
+ * from interrupt handlers. Each pool may hold at most 65534 elements.
+ */
+#ifndef MEMP_LOCKFREE
+#define MEMP_LOCKFREE                   0
+#endif
+
+/**
+ * MEMP_CACHE_SIZE: with MEMP_LOCKFREE, the number of free elements of each
+ * pool that every core keeps for itself, or 0 to use the shared free lists
+ * only. A core takes and returns elements in batches of MEMP_CACHE_SIZE/2,
+ * so its lists are shared less often. Cached elements can only be used by
+ * their core; size the pools for MEMP_NUM_CORES * MEMP_CACHE_SIZE more.
+ */
+#ifndef MEMP_CACHE_SIZE
+#define MEMP_CACHE_SIZE                 0
+#endif
+
+/**
+ * MEMP_NUM_CORES: the number of cores that call memp_malloc() and
+ * memp_free(), i.e. the range of SYS_ARCH_CORE_ID(). Only used with
+ * MEMP_CACHE_SIZE > 0.
+ */
+#ifndef MEMP_NUM_CORES
+#define MEMP_NUM_CORES                  1
+#endif
+
 /**
  * MEM_USE_POOLS==1: Use an alternative to malloc() by allocating from a set
  * of memory pools of various sizes. When mem_malloc is called, an element of
@@ -348,6 +437,15 @@
 #define MEMP_NUM_TCPIP_MSG_INPKT        8
 #endif
 
+/**
+ * MEMP_NUM_TCPIP_INPUT_BATCH: the number of batches of incoming packets
+ * (see LWIP_TCPIP_INPUT_BATCH) that can be allocated at the same time.
+ * (only needed if you use tcpip.c)
+ */
+#ifndef MEMP_NUM_TCPIP_INPUT_BATCH
+#define MEMP_NUM_TCPIP_INPUT_BATCH      2
+#endif
+
 /**
  * MEMP_NUM_SNMP_NODE: the number of leafs in the SNMP tree.
  */
@@ -426,11 +524,41 @@
 
 /**
  * ARP_TABLE_SIZE: Number of active MAC-IP address pairs cached.
+ * At most 127, or 32767 with LWIP_ARP_HASH==1.
  */
 #ifndef ARP_TABLE_SIZE
 #define ARP_TABLE_SIZE                  10
 #endif
 
+/**
+ * LWIP_ARP_HASH==1: Find ARP table entries through a hash table on the IP
+ * address instead of scanning the whole table, and recycle the least recently
+ * used entry when the table is full. Each netif also keeps a small cache of
+ * the entries it last sent to (ETHARP_NETIF_HINTS), which etharp_output()
+ * checks before looking up the table. This replaces the per-pcb hints of
+ * LWIP_NETIF_HWADDRHINT, which can only hold an index below 256.
+ */
+#ifndef LWIP_ARP_HASH
+#define LWIP_ARP_HASH                   0
+#endif
+
+/**
+ * ARP_HASH_SIZE: Number of buckets in the ARP hash table used when
+ * LWIP_ARP_HASH==1. Must be a power of 2.
+ */
+#ifndef ARP_HASH_SIZE
+#define ARP_HASH_SIZE                   16
+#endif
+
+/**
+ * ETHARP_NETIF_HINTS: Number of ARP table entries each netif remembers for
+ * the destinations it sent to, indexed by a hash of the destination address.
+ * Only used when LWIP_ARP_HASH==1. Must be a power of 2.
+ */
+#ifndef ETHARP_NETIF_HINTS
+#define ETHARP_NETIF_HINTS              4
+#endif
+
 /**
  * ARP_QUEUEING==1: Multiple outgoing packets are queued during hardware address
  * resolution. By default, only the most recent packet is queued per IP address.
@@ -865,6 +993,26 @@
 #define UDP_TTL                         (IP_DEFAULT_TTL)
 #endif
 
+/**
+ * LWIP_UDP_PCB_HASH==1: Find the pcb for an incoming datagram through hash
+ * tables instead of walking udp_pcbs. All pcbs are hashed on their local
+ * port; connected pcbs are also hashed on local port and remote address and
+ * port, so that a datagram for a connected pcb is matched exactly without
+ * looking at the other pcbs bound to the same port. Binding to a free port
+ * and checking for a port conflict only look at one bucket.
+ */
+#ifndef LWIP_UDP_PCB_HASH
+#define LWIP_UDP_PCB_HASH               0
+#endif
+
+/**
+ * UDP_PCB_HASH_SIZE: Number of buckets in each of the UDP pcb hash tables
+ * used when LWIP_UDP_PCB_HASH==1. Must be a power of 2.
+ */
+#ifndef UDP_PCB_HASH_SIZE
+#define UDP_PCB_HASH_SIZE               16
+#endif
+
 /**
  * LWIP_NETBUF_RECVINFO==1: append destination addr and port to every netbuf.
  */
@@ -994,6 +1142,46 @@
 #define TCP_DEFAULT_LISTEN_BACKLOG      0xff
 #endif
 
+/**
+ * LWIP_TCP_PCB_HASH==1: Find the pcb for an incoming segment through hash
+ * tables instead of walking the active, TIME-WAIT and listen pcb lists.
+ * Connections are hashed on their address/port 4-tuple, listening pcbs on
+ * their local port. Costs one pointer per pcb plus the tables themselves,
+ * and is worth it when many connections are open at once.
+ */
+#ifndef LWIP_TCP_PCB_HASH
+#define LWIP_TCP_PCB_HASH               0
+#endif
+
+/**
+ * TCP_PCB_HASH_SIZE: Number of buckets in the connection hash table used
+ * when LWIP_TCP_PCB_HASH==1. Must be a power of 2; about the number of
+ * connections expected to be open at once is a good size.
+ */
+#ifndef TCP_PCB_HASH_SIZE
+#define TCP_PCB_HASH_SIZE               64
+#endif
+
+/**
+ * TCP_LISTEN_HASH_SIZE: Number of buckets in the listening pcb hash table
+ * used when LWIP_TCP_PCB_HASH==1. Must be a power of 2.
+ */
+#ifndef TCP_LISTEN_HASH_SIZE
+#define TCP_LISTEN_HASH_SIZE            8
+#endif
+
+/**
+ * LWIP_TCP_PCB_TIMERS==1: Give each TCP pcb its own timeout instead of
+ * running the fast and slow timers over every pcb on each TCP_TMR_INTERVAL.
+ * A pcb with data in flight or an ACK pending is serviced every
+ * TCP_FAST_INTERVAL as before; an idle established pcb only wakes for its
+ * poll callback or keepalive, so idle connections cost nothing in between.
+ * Requires LWIP_TIMERS_WHEEL.
+ */
+#ifndef LWIP_TCP_PCB_TIMERS
+#define LWIP_TCP_PCB_TIMERS             0
+#endif
+
 /**
  * TCP_OVERSIZE: The maximum number of bytes that tcp_write may
  * allocate ahead of time in an attempt to create shorter pbuf chains
@@ -1339,8 +1527,13 @@
    ----------------------------------------------
 */
 /**
- * LWIP_TCPIP_CORE_LOCKING: (EXPERIMENTAL!)
- * Don't use it if you're not an active lwIP project member
+ * LWIP_TCPIP_CORE_LOCKING==1: Let netconn and socket API calls lock the lwIP
+ * core with a mutex and run in the calling thread, instead of posting a
+ * message to tcpip_thread and waiting for it to be processed. This saves two
+ * context switches per call; small writes that fit into the send buffer call
+ * tcp_write() and tcp_output() directly.
+ * The port's sys_mutex_t should support priority inheritance, so that a low
+ * priority thread holding the core lock doesn't block tcpip_thread for long.
  */
 #ifndef LWIP_TCPIP_CORE_LOCKING
 #define LWIP_TCPIP_CORE_LOCKING         0
@@ -1354,6 +1547,23 @@
 #define LWIP_TCPIP_CORE_LOCKING_INPUT   0
 #endif
 
+/**
+ * LWIP_TCPIP_INPUT_BATCH==1: Enable tcpip_input_batch_post(), which lets a
+ * driver pass up to TCPIP_INPUT_BATCH_SIZE received packets to tcpip_thread
+ * with a single mailbox post, instead of one tcpip_input() call per packet.
+ */
+#ifndef LWIP_TCPIP_INPUT_BATCH
+#define LWIP_TCPIP_INPUT_BATCH          0
+#endif
+
+/**
+ * TCPIP_INPUT_BATCH_SIZE: the maximum number of packets in one batch passed
+ * to tcpip_input_batch_post().
+ */
+#ifndef TCPIP_INPUT_BATCH_SIZE
+#define TCPIP_INPUT_BATCH_SIZE          8
+#endif
+
 /**
  * LWIP_NETCONN==1: Enable Netconn API (require to use api_lib.c)
  */
@@ -1443,6 +1653,16 @@
 #define SO_REUSE_RXTOALL                0
 #endif
 
+/**
+ * LWIP_SOCKET_RECV_PBUF==1: Enable lwip_recv_pbuf() and
+ * lwip_recv_pbuf_release(), which hand the received pbuf chain to the
+ * application instead of copying it into a buffer. For TCP, the receive
+ * window is only opened again when the chain is released.
+ */
+#ifndef LWIP_SOCKET_RECV_PBUF
+#define LWIP_SOCKET_RECV_PBUF           0
+#endif
+
 /*
    ----------------------------------------
    ---------- Statistics options ----------
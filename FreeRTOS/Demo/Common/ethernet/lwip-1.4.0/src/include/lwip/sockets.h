@@ -42,6 +42,7 @@
 
 #include "lwip/ip_addr.h"
 #include "lwip/inet.h"
+#include "lwip/pbuf.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -339,6 +340,11 @@ int lwip_select(int maxfdp1, fd_set *readset, fd_set *writeset, fd_set *exceptse
                 struct timeval *timeout);
 int lwip_ioctl(int s, long cmd, void *argp);
 int lwip_fcntl(int s, int cmd, int val);
+#if LWIP_SOCKET_RECV_PBUF
+int lwip_recv_pbuf(int s, struct pbuf **p, int flags,
+      struct sockaddr *from, socklen_t *fromlen);
+void lwip_recv_pbuf_release(int s, struct pbuf *p);
+#endif /* LWIP_SOCKET_RECV_PBUF */
 
 #if LWIP_COMPAT_SOCKETS
 #define accept(a,b,c)         lwip_accept(a,b,c)
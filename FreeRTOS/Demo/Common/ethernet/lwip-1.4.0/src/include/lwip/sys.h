@@ -282,6 +282,47 @@ void sys_arch_unprotect(sys_prot_t pval);
 
 #endif /* SYS_ARCH_PROTECT */
 
+#if MEMP_LOCKFREE
+/** SYS_ARCH_CAS32
+ * Atomically compare the u32_t at "ptr" with "expected" and store "desired"
+ * there if they are equal. Evaluates to nonzero if the store was done. It
+ * must be safe to use from interrupt handlers and between cores, and act as
+ * a full memory barrier. This macro defaults to the gcc builtin; other
+ * compilers need it defined in sys_arch.h or cc.h (e.g. with
+ * InterlockedCompareExchange() on win32).
+ */
+#ifndef SYS_ARCH_CAS32
+#ifdef __GNUC__
+#define SYS_ARCH_CAS32(ptr, expected, desired) \
+  __sync_bool_compare_and_swap((ptr), (expected), (desired))
+#else
+#error "MEMP_LOCKFREE needs SYS_ARCH_CAS32 to be defined in sys_arch.h or cc.h"
+#endif
+#endif /* SYS_ARCH_CAS32 */
+
+/** SYS_ARCH_CORE_ID
+ * The number of the core that is running, from 0 to MEMP_NUM_CORES - 1.
+ * Only read inside SYS_ARCH_LOCAL_PROTECT. Defaults to 0 for single core
+ * systems; an SMP FreeRTOS port would use portGET_CORE_ID().
+ */
+#ifndef SYS_ARCH_CORE_ID
+#define SYS_ARCH_CORE_ID() 0
+#endif /* SYS_ARCH_CORE_ID */
+
+/** SYS_ARCH_LOCAL_PROTECT
+ * Like SYS_ARCH_PROTECT, but only has to keep out other tasks and interrupts
+ * on the same core, and must work from interrupt handlers. Protects the
+ * per-core memp caches. On an SMP port this would only mask interrupts on
+ * the calling core (e.g. portSET_INTERRUPT_MASK_FROM_ISR()) instead of also
+ * taking the lock that the other cores spin on. Defaults to SYS_ARCH_PROTECT.
+ */
+#ifndef SYS_ARCH_LOCAL_PROTECT
+#define SYS_ARCH_DECL_LOCAL_PROTECT(lev) SYS_ARCH_DECL_PROTECT(lev)
+#define SYS_ARCH_LOCAL_PROTECT(lev)      SYS_ARCH_PROTECT(lev)
+#define SYS_ARCH_LOCAL_UNPROTECT(lev)    SYS_ARCH_UNPROTECT(lev)
+#endif /* SYS_ARCH_LOCAL_PROTECT */
+#endif /* MEMP_LOCKFREE */
+
 /*
  * Macros to set/get and increase/decrease variables in a thread-safe way.
  * Use these for accessing variable that are used from more than one thread.
@@ -42,6 +42,9 @@
 #include "lwip/ip.h"
 #include "lwip/icmp.h"
 #include "lwip/err.h"
+#if LWIP_TCP_PCB_TIMERS
+#include "lwip/timers.h"
+#endif /* LWIP_TCP_PCB_TIMERS */
 
 #ifdef __cplusplus
 extern "C" {
@@ -151,11 +154,18 @@ enum tcp_state {
 #define DEF_ACCEPT_CALLBACK
 #endif /* LWIP_CALLBACK_API */
 
+#if LWIP_TCP_PCB_HASH
+#define DEF_HASH_NEXT(type)  type *hash_next; /* for the hash table bucket */
+#else /* LWIP_TCP_PCB_HASH */
+#define DEF_HASH_NEXT(type)
+#endif /* LWIP_TCP_PCB_HASH */
+
 /**
  * members common to struct tcp_pcb and struct tcp_listen_pcb
  */
 #define TCP_PCB_COMMON(type) \
   type *next; /* for the linked list */ \
+  DEF_HASH_NEXT(type) \
   enum tcp_state state; /* TCP state */ \
   u8_t prio; \
   void *callback_arg; \
@@ -277,6 +287,17 @@ struct tcp_pcb {
 
   /* KEEPALIVE counter */
   u8_t keep_cnt_sent;
+
+#if LWIP_TCP_PCB_TIMERS
+  /* Timer that runs the fast and slow timer work for this pcb only */
+  struct sys_timeo timer;
+  /* tcp_ticks when the timer was parked */
+  u32_t timer_parked;
+  u8_t timer_flags;
+#define TCP_TIMER_BUSY      ((u8_t)0x01U)   /* Running every TCP_FAST_INTERVAL. */
+#define TCP_TIMER_PARKED    ((u8_t)0x02U)   /* Idle, polltmr not counted since timer_parked. */
+#define TCP_TIMER_FAST_ONLY ((u8_t)0x04U)   /* Next run skips the slow timer work. */
+#endif /* LWIP_TCP_PCB_TIMERS */
 };
 
 struct tcp_pcb_listen {  
@@ -364,6 +385,12 @@ void             tcp_setprio (struct tcp_pcb *pcb, u8_t prio);
 
 err_t            tcp_output  (struct tcp_pcb *pcb);
 
+#if LWIP_TCP_PCB_TIMERS
+/* Call after changing so_options or the keepalive settings of an idle pcb
+   directly, so its timer picks them up before the next activity. */
+void             tcp_timer_kick(struct tcp_pcb *pcb);
+#endif /* LWIP_TCP_PCB_TIMERS */
+
 
 const char* tcp_debug_state_str(enum tcp_state s);
 
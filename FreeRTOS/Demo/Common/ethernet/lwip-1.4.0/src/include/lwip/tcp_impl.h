@@ -324,6 +324,50 @@ extern struct tcp_pcb *tcp_tw_pcbs;      /* List of all TCP PCBs in TIME-WAIT. *
 
 extern struct tcp_pcb *tcp_tmp_pcb;      /* Only used for temporary storage. */
 
+#if LWIP_TCP_PCB_HASH
+/* Hash tables over the active and TIME-WAIT PCBs (keyed on the 4-tuple) and
+   over the listening PCBs (keyed on the local port). They are kept in step
+   with the lists by TCP_REG and TCP_RMV; PCBs in tcp_bound_pcbs are not
+   hashed. The buckets are chained through hash_next. */
+extern struct tcp_pcb *tcp_conn_hash[TCP_PCB_HASH_SIZE];
+extern struct tcp_pcb_listen *tcp_listen_hash[TCP_LISTEN_HASH_SIZE];
+
+#define TCP_LISTEN_HASH_INDEX(port) \
+  ((u16_t)((port) ^ ((port) >> 8)) & (TCP_LISTEN_HASH_SIZE - 1))
+
+void tcp_pcb_hash_add(struct tcp_pcb **pcbs, struct tcp_pcb *pcb);
+void tcp_pcb_hash_remove(struct tcp_pcb **pcbs, struct tcp_pcb *pcb);
+struct tcp_pcb *tcp_conn_hash_lookup(ip_addr_t *local_ip, u16_t local_port,
+                                     ip_addr_t *remote_ip, u16_t remote_port);
+struct tcp_pcb_listen *tcp_listen_hash_lookup(ip_addr_t *local_ip, u16_t local_port);
+
+#define TCP_HASH_ADD(pcbs, npcb)  tcp_pcb_hash_add((pcbs), (npcb))
+#define TCP_HASH_RMV(pcbs, npcb)  tcp_pcb_hash_remove((pcbs), (npcb))
+#else /* LWIP_TCP_PCB_HASH */
+#define TCP_HASH_ADD(pcbs, npcb)
+#define TCP_HASH_RMV(pcbs, npcb)
+#endif /* LWIP_TCP_PCB_HASH */
+
+#if LWIP_TCP_PCB_TIMERS
+/* Each active and TIME-WAIT PCB runs its own timer. TCP_REG and TCP_RMV
+   start and stop it; anything that gives an idle PCB work to do
+   (tcp_output, tcp_write) kicks it back to the fast interval. */
+void tcp_pcb_timer_reg(struct tcp_pcb **pcbs, struct tcp_pcb *pcb);
+void tcp_pcb_timer_rmv(struct tcp_pcb **pcbs, struct tcp_pcb *pcb);
+
+#define TCP_TIMER_REG(pcbs, npcb) tcp_pcb_timer_reg((pcbs), (npcb))
+#define TCP_TIMER_RMV(pcbs, npcb) tcp_pcb_timer_rmv((pcbs), (npcb))
+#define TCP_TIMER_KICK(pcb)  do { \
+                               if (!((pcb)->timer_flags & TCP_TIMER_BUSY)) { \
+                                 tcp_timer_kick(pcb); \
+                               } \
+                             } while (0)
+#else /* LWIP_TCP_PCB_TIMERS */
+#define TCP_TIMER_REG(pcbs, npcb)
+#define TCP_TIMER_RMV(pcbs, npcb)
+#define TCP_TIMER_KICK(pcb)
+#endif /* LWIP_TCP_PCB_TIMERS */
+
 /* Axioms about the above lists:   
    1) Every TCP PCB that is not CLOSED is in one of the lists.
    2) A PCB is only in one of the lists.
@@ -347,6 +391,8 @@ extern struct tcp_pcb *tcp_tmp_pcb;      /* Only used for temporary storage. */
                             (npcb)->next = *(pcbs); \
                             LWIP_ASSERT("TCP_REG: npcb->next != npcb", (npcb)->next != (npcb)); \
                             *(pcbs) = (npcb); \
+                            TCP_HASH_ADD(pcbs, npcb); \
+                            TCP_TIMER_REG(pcbs, npcb); \
                             LWIP_ASSERT("TCP_RMV: tcp_pcbs sane", tcp_pcbs_sane()); \
               tcp_timer_needed(); \
                             } while(0)
@@ -362,6 +408,8 @@ extern struct tcp_pcb *tcp_tmp_pcb;      /* Only used for temporary storage. */
                                } \
                             } \
                             (npcb)->next = NULL; \
+                            TCP_HASH_RMV(pcbs, npcb); \
+                            TCP_TIMER_RMV(pcbs, npcb); \
                             LWIP_ASSERT("TCP_RMV: tcp_pcbs sane", tcp_pcbs_sane()); \
                             LWIP_DEBUGF(TCP_DEBUG, ("TCP_RMV: removed %p from %p\n", (npcb), *(pcbs))); \
                             } while(0)
@@ -372,6 +420,8 @@ extern struct tcp_pcb *tcp_tmp_pcb;      /* Only used for temporary storage. */
   do {                                             \
     (npcb)->next = *pcbs;                          \
     *(pcbs) = (npcb);                              \
+    TCP_HASH_ADD(pcbs, npcb);                      \
+    TCP_TIMER_REG(pcbs, npcb);                     \
     tcp_timer_needed();                            \
   } while (0)
 
@@ -391,6 +441,8 @@ extern struct tcp_pcb *tcp_tmp_pcb;      /* Only used for temporary storage. */
       }                                            \
     }                                              \
     (npcb)->next = NULL;                           \
+    TCP_HASH_RMV(pcbs, npcb);                      \
+    TCP_TIMER_RMV(pcbs, npcb);                     \
   } while(0)
 
 #endif /* LWIP_DEBUG */
@@ -88,6 +88,13 @@ err_t tcpip_apimsg_lock(struct api_msg *apimsg);
 
 err_t tcpip_input(struct pbuf *p, struct netif *inp);
 
+#if LWIP_TCPIP_INPUT_BATCH
+struct tcpip_input_batch *tcpip_input_batch_new(struct netif *inp);
+err_t tcpip_input_batch_add(struct tcpip_input_batch *batch, struct pbuf *p);
+err_t tcpip_input_batch_post(struct tcpip_input_batch *batch);
+#define tcpip_input_batch_full(batch) ((batch)->count == TCPIP_INPUT_BATCH_SIZE)
+#endif /* LWIP_TCPIP_INPUT_BATCH */
+
 #if LWIP_NETIF_API
 err_t tcpip_netifapi(struct netifapi_msg *netifapimsg);
 #if LWIP_TCPIP_CORE_LOCKING
@@ -112,6 +119,9 @@ enum tcpip_msg_type {
   TCPIP_MSG_API,
 #endif /* LWIP_NETCONN */
   TCPIP_MSG_INPKT,
+#if LWIP_TCPIP_INPUT_BATCH
+  TCPIP_MSG_INPKT_BATCH,
+#endif /* LWIP_TCPIP_INPUT_BATCH */
 #if LWIP_NETIF_API
   TCPIP_MSG_NETIFAPI,
 #endif /* LWIP_NETIF_API */
@@ -136,6 +146,9 @@ struct tcpip_msg {
       struct pbuf *p;
       struct netif *netif;
     } inp;
+#if LWIP_TCPIP_INPUT_BATCH
+    struct tcpip_input_batch *batch;
+#endif /* LWIP_TCPIP_INPUT_BATCH */
     struct {
       tcpip_callback_fn function;
       void *ctx;
@@ -150,6 +163,20 @@ struct tcpip_msg {
   } msg;
 };
 
+#if LWIP_TCPIP_INPUT_BATCH
+/** Received packets collected by a driver and passed to tcpip_thread
+ * together. Allocate with tcpip_input_batch_new(). */
+struct tcpip_input_batch {
+  /** the message posted to tcpip_thread, so no MEMP_TCPIP_MSG_INPKT is needed */
+  struct tcpip_msg msg;
+  /** the network interface the packets were received on */
+  struct netif *netif;
+  /** number of packets in p[] */
+  u16_t count;
+  struct pbuf *p[TCPIP_INPUT_BATCH_SIZE];
+};
+#endif /* LWIP_TCPIP_INPUT_BATCH */
+
 #ifdef __cplusplus
 }
 #endif
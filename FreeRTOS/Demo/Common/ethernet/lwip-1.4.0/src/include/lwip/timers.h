@@ -62,11 +62,20 @@ extern "C" {
  */
 typedef void (* sys_timeout_handler)(void *arg);
 
+/** With LWIP_TIMERS_WHEEL==1, time is the sys_now() time the timeout expires
+ * at; otherwise it is the time after the previous timeout in the list. */
 struct sys_timeo {
   struct sys_timeo *next;
   u32_t time;
   sys_timeout_handler h;
   void *arg;
+#if LWIP_TIMERS_WHEEL
+  /** the pointer that points to this timeout, to unlink it in O(1) */
+  struct sys_timeo **pprev;
+  /** next timeout in the sys_untimeout() hash bucket */
+  struct sys_timeo *hash_next;
+  u8_t flags;
+#endif /* LWIP_TIMERS_WHEEL */
 #if LWIP_DEBUG_TIMERNAMES
   const char* handler_name;
 #endif /* LWIP_DEBUG_TIMERNAMES */
@@ -82,6 +91,15 @@ void sys_timeout(u32_t msecs, sys_timeout_handler handler, void *arg);
 #endif /* LWIP_DEBUG_TIMERNAMES */
 
 void sys_untimeout(sys_timeout_handler handler, void *arg);
+#if LWIP_TIMERS_WHEEL
+/** Flags for struct sys_timeo */
+#define SYS_TIMEO_ACTIVE    0x01U /* in the wheel or due to run */
+#define SYS_TIMEO_STATIC    0x02U /* owned by the caller, not MEMP_SYS_TIMEOUT */
+
+void sys_timeout_start(struct sys_timeo *timeout, u32_t msecs, sys_timeout_handler handler, void *arg);
+void sys_timeout_stop(struct sys_timeo *timeout);
+#define sys_timeout_is_active(timeout) (((timeout)->flags & SYS_TIMEO_ACTIVE) != 0)
+#endif /* LWIP_TIMERS_WHEEL */
 #if NO_SYS
 void sys_check_timeouts(void);
 void sys_restart_timeouts(void);
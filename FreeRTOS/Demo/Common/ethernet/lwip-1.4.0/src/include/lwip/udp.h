@@ -95,6 +95,12 @@ struct udp_pcb {
 /* Protocol specific PCB members */
 
   struct udp_pcb *next;
+#if LWIP_UDP_PCB_HASH
+  /** next pcb in the same local port hash bucket */
+  struct udp_pcb *hash_next;
+  /** next pcb in the same connection hash bucket (connected pcbs only) */
+  struct udp_pcb *conn_next;
+#endif /* LWIP_UDP_PCB_HASH */
 
   u8_t flags;
   /** ports are in host byte order */
@@ -178,9 +178,16 @@ struct etharp_q_entry {
 };
 #endif /* ARP_QUEUEING */
 
+#if LWIP_ARP_HASH
+/** Index into the ARP table, wide enough for more than 127 entries */
+typedef s16_t etharp_idx_t;
+void etharp_init(void);
+#else /* LWIP_ARP_HASH */
+typedef s8_t etharp_idx_t;
 #define etharp_init() /* Compatibility define, not init needed. */
+#endif /* LWIP_ARP_HASH */
 void etharp_tmr(void);
-s8_t etharp_find_addr(struct netif *netif, ip_addr_t *ipaddr,
+etharp_idx_t etharp_find_addr(struct netif *netif, ip_addr_t *ipaddr,
          struct eth_addr **eth_ret, ip_addr_t **ip_ret);
 err_t etharp_output(struct netif *netif, struct pbuf *q, ip_addr_t *ipaddr);
 err_t etharp_query(struct netif *netif, ip_addr_t *ipaddr, struct pbuf *q);
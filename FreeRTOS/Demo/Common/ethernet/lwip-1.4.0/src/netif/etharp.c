@@ -107,13 +107,46 @@ struct etharp_entry {
 #if ETHARP_SUPPORT_STATIC_ENTRIES
   u8_t static_entry;
 #endif /* ETHARP_SUPPORT_STATIC_ENTRIES */
+#if LWIP_ARP_HASH
+  /** next entry in the same arp_hash bucket, or in arp_free if empty */
+  etharp_idx_t hash_next;
+  /** neighbours on the LRU list (static entries are not on it) */
+  etharp_idx_t lru_prev;
+  etharp_idx_t lru_next;
+#endif /* LWIP_ARP_HASH */
 };
 
 static struct etharp_entry arp_table[ARP_TABLE_SIZE];
 
-#if !LWIP_NETIF_HWADDRHINT
+#if LWIP_ARP_HASH
+/** marks the end of the hash bucket, free and LRU lists */
+#define ETHARP_IDX_NONE  ((etharp_idx_t)-1)
+
+/** first entry of each hash bucket */
+static etharp_idx_t arp_hash[ARP_HASH_SIZE];
+/** list of empty entries, linked through hash_next */
+static etharp_idx_t arp_free;
+/** non-empty, non-static entries, most recently used first */
+static etharp_idx_t arp_lru_head;
+static etharp_idx_t arp_lru_tail;
+
+/** Folds an IP address into 16 bits for the hash bucket and netif hint
+ * index. Works the same for both byte orders. */
+#define ETHARP_IP_HASH(ipaddr) \
+  ((u16_t)(ip4_addr_get_u32(ipaddr) ^ (ip4_addr_get_u32(ipaddr) >> 16)))
+#define ETHARP_HASH_INDEX(ipaddr) \
+  ((ETHARP_IP_HASH(ipaddr) ^ (ETHARP_IP_HASH(ipaddr) >> 8)) & (ARP_HASH_SIZE - 1))
+#define ETHARP_HINT_INDEX(ipaddr) \
+  ((ETHARP_IP_HASH(ipaddr) ^ (ETHARP_IP_HASH(ipaddr) >> 8)) & (ETHARP_NETIF_HINTS - 1))
+
+#if ETHARP_SUPPORT_STATIC_ENTRIES
+#define ETHARP_ON_LRU(i)  (arp_table[i].static_entry == 0)
+#else /* ETHARP_SUPPORT_STATIC_ENTRIES */
+#define ETHARP_ON_LRU(i)  1
+#endif /* ETHARP_SUPPORT_STATIC_ENTRIES */
+#elif !LWIP_NETIF_HWADDRHINT
 static u8_t etharp_cached_entry;
-#endif /* !LWIP_NETIF_HWADDRHINT */
+#endif /* LWIP_ARP_HASH */
 
 /** Try hard to create a new entry - we want the IP address to appear in
     the cache (even if this means removing an active entry or so). */
@@ -121,19 +154,24 @@ static u8_t etharp_cached_entry;
 #define ETHARP_FLAG_FIND_ONLY    2
 #define ETHARP_FLAG_STATIC_ENTRY 4
 
-#if LWIP_NETIF_HWADDRHINT
-#define ETHARP_SET_HINT(netif, hint)  if (((netif) != NULL) && ((netif)->addr_hint != NULL))  \
-                                      *((netif)->addr_hint) = (hint);
+#if LWIP_ARP_HASH
+#define ETHARP_SET_HINT(netif, ipaddr, hint)  ((netif)->arp_hint[ETHARP_HINT_INDEX(ipaddr)] = (u16_t)(hint))
+#elif LWIP_NETIF_HWADDRHINT
+#define ETHARP_SET_HINT(netif, ipaddr, hint)  if (((netif) != NULL) && ((netif)->addr_hint != NULL))  \
+                                              *((netif)->addr_hint) = (hint);
 #else /* LWIP_NETIF_HWADDRHINT */
-#define ETHARP_SET_HINT(netif, hint)  (etharp_cached_entry = (hint))
+#define ETHARP_SET_HINT(netif, ipaddr, hint)  (etharp_cached_entry = (hint))
 #endif /* LWIP_NETIF_HWADDRHINT */
 
 static err_t update_arp_entry(struct netif *netif, ip_addr_t *ipaddr, struct eth_addr *ethaddr, u8_t flags);
 
 
 /* Some checks, instead of etharp_init(): */
-#if (LWIP_ARP && (ARP_TABLE_SIZE > 0x7f))
-  #error "ARP_TABLE_SIZE must fit in an s8_t, you have to reduce it in your lwipopts.h"
+#if (LWIP_ARP && !LWIP_ARP_HASH && (ARP_TABLE_SIZE > 0x7f))
+  #error "ARP_TABLE_SIZE must fit in an s8_t, you have to reduce it in your lwipopts.h or enable LWIP_ARP_HASH"
+#endif
+#if (LWIP_ARP && LWIP_ARP_HASH && (ARP_TABLE_SIZE > 0x7fff))
+  #error "ARP_TABLE_SIZE must fit in an s16_t, you have to reduce it in your lwipopts.h"
 #endif
 
 
@@ -164,10 +202,122 @@ free_etharp_q(struct etharp_q_entry *q)
 
 #endif /* ARP_QUEUEING */
 
+#if LWIP_ARP_HASH
+/**
+ * Initialize the ARP hash table: all entries are empty and on the free list.
+ * Called from lwip_init().
+ */
+void
+etharp_init(void)
+{
+  etharp_idx_t i;
+
+  for (i = 0; i < ARP_HASH_SIZE; i++) {
+    arp_hash[i] = ETHARP_IDX_NONE;
+  }
+  for (i = 0; i < ARP_TABLE_SIZE; i++) {
+    arp_table[i].hash_next = (etharp_idx_t)(i + 1);
+  }
+  arp_table[ARP_TABLE_SIZE - 1].hash_next = ETHARP_IDX_NONE;
+  arp_free = 0;
+  arp_lru_head = ETHARP_IDX_NONE;
+  arp_lru_tail = ETHARP_IDX_NONE;
+}
+
+/** Remove an entry from the LRU list */
+static void
+etharp_lru_unlink(etharp_idx_t i)
+{
+  etharp_idx_t prev = arp_table[i].lru_prev;
+  etharp_idx_t next = arp_table[i].lru_next;
+
+  if (prev != ETHARP_IDX_NONE) {
+    arp_table[prev].lru_next = next;
+  } else {
+    arp_lru_head = next;
+  }
+  if (next != ETHARP_IDX_NONE) {
+    arp_table[next].lru_prev = prev;
+  } else {
+    arp_lru_tail = prev;
+  }
+}
+
+/** Put an entry at the front (most recently used end) of the LRU list */
+static void
+etharp_lru_push(etharp_idx_t i)
+{
+  arp_table[i].lru_prev = ETHARP_IDX_NONE;
+  arp_table[i].lru_next = arp_lru_head;
+  if (arp_lru_head != ETHARP_IDX_NONE) {
+    arp_table[arp_lru_head].lru_prev = i;
+  } else {
+    arp_lru_tail = i;
+  }
+  arp_lru_head = i;
+}
+
+/** Mark an entry as just used */
+static void
+etharp_lru_touch(etharp_idx_t i)
+{
+  if ((arp_lru_head != i) && ETHARP_ON_LRU(i)) {
+    etharp_lru_unlink(i);
+    etharp_lru_push(i);
+  }
+}
+
+/**
+ * Choose the entry to recycle when the table is full, in the same order of
+ * preference as the table scan: the least recently used stable entry, else
+ * the least recently used pending entry without and then with queued packets.
+ * Pending entries expire after ARP_MAXPENDING, so the walk normally stops at
+ * the tail.
+ *
+ * @return the entry to recycle, or ETHARP_IDX_NONE if there is none
+ */
+static etharp_idx_t
+etharp_lru_victim(void)
+{
+  etharp_idx_t i;
+  etharp_idx_t old_pending = ETHARP_IDX_NONE, old_queue = ETHARP_IDX_NONE;
+
+  for (i = arp_lru_tail; i != ETHARP_IDX_NONE; i = arp_table[i].lru_prev) {
+    if (arp_table[i].state == ETHARP_STATE_STABLE) {
+      /* no queued packets should exist on stable entries */
+      LWIP_ASSERT("arp_table[i].q == NULL", arp_table[i].q == NULL);
+      return i;
+    } else if (arp_table[i].q == NULL) {
+      if (old_pending == ETHARP_IDX_NONE) {
+        old_pending = i;
+      }
+    } else if (old_queue == ETHARP_IDX_NONE) {
+      old_queue = i;
+    }
+  }
+  return (old_pending != ETHARP_IDX_NONE) ? old_pending : old_queue;
+}
+#endif /* LWIP_ARP_HASH */
+
 /** Clean up ARP table entries */
 static void
 free_entry(int i)
 {
+#if LWIP_ARP_HASH
+  etharp_idx_t *link = &arp_hash[ETHARP_HASH_INDEX(&arp_table[i].ipaddr)];
+
+  /* unlink from its hash bucket and the LRU list, return to the free list */
+  while (*link != i) {
+    LWIP_ASSERT("ARP entry not in its hash bucket", *link != ETHARP_IDX_NONE);
+    link = &arp_table[*link].hash_next;
+  }
+  *link = arp_table[i].hash_next;
+  if (ETHARP_ON_LRU(i)) {
+    etharp_lru_unlink((etharp_idx_t)i);
+  }
+  arp_table[i].hash_next = arp_free;
+  arp_free = (etharp_idx_t)i;
+#endif /* LWIP_ARP_HASH */
   /* remove from SNMP ARP index tree */
   snmp_delete_arpidx_tree(arp_table[i].netif, &arp_table[i].ipaddr);
   /* and empty packet queue */
@@ -202,7 +352,7 @@ free_entry(int i)
 void
 etharp_tmr(void)
 {
-  u8_t i;
+  etharp_idx_t i;
 
   LWIP_DEBUGF(ETHARP_DEBUG, ("etharp_timer\n"));
   /* remove expired entries from the ARP table */
@@ -254,6 +404,66 @@ etharp_tmr(void)
  * @return The ARP entry index that matched or is created, ERR_MEM if no
  * entry is found or could be recycled.
  */
+#if LWIP_ARP_HASH
+static etharp_idx_t
+find_entry(ip_addr_t *ipaddr, u8_t flags)
+{
+  etharp_idx_t i;
+
+  /* a) search the hash bucket of the IP address */
+  if (ipaddr != NULL) {
+    for (i = arp_hash[ETHARP_HASH_INDEX(ipaddr)]; i != ETHARP_IDX_NONE; i = arp_table[i].hash_next) {
+      LWIP_ASSERT("state == ETHARP_STATE_PENDING || state == ETHARP_STATE_STABLE",
+        arp_table[i].state == ETHARP_STATE_PENDING || arp_table[i].state == ETHARP_STATE_STABLE);
+      if (ip_addr_cmp(ipaddr, &arp_table[i].ipaddr)) {
+        LWIP_DEBUGF(ETHARP_DEBUG | LWIP_DBG_TRACE, ("find_entry: found matching entry %"U16_F"\n", (u16_t)i));
+        etharp_lru_touch(i);
+        return i;
+      }
+    }
+  }
+  /* { we have no match } => try to create a new entry */
+
+  /* don't create new entry, only search? */
+  if (((flags & ETHARP_FLAG_FIND_ONLY) != 0) ||
+      /* or no empty entry found and not allowed to recycle? */
+      ((arp_free == ETHARP_IDX_NONE) && ((flags & ETHARP_FLAG_TRY_HARD) == 0))) {
+    LWIP_DEBUGF(ETHARP_DEBUG | LWIP_DBG_TRACE, ("find_entry: no empty entry found and not allowed to recycle\n"));
+    return (etharp_idx_t)ERR_MEM;
+  }
+
+  /* b) no empty entry: recycle the least recently used one */
+  if (arp_free == ETHARP_IDX_NONE) {
+    i = etharp_lru_victim();
+    if (i == ETHARP_IDX_NONE) {
+      LWIP_DEBUGF(ETHARP_DEBUG | LWIP_DBG_TRACE, ("find_entry: no empty or recyclable entries found\n"));
+      return (etharp_idx_t)ERR_MEM;
+    }
+    LWIP_DEBUGF(ETHARP_DEBUG | LWIP_DBG_TRACE, ("find_entry: recycling least recently used entry %"U16_F"\n", (u16_t)i));
+    free_entry(i);
+  }
+
+  /* c) take the first empty entry and hash it on its IP address */
+  i = arp_free;
+  arp_free = arp_table[i].hash_next;
+  LWIP_ASSERT("arp_table[i].state == ETHARP_STATE_EMPTY",
+    arp_table[i].state == ETHARP_STATE_EMPTY);
+
+  if (ipaddr != NULL) {
+    ip_addr_copy(arp_table[i].ipaddr, *ipaddr);
+  } else {
+    ip_addr_set_zero(&arp_table[i].ipaddr);
+  }
+  arp_table[i].ctime = 0;
+#if ETHARP_SUPPORT_STATIC_ENTRIES
+  arp_table[i].static_entry = 0;
+#endif /* ETHARP_SUPPORT_STATIC_ENTRIES */
+  arp_table[i].hash_next = arp_hash[ETHARP_HASH_INDEX(&arp_table[i].ipaddr)];
+  arp_hash[ETHARP_HASH_INDEX(&arp_table[i].ipaddr)] = i;
+  etharp_lru_push(i);
+  return i;
+}
+#else /* LWIP_ARP_HASH */
 static s8_t
 find_entry(ip_addr_t *ipaddr, u8_t flags)
 {
@@ -395,6 +605,7 @@ find_entry(ip_addr_t *ipaddr, u8_t flags)
 #endif /* ETHARP_SUPPORT_STATIC_ENTRIES */
   return (err_t)i;
 }
+#endif /* LWIP_ARP_HASH */
 
 /**
  * Send an IP packet on the network using netif->linkoutput
@@ -442,7 +653,7 @@ etharp_send_ip(struct netif *netif, struct pbuf *p, struct eth_addr *src, struct
 static err_t
 update_arp_entry(struct netif *netif, ip_addr_t *ipaddr, struct eth_addr *ethaddr, u8_t flags)
 {
-  s8_t i;
+  etharp_idx_t i;
   LWIP_ASSERT("netif->hwaddr_len == ETHARP_HWADDR_LEN", netif->hwaddr_len == ETHARP_HWADDR_LEN);
   LWIP_DEBUGF(ETHARP_DEBUG | LWIP_DBG_TRACE, ("update_arp_entry: %"U16_F".%"U16_F".%"U16_F".%"U16_F" - %02"X16_F":%02"X16_F":%02"X16_F":%02"X16_F":%02"X16_F":%02"X16_F"\n",
     ip4_addr1_16(ipaddr), ip4_addr2_16(ipaddr), ip4_addr3_16(ipaddr), ip4_addr4_16(ipaddr),
@@ -463,7 +674,11 @@ update_arp_entry(struct netif *netif, ip_addr_t *ipaddr, struct eth_addr *ethadd
   }
 
 #if ETHARP_SUPPORT_STATIC_ENTRIES
-  if (flags & ETHARP_FLAG_STATIC_ENTRY) {
+  if ((flags & ETHARP_FLAG_STATIC_ENTRY) && (arp_table[i].static_entry == 0)) {
+#if LWIP_ARP_HASH
+    /* static entries are never recycled, keep them off the LRU list */
+    etharp_lru_unlink(i);
+#endif /* LWIP_ARP_HASH */
     /* record static type */
     arp_table[i].static_entry = 1;
   }
@@ -546,7 +761,7 @@ etharp_add_static_entry(ip_addr_t *ipaddr, struct eth_addr *ethaddr)
 err_t
 etharp_remove_static_entry(ip_addr_t *ipaddr)
 {
-  s8_t i;
+  etharp_idx_t i;
   LWIP_DEBUGF(ETHARP_DEBUG | LWIP_DBG_TRACE, ("etharp_remove_static_entry: %"U16_F".%"U16_F".%"U16_F".%"U16_F"\n",
     ip4_addr1_16(ipaddr), ip4_addr2_16(ipaddr), ip4_addr3_16(ipaddr), ip4_addr4_16(ipaddr)));
 
@@ -579,11 +794,11 @@ etharp_remove_static_entry(ip_addr_t *ipaddr)
  * @param ip_ret points to return pointer
  * @return table index if found, -1 otherwise
  */
-s8_t
+etharp_idx_t
 etharp_find_addr(struct netif *netif, ip_addr_t *ipaddr,
          struct eth_addr **eth_ret, ip_addr_t **ip_ret)
 {
-  s8_t i;
+  etharp_idx_t i;
 
   LWIP_ASSERT("eth_ret != NULL && ip_ret != NULL",
     eth_ret != NULL && ip_ret != NULL);
@@ -893,7 +1108,12 @@ etharp_output(struct netif *netif, struct pbuf *q, ip_addr_t *ipaddr)
         }
       }
     }
-#if LWIP_NETIF_HWADDRHINT
+#if LWIP_ARP_HASH
+    {
+      /* per-netif cached entry for this destination */
+      u16_t etharp_cached_entry = netif->arp_hint[ETHARP_HINT_INDEX(ipaddr)];
+      if (etharp_cached_entry < ARP_TABLE_SIZE) {
+#elif LWIP_NETIF_HWADDRHINT
     if (netif->addr_hint != NULL) {
       /* per-pcb cached entry was given */
       u8_t etharp_cached_entry = *(netif->addr_hint);
@@ -903,13 +1123,16 @@ etharp_output(struct netif *netif, struct pbuf *q, ip_addr_t *ipaddr)
             (ip_addr_cmp(ipaddr, &arp_table[etharp_cached_entry].ipaddr))) {
           /* the per-pcb-cached entry is stable and the right one! */
           ETHARP_STATS_INC(etharp.cachehit);
+#if LWIP_ARP_HASH
+          etharp_lru_touch((etharp_idx_t)etharp_cached_entry);
+#endif /* LWIP_ARP_HASH */
           return etharp_send_ip(netif, q, (struct eth_addr*)(netif->hwaddr),
             &arp_table[etharp_cached_entry].ethaddr);
         }
-#if LWIP_NETIF_HWADDRHINT
+#if LWIP_ARP_HASH || LWIP_NETIF_HWADDRHINT
       }
     }
-#endif /* LWIP_NETIF_HWADDRHINT */
+#endif /* LWIP_ARP_HASH || LWIP_NETIF_HWADDRHINT */
     /* queue on destination Ethernet address belonging to ipaddr */
     return etharp_query(netif, ipaddr, q);
   }
@@ -958,7 +1181,7 @@ etharp_query(struct netif *netif, ip_addr_t *ipaddr, struct pbuf *q)
 {
   struct eth_addr * srcaddr = (struct eth_addr *)netif->hwaddr;
   err_t result = ERR_MEM;
-  s8_t i; /* ARP entry index */
+  etharp_idx_t i; /* ARP entry index */
 
   /* non-unicast address? */
   if (ip_addr_isbroadcast(ipaddr, netif) ||
@@ -1011,7 +1234,7 @@ etharp_query(struct netif *netif, ip_addr_t *ipaddr, struct pbuf *q)
   /* stable entry? */
   if (arp_table[i].state == ETHARP_STATE_STABLE) {
     /* we have a valid IP->Ethernet address mapping */
-    ETHARP_SET_HINT(netif, i);
+    ETHARP_SET_HINT(netif, ipaddr, i);
     /* send the packet */
     result = etharp_send_ip(netif, q, srcaddr, &(arp_table[i].ethaddr));
   /* pending entry? (either just created or already pending */
@@ -0,0 +1,11 @@
+/**
+ * @file
+ * Performance measurement hooks, unused by the benchmarks.
+ */
+#ifndef __PERF_H__
+#define __PERF_H__
+
+#define PERF_START    /* null definition */
+#define PERF_STOP(x)  /* null definition */
+
+#endif /* __PERF_H__ */
@@ -0,0 +1,28 @@
+/**
+ * @file
+ * Operating system types for the benchmarks built with NO_SYS=0, implemented
+ * with POSIX threads in sys_arch.c.
+ */
+#ifndef __ARCH_SYS_ARCH_H__
+#define __ARCH_SYS_ARCH_H__
+
+#define SYS_MBOX_NULL NULL
+#define SYS_SEM_NULL  NULL
+
+struct sys_sem;
+struct sys_mutex;
+struct sys_mbox;
+
+typedef struct sys_sem *sys_sem_t;
+typedef struct sys_mutex *sys_mutex_t;
+typedef struct sys_mbox *sys_mbox_t;
+typedef unsigned long sys_thread_t;
+
+#define sys_sem_valid(sem)             (*(sem) != NULL)
+#define sys_sem_set_invalid(sem)       (*(sem) = NULL)
+#define sys_mutex_valid(mutex)         (*(mutex) != NULL)
+#define sys_mutex_set_invalid(mutex)   (*(mutex) = NULL)
+#define sys_mbox_valid(mbox)           (*(mbox) != NULL)
+#define sys_mbox_set_invalid(mbox)     (*(mbox) = NULL)
+
+#endif /* __ARCH_SYS_ARCH_H__ */
@@ -0,0 +1,200 @@
+/**
+ * @file
+ * Measures how fast etharp_output() resolves the destination of an outgoing
+ * packet as the number of peers in the ARP table grows, and how fast the
+ * table takes in ARP replies once it is full and entries are recycled.
+ * Peers are added by feeding ARP replies to ethernet_input(). Packets are
+ * sent either to a random peer each time, or in bursts of BENCH_BURST packets
+ * to the same peer, which is what the netif destination hints help with.
+ *
+ * Build with LWIP_ARP_HASH=0 and =1 (the Makefile builds both) to compare
+ * the table scan with the hash table. Without the hash the table is limited
+ * to 127 entries.
+ */
+#include "bench_common.h"
+
+#include "netif/etharp.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define BENCH_PACKETS   1000000
+#define BENCH_BURST     8
+#define BENCH_MAX_PEERS 4096
+
+/** An ethernet interface on 192.168.0.1/16, separate from bench_netif */
+static struct netif eth_netif;
+static const struct eth_addr eth_netif_addr = {{0x02, 0x00, 0x00, 0x00, 0x00, 0x01}};
+
+/** The MAC address the next packet sent should carry, and the results */
+static struct eth_addr expected_dest;
+static u32_t frames_out;
+static u32_t frames_misaddressed;
+
+static void
+bench_peer_ip(ip_addr_t *addr, int peer)
+{
+  IP4_ADDR(addr, 192, 168, (u8_t)(1 + (peer >> 8)), (u8_t)peer);
+}
+
+static void
+bench_peer_mac(struct eth_addr *addr, int peer)
+{
+  addr->addr[0] = 0x02;
+  addr->addr[1] = 0x00;
+  addr->addr[2] = 0x00;
+  addr->addr[3] = 0x01;
+  addr->addr[4] = (u8_t)(peer >> 8);
+  addr->addr[5] = (u8_t)peer;
+}
+
+/** Counts the frames sent and checks they went to expected_dest */
+static err_t
+bench_linkoutput(struct netif *netif, struct pbuf *p)
+{
+  struct eth_hdr *ethhdr = (struct eth_hdr *)p->payload;
+
+  LWIP_UNUSED_ARG(netif);
+
+  frames_out++;
+  if (memcmp(&ethhdr->dest, &expected_dest, ETHARP_HWADDR_LEN) != 0) {
+    frames_misaddressed++;
+  }
+  return ERR_OK;
+}
+
+static err_t
+bench_eth_netif_init(struct netif *netif)
+{
+  netif->name[0] = 'e';
+  netif->name[1] = 't';
+  netif->output = etharp_output;
+  netif->linkoutput = bench_linkoutput;
+  netif->mtu = 1500;
+  netif->hwaddr_len = ETHARP_HWADDR_LEN;
+  memcpy(netif->hwaddr, &eth_netif_addr, ETHARP_HWADDR_LEN);
+  netif->flags = NETIF_FLAG_BROADCAST | NETIF_FLAG_ETHARP | NETIF_FLAG_LINK_UP;
+  return ERR_OK;
+}
+
+/** Feeds eth_netif an ARP reply from a peer to our address */
+static void
+bench_arp_reply(int peer)
+{
+  struct pbuf *p;
+  struct eth_hdr *ethhdr;
+  struct etharp_hdr *hdr;
+  ip_addr_t sipaddr;
+  struct eth_addr shwaddr;
+
+  bench_peer_ip(&sipaddr, peer);
+  bench_peer_mac(&shwaddr, peer);
+
+  p = pbuf_alloc(PBUF_RAW, SIZEOF_ETHARP_PACKET, PBUF_RAM);
+  LWIP_ASSERT("bench_arp_reply: out of memory", p != NULL);
+  ethhdr = (struct eth_hdr *)p->payload;
+  hdr = (struct etharp_hdr *)((u8_t *)ethhdr + SIZEOF_ETH_HDR);
+
+  memcpy(&ethhdr->dest, &eth_netif_addr, ETHARP_HWADDR_LEN);
+  memcpy(&ethhdr->src, &shwaddr, ETHARP_HWADDR_LEN);
+  ethhdr->type = PP_HTONS(ETHTYPE_ARP);
+  hdr->hwtype = PP_HTONS(1);
+  hdr->proto = PP_HTONS(ETHTYPE_IP);
+  hdr->hwlen = ETHARP_HWADDR_LEN;
+  hdr->protolen = sizeof(ip_addr_t);
+  hdr->opcode = PP_HTONS(ARP_REPLY);
+  memcpy(&hdr->shwaddr, &shwaddr, ETHARP_HWADDR_LEN);
+  memcpy(&hdr->sipaddr, &sipaddr, sizeof(ip_addr_t));
+  memcpy(&hdr->dhwaddr, &eth_netif_addr, ETHARP_HWADDR_LEN);
+  memcpy(&hdr->dipaddr, &eth_netif.ip_addr, sizeof(ip_addr_t));
+
+  ethernet_input(p, &eth_netif);
+}
+
+/** Sends BENCH_PACKETS packets to the first num_peers peers, burst packets
+ * in a row to each randomly chosen peer. Returns ns per packet. */
+static double
+bench_send(struct pbuf *p, int num_peers, int burst)
+{
+  u32_t rand_state = 1;
+  double start;
+  int sent, i;
+
+  start = bench_seconds();
+  for (sent = 0; sent < BENCH_PACKETS; sent += burst) {
+    ip_addr_t dest;
+    int peer;
+
+    rand_state = rand_state * 1103515245u + 12345u;
+    peer = (int)((rand_state >> 8) % (u32_t)num_peers);
+    bench_peer_ip(&dest, peer);
+    bench_peer_mac(&expected_dest, peer);
+    for (i = 0; i < burst; i++) {
+      eth_netif.output(&eth_netif, p, &dest);
+      pbuf_header(p, -(s16_t)sizeof(struct eth_hdr));
+    }
+  }
+  return ((bench_seconds() - start) * 1e9) / BENCH_PACKETS;
+}
+
+int
+main(void)
+{
+  static const int peer_counts[] = {8, 32, 127, 512, 1024, 4096};
+  ip_addr_t ipaddr, netmask, gw;
+  struct pbuf *p;
+  int num_peers = 0;
+  double start, churn;
+  unsigned i;
+
+  bench_init();
+  IP4_ADDR(&ipaddr, 192, 168, 0, 1);
+  IP4_ADDR(&netmask, 255, 255, 0, 0);
+  IP4_ADDR(&gw, 192, 168, 0, 254);
+  netif_add(&eth_netif, &ipaddr, &netmask, &gw, NULL, bench_eth_netif_init, ethernet_input);
+  netif_set_up(&eth_netif);
+
+  p = pbuf_alloc(PBUF_IP, 64, PBUF_RAM);
+  LWIP_ASSERT("out of memory", p != NULL);
+  memset(p->payload, 0, p->len);
+
+  printf("LWIP_ARP_HASH=%d ARP_TABLE_SIZE=%d\n", LWIP_ARP_HASH, ARP_TABLE_SIZE);
+  printf("%8s %14s %14s %12s\n", "peers", "ns/pkt random", "ns/pkt burst", "ns/reply");
+
+  for (i = 0; i < sizeof(peer_counts) / sizeof(peer_counts[0]); i++) {
+    double random_ns, burst_ns, reply_ns;
+    int added;
+
+    if (peer_counts[i] > ARP_TABLE_SIZE) {
+      break;
+    }
+    added = peer_counts[i] - num_peers;
+    start = bench_seconds();
+    while (num_peers < peer_counts[i]) {
+      bench_arp_reply(num_peers++);
+    }
+    reply_ns = ((bench_seconds() - start) * 1e9) / added;
+
+    frames_out = 0;
+    frames_misaddressed = 0;
+    random_ns = bench_send(p, num_peers, 1);
+    burst_ns = bench_send(p, num_peers, BENCH_BURST);
+    if ((frames_out != 2 * BENCH_PACKETS) || (frames_misaddressed != 0)) {
+      printf("error: %u of %u frames sent, %u to the wrong address\n",
+             (unsigned)frames_out, 2 * BENCH_PACKETS, (unsigned)frames_misaddressed);
+      return 1;
+    }
+    printf("%8d %14.1f %14.1f %12.1f\n", num_peers, random_ns, burst_ns, reply_ns);
+  }
+
+  /* With the table full, every reply from a new peer recycles an entry. */
+  start = bench_seconds();
+  for (i = 0; i < BENCH_MAX_PEERS; i++) {
+    bench_arp_reply(ARP_TABLE_SIZE + (int)i);
+  }
+  churn = ((bench_seconds() - start) * 1e9) / BENCH_MAX_PEERS;
+  printf("%8s %14s %14s %12.1f\n", "full", "", "", churn);
+
+  pbuf_free(p);
+  return 0;
+}
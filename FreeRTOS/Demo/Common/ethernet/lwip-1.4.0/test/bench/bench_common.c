@@ -0,0 +1,149 @@
+/**
+ * @file
+ * Helpers shared by the lwIP host benchmarks.
+ */
+#include "bench_common.h"
+
+#include "lwip/init.h"
+#include "lwip/ip.h"
+#include "lwip/tcp_impl.h"
+#include "lwip/udp.h"
+#include "lwip/inet_chksum.h"
+
+#include <string.h>
+#include <time.h>
+
+struct netif bench_netif;
+struct bench_tcp_out bench_last_tcp_out;
+u32_t bench_packets_out;
+
+/** Records the TCP header of every segment sent instead of resolving and
+ * transmitting it. */
+static err_t
+bench_output(struct netif *netif, struct pbuf *p, ip_addr_t *ipaddr)
+{
+  struct ip_hdr *iphdr = (struct ip_hdr *)p->payload;
+
+  LWIP_UNUSED_ARG(netif);
+  LWIP_UNUSED_ARG(ipaddr);
+
+  bench_packets_out++;
+  if (IPH_PROTO(iphdr) == IP_PROTO_TCP) {
+    struct tcp_hdr *tcphdr = (struct tcp_hdr *)((u8_t *)p->payload + IPH_HL(iphdr) * 4);
+
+    bench_last_tcp_out.seqno = ntohl(tcphdr->seqno);
+    bench_last_tcp_out.ackno = ntohl(tcphdr->ackno);
+    bench_last_tcp_out.src = ntohs(tcphdr->src);
+    bench_last_tcp_out.dest = ntohs(tcphdr->dest);
+    bench_last_tcp_out.flags = TCPH_FLAGS(tcphdr);
+  }
+  return ERR_OK;
+}
+
+static err_t
+bench_netif_init(struct netif *netif)
+{
+  netif->name[0] = 'b';
+  netif->name[1] = 'n';
+  netif->output = bench_output;
+  netif->mtu = 1500;
+  netif->flags = NETIF_FLAG_BROADCAST | NETIF_FLAG_LINK_UP;
+  return ERR_OK;
+}
+
+void
+bench_init(void)
+{
+  lwip_init();
+  bench_netif_add();
+}
+
+void
+bench_netif_add(void)
+{
+  ip_addr_t ipaddr, netmask, gw;
+
+  bench_ip4(&ipaddr, 0, 0, 1);
+  IP4_ADDR(&netmask, 255, 0, 0, 0);
+  bench_ip4(&gw, 0, 0, 254);
+  netif_add(&bench_netif, &ipaddr, &netmask, &gw, NULL, bench_netif_init, ip_input);
+  netif_set_default(&bench_netif);
+  netif_set_up(&bench_netif);
+}
+
+void
+bench_ip4(ip_addr_t *addr, u8_t a, u8_t b, u8_t c)
+{
+  IP4_ADDR(addr, 10, a, b, c);
+}
+
+/** Allocates a packet and fills in its IP header. */
+static struct pbuf *
+bench_ip_packet(ip_addr_t *src_ip, u8_t proto, u16_t len)
+{
+  struct pbuf *p;
+  struct ip_hdr *iphdr;
+
+  p = pbuf_alloc(PBUF_RAW, (u16_t)(IP_HLEN + len), PBUF_RAM);
+  LWIP_ASSERT("bench_ip_packet: out of memory", p != NULL);
+  memset(p->payload, 0, IP_HLEN + len);
+
+  iphdr = (struct ip_hdr *)p->payload;
+  IPH_VHLTOS_SET(iphdr, 4, IP_HLEN / 4, 0);
+  IPH_LEN_SET(iphdr, htons((u16_t)(IP_HLEN + len)));
+  IPH_TTL_SET(iphdr, 64);
+  IPH_PROTO_SET(iphdr, proto);
+  ip_addr_copy(iphdr->src, *src_ip);
+  ip_addr_copy(iphdr->dest, bench_netif.ip_addr);
+  IPH_CHKSUM_SET(iphdr, inet_chksum(iphdr, IP_HLEN));
+  return p;
+}
+
+struct pbuf *
+bench_tcp_packet(ip_addr_t *src_ip, u16_t src_port, u16_t dest_port,
+                 u32_t seqno, u32_t ackno, u8_t flags, u16_t len)
+{
+  struct pbuf *p = bench_ip_packet(src_ip, IP_PROTO_TCP, (u16_t)(TCP_HLEN + len));
+  struct tcp_hdr *tcphdr = (struct tcp_hdr *)((u8_t *)p->payload + IP_HLEN);
+
+  tcphdr->src = htons(src_port);
+  tcphdr->dest = htons(dest_port);
+  tcphdr->seqno = htonl(seqno);
+  tcphdr->ackno = htonl(ackno);
+  TCPH_HDRLEN_FLAGS_SET(tcphdr, TCP_HLEN / 4, flags);
+  tcphdr->wnd = htons(TCP_WND);
+  return p;
+}
+
+struct pbuf *
+bench_udp_packet(ip_addr_t *src_ip, u16_t src_port, u16_t dest_port, u16_t len)
+{
+  struct pbuf *p = bench_ip_packet(src_ip, IP_PROTO_UDP, (u16_t)(UDP_HLEN + len));
+  struct udp_hdr *udphdr = (struct udp_hdr *)((u8_t *)p->payload + IP_HLEN);
+
+  udphdr->src = htons(src_port);
+  udphdr->dest = htons(dest_port);
+  udphdr->len = htons((u16_t)(UDP_HLEN + len));
+  return p;
+}
+
+double
+bench_seconds(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (double)now.tv_sec + ((double)now.tv_nsec / 1e9);
+}
+
+#if NO_SYS
+u32_t bench_time_offset;
+
+/** Millisecond clock used by the lwIP timers (sys_arch.c provides it
+ * otherwise) */
+u32_t
+sys_now(void)
+{
+  return (u32_t)(bench_seconds() * 1000.0) + bench_time_offset;
+}
+#endif /* NO_SYS */
@@ -0,0 +1,57 @@
+/**
+ * @file
+ * Helpers shared by the lwIP host benchmarks: a network interface that
+ * records what the stack sends, builders for the packets fed into
+ * ip_input(), and timing.
+ */
+#ifndef __BENCH_COMMON_H__
+#define __BENCH_COMMON_H__
+
+#include "lwip/opt.h"
+#include "lwip/ip_addr.h"
+#include "lwip/netif.h"
+#include "lwip/pbuf.h"
+
+/** The interface the benchmarks use, addressed 10.0.0.1/8 */
+extern struct netif bench_netif;
+
+/** The last TCP segment the stack sent, in host byte order */
+struct bench_tcp_out {
+  u32_t seqno;
+  u32_t ackno;
+  u16_t src;
+  u16_t dest;
+  u8_t flags;
+};
+extern struct bench_tcp_out bench_last_tcp_out;
+/** Number of IP packets the stack sent */
+extern u32_t bench_packets_out;
+
+/** Initialise lwIP and add bench_netif. */
+void bench_init(void);
+
+/** Add bench_netif only, for benchmarks that start lwIP with tcpip_init().
+ * Must be called from tcpip_thread. */
+void bench_netif_add(void);
+
+/** Set addr to 10.a.b.c */
+void bench_ip4(ip_addr_t *addr, u8_t a, u8_t b, u8_t c);
+
+/** Build an IPv4 packet with a TCP header and len bytes of payload from
+ * src_ip:src_port to bench_netif's address. */
+struct pbuf *bench_tcp_packet(ip_addr_t *src_ip, u16_t src_port, u16_t dest_port,
+                              u32_t seqno, u32_t ackno, u8_t flags, u16_t len);
+
+/** Build an IPv4 packet with a UDP header and len bytes of payload from
+ * src_ip:src_port to bench_netif's address. */
+struct pbuf *bench_udp_packet(ip_addr_t *src_ip, u16_t src_port, u16_t dest_port,
+                              u16_t len);
+
+/** Monotonic time in seconds */
+double bench_seconds(void);
+
+/** Milliseconds added to sys_now() (NO_SYS only), so that benchmarks can
+ * run timers without waiting for them */
+extern u32_t bench_time_offset;
+
+#endif /* __BENCH_COMMON_H__ */
@@ -0,0 +1,130 @@
+/**
+ * @file
+ * Checks inet_chksum() and lwip_chksum_copy() against a byte at a time
+ * reference on random data, lengths and alignments, then measures both at
+ * typical packet sizes.
+ *
+ * Build with each LWIP_CHKSUM_ALGORITHM (the Makefile builds 2, 3 and 4, the
+ * latter with and without LWIP_CHKSUM_VECTOR) to compare them.
+ */
+#include "bench_common.h"
+
+#include "lwip/inet_chksum.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef LWIP_CHKSUM_VECTOR
+#define LWIP_CHKSUM_VECTOR 0
+#endif
+
+#define BENCH_BUF_SIZE      (9000 + 64)
+#define BENCH_CHECKS        200000
+#define BENCH_BYTES         (256UL * 1024 * 1024)
+
+static u8_t src_buf[BENCH_BUF_SIZE];
+static u8_t dst_buf[BENCH_BUF_SIZE];
+
+/** Inverted Internet sum of the data, in network order as stored in memory. */
+static u16_t
+reference_chksum(const u8_t *data, int len)
+{
+  u32_t sum = 0;
+  int i;
+
+  for (i = 0; i + 1 < len; i += 2) {
+    sum += (u32_t)((data[i] << 8) | data[i + 1]);
+  }
+  if (i < len) {
+    sum += (u32_t)(data[i] << 8);
+  }
+  while (sum >> 16) {
+    sum = (sum & 0xffff) + (sum >> 16);
+  }
+  return htons((u16_t)~sum);
+}
+
+static int
+check(void)
+{
+  int i;
+
+  for (i = 0; i < BENCH_CHECKS; i++) {
+    int offset = rand() % 16;
+    int len = (i & 1) ? rand() % 64 : rand() % (BENCH_BUF_SIZE - 32);
+    u16_t expected = reference_chksum(src_buf + offset, len);
+    u16_t sum = inet_chksum(src_buf + offset, (u16_t)len);
+
+    if (sum != expected) {
+      printf("inet_chksum mismatch: offset %d len %d: %04x != %04x\n",
+             offset, len, sum, expected);
+      return 0;
+    }
+#if LWIP_CHECKSUM_ON_COPY
+    {
+      int dst_offset = rand() % 16;
+
+      /* lwip_chksum_copy() is only ever called at even offsets */
+      offset &= ~1;
+      dst_offset &= ~1;
+      expected = reference_chksum(src_buf + offset, len);
+      sum = (u16_t)~lwip_chksum_copy(dst_buf + dst_offset, src_buf + offset, (u16_t)len);
+      if (sum != expected || memcmp(dst_buf + dst_offset, src_buf + offset, len) != 0) {
+        printf("lwip_chksum_copy mismatch: offset %d len %d: %04x != %04x\n",
+               offset, len, sum, expected);
+        return 0;
+      }
+    }
+#endif /* LWIP_CHECKSUM_ON_COPY */
+  }
+  return 1;
+}
+
+int
+main(void)
+{
+  static const u16_t sizes[] = {20, 64, 128, 256, 512, 1024, 1460, 4096, 9000};
+  unsigned i;
+  volatile u16_t sink = 0;
+
+  for (i = 0; i < BENCH_BUF_SIZE; i++) {
+    src_buf[i] = (u8_t)rand();
+  }
+
+  printf("LWIP_CHKSUM_ALGORITHM=%d LWIP_CHKSUM_VECTOR=%d LWIP_CHKSUM_COPY_ALGORITHM=%d\n",
+         LWIP_CHKSUM_ALGORITHM, LWIP_CHKSUM_VECTOR, LWIP_CHKSUM_COPY_ALGORITHM);
+  if (!check()) {
+    return 1;
+  }
+  printf("%8s %12s %10s %12s %10s\n", "bytes", "ns/chksum", "GB/s", "ns/copy", "GB/s");
+
+  for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    u16_t len = sizes[i];
+    unsigned long calls = BENCH_BYTES / len;
+    unsigned long n;
+    double start, chksum_time, copy_time = 0;
+
+    start = bench_seconds();
+    for (n = 0; n < calls; n++) {
+      sink += inet_chksum(src_buf, len);
+    }
+    chksum_time = bench_seconds() - start;
+
+#if LWIP_CHECKSUM_ON_COPY
+    start = bench_seconds();
+    for (n = 0; n < calls; n++) {
+      sink += lwip_chksum_copy(dst_buf, src_buf, len);
+    }
+    copy_time = bench_seconds() - start;
+#endif /* LWIP_CHECKSUM_ON_COPY */
+
+    printf("%8u %12.1f %10.2f %12.1f %10.2f\n", len,
+           chksum_time * 1e9 / calls, (double)calls * len / chksum_time / 1e9,
+           copy_time * 1e9 / calls,
+           copy_time > 0 ? (double)calls * len / copy_time / 1e9 : 0.0);
+  }
+
+  (void)sink;
+  return 0;
+}
@@ -0,0 +1,123 @@
+/**
+ * @file
+ * lwIP options for the host benchmarks: the raw API only (NO_SYS), with
+ * enough PCBs and buffers for a few thousand connections. Options that a
+ * benchmark compares are only defaulted here, so the Makefile can build
+ * each variant with -D.
+ *
+ * The sockets benchmarks are built with LWIP_BENCH_SYS=1 instead, which runs
+ * tcpip_thread on the POSIX threads port in sys_arch.c and adds a loopback
+ * interface.
+ */
+#ifndef __LWIPOPTS_H__
+#define __LWIPOPTS_H__
+
+#ifndef LWIP_BENCH_SYS
+#define LWIP_BENCH_SYS                  0
+#endif
+
+#if LWIP_BENCH_SYS
+#define NO_SYS                          0
+#define LWIP_NETCONN                    1
+#define LWIP_SOCKET                     1
+#define LWIP_COMPAT_SOCKETS             0
+#define SYS_LIGHTWEIGHT_PROT            1
+#define LWIP_NETIF_LOOPBACK             1
+#define LWIP_HAVE_LOOPIF                1
+#define TCPIP_MBOX_SIZE                 64
+#define DEFAULT_TCP_RECVMBOX_SIZE       64
+#define DEFAULT_ACCEPTMBOX_SIZE         8
+#define MEMP_NUM_TCPIP_MSG_INPKT        64
+#define MEMP_NUM_TCPIP_INPUT_BATCH      16
+#else /* LWIP_BENCH_SYS */
+#define NO_SYS                          1
+#define LWIP_NETCONN                    0
+#define LWIP_SOCKET                     0
+#define SYS_LIGHTWEIGHT_PROT            0
+#endif /* LWIP_BENCH_SYS */
+
+#ifndef LWIP_TCPIP_CORE_LOCKING
+#define LWIP_TCPIP_CORE_LOCKING         0
+#endif
+
+#define MEM_ALIGNMENT                   8
+#ifndef MEM_SIZE
+#define MEM_SIZE                        (4 * 1024 * 1024)
+#endif
+#define MEMP_NUM_PBUF                   64
+#define MEMP_NUM_TCP_PCB                4200
+#define MEMP_NUM_TCP_PCB_LISTEN         8
+#define MEMP_NUM_TCP_SEG                256
+#define MEMP_NUM_UDP_PCB                4200
+#define PBUF_POOL_SIZE                  64
+
+#define LWIP_ARP                        1
+#define LWIP_ETHERNET                   1
+#define LWIP_ICMP                       1
+#define LWIP_UDP                        1
+#define LWIP_TCP                        1
+#define LWIP_DHCP                       0
+#ifndef LWIP_STATS
+#define LWIP_STATS                      0
+#endif
+
+#define TCP_MSS                         1460
+#define TCP_WND                         (8 * TCP_MSS)
+#define TCP_SND_BUF                     (8 * TCP_MSS)
+#define TCP_SND_QUEUELEN                (4 * TCP_SND_BUF / TCP_MSS)
+
+/* The benchmarks feed the stack hand built packets; leave their checksums
+   unchecked so that only the code under test is timed. */
+#define CHECKSUM_CHECK_IP               0
+#define CHECKSUM_CHECK_TCP              0
+#define CHECKSUM_CHECK_UDP              0
+
+#ifndef LWIP_TCP_PCB_HASH
+#define LWIP_TCP_PCB_HASH               0
+#endif
+#define TCP_PCB_HASH_SIZE               4096
+
+#ifndef LWIP_UDP_PCB_HASH
+#define LWIP_UDP_PCB_HASH               0
+#endif
+#define UDP_PCB_HASH_SIZE               1024
+
+#ifndef LWIP_ARP_HASH
+#define LWIP_ARP_HASH                   0
+#endif
+#if LWIP_ARP_HASH
+#define ARP_TABLE_SIZE                  4096
+#define ARP_HASH_SIZE                   1024
+#define ETHARP_NETIF_HINTS              16
+#else /* LWIP_ARP_HASH */
+#define ARP_TABLE_SIZE                  127
+#endif /* LWIP_ARP_HASH */
+
+#ifndef LWIP_TIMERS_WHEEL
+#define LWIP_TIMERS_WHEEL               0
+#endif
+#ifndef LWIP_TCP_PCB_TIMERS
+#define LWIP_TCP_PCB_TIMERS             0
+#endif
+#define MEMP_NUM_SYS_TIMEOUT            (4096 + 16)
+#define SYS_TIMEOUT_HASH_SIZE           1024
+
+#ifndef MEM_TLSF
+#define MEM_TLSF                        0
+#endif
+
+#ifndef MEMP_LOCKFREE
+#define MEMP_LOCKFREE                   0
+#endif
+#if MEMP_CACHE_SIZE
+/* Each memp_bench thread plays one core. Nothing else runs on a thread's
+   "core" in between, so its caches need no protection. */
+extern __thread int bench_core_id;
+#define MEMP_NUM_CORES                  8
+#define SYS_ARCH_CORE_ID()              bench_core_id
+#define SYS_ARCH_DECL_LOCAL_PROTECT(lev)
+#define SYS_ARCH_LOCAL_PROTECT(lev)
+#define SYS_ARCH_LOCAL_UNPROTECT(lev)
+#endif /* MEMP_CACHE_SIZE */
+
+#endif /* __LWIPOPTS_H__ */
@@ -0,0 +1,139 @@
+/**
+ * @file
+ * Soak test of the lwIP heap with PBUF_RAM allocations shaped like mixed TX
+ * traffic: TCP ACKs and small segments, full sized segments, partly filled
+ * segments and UDP datagrams, some of them shrunk with pbuf_realloc() after
+ * allocation (which calls mem_trim()), all freed in random order. Each phase
+ * reports mem_malloc() latency percentiles, the heap's fragmentation (how
+ * much of the free space the largest free block is) and failed allocations.
+ *
+ * Build with MEM_TLSF=0 and =1 (the Makefile builds both) to compare the
+ * first-fit heap with the TLSF heap.
+ */
+#include "bench_common.h"
+
+#include "lwip/mem.h"
+#include "lwip/stats.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define BENCH_PHASES        6
+#define BENCH_PHASE_OPS     1000000
+/** Allocations are made into and freed from this many slots, about half of
+ * which are in use at any time: enough to fill most of the heap. */
+#define BENCH_SLOTS         420
+/** Latency histogram: BENCH_BUCKET_NS wide buckets, the last one open */
+#define BENCH_BUCKET_NS     10
+#define BENCH_BUCKETS       10000
+
+static struct pbuf *slots[BENCH_SLOTS];
+static u32_t histogram[BENCH_BUCKETS];
+static u32_t rand_state = 1;
+
+static u32_t
+bench_rand(void)
+{
+  rand_state = rand_state * 1103515245u + 12345u;
+  return rand_state >> 8;
+}
+
+/** Picks the payload length of the next TX pbuf */
+static u16_t
+bench_size(void)
+{
+  u32_t r = bench_rand() % 100;
+
+  if (r < 40) {
+    /* ACKs, window updates and small writes */
+    return (u16_t)(bench_rand() % 64);
+  } else if (r < 70) {
+    return TCP_MSS;
+  } else if (r < 90) {
+    return (u16_t)(64 + bench_rand() % (TCP_MSS - 64));
+  }
+  /* UDP: DNS, NTP, small RPCs */
+  return (u16_t)(48 + bench_rand() % 512);
+}
+
+/** Returns latency percentile p (0..1) in ns from the histogram */
+static u32_t
+bench_percentile(u32_t count, double p)
+{
+  u32_t i, sum = 0;
+
+  for (i = 0; i < BENCH_BUCKETS; i++) {
+    sum += histogram[i];
+    if (sum >= (u32_t)(p * count)) {
+      break;
+    }
+  }
+  return (i + 1) * BENCH_BUCKET_NS;
+}
+
+int
+main(void)
+{
+  struct mem_heap_stats heap;
+  double start, max_ns, ns;
+  u32_t allocs, failed, op;
+  int phase, slot;
+  u16_t len;
+
+  bench_init();
+
+  printf("MEM_TLSF=%d MEM_SIZE=%d\n", MEM_TLSF, MEM_SIZE);
+  printf("%6s %8s %8s %8s %9s %8s %7s %7s %7s\n", "phase", "p50 ns", "p99 ns",
+         "p99.9 ns", "max ns", "free KB", "frag %", "search", "failed");
+  for (phase = 1; phase <= BENCH_PHASES; phase++) {
+    memset(histogram, 0, sizeof(histogram));
+    allocs = failed = 0;
+    max_ns = 0;
+
+    for (op = 0; op < BENCH_PHASE_OPS; op++) {
+      slot = (int)(bench_rand() % BENCH_SLOTS);
+      if (slots[slot] != NULL) {
+        pbuf_free(slots[slot]);
+        slots[slot] = NULL;
+        continue;
+      }
+
+      len = bench_size();
+      start = bench_seconds();
+      slots[slot] = pbuf_alloc(PBUF_TRANSPORT, len, PBUF_RAM);
+      ns = (bench_seconds() - start) * 1e9;
+
+      allocs++;
+      histogram[(ns / BENCH_BUCKET_NS) < BENCH_BUCKETS - 1 ? (u32_t)(ns / BENCH_BUCKET_NS) : BENCH_BUCKETS - 1]++;
+      if (ns > max_ns) {
+        max_ns = ns;
+      }
+      if (slots[slot] == NULL) {
+        failed++;
+      } else if ((len > 64) && (bench_rand() % 5 == 0)) {
+        /* a segment that was allocated for more than it ended up holding */
+        pbuf_realloc(slots[slot], (u16_t)(len / 2));
+      }
+    }
+
+    mem_heap_stats(&heap);
+    printf("%6d %8u %8u %8u %9.0f %8.1f %7.1f %7u %7u\n", phase,
+           (unsigned)bench_percentile(allocs, 0.5), (unsigned)bench_percentile(allocs, 0.99),
+           (unsigned)bench_percentile(allocs, 0.999), max_ns, heap.free / 1024.0,
+           heap.free ? 100.0 * (1.0 - (double)heap.largest_free / heap.free) : 0.0,
+           (unsigned)heap.max_search, (unsigned)failed);
+  }
+
+  for (slot = 0; slot < BENCH_SLOTS; slot++) {
+    if (slots[slot] != NULL) {
+      pbuf_free(slots[slot]);
+    }
+  }
+  mem_heap_stats(&heap);
+  if ((heap.free_blocks != 1) || (lwip_stats.mem.used != 0)) {
+    printf("error: %u free blocks and %u bytes used after freeing everything\n",
+           (unsigned)heap.free_blocks, (unsigned)lwip_stats.mem.used);
+    return 1;
+  }
+  return 0;
+}
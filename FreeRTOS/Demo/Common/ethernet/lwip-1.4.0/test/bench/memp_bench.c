@@ -0,0 +1,102 @@
+/**
+ * @file
+ * Measures memp_malloc() and memp_free() throughput as more threads share a
+ * pool. Each thread repeatedly takes BENCH_BURST elements, stamps them,
+ * checks the stamps and frees them again, so an element handed out twice is
+ * caught. The pool high-water mark and failed allocations come from
+ * lwip_stats.memp[] and are cumulative over the runs.
+ *
+ * Build with MEMP_LOCKFREE=0, with MEMP_LOCKFREE=1 and with MEMP_LOCKFREE=1
+ * plus MEMP_CACHE_SIZE (the Makefile builds all three) to compare the pools
+ * behind SYS_ARCH_PROTECT, which is one mutex in sys_arch.c, with the
+ * lock-free free lists and with per-core caches. Each thread plays one core.
+ */
+#include "bench_common.h"
+
+#include "lwip/memp.h"
+#include "lwip/stats.h"
+
+#include <pthread.h>
+#include <stdio.h>
+
+#define BENCH_POOL          MEMP_UDP_PCB
+#define BENCH_BURST         8
+#define BENCH_ROUNDS        250000
+#define BENCH_MAX_THREADS   8
+
+#if MEMP_CACHE_SIZE
+__thread int bench_core_id;
+#endif /* MEMP_CACHE_SIZE */
+
+static u32_t bench_failed;
+static u32_t bench_corrupted;
+
+static void *
+bench_thread(void *arg)
+{
+  int id = (int)(mem_ptr_t)arg;
+  void *elements[BENCH_BURST];
+  u32_t round, stamp;
+  int i;
+
+#if MEMP_CACHE_SIZE
+  bench_core_id = id;
+#endif /* MEMP_CACHE_SIZE */
+
+  for (round = 0; round < BENCH_ROUNDS; round++) {
+    stamp = ((u32_t)id << 24) | round;
+    for (i = 0; i < BENCH_BURST; i++) {
+      elements[i] = memp_malloc(BENCH_POOL);
+      if (elements[i] == NULL) {
+        __atomic_fetch_add(&bench_failed, 1, __ATOMIC_RELAXED);
+      } else {
+        *(volatile u32_t *)elements[i] = stamp + (u32_t)i;
+      }
+    }
+    for (i = 0; i < BENCH_BURST; i++) {
+      if (elements[i] != NULL) {
+        if (*(volatile u32_t *)elements[i] != stamp + (u32_t)i) {
+          __atomic_fetch_add(&bench_corrupted, 1, __ATOMIC_RELAXED);
+        }
+        memp_free(BENCH_POOL, elements[i]);
+      }
+    }
+  }
+  return NULL;
+}
+
+int
+main(void)
+{
+  static const int thread_counts[] = {1, 2, 4, BENCH_MAX_THREADS};
+  pthread_t threads[BENCH_MAX_THREADS];
+  double start, seconds, pairs;
+  unsigned i;
+  int j;
+
+  stats_init();
+  memp_init();
+
+  printf("MEMP_LOCKFREE=%d MEMP_CACHE_SIZE=%d\n", MEMP_LOCKFREE, MEMP_CACHE_SIZE);
+  printf("%8s %16s %16s %12s %8s\n", "threads", "M allocs/s", "ns/alloc+free", "high-water", "failed");
+  for (i = 0; i < sizeof(thread_counts) / sizeof(thread_counts[0]); i++) {
+    start = bench_seconds();
+    for (j = 0; j < thread_counts[i]; j++) {
+      pthread_create(&threads[j], NULL, bench_thread, (void *)(mem_ptr_t)j);
+    }
+    for (j = 0; j < thread_counts[i]; j++) {
+      pthread_join(threads[j], NULL);
+    }
+    seconds = bench_seconds() - start;
+    pairs = (double)thread_counts[i] * BENCH_ROUNDS * BENCH_BURST;
+
+    if (bench_corrupted != 0) {
+      printf("error: %u elements were handed out twice\n", (unsigned)bench_corrupted);
+      return 1;
+    }
+    printf("%8d %16.1f %16.1f %12u %8u\n", thread_counts[i], pairs / seconds / 1e6,
+           (seconds * 1e9) / (pairs / thread_counts[i]),
+           (unsigned)lwip_stats.memp[BENCH_POOL].max, (unsigned)bench_failed);
+  }
+  return 0;
+}
@@ -0,0 +1,178 @@
+/**
+ * @file
+ * Measures TCP receive throughput over the loopback interface with a
+ * consumer that reads every byte once (it checks the stream against the
+ * pattern the sender wrote): once with lwip_recv() into a buffer, once with
+ * lwip_recv_pbuf() reading the pbuf chains in place. The second run starts
+ * with a short lwip_recv(), so the chain it leaves partly read is handed
+ * over too.
+ */
+#include "bench_common.h"
+
+#include "lwip/sockets.h"
+#include "lwip/sys.h"
+#include "lwip/tcpip.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define BENCH_PORT          7
+#define BENCH_BYTES         (64 * 1024 * 1024)
+#define BENCH_CHUNK         (4 * TCP_MSS)
+#define BENCH_RECV_BUF      4096
+#define BENCH_HEAD          100
+/** Pattern byte at stream offset i; a prime keeps it out of step with
+ * segment boundaries */
+#define BENCH_PATTERN(i)    ((u8_t)((i) % 251))
+
+static sys_sem_t bench_ready;
+
+static void
+bench_tcpip_init_done(void *arg)
+{
+  LWIP_UNUSED_ARG(arg);
+  sys_sem_signal(&bench_ready);
+}
+
+/** Streams BENCH_BYTES of the pattern on each of two connections */
+static void
+bench_server_thread(void *arg)
+{
+  static u8_t chunk[BENCH_CHUNK + 251];
+  struct sockaddr_in addr;
+  int listener, s, conn, len, sent;
+  u32_t off;
+
+  LWIP_UNUSED_ARG(arg);
+
+  for (off = 0; off < sizeof(chunk); off++) {
+    chunk[off] = BENCH_PATTERN(off);
+  }
+
+  listener = lwip_socket(AF_INET, SOCK_STREAM, 0);
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_len = sizeof(addr);
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(BENCH_PORT);
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  lwip_bind(listener, (struct sockaddr *)&addr, sizeof(addr));
+  lwip_listen(listener, 1);
+  sys_sem_signal(&bench_ready);
+
+  for (conn = 0; conn < 2; conn++) {
+    s = lwip_accept(listener, NULL, NULL);
+    for (off = 0; off < BENCH_BYTES; off += sent) {
+      len = BENCH_BYTES - off < BENCH_CHUNK ? BENCH_BYTES - off : BENCH_CHUNK;
+      sent = lwip_send(s, chunk + off % 251, len, 0);
+      if (sent <= 0) {
+        break;
+      }
+    }
+    lwip_close(s);
+  }
+  lwip_close(listener);
+}
+
+static int
+bench_connect(void)
+{
+  struct sockaddr_in addr;
+  int s;
+
+  s = lwip_socket(AF_INET, SOCK_STREAM, 0);
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_len = sizeof(addr);
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(BENCH_PORT);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (lwip_connect(s, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+    lwip_close(s);
+    return -1;
+  }
+  return s;
+}
+
+/** Checks len bytes at stream offset off against the pattern, returns the
+ * number of mismatches */
+static u32_t
+bench_consume(const u8_t *data, int len, u32_t off)
+{
+  u32_t bad = 0;
+  u8_t expected = BENCH_PATTERN(off);
+  int i;
+
+  for (i = 0; i < len; i++) {
+    bad += (data[i] != expected);
+    expected = (expected == 250) ? 0 : (u8_t)(expected + 1);
+  }
+  return bad;
+}
+
+/** Receives the whole stream on s, with lwip_recv_pbuf() if zero_copy */
+static int
+bench_receive(int s, int zero_copy, u32_t *received)
+{
+  static u8_t buf[BENCH_RECV_BUF];
+  struct pbuf *p, *q;
+  u32_t off = 0, bad = 0;
+  int len;
+
+  if (zero_copy) {
+    len = lwip_recv(s, buf, BENCH_HEAD, 0);
+    if (len > 0) {
+      bad += bench_consume(buf, len, off);
+      off += len;
+    }
+    while ((len = lwip_recv_pbuf(s, &p, 0, NULL, NULL)) > 0) {
+      for (q = p; q != NULL; q = q->next) {
+        bad += bench_consume((const u8_t *)q->payload, q->len, off);
+        off += q->len;
+      }
+      lwip_recv_pbuf_release(s, p);
+    }
+  } else {
+    while ((len = lwip_recv(s, buf, sizeof(buf), 0)) > 0) {
+      bad += bench_consume(buf, len, off);
+      off += len;
+    }
+  }
+  *received = off;
+  return (bad == 0) && (off == BENCH_BYTES);
+}
+
+int
+main(void)
+{
+  static const char *names[] = {"recv", "recv_pbuf"};
+  double start, elapsed;
+  u32_t received;
+  int s, zero_copy;
+
+  sys_sem_new(&bench_ready, 0);
+  tcpip_init(bench_tcpip_init_done, NULL);
+  sys_sem_wait(&bench_ready);
+  sys_thread_new("server", bench_server_thread, NULL, 0, 0);
+  sys_sem_wait(&bench_ready);
+
+  printf("TCP_WND=%d BENCH_BYTES=%d\n", TCP_WND, BENCH_BYTES);
+  printf("%10s %10s %10s\n", "api", "MB/s", "ns/byte");
+  for (zero_copy = 0; zero_copy < 2; zero_copy++) {
+    s = bench_connect();
+    if (s < 0) {
+      printf("connect failed\n");
+      return 1;
+    }
+    start = bench_seconds();
+    if (!bench_receive(s, zero_copy, &received)) {
+      printf("error: %s received %u bytes or a corrupted stream\n",
+             names[zero_copy], (unsigned)received);
+      return 1;
+    }
+    elapsed = bench_seconds() - start;
+    lwip_close(s);
+
+    printf("%10s %10.1f %10.2f\n", names[zero_copy], BENCH_BYTES / elapsed / 1e6,
+           elapsed * 1e9 / BENCH_BYTES);
+  }
+  return 0;
+}
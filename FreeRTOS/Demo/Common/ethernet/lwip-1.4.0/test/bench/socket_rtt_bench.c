@@ -0,0 +1,165 @@
+/**
+ * @file
+ * Measures the round trip time of small messages between two threads over a
+ * TCP socket on the loopback interface: the client sends a message, the
+ * server echoes it back. Every send() and recv() goes through the sequential
+ * API, so this shows what each call costs.
+ *
+ * Build with LWIP_TCPIP_CORE_LOCKING=0 and =1 (the Makefile builds both) to
+ * compare passing each call to tcpip_thread with locking the core.
+ */
+#include "bench_common.h"
+
+#include "lwip/sockets.h"
+#include "lwip/sys.h"
+#include "lwip/tcpip.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define BENCH_PORT          7
+#define BENCH_MAX_MESSAGE   1024
+#define BENCH_WARMUP        1000
+#define BENCH_ROUND_TRIPS   20000
+
+static sys_sem_t bench_ready;
+
+static void
+bench_tcpip_init_done(void *arg)
+{
+  LWIP_UNUSED_ARG(arg);
+  sys_sem_signal(&bench_ready);
+}
+
+static void
+bench_set_nodelay(int s)
+{
+  int one = 1;
+
+  lwip_setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+}
+
+/** Sends all of buf, returns 0 on error */
+static int
+bench_send_all(int s, const u8_t *buf, int len)
+{
+  while (len > 0) {
+    int sent = lwip_send(s, buf, len, 0);
+
+    if (sent <= 0) {
+      return 0;
+    }
+    buf += sent;
+    len -= sent;
+  }
+  return 1;
+}
+
+/** Receives exactly len bytes, returns 0 on error */
+static int
+bench_recv_all(int s, u8_t *buf, int len)
+{
+  while (len > 0) {
+    int received = lwip_recv(s, buf, len, 0);
+
+    if (received <= 0) {
+      return 0;
+    }
+    buf += received;
+    len -= received;
+  }
+  return 1;
+}
+
+/** Echoes everything received on one connection until it is closed */
+static void
+bench_server_thread(void *arg)
+{
+  static u8_t buf[BENCH_MAX_MESSAGE];
+  struct sockaddr_in addr;
+  int listener, s, len;
+
+  LWIP_UNUSED_ARG(arg);
+
+  listener = lwip_socket(AF_INET, SOCK_STREAM, 0);
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_len = sizeof(addr);
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(BENCH_PORT);
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  lwip_bind(listener, (struct sockaddr *)&addr, sizeof(addr));
+  lwip_listen(listener, 1);
+  sys_sem_signal(&bench_ready);
+
+  s = lwip_accept(listener, NULL, NULL);
+  bench_set_nodelay(s);
+  while ((len = lwip_recv(s, buf, sizeof(buf), 0)) > 0) {
+    if (!bench_send_all(s, buf, len)) {
+      break;
+    }
+  }
+  lwip_close(s);
+  lwip_close(listener);
+}
+
+int
+main(void)
+{
+  static const int sizes[] = {1, 16, 64, 256, 1024};
+  static u8_t message[BENCH_MAX_MESSAGE];
+  static u8_t reply[BENCH_MAX_MESSAGE];
+  struct sockaddr_in addr;
+  unsigned i;
+  int s, n;
+
+  sys_sem_new(&bench_ready, 0);
+  tcpip_init(bench_tcpip_init_done, NULL);
+  sys_sem_wait(&bench_ready);
+  sys_thread_new("server", bench_server_thread, NULL, 0, 0);
+  sys_sem_wait(&bench_ready);
+
+  s = lwip_socket(AF_INET, SOCK_STREAM, 0);
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_len = sizeof(addr);
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(BENCH_PORT);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (lwip_connect(s, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+    printf("connect failed\n");
+    return 1;
+  }
+  bench_set_nodelay(s);
+
+  for (i = 0; i < sizeof(message); i++) {
+    message[i] = (u8_t)i;
+  }
+
+  printf("LWIP_TCPIP_CORE_LOCKING=%d\n", LWIP_TCPIP_CORE_LOCKING);
+  printf("%8s %14s %14s\n", "bytes", "round trips/s", "us/round trip");
+
+  for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    int size = sizes[i];
+    double start, elapsed;
+
+    for (n = 0; n < BENCH_WARMUP + BENCH_ROUND_TRIPS; n++) {
+      if (n == BENCH_WARMUP) {
+        start = bench_seconds();
+      }
+      if (!bench_send_all(s, message, size) || !bench_recv_all(s, reply, size)) {
+        printf("connection failed\n");
+        return 1;
+      }
+    }
+    elapsed = bench_seconds() - start;
+
+    if (memcmp(message, reply, size) != 0) {
+      printf("reply differs from message\n");
+      return 1;
+    }
+    printf("%8d %14.0f %14.2f\n", size, BENCH_ROUND_TRIPS / elapsed,
+           elapsed * 1e6 / BENCH_ROUND_TRIPS);
+  }
+
+  lwip_close(s);
+  return 0;
+}
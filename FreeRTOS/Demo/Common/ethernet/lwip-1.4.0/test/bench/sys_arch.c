@@ -0,0 +1,369 @@
+/**
+ * @file
+ * A POSIX threads port of the lwIP operating system layer, so that the
+ * benchmarks can run tcpip_thread and the netconn/socket API on the host.
+ * Like the FreeRTOS ports, mutexes use priority inheritance.
+ */
+#include "lwip/opt.h"
+
+#if !NO_SYS
+
+#include "lwip/sys.h"
+#include "lwip/err.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+
+/** Capacity of mailboxes created with size 0 (the lwIP default) */
+#define SYS_MBOX_DEFAULT_SIZE 128
+
+struct sys_sem {
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  unsigned count;
+};
+
+struct sys_mutex {
+  pthread_mutex_t lock;
+};
+
+struct sys_mbox {
+  pthread_mutex_t lock;
+  pthread_cond_t not_empty;
+  pthread_cond_t not_full;
+  int size;
+  int first;
+  int count;
+  void *msgs[1];
+};
+
+static pthread_mutex_t sys_prot_lock;
+
+static void
+sys_cond_init(pthread_cond_t *cond)
+{
+  pthread_condattr_t attr;
+
+  pthread_condattr_init(&attr);
+  pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+  pthread_cond_init(cond, &attr);
+  pthread_condattr_destroy(&attr);
+}
+
+static u32_t
+sys_now_ms(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (u32_t)(now.tv_sec * 1000 + now.tv_nsec / 1000000);
+}
+
+/** Waits on cond for at most timeout milliseconds (forever if 0).
+ * @return 0 if woken, ETIMEDOUT if the timeout expired */
+static int
+sys_cond_wait(pthread_cond_t *cond, pthread_mutex_t *lock, u32_t timeout)
+{
+  struct timespec until;
+
+  if (timeout == 0) {
+    return pthread_cond_wait(cond, lock);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &until);
+  until.tv_sec += timeout / 1000;
+  until.tv_nsec += (long)(timeout % 1000) * 1000000;
+  if (until.tv_nsec >= 1000000000) {
+    until.tv_sec++;
+    until.tv_nsec -= 1000000000;
+  }
+  return pthread_cond_timedwait(cond, lock, &until);
+}
+
+void
+sys_init(void)
+{
+  pthread_mutexattr_t attr;
+
+  pthread_mutexattr_init(&attr);
+  pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+  pthread_mutex_init(&sys_prot_lock, &attr);
+  pthread_mutexattr_destroy(&attr);
+}
+
+u32_t
+sys_now(void)
+{
+  return sys_now_ms();
+}
+
+err_t
+sys_sem_new(sys_sem_t *sem, u8_t count)
+{
+  struct sys_sem *s = (struct sys_sem *)malloc(sizeof(struct sys_sem));
+
+  if (s == NULL) {
+    *sem = NULL;
+    return ERR_MEM;
+  }
+  pthread_mutex_init(&s->lock, NULL);
+  sys_cond_init(&s->cond);
+  s->count = count;
+  *sem = s;
+  return ERR_OK;
+}
+
+void
+sys_sem_signal(sys_sem_t *sem)
+{
+  struct sys_sem *s = *sem;
+
+  pthread_mutex_lock(&s->lock);
+  s->count++;
+  pthread_cond_signal(&s->cond);
+  pthread_mutex_unlock(&s->lock);
+}
+
+u32_t
+sys_arch_sem_wait(sys_sem_t *sem, u32_t timeout)
+{
+  struct sys_sem *s = *sem;
+  u32_t start = sys_now_ms();
+  u32_t ret;
+
+  pthread_mutex_lock(&s->lock);
+  while (s->count == 0) {
+    if (sys_cond_wait(&s->cond, &s->lock, timeout) == ETIMEDOUT) {
+      pthread_mutex_unlock(&s->lock);
+      return SYS_ARCH_TIMEOUT;
+    }
+  }
+  s->count--;
+  pthread_mutex_unlock(&s->lock);
+
+  ret = sys_now_ms() - start;
+  return (ret == SYS_ARCH_TIMEOUT) ? ret - 1 : ret;
+}
+
+void
+sys_sem_free(sys_sem_t *sem)
+{
+  struct sys_sem *s = *sem;
+
+  pthread_cond_destroy(&s->cond);
+  pthread_mutex_destroy(&s->lock);
+  free(s);
+}
+
+err_t
+sys_mutex_new(sys_mutex_t *mutex)
+{
+  struct sys_mutex *m = (struct sys_mutex *)malloc(sizeof(struct sys_mutex));
+  pthread_mutexattr_t attr;
+
+  if (m == NULL) {
+    *mutex = NULL;
+    return ERR_MEM;
+  }
+  pthread_mutexattr_init(&attr);
+  pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+  pthread_mutex_init(&m->lock, &attr);
+  pthread_mutexattr_destroy(&attr);
+  *mutex = m;
+  return ERR_OK;
+}
+
+void
+sys_mutex_lock(sys_mutex_t *mutex)
+{
+  pthread_mutex_lock(&(*mutex)->lock);
+}
+
+void
+sys_mutex_unlock(sys_mutex_t *mutex)
+{
+  pthread_mutex_unlock(&(*mutex)->lock);
+}
+
+void
+sys_mutex_free(sys_mutex_t *mutex)
+{
+  pthread_mutex_destroy(&(*mutex)->lock);
+  free(*mutex);
+}
+
+err_t
+sys_mbox_new(sys_mbox_t *mbox, int size)
+{
+  struct sys_mbox *mb;
+
+  if (size <= 0) {
+    size = SYS_MBOX_DEFAULT_SIZE;
+  }
+  mb = (struct sys_mbox *)malloc(sizeof(struct sys_mbox) + (size - 1) * sizeof(void *));
+  if (mb == NULL) {
+    *mbox = NULL;
+    return ERR_MEM;
+  }
+  pthread_mutex_init(&mb->lock, NULL);
+  sys_cond_init(&mb->not_empty);
+  sys_cond_init(&mb->not_full);
+  mb->size = size;
+  mb->first = 0;
+  mb->count = 0;
+  *mbox = mb;
+  return ERR_OK;
+}
+
+/** Appends msg to a locked mailbox that has room for it */
+static void
+sys_mbox_put(struct sys_mbox *mb, void *msg)
+{
+  mb->msgs[(mb->first + mb->count) % mb->size] = msg;
+  mb->count++;
+  pthread_cond_signal(&mb->not_empty);
+}
+
+/** Removes the oldest message from a locked, non-empty mailbox */
+static void
+sys_mbox_get(struct sys_mbox *mb, void **msg)
+{
+  if (msg != NULL) {
+    *msg = mb->msgs[mb->first];
+  }
+  mb->first = (mb->first + 1) % mb->size;
+  mb->count--;
+  pthread_cond_signal(&mb->not_full);
+}
+
+void
+sys_mbox_post(sys_mbox_t *mbox, void *msg)
+{
+  struct sys_mbox *mb = *mbox;
+
+  pthread_mutex_lock(&mb->lock);
+  while (mb->count == mb->size) {
+    pthread_cond_wait(&mb->not_full, &mb->lock);
+  }
+  sys_mbox_put(mb, msg);
+  pthread_mutex_unlock(&mb->lock);
+}
+
+err_t
+sys_mbox_trypost(sys_mbox_t *mbox, void *msg)
+{
+  struct sys_mbox *mb = *mbox;
+  err_t err = ERR_MEM;
+
+  pthread_mutex_lock(&mb->lock);
+  if (mb->count < mb->size) {
+    sys_mbox_put(mb, msg);
+    err = ERR_OK;
+  }
+  pthread_mutex_unlock(&mb->lock);
+  return err;
+}
+
+u32_t
+sys_arch_mbox_fetch(sys_mbox_t *mbox, void **msg, u32_t timeout)
+{
+  struct sys_mbox *mb = *mbox;
+  u32_t start = sys_now_ms();
+  u32_t ret;
+
+  pthread_mutex_lock(&mb->lock);
+  while (mb->count == 0) {
+    if (sys_cond_wait(&mb->not_empty, &mb->lock, timeout) == ETIMEDOUT) {
+      pthread_mutex_unlock(&mb->lock);
+      if (msg != NULL) {
+        *msg = NULL;
+      }
+      return SYS_ARCH_TIMEOUT;
+    }
+  }
+  sys_mbox_get(mb, msg);
+  pthread_mutex_unlock(&mb->lock);
+
+  ret = sys_now_ms() - start;
+  return (ret == SYS_ARCH_TIMEOUT) ? ret - 1 : ret;
+}
+
+u32_t
+sys_arch_mbox_tryfetch(sys_mbox_t *mbox, void **msg)
+{
+  struct sys_mbox *mb = *mbox;
+  u32_t ret = SYS_MBOX_EMPTY;
+
+  pthread_mutex_lock(&mb->lock);
+  if (mb->count > 0) {
+    sys_mbox_get(mb, msg);
+    ret = 0;
+  }
+  pthread_mutex_unlock(&mb->lock);
+  return ret;
+}
+
+void
+sys_mbox_free(sys_mbox_t *mbox)
+{
+  struct sys_mbox *mb = *mbox;
+
+  LWIP_ASSERT("sys_mbox_free: mbox not empty", mb->count == 0);
+  pthread_cond_destroy(&mb->not_full);
+  pthread_cond_destroy(&mb->not_empty);
+  pthread_mutex_destroy(&mb->lock);
+  free(mb);
+}
+
+struct sys_thread_start {
+  lwip_thread_fn function;
+  void *arg;
+};
+
+static void *
+sys_thread_main(void *arg)
+{
+  struct sys_thread_start start = *(struct sys_thread_start *)arg;
+
+  free(arg);
+  start.function(start.arg);
+  return NULL;
+}
+
+sys_thread_t
+sys_thread_new(const char *name, lwip_thread_fn thread, void *arg, int stacksize, int prio)
+{
+  struct sys_thread_start *start;
+  pthread_t id;
+
+  LWIP_UNUSED_ARG(name);
+  LWIP_UNUSED_ARG(stacksize);
+  LWIP_UNUSED_ARG(prio);
+
+  start = (struct sys_thread_start *)malloc(sizeof(struct sys_thread_start));
+  LWIP_ASSERT("sys_thread_new: out of memory", start != NULL);
+  start->function = thread;
+  start->arg = arg;
+  if (pthread_create(&id, NULL, sys_thread_main, start) != 0) {
+    LWIP_ASSERT("sys_thread_new: pthread_create failed", 0);
+  }
+  pthread_detach(id);
+  return (sys_thread_t)id;
+}
+
+sys_prot_t
+sys_arch_protect(void)
+{
+  pthread_mutex_lock(&sys_prot_lock);
+  return 0;
+}
+
+void
+sys_arch_unprotect(sys_prot_t pval)
+{
+  LWIP_UNUSED_ARG(pval);
+  pthread_mutex_unlock(&sys_prot_lock);
+}
+
+#endif /* !NO_SYS */
@@ -0,0 +1,127 @@
+/**
+ * @file
+ * Measures how fast tcp_input() delivers segments as the number of open
+ * connections grows. Connections are opened to a listening pcb by replaying
+ * the three-way handshake, then one byte data segments are fed to randomly
+ * chosen connections through ip_input().
+ *
+ * Build with LWIP_TCP_PCB_HASH=0 and =1 (the Makefile builds both) to compare
+ * the list walk with the hash table lookup.
+ */
+#include "bench_common.h"
+
+#include "lwip/tcp_impl.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define BENCH_LISTEN_PORT   80
+#define BENCH_MAX_CONNS     4096
+#define BENCH_SEGMENTS      200000
+
+/** The peer end of each connection */
+struct bench_peer {
+  ip_addr_t ip;
+  u16_t port;
+  u32_t snd_nxt;
+  u32_t rcv_nxt;
+};
+
+static struct bench_peer peers[BENCH_MAX_CONNS];
+static int num_peers;
+static u32_t bytes_received;
+
+static err_t
+bench_recv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err)
+{
+  LWIP_UNUSED_ARG(arg);
+  LWIP_UNUSED_ARG(err);
+
+  if (p != NULL) {
+    bytes_received += p->tot_len;
+    tcp_recved(pcb, p->tot_len);
+    pbuf_free(p);
+  }
+  return ERR_OK;
+}
+
+static err_t
+bench_accept(void *arg, struct tcp_pcb *pcb, err_t err)
+{
+  LWIP_UNUSED_ARG(arg);
+  LWIP_UNUSED_ARG(err);
+
+  tcp_recv(pcb, bench_recv);
+  return ERR_OK;
+}
+
+/** Opens one more connection by playing the client side of the handshake. */
+static void
+bench_open_connection(void)
+{
+  struct bench_peer *peer = &peers[num_peers];
+  u32_t iss = 1000u * (u32_t)num_peers;
+
+  bench_ip4(&peer->ip, 1, (u8_t)(num_peers >> 8), (u8_t)num_peers);
+  peer->port = (u16_t)(1024 + num_peers);
+
+  ip_input(bench_tcp_packet(&peer->ip, peer->port, BENCH_LISTEN_PORT,
+                            iss, 0, TCP_SYN, 0), &bench_netif);
+  LWIP_ASSERT("no SYN-ACK", (bench_last_tcp_out.flags & (TCP_SYN | TCP_ACK)) == (TCP_SYN | TCP_ACK));
+  peer->snd_nxt = iss + 1;
+  peer->rcv_nxt = bench_last_tcp_out.seqno + 1;
+  ip_input(bench_tcp_packet(&peer->ip, peer->port, BENCH_LISTEN_PORT,
+                            peer->snd_nxt, peer->rcv_nxt, TCP_ACK, 0), &bench_netif);
+  num_peers++;
+}
+
+int
+main(void)
+{
+  static const int conn_counts[] = {1, 16, 64, 256, 1024, 4096};
+  struct tcp_pcb *listen_pcb;
+  unsigned i, j;
+  u32_t rand_state = 1;
+
+  bench_init();
+
+  listen_pcb = tcp_new();
+  tcp_bind(listen_pcb, IP_ADDR_ANY, BENCH_LISTEN_PORT);
+  listen_pcb = tcp_listen(listen_pcb);
+  tcp_accept(listen_pcb, bench_accept);
+
+  printf("LWIP_TCP_PCB_HASH=%d\n", LWIP_TCP_PCB_HASH);
+  printf("%12s %16s %12s\n", "connections", "segments/s", "ns/segment");
+
+  for (i = 0; i < sizeof(conn_counts) / sizeof(conn_counts[0]); i++) {
+    double start, elapsed;
+    u32_t expected;
+
+    while (num_peers < conn_counts[i]) {
+      bench_open_connection();
+    }
+
+    expected = bytes_received + BENCH_SEGMENTS;
+    start = bench_seconds();
+    for (j = 0; j < BENCH_SEGMENTS; j++) {
+      struct bench_peer *peer;
+
+      rand_state = rand_state * 1103515245u + 12345u;
+      peer = &peers[(rand_state >> 8) % (u32_t)num_peers];
+      ip_input(bench_tcp_packet(&peer->ip, peer->port, BENCH_LISTEN_PORT,
+                                peer->snd_nxt, peer->rcv_nxt, TCP_ACK | TCP_PSH, 1),
+               &bench_netif);
+      peer->snd_nxt++;
+    }
+    elapsed = bench_seconds() - start;
+
+    if (bytes_received != expected) {
+      printf("error: %u of %u segments delivered\n",
+             (unsigned)(BENCH_SEGMENTS - (expected - bytes_received)), BENCH_SEGMENTS);
+      return 1;
+    }
+    printf("%12d %16.0f %12.1f\n", num_peers, BENCH_SEGMENTS / elapsed,
+           (elapsed * 1e9) / BENCH_SEGMENTS);
+  }
+  return 0;
+}
@@ -0,0 +1,139 @@
+/**
+ * @file
+ * Measures how fast tcpip_thread takes in received packets when a driver
+ * thread passes them in bursts, one tcpip_input() call per packet compared
+ * with tcpip_input_batch_post(). Packets that can't be posted (mailbox or
+ * message pool full) are dropped, as a driver would, and counted.
+ *
+ * Build with LWIP_TCPIP_CORE_LOCKING_INPUT=0 and =1 (the Makefile builds
+ * both) to also compare posting to tcpip_thread with locking the core.
+ */
+#include "bench_common.h"
+
+#include "lwip/sys.h"
+#include "lwip/tcpip.h"
+#include "lwip/udp.h"
+
+#include <sched.h>
+#include <stdio.h>
+
+#define BENCH_PORT          7
+#define BENCH_PAYLOAD       64
+#define BENCH_BURST         64
+#define BENCH_PACKETS       400000
+
+static sys_sem_t bench_ready;
+static u32_t packets_received;
+
+static void
+bench_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p, ip_addr_t *addr, u16_t port)
+{
+  LWIP_UNUSED_ARG(arg);
+  LWIP_UNUSED_ARG(pcb);
+  LWIP_UNUSED_ARG(addr);
+  LWIP_UNUSED_ARG(port);
+
+  __atomic_fetch_add(&packets_received, 1, __ATOMIC_RELAXED);
+  pbuf_free(p);
+}
+
+static void
+bench_tcpip_init_done(void *arg)
+{
+  struct udp_pcb *pcb;
+
+  LWIP_UNUSED_ARG(arg);
+
+  bench_netif_add();
+  pcb = udp_new();
+  udp_bind(pcb, IP_ADDR_ANY, BENCH_PORT);
+  udp_recv(pcb, bench_recv, NULL);
+  sys_sem_signal(&bench_ready);
+}
+
+/** Passes bursts of packets to the stack, batch_size packets per
+ * tcpip_input_batch_post() call, or one tcpip_input() call per packet if
+ * batch_size is 0. Waits for each burst to be processed before the next. */
+static void
+bench_run(int batch_size)
+{
+  ip_addr_t src;
+  u32_t sent = 0, dropped = 0, received_before;
+  double start, elapsed;
+
+  bench_ip4(&src, 1, 0, 1);
+  received_before = __atomic_load_n(&packets_received, __ATOMIC_RELAXED);
+  start = bench_seconds();
+
+  while (sent < BENCH_PACKETS) {
+    int i;
+    struct tcpip_input_batch *batch = NULL;
+
+    for (i = 0; i < BENCH_BURST; i++) {
+      struct pbuf *p = bench_udp_packet(&src, 1024, BENCH_PORT, BENCH_PAYLOAD);
+
+      if (batch_size == 0) {
+        if (tcpip_input(p, &bench_netif) != ERR_OK) {
+          pbuf_free(p);
+          dropped++;
+        }
+      } else {
+        if (batch == NULL) {
+          batch = tcpip_input_batch_new(&bench_netif);
+        }
+        if (batch == NULL) {
+          pbuf_free(p);
+          dropped++;
+          continue;
+        }
+        tcpip_input_batch_add(batch, p);
+        if ((batch->count == batch_size) || (i == BENCH_BURST - 1)) {
+          u16_t count = batch->count;
+
+          if (tcpip_input_batch_post(batch) != ERR_OK) {
+            dropped += count;
+          }
+          batch = NULL;
+        }
+      }
+    }
+    sent += BENCH_BURST;
+
+    /* let the stack drain the burst, like the gap between two bursts on the
+       wire */
+    while (__atomic_load_n(&packets_received, __ATOMIC_RELAXED) - received_before + dropped < sent) {
+      sched_yield();
+    }
+  }
+  elapsed = bench_seconds() - start;
+
+  if (batch_size == 0) {
+    printf("%10s", "single");
+  } else {
+    printf("%10d", batch_size);
+  }
+  printf(" %14.0f %12.1f %9.2f%%\n", (sent - dropped) / elapsed,
+         elapsed * 1e9 / sent, 100.0 * dropped / sent);
+}
+
+int
+main(void)
+{
+  static const int batch_sizes[] = {0, 4, 8, 16, 32};
+  unsigned i;
+
+  sys_sem_new(&bench_ready, 0);
+  tcpip_init(bench_tcpip_init_done, NULL);
+  sys_sem_wait(&bench_ready);
+
+  printf("LWIP_TCPIP_CORE_LOCKING_INPUT=%d, bursts of %d packets\n",
+         LWIP_TCPIP_CORE_LOCKING_INPUT, BENCH_BURST);
+  printf("%10s %14s %12s %10s\n", "batch", "packets/s", "ns/packet", "dropped");
+
+  for (i = 0; i < sizeof(batch_sizes) / sizeof(batch_sizes[0]); i++) {
+    if (batch_sizes[i] <= TCPIP_INPUT_BATCH_SIZE) {
+      bench_run(batch_sizes[i]);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,170 @@
+/**
+ * @file
+ * Measures what lwIP timeouts cost as the number of them grows: restarting
+ * one of N pending timeouts with sys_untimeout() and sys_timeout(), letting
+ * all N expire, and the time sys_check_timeouts() spends on the TCP timers
+ * while N idle connections are open. Time is moved forward through
+ * bench_time_offset, so a minute of timers runs in a fraction of a second.
+ *
+ * Build with LWIP_TIMERS_WHEEL=0, with LWIP_TIMERS_WHEEL=1 and with
+ * LWIP_TIMERS_WHEEL=1 plus LWIP_TCP_PCB_TIMERS=1 (the Makefile builds all
+ * three) to compare the sorted list, the timing wheel and per-pcb TCP timers.
+ */
+#include "bench_common.h"
+
+#include "lwip/tcp_impl.h"
+#include "lwip/timers.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define BENCH_LISTEN_PORT   80
+#define BENCH_MAX_TIMEOUTS  4096
+#define BENCH_RESTARTS      200000
+#define BENCH_IDLE_SECONDS  60
+/** How far time moves between calls to sys_check_timeouts() */
+#define BENCH_STEP_MS       10
+
+static u32_t timeout_args[BENCH_MAX_TIMEOUTS];
+static u32_t timeouts_fired;
+static u32_t rand_state = 1;
+static int num_conns;
+
+static u32_t
+bench_rand(void)
+{
+  rand_state = rand_state * 1103515245u + 12345u;
+  return rand_state >> 8;
+}
+
+static void
+bench_timeout(void *arg)
+{
+  (*(u32_t *)arg)++;
+  timeouts_fired++;
+}
+
+/** A delay between 1 and 61 seconds */
+static u32_t
+bench_delay(void)
+{
+  return 1000 + bench_rand() % 60000;
+}
+
+/** Moves time forward by msecs, running timeouts every BENCH_STEP_MS */
+static void
+bench_advance(u32_t msecs)
+{
+  u32_t step;
+
+  for (step = 0; step < msecs; step += BENCH_STEP_MS) {
+    bench_time_offset += BENCH_STEP_MS;
+    sys_check_timeouts();
+  }
+}
+
+static err_t
+bench_accept(void *arg, struct tcp_pcb *pcb, err_t err)
+{
+  LWIP_UNUSED_ARG(arg);
+  LWIP_UNUSED_ARG(pcb);
+  LWIP_UNUSED_ARG(err);
+  return ERR_OK;
+}
+
+/** Opens one more connection by playing the client side of the handshake. */
+static void
+bench_open_connection(void)
+{
+  ip_addr_t ip;
+  u16_t port = (u16_t)(1024 + num_conns);
+  u32_t iss = 1000u * (u32_t)num_conns;
+
+  bench_ip4(&ip, 1, (u8_t)(num_conns >> 8), (u8_t)num_conns);
+  ip_input(bench_tcp_packet(&ip, port, BENCH_LISTEN_PORT, iss, 0, TCP_SYN, 0), &bench_netif);
+  LWIP_ASSERT("no SYN-ACK", (bench_last_tcp_out.flags & (TCP_SYN | TCP_ACK)) == (TCP_SYN | TCP_ACK));
+  ip_input(bench_tcp_packet(&ip, port, BENCH_LISTEN_PORT, iss + 1,
+                            bench_last_tcp_out.seqno + 1, TCP_ACK, 0), &bench_netif);
+  num_conns++;
+}
+
+static int
+bench_count_established(void)
+{
+  struct tcp_pcb *pcb;
+  int count = 0;
+
+  for (pcb = tcp_active_pcbs; pcb != NULL; pcb = pcb->next) {
+    if (pcb->state == ESTABLISHED) {
+      count++;
+    }
+  }
+  return count;
+}
+
+int
+main(void)
+{
+  static const int counts[] = {16, 256, 1024, 4096};
+  struct tcp_pcb *listen_pcb;
+  double start, restart_ns, expire_ns;
+  unsigned i;
+  int j, n;
+
+  bench_init();
+
+  printf("LWIP_TIMERS_WHEEL=%d LWIP_TCP_PCB_TIMERS=%d\n", LWIP_TIMERS_WHEEL, LWIP_TCP_PCB_TIMERS);
+  printf("%10s %14s %14s\n", "timeouts", "ns/restart", "ns/expiry");
+  for (i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+    n = counts[i];
+    for (j = 0; j < n; j++) {
+      sys_timeout(bench_delay(), bench_timeout, &timeout_args[j]);
+    }
+
+    start = bench_seconds();
+    for (j = 0; j < BENCH_RESTARTS; j++) {
+      u32_t *arg = &timeout_args[bench_rand() % (u32_t)n];
+
+      sys_untimeout(bench_timeout, arg);
+      sys_timeout(bench_delay(), bench_timeout, arg);
+    }
+    restart_ns = ((bench_seconds() - start) * 1e9) / BENCH_RESTARTS;
+
+    /* all of them are due after 61 seconds */
+    timeouts_fired = 0;
+    bench_time_offset += 61000;
+    start = bench_seconds();
+    sys_check_timeouts();
+    expire_ns = ((bench_seconds() - start) * 1e9) / n;
+    if (timeouts_fired != (u32_t)n) {
+      printf("error: %u of %d timeouts fired\n", (unsigned)timeouts_fired, n);
+      return 1;
+    }
+    printf("%10d %14.1f %14.1f\n", n, restart_ns, expire_ns);
+  }
+
+  listen_pcb = tcp_new();
+  tcp_bind(listen_pcb, IP_ADDR_ANY, BENCH_LISTEN_PORT);
+  listen_pcb = tcp_listen(listen_pcb);
+  tcp_accept(listen_pcb, bench_accept);
+
+  printf("\n%12s %22s\n", "idle conns", "us per second of time");
+  for (i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+    while (num_conns < counts[i]) {
+      bench_open_connection();
+    }
+    /* let the new connections settle */
+    bench_advance(1000);
+
+    start = bench_seconds();
+    bench_advance(BENCH_IDLE_SECONDS * 1000);
+    n = bench_count_established();
+    if (n != num_conns) {
+      printf("error: %d of %d connections established\n", n, num_conns);
+      return 1;
+    }
+    printf("%12d %22.1f\n", num_conns,
+           ((bench_seconds() - start) * 1e6) / BENCH_IDLE_SECONDS);
+  }
+  return 0;
+}
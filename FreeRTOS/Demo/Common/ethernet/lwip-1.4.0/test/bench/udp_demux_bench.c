@@ -0,0 +1,112 @@
+/**
+ * @file
+ * Measures how fast udp_input() delivers datagrams, and how long udp_bind()
+ * takes to find a free port, as the number of UDP pcbs grows. Half of the
+ * pcbs are unconnected servers on fixed ports, the other half clients bound
+ * to an automatically chosen port and connected to a remote peer. Datagrams
+ * are fed to randomly chosen pcbs through ip_input().
+ *
+ * Build with LWIP_UDP_PCB_HASH=0 and =1 (the Makefile builds both) to
+ * compare the list walk with the hash table lookup.
+ */
+#include "bench_common.h"
+
+#include "lwip/udp.h"
+
+#include <stdio.h>
+
+#define BENCH_MAX_PCBS      4096
+#define BENCH_DATAGRAMS     200000
+#define BENCH_SERVER_PORT   5000
+
+/** The remote end of each pcb */
+struct bench_peer {
+  ip_addr_t ip;
+  u16_t src_port;
+  u16_t dest_port;
+};
+
+static struct bench_peer peers[BENCH_MAX_PCBS];
+static int num_pcbs;
+static u32_t datagrams_received;
+
+static void
+bench_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p, ip_addr_t *addr, u16_t port)
+{
+  LWIP_UNUSED_ARG(arg);
+  LWIP_UNUSED_ARG(pcb);
+  LWIP_UNUSED_ARG(addr);
+  LWIP_UNUSED_ARG(port);
+
+  datagrams_received++;
+  pbuf_free(p);
+}
+
+/** Adds one more pcb, alternating between servers and connected clients. */
+static void
+bench_add_pcb(void)
+{
+  struct bench_peer *peer = &peers[num_pcbs];
+  struct udp_pcb *pcb = udp_new();
+
+  LWIP_ASSERT("out of UDP pcbs", pcb != NULL);
+  udp_recv(pcb, bench_recv, NULL);
+  bench_ip4(&peer->ip, 2, (u8_t)(num_pcbs >> 8), (u8_t)num_pcbs);
+  peer->src_port = (u16_t)(1024 + num_pcbs);
+
+  if ((num_pcbs & 1) == 0) {
+    peer->dest_port = (u16_t)(BENCH_SERVER_PORT + num_pcbs);
+    udp_bind(pcb, IP_ADDR_ANY, peer->dest_port);
+  } else {
+    udp_bind(pcb, IP_ADDR_ANY, 0);
+    udp_connect(pcb, &peer->ip, peer->src_port);
+    peer->dest_port = pcb->local_port;
+  }
+  num_pcbs++;
+}
+
+int
+main(void)
+{
+  static const int pcb_counts[] = {2, 16, 64, 256, 1024, 4096};
+  unsigned i, j;
+  u32_t rand_state = 1;
+
+  bench_init();
+
+  printf("LWIP_UDP_PCB_HASH=%d\n", LWIP_UDP_PCB_HASH);
+  printf("%8s %16s %14s %12s\n", "pcbs", "datagrams/s", "ns/datagram", "ns/bind");
+
+  for (i = 0; i < sizeof(pcb_counts) / sizeof(pcb_counts[0]); i++) {
+    double start, bind_time, elapsed;
+    int added = pcb_counts[i] - num_pcbs;
+    u32_t expected;
+
+    start = bench_seconds();
+    while (num_pcbs < pcb_counts[i]) {
+      bench_add_pcb();
+    }
+    bind_time = bench_seconds() - start;
+
+    expected = datagrams_received + BENCH_DATAGRAMS;
+    start = bench_seconds();
+    for (j = 0; j < BENCH_DATAGRAMS; j++) {
+      struct bench_peer *peer;
+
+      rand_state = rand_state * 1103515245u + 12345u;
+      peer = &peers[(rand_state >> 8) % (u32_t)num_pcbs];
+      ip_input(bench_udp_packet(&peer->ip, peer->src_port, peer->dest_port, 32),
+               &bench_netif);
+    }
+    elapsed = bench_seconds() - start;
+
+    if (datagrams_received != expected) {
+      printf("error: %u of %u datagrams delivered\n",
+             (unsigned)(BENCH_DATAGRAMS - (expected - datagrams_received)), BENCH_DATAGRAMS);
+      return 1;
+    }
+    printf("%8d %16.0f %14.1f %12.1f\n", num_pcbs, BENCH_DATAGRAMS / elapsed,
+           (elapsed * 1e9) / BENCH_DATAGRAMS, (bind_time * 1e9) / added);
+  }
+  return 0;
+}